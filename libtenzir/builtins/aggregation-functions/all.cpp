@@ -100,6 +100,18 @@ public:
     TENZIR_UNREACHABLE();
   }
 
+  auto merge(const aggregation_instance& other, session) -> void override {
+    const auto* rhs = dynamic_cast<const all_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    if (state_ == state::failed) {
+      return;
+    }
+    if (rhs->state_ != state::none) {
+      state_ = rhs->state_;
+    }
+    all_ = all_ and rhs->all_;
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     const auto fb_state = [&] {
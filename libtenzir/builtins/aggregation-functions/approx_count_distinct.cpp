@@ -0,0 +1,179 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <tenzir/arrow_table_slice.hpp>
+#include <tenzir/as_bytes.hpp>
+#include <tenzir/detail/type_traits.hpp>
+#include <tenzir/error.hpp>
+#include <tenzir/fbs/aggregation.hpp>
+#include <tenzir/flatbuffer.hpp>
+#include <tenzir/hash/hash.hpp>
+#include <tenzir/hash/xxhash.hpp>
+#include <tenzir/sketch/hyperloglog.hpp>
+#include <tenzir/tql2/eval.hpp>
+#include <tenzir/tql2/plugin.hpp>
+
+#include <cmath>
+
+namespace tenzir::plugins::approx_count_distinct {
+
+namespace {
+
+constexpr auto default_precision = uint8_t{12};
+
+/// Calls `f` with the digest of every non-null value of the series. Values of
+/// fixed-width and string-like types are hashed directly from the Arrow
+/// buffers, all other values are hashed through their views.
+template <class F>
+void for_each_digest(const series& s, F f) {
+  const auto hash_number = [](auto x) {
+    return xxh3_64::make(as_bytes(x));
+  };
+  const auto hash_string = [](auto x) {
+    return xxh3_64::make(as_bytes(x.data(), x.size()));
+  };
+  const auto each = [&](const auto& array, auto digest) {
+    for (auto i = int64_t{0}; i < array.length(); ++i) {
+      if (array.IsValid(i)) {
+        f(digest(array.GetView(i)));
+      }
+    }
+  };
+  match(s.type, [&]<concrete_type Type>(const Type&) {
+    const auto& array = *s.array;
+    if constexpr (std::same_as<Type, null_type>) {
+      return;
+    } else if constexpr (std::same_as<Type, double_type>) {
+      // Positive and negative zero are equal, so they must have equal digests.
+      each(as<arrow::DoubleArray>(array), [&](double x) {
+        return hash_number(x == 0.0 ? 0.0 : x);
+      });
+    } else if constexpr (detail::is_any_v<Type, int64_type, uint64_type,
+                                          duration_type, time_type>) {
+      each(as<type_to_arrow_array_t<Type>>(array), hash_number);
+    } else if constexpr (detail::is_any_v<Type, string_type, blob_type>) {
+      each(as<type_to_arrow_array_t<Type>>(array), hash_string);
+    } else {
+      for (auto i = int64_t{0}; i < array.length(); ++i) {
+        if (array.IsValid(i)) {
+          f(hash(value_at(s.type, array, i)));
+        }
+      }
+    }
+  });
+}
+
+class approx_count_distinct_instance final : public aggregation_instance {
+public:
+  approx_count_distinct_instance(ast::expression expr,
+                                 sketch::hyperloglog sketch)
+    : expr_{std::move(expr)}, sketch_{std::move(sketch)} {
+  }
+
+  auto update(const table_slice& input, session ctx) -> void override {
+    for (auto& arg : eval(expr_, input, ctx)) {
+      for_each_digest(arg, [&](uint64_t digest) {
+        sketch_.add(digest);
+      });
+    }
+  }
+
+  auto get() const -> data override {
+    return data{static_cast<uint64_t>(std::llround(sketch_.estimate()))};
+  }
+
+  auto merge(const aggregation_instance& other, session) -> void override {
+    const auto* rhs
+      = dynamic_cast<const approx_count_distinct_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    sketch_.merge(rhs->sketch_);
+  }
+
+  auto save() const -> chunk_ptr override {
+    auto fbb = flatbuffers::FlatBufferBuilder{};
+    const auto sparse = sketch_.sparse();
+    const auto dense = sketch_.dense();
+    const auto fb_sparse = fbb.CreateVector(sparse.data(), sparse.size());
+    const auto fb_dense = fbb.CreateVector(dense.data(), dense.size());
+    const auto fb_sketch = fbs::aggregation::CreateApproxCountDistinct(
+      fbb, sketch_.precision(), fb_sparse, fb_dense);
+    fbb.Finish(fb_sketch);
+    return chunk::make(fbb.Release());
+  }
+
+  auto restore(chunk_ptr chunk, session ctx) -> void override {
+    const auto fb = flatbuffer<fbs::aggregation::ApproxCountDistinct>::make(
+      std::move(chunk));
+    if (not fb) {
+      diagnostic::warning("invalid FlatBuffer")
+        .note("failed to restore `approx_count_distinct` aggregation instance")
+        .emit(ctx);
+      return;
+    }
+    const auto* fb_sparse = (*fb)->sparse();
+    const auto* fb_dense = (*fb)->dense();
+    auto sketch = sketch::hyperloglog::make(
+      (*fb)->precision(),
+      fb_sparse ? std::span{fb_sparse->data(), fb_sparse->size()}
+                : std::span<const uint32_t>{},
+      fb_dense ? std::span{fb_dense->data(), fb_dense->size()}
+               : std::span<const uint8_t>{});
+    if (not sketch) {
+      diagnostic::warning("{}", sketch.error())
+        .note("failed to restore `approx_count_distinct` aggregation instance")
+        .emit(ctx);
+      return;
+    }
+    sketch_ = std::move(*sketch);
+  }
+
+  auto reset() -> void override {
+    sketch_ = check(sketch::hyperloglog::make(sketch_.precision()));
+  }
+
+private:
+  ast::expression expr_;
+  sketch::hyperloglog sketch_;
+};
+
+class plugin : public virtual aggregation_plugin {
+public:
+  auto name() const -> std::string override {
+    return "approx_count_distinct";
+  };
+
+  auto make_aggregation(invocation inv, session ctx) const
+    -> failure_or<std::unique_ptr<aggregation_instance>> override {
+    auto expr = ast::expression{};
+    auto precision = std::optional<located<int64_t>>{};
+    TRY(argument_parser2::function(name())
+          .positional("x", expr, "any")
+          .named("precision", precision)
+          .parse(inv, ctx));
+    if (precision
+        and (precision->inner < sketch::hyperloglog::min_precision
+             or precision->inner > sketch::hyperloglog::max_precision)) {
+      diagnostic::error("`precision` must be between {} and {}",
+                        sketch::hyperloglog::min_precision,
+                        sketch::hyperloglog::max_precision)
+        .primary(*precision)
+        .emit(ctx);
+      return failure::promise();
+    }
+    auto sketch = check(sketch::hyperloglog::make(
+      precision ? static_cast<uint8_t>(precision->inner) : default_precision));
+    return std::make_unique<approx_count_distinct_instance>(std::move(expr),
+                                                            std::move(sketch));
+  }
+};
+
+} // namespace
+
+} // namespace tenzir::plugins::approx_count_distinct
+
+TENZIR_REGISTER_PLUGIN(tenzir::plugins::approx_count_distinct::plugin)
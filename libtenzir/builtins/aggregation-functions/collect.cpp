@@ -81,6 +81,12 @@ public:
     return result_;
   }
 
+  auto merge(const aggregation_instance& other, session) -> void override {
+    const auto* rhs = dynamic_cast<const collect_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    result_.insert(result_.end(), rhs->result_.begin(), rhs->result_.end());
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     auto offsets = std::vector<flatbuffers::Offset<fbs::Data>>{};
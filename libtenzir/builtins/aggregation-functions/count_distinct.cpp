@@ -117,6 +117,12 @@ public:
     return data{uint64_t{distinct_.size()}};
   }
 
+  auto merge(const aggregation_instance& other, session) -> void override {
+    const auto* rhs = dynamic_cast<const count_distinct_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    distinct_.insert(rhs->distinct_.begin(), rhs->distinct_.end());
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     auto offsets = std::vector<flatbuffers::Offset<fbs::Data>>{};
@@ -124,6 +124,12 @@ public:
     return list{distinct_.begin(), distinct_.end()};
   }
 
+  auto merge(const aggregation_instance& other, session) -> void override {
+    const auto* rhs = dynamic_cast<const distinct_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    distinct_.insert(rhs->distinct_.begin(), rhs->distinct_.end());
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     auto offsets = std::vector<flatbuffers::Offset<fbs::Data>>{};
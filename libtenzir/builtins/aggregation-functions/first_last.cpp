@@ -57,6 +57,18 @@ public:
     return result_;
   }
 
+  auto merge(const aggregation_instance& other, session) -> void override {
+    // We treat the input of the other instance as if it came after ours.
+    const auto* rhs = dynamic_cast<const first_last_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    if (is<caf::none_t>(rhs->result_)) {
+      return;
+    }
+    if (Mode == mode::last or is<caf::none_t>(result_)) {
+      result_ = rhs->result_;
+    }
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     const auto fb_result = pack(fbb, result_);
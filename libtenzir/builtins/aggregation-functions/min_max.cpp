@@ -170,18 +170,61 @@ public:
     return {};
   }
 
+  auto merge(const aggregation_instance& other, session ctx) -> void override {
+    const auto* rhs = dynamic_cast<const min_max_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    if (not rhs->result_) {
+      return;
+    }
+    if (not result_) {
+      type_ = rhs->type_;
+      result_ = rhs->result_;
+      return;
+    }
+    result_ = match(
+      std::tie(*result_, *rhs->result_),
+      [&]<class L, class R>(const L& x, const R& y) -> result_t {
+        if constexpr (std::same_as<L, caf::none_t>
+                      or std::same_as<R, caf::none_t>) {
+          return caf::none;
+        } else if constexpr (std::integral<L> and std::integral<R>) {
+          if (Mode == mode::min ? std::cmp_less(y, x)
+                                : std::cmp_greater(y, x)) {
+            return y;
+          }
+          return x;
+        } else if constexpr (concepts::arithmetic<L>
+                             and concepts::arithmetic<R>) {
+          return Mode == mode::min
+                   ? std::min(static_cast<double>(x), static_cast<double>(y))
+                   : std::max(static_cast<double>(x), static_cast<double>(y));
+        } else if constexpr (std::same_as<L, R>) {
+          return Mode == mode::min ? std::min(x, y) : std::max(x, y);
+        } else {
+          diagnostic::warning("got incompatible types `{}` and `{}`",
+                              type_.kind(), rhs->type_.kind())
+            .primary(expr_)
+            .emit(ctx);
+          return caf::none;
+        }
+      });
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     const auto result
       = not result_ ? data{} : result_->match<data>([](const auto& x) {
           return data{x};
         });
+    // A failed aggregation and one without any input both have a null result,
+    // so we need to store the failure separately.
+    const auto failed = result_ and is<caf::none_t>(*result_);
     const auto fb_result = pack(fbb, result);
     const auto type_bytes = as_bytes(type_);
     auto fb_type = fbb.CreateVector(
       reinterpret_cast<const uint8_t*>(type_bytes.data()), type_bytes.size());
     const auto fb_min_max
-      = fbs::aggregation::CreateMinMaxSum(fbb, fb_result, fb_type);
+      = fbs::aggregation::CreateMinMaxSum(fbb, fb_result, fb_type, failed);
     fbb.Finish(fb_min_max);
     return chunk::make(fbb.Release());
   }
@@ -214,7 +257,11 @@ public:
     }
     match(result, [&]<class T>(const T& x) {
       if constexpr (std::is_same_v<T, caf::none_t>) {
-        result_.reset();
+        if ((*fb)->failed()) {
+          result_.emplace(caf::none);
+        } else {
+          result_.reset();
+        }
       } else if constexpr (result_t::can_have<T>) {
         result_.emplace(x);
       } else {
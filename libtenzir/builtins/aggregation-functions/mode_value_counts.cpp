@@ -73,6 +73,19 @@ public:
     }
   }
 
+  auto merge(const aggregation_instance& other, session) -> void override {
+    const auto* rhs = dynamic_cast<const instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    for (const auto& [value, count] : rhs->counts_) {
+      auto it = counts_.find(value);
+      if (it == counts_.end()) {
+        counts_.emplace_hint(it, value, count);
+        continue;
+      }
+      it.value() += count;
+    }
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     auto offsets
@@ -45,6 +45,23 @@ public:
     return result_;
   }
 
+  auto merge(const aggregation_instance& other, session ctx) -> void override {
+    const auto* rhs = dynamic_cast<const once_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    if (not rhs->done_) {
+      return;
+    }
+    if (done_) {
+      diagnostic::warning("`once` received more than one event")
+        .primary(expr_)
+        .hint("use an aggregation function to aggregate multiple values")
+        .emit(ctx);
+      return;
+    }
+    result_ = rhs->result_;
+    done_ = true;
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     const auto fb_result = pack(fbb, result_);
@@ -182,6 +182,34 @@ public:
     TENZIR_UNREACHABLE();
   }
 
+  auto merge(const aggregation_instance& other, session ctx) -> void override {
+    const auto* rhs = dynamic_cast<const stddev_variance_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    if (state_ == state::failed or rhs->state_ == state::none) {
+      return;
+    }
+    if (rhs->state_ == state::failed) {
+      state_ = state::failed;
+      return;
+    }
+    if (state_ != state::none and state_ != rhs->state_) {
+      diagnostic::warning("got incompatible types `duration` and `number`")
+        .primary(expr_)
+        .emit(ctx);
+      state_ = state::failed;
+      return;
+    }
+    state_ = rhs->state_;
+    const auto count = count_ + rhs->count_;
+    if (count > 0) {
+      const auto weight
+        = static_cast<double>(rhs->count_) / static_cast<double>(count);
+      mean_ += (rhs->mean_ - mean_) * weight;
+      mean_squared_ += (rhs->mean_squared_ - mean_squared_) * weight;
+    }
+    count_ = count;
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     const auto fb_state = [&] {
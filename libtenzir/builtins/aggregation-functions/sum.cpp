@@ -172,18 +172,68 @@ public:
     return data{};
   }
 
+  auto merge(const aggregation_instance& other, session ctx) -> void override {
+    const auto* rhs = dynamic_cast<const sum_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    if (not rhs->sum_) {
+      return;
+    }
+    if (not sum_) {
+      type_ = rhs->type_;
+      sum_ = rhs->sum_;
+      return;
+    }
+    sum_ = match(
+      std::tie(*sum_, *rhs->sum_),
+      [&]<class L, class R>(const L& x, const R& y) -> sum_t {
+        if constexpr (std::same_as<L, caf::none_t>
+                      or std::same_as<R, caf::none_t>) {
+          return caf::none;
+        } else if constexpr (std::integral<L> and std::integral<R>) {
+          // Int64 + UInt64 => UInt64
+          auto checked = checked_add(x, y);
+          if (not checked) {
+            diagnostic::warning("integer overflow").primary(expr_).emit(ctx);
+            return caf::none;
+          }
+          return checked.value();
+        } else if constexpr (concepts::arithmetic<L>
+                             and concepts::arithmetic<R>) {
+          // * + Double => Double
+          return static_cast<double>(x) + static_cast<double>(y);
+        } else if constexpr (std::same_as<L, duration>
+                             and std::same_as<R, duration>) {
+          auto checked = checked_add(x.count(), y.count());
+          if (not checked) {
+            diagnostic::warning("duration overflow").primary(expr_).emit(ctx);
+            return caf::none;
+          }
+          return duration{checked.value()};
+        } else {
+          diagnostic::warning("got incompatible types `{}` and `{}`",
+                              type_.kind(), rhs->type_.kind())
+            .primary(expr_)
+            .emit(ctx);
+          return caf::none;
+        }
+      });
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     const auto result
       = not sum_ ? data{} : sum_->match<data>([](const auto& x) {
           return data{x};
         });
+    // A failed aggregation and one without any input both have a null result,
+    // so we need to store the failure separately.
+    const auto failed = sum_ and is<caf::none_t>(*sum_);
     const auto fb_result = pack(fbb, result);
     const auto type_bytes = as_bytes(type_);
     auto fb_type = fbb.CreateVector(
       reinterpret_cast<const uint8_t*>(type_bytes.data()), type_bytes.size());
     const auto fb_min_max
-      = fbs::aggregation::CreateMinMaxSum(fbb, fb_result, fb_type);
+      = fbs::aggregation::CreateMinMaxSum(fbb, fb_result, fb_type, failed);
     fbb.Finish(fb_min_max);
     return chunk::make(fbb.Release());
   }
@@ -213,7 +263,11 @@ public:
     }
     match(result, [&]<class T>(const T& x) {
       if constexpr (std::is_same_v<T, caf::none_t>) {
-        sum_.reset();
+        if ((*fb)->failed()) {
+          sum_.emplace(caf::none);
+        } else {
+          sum_.reset();
+        }
       } else if constexpr (sum_t::can_have<T>) {
         sum_.emplace(x);
       } else {
@@ -50,6 +50,7 @@ namespace {
 struct start_options {
   bool all = false;
   bool undersized = false;
+  bool cold = false;
   size_t parallel = 1;
   size_t max_partitions = std::numeric_limits<size_t>::max();
   class expression expression = {};
@@ -57,7 +58,7 @@ struct start_options {
   bool automatic = false;
 
   friend auto inspect(auto& f, start_options& x) {
-    return detail::apply_all(f, x.all, x.undersized, x.parallel,
+    return detail::apply_all(f, x.all, x.undersized, x.cold, x.parallel,
                              x.max_partitions, x.expression, x.detached,
                              x.automatic);
   }
@@ -140,6 +141,7 @@ struct rebuilder_state {
   size_t desired_batch_size = 0u;
   size_t automatic_rebuild = 0u;
   duration rebuild_interval = {};
+  duration cold_store_after = {};
 
   /// The state of the ongoing rebuild.
   std::optional<struct run> run = {};
@@ -164,6 +166,7 @@ struct rebuilder_state {
        record{
          {"all", run->options.all},
          {"undersized", run->options.undersized},
+         {"cold", run->options.cold},
          {"parallel", run->options.parallel},
          {"max-partitions", run->options.max_partitions},
          {"expression", fmt::to_string(run->options.expression)},
@@ -207,10 +210,10 @@ struct rebuilder_state {
     }
     run.emplace();
     run->options = std::move(options);
-    TENZIR_DEBUG("{} requests {}{} partitions matching the expression {}",
+    TENZIR_DEBUG("{} requests {}{}{} partitions matching the expression {}",
                  *self, run->options.all ? "all" : "outdated",
                  run->options.undersized ? " undersized" : "",
-                 run->options.expression);
+                 run->options.cold ? " aging" : "", run->options.expression);
     auto rp = self->make_response_promise<void>();
     auto finish = [this, rp](caf::error err, bool silent = false) mutable {
       if (!silent) {
@@ -252,6 +255,7 @@ struct rebuilder_state {
       .then(
         [this, finish](catalog_lookup_result& lookup_result) mutable {
           TENZIR_ASSERT(run->statistics.num_total == 0);
+          const auto now = time::clock::now();
           for (auto& [type, result] : lookup_result.candidate_infos) {
             if (not run->options.all) {
               std::erase_if(
@@ -265,6 +269,11 @@ struct rebuilder_state {
                            * undersized_threshold)) {
                     return false;
                   }
+                  if (run->options.cold
+                      && partition.is_due_for_cold_tier(cold_store_after,
+                                                        now)) {
+                    return false;
+                  }
                   return true;
                 });
             }
@@ -391,12 +400,16 @@ struct rebuilder_state {
     run->statistics.num_rebuilding += current_run_partitions.size();
     // If we have just a single partition then we shouldn't rebuild if our
     // intent was to merge undersized partitions, unless the partition is
-    // oversized or not of the latest partition version.
+    // oversized, not of the latest partition version, or due for the cold
+    // storage tier.
     const auto skip_rebuild
       = run->options.undersized && current_run_partitions.size() == 1
         && current_run_partitions[0].version
              == version::current_partition_version
-        && current_run_partitions[0].events <= max_partition_size;
+        && current_run_partitions[0].events <= max_partition_size
+        && not(run->options.cold
+               && current_run_partitions[0].is_due_for_cold_tier(
+                 cold_store_after, time::clock::now()));
     if (skip_rebuild) {
       TENZIR_DEBUG("{} skips rebuilding of undersized partition {} because no "
                    "other partition of schema {} exists",
@@ -484,6 +497,7 @@ struct rebuilder_state {
     auto options = start_options{
       .all = false,
       .undersized = true,
+      .cold = cold_store_after > duration::zero(),
       .parallel = automatic_rebuild,
       .max_partitions = std::numeric_limits<size_t>::max(),
       .expression = trivially_true_expression(),
@@ -521,6 +535,9 @@ rebuilder(rebuilder_actor::stateful_pointer<rebuilder_state> self,
   self->state().desired_batch_size
     = caf::get_or(content(self->system().config()), "tenzir.import.batch-size",
                   defaults::import::table_slice_size);
+  self->state().cold_store_after
+    = caf::get_or(content(self->system().config()), "tenzir.cold-store-after",
+                  duration::zero());
   self->state().automatic_rebuild = caf::get_or(
     content(self->system().config()), "tenzir.automatic-rebuild", size_t{1});
   if (self->state().automatic_rebuild > 0) {
@@ -658,6 +675,7 @@ rebuild_start_command(const invocation& inv, caf::actor_system& sys) {
   auto options = start_options{
     .all = caf::get_or(inv.options, "tenzir.rebuild.all", false),
     .undersized = caf::get_or(inv.options, "tenzir.rebuild.undersized", false),
+    .cold = caf::get_or(inv.options, "tenzir.rebuild.cold", false),
     .parallel = caf::get_or(inv.options, "tenzir.rebuild.parallel", size_t{1}),
     .max_partitions = caf::get_or(inv.options, "tenzir.rebuild.max-partitions",
                                   std::numeric_limits<size_t>::max()),
@@ -739,6 +757,8 @@ public:
       command::opts("?tenzir.rebuild")
         .add<bool>("all", "rebuild all partitions")
         .add<bool>("undersized", "consider only undersized partitions")
+        .add<bool>("cold", "consider partitions that are due for "
+                           "recompression in the cold storage tier")
         .add<bool>("detached,d", "exit immediately instead of waiting for the "
                                  "rebuild to finish")
         .add<std::string>("read,r", "path for reading the (optional) query")
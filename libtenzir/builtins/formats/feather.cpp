@@ -9,31 +9,44 @@
 #include <tenzir/argument_parser.hpp>
 #include <tenzir/arrow_table_slice.hpp>
 #include <tenzir/arrow_utils.hpp>
+#include <tenzir/batch_statistics.hpp>
+#include <tenzir/bitmap_algorithms.hpp>
 #include <tenzir/chunk.hpp>
 #include <tenzir/collect.hpp>
 #include <tenzir/concept/convertible/data.hpp>
+#include <tenzir/concept/parseable/tenzir/time.hpp>
 #include <tenzir/data.hpp>
+#include <tenzir/defaults.hpp>
+#include <tenzir/detail/base64.hpp>
 #include <tenzir/detail/narrow.hpp>
+#include <tenzir/detail/serialize.hpp>
 #include <tenzir/error.hpp>
 #include <tenzir/fwd.hpp>
 #include <tenzir/generator.hpp>
+#include <tenzir/ids.hpp>
+#include <tenzir/logger.hpp>
 #include <tenzir/make_byte_reader.hpp>
 #include <tenzir/plugin.hpp>
 #include <tenzir/store.hpp>
 #include <tenzir/table_slice.hpp>
 #include <tenzir/tql2/plugin.hpp>
 
+#include <arrow/io/file.h>
 #include <arrow/io/memory.h>
-#include <arrow/ipc/feather.h>
 #include <arrow/ipc/reader.h>
 #include <arrow/ipc/writer.h>
 #include <arrow/record_batch.h>
-#include <arrow/table.h>
-#include <arrow/util/iterator.h>
+#include <arrow/util/compression.h>
 #include <arrow/util/key_value_metadata.h>
+#include <caf/binary_deserializer.hpp>
 #include <caf/expected.hpp>
 
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <numeric>
 #include <queue>
+#include <span>
 #include <string_view>
 
 namespace tenzir::plugins::feather {
@@ -59,37 +72,13 @@ unwrap_record_batch(const std::shared_ptr<arrow::RecordBatch>& rb) {
   return event_rb->ReplaceSchemaMetadata(schema_metadata);
 }
 
-/// Create a constant column for the given import time with `rows` rows
-auto make_import_time_col(const time& import_time, int64_t rows) {
-  auto v = import_time.time_since_epoch().count();
-  auto builder = time_type::make_arrow_builder(arrow::default_memory_pool());
-  check(builder->Reserve(rows));
-  for (int i = 0; i < rows; ++i) {
-    auto status = builder->Append(v);
-    TENZIR_ASSERT(status.ok());
-  }
-  return builder->Finish().ValueOrDie();
-}
+/// The key of the custom metadata that holds the import time of a record batch
+/// in the flat store layout.
+constexpr auto import_time_key = std::string_view{"TENZIR:import_time"};
 
-/// Wrap a record batch into an event envelope containing the event data
-/// as a nested struct alongside metadata as separate columns, containing
-/// the `import_time`.
-auto wrap_record_batch(const table_slice& slice)
-  -> std::shared_ptr<arrow::RecordBatch> {
-  auto rb = to_record_batch(slice);
-  auto event_array = rb->ToStructArray().ValueOrDie();
-  auto time_col = make_import_time_col(slice.import_time(), rb->num_rows());
-  auto schema = arrow::schema(
-    {arrow::field("import_time", time_type::to_arrow_type()),
-     arrow::field("event", event_array->type(), rb->schema()->metadata())});
-  auto new_rb
-    = arrow::RecordBatch::Make(schema, rb->num_rows(), {time_col, event_array});
-  return new_rb;
-}
-
-/// Decode an Arrow IPC stream incrementally.
-auto decode_ipc_stream(chunk_ptr chunk)
-  -> caf::expected<generator<std::shared_ptr<arrow::RecordBatch>>> {
+/// Opens an Arrow IPC file for random access to its record batches.
+auto open_ipc_file(chunk_ptr chunk, const arrow::ipc::IpcReadOptions& options)
+  -> caf::expected<std::shared_ptr<arrow::ipc::RecordBatchFileReader>> {
   // See arrow::ipc::internal::kArrowMagicBytes in
   // arrow/ipc/metadata_internal.h.
   static constexpr auto arrow_magic_bytes = std::string_view{"ARROW1"};
@@ -100,82 +89,197 @@ auto decode_ipc_stream(chunk_ptr chunk)
     return caf::make_error(ec::format_error, "not an Apache Feather v1 or "
                                              "Arrow IPC file");
   }
-  auto open_reader_result
-    = arrow::ipc::RecordBatchFileReader::Open(as_arrow_file(std::move(chunk)));
+  auto open_reader_result = arrow::ipc::RecordBatchFileReader::Open(
+    as_arrow_file(std::move(chunk)), options);
   if (!open_reader_result.ok()) {
     return caf::make_error(ec::format_error,
                            fmt::format("failed to open reader: {}",
                                        open_reader_result.status().ToString()));
   }
-  auto reader = open_reader_result.MoveValueUnsafe();
-  auto get_generator_result = reader->GetRecordBatchGenerator();
-  if (!get_generator_result.ok()) {
-    return caf::make_error(
-      ec::format_error, fmt::format("failed to get batch generator: {}",
-                                    get_generator_result.status().ToString()));
-  }
-  auto gen = get_generator_result.MoveValueUnsafe();
-  return []([[maybe_unused]] auto reader,
-            auto gen) -> generator<std::shared_ptr<arrow::RecordBatch>> {
-    while (true) {
-      auto next = gen();
-      if (!next.is_finished()) {
-        next.Wait();
+  return open_reader_result.MoveValueUnsafe();
+}
+
+/// Checks whether a store was written in the legacy layout, which nests all
+/// event fields in a single `event` column next to an `import_time` column.
+/// The flat layout stores every top-level event field as a column of its own,
+/// which allows for reading only some of them.
+auto is_legacy_layout(const arrow::Schema& schema) -> bool {
+  return schema.num_fields() == 2 and schema.field(0)->name() == "import_time"
+         and schema.field(1)->name() == "event"
+         and (not schema.metadata() or schema.metadata()->size() == 0);
+}
+
+/// Reads the `i`th record batch of a store as a table slice.
+auto read_slice(arrow::ipc::RecordBatchFileReader& reader, int i, bool legacy,
+                const type& schema) -> table_slice {
+  auto batch = reader.ReadRecordBatchWithCustomMetadata(i).ValueOrDie();
+  TENZIR_ASSERT(batch.batch);
+  if (legacy) {
+    auto import_time_column = batch.batch->GetColumnByName("import_time");
+    auto slice = schema ? table_slice{unwrap_record_batch(batch.batch), schema}
+                        : table_slice{unwrap_record_batch(batch.batch)};
+    slice.import_time(derive_import_time(import_time_column));
+    return slice;
+  }
+  auto slice = schema ? table_slice{batch.batch, schema}
+                      : table_slice{batch.batch};
+  if (batch.custom_metadata) {
+    const auto import_time
+      = batch.custom_metadata->Get(std::string{import_time_key});
+    if (import_time.ok()) {
+      slice.import_time(time{duration{std::stoll(*import_time)}});
+    }
+  }
+  return slice;
+}
+
+/// Collects the top-level fields that a tailored expression reads.
+auto top_level_fields(const expression& expr, const record_type& schema)
+  -> std::vector<int> {
+  auto result = std::vector<int>{};
+  for_each_predicate(expr, [&](const predicate& pred) {
+    for (const auto* operand : {&pred.lhs, &pred.rhs}) {
+      if (const auto* ex = try_as<data_extractor>(*operand)) {
+        result.push_back(
+          detail::narrow<int>(schema.resolve_flat_index(ex->column)[0]));
       }
-      TENZIR_ASSERT(next.is_finished());
-      auto result = next.MoveResult().ValueOrDie();
-      if (arrow::IsIterationEnd(result)) {
-        co_return;
+    }
+    return expression{pred};
+  });
+  return result;
+}
+
+/// Rewrites the data extractors of an expression tailored to `from` so that
+/// they apply to `to`, which contains the top-level fields `fields` of `from`.
+auto project_expression(const expression& expr, const record_type& from,
+                        const record_type& to, std::span<const int> fields)
+  -> expression {
+  return for_each_predicate(expr, [&](const predicate& pred) {
+    auto result = pred;
+    for (auto* operand : {&result.lhs, &result.rhs}) {
+      if (auto* ex = try_as<data_extractor>(*operand)) {
+        auto index = from.resolve_flat_index(ex->column);
+        const auto it = std::ranges::find(fields, index[0]);
+        TENZIR_ASSERT(it != fields.end());
+        index[0] = detail::narrow<size_t>(it - fields.begin());
+        ex->column = to.flat_index(index);
       }
-      co_yield std::move(result);
     }
-  }(std::move(reader), std::move(gen));
+    return expression{std::move(result)};
+  });
+}
+
+/// The key of the footer metadata that holds the statistics of all record
+/// batches in the flat store layout.
+constexpr auto statistics_key = std::string_view{"TENZIR:statistics"};
+
+/// Serializes the statistics of all record batches of a store for its footer
+/// metadata.
+auto encode_statistics(std::vector<batch_statistics>& statistics)
+  -> caf::expected<std::string> {
+  auto buffer = caf::byte_buffer{};
+  if (not detail::serialize(buffer, statistics)) {
+    return caf::make_error(ec::serialization_error,
+                           "failed to serialize record batch statistics");
+  }
+  return detail::base64::encode(buffer);
+}
+
+auto decode_statistics(std::string_view encoded)
+  -> caf::expected<std::vector<batch_statistics>> {
+  auto buffer = detail::base64::try_decode(encoded);
+  if (not buffer) {
+    return caf::make_error(ec::parse_error,
+                           "record batch statistics are not valid Base64");
+  }
+  auto result = std::vector<batch_statistics>{};
+  auto f = caf::binary_deserializer{buffer->data(), buffer->size()};
+  if (not f.apply(result)) {
+    return caf::make_error(ec::parse_error,
+                           fmt::format("failed to deserialize record batch "
+                                       "statistics: {}",
+                                       f.get_error()));
+  }
+  return result;
 }
 
 class passive_feather_store final : public passive_store {
   [[nodiscard]] caf::error load(chunk_ptr chunk) override {
-    auto decode_result = decode_ipc_stream(std::move(chunk));
-    if (!decode_result) {
+    auto reader
+      = open_ipc_file(chunk, arrow::ipc::IpcReadOptions::Defaults());
+    if (!reader) {
       return caf::make_error(ec::format_error,
                              fmt::format("failed to load feather store: {}",
-                                         decode_result.error()));
+                                         reader.error()));
     }
-    remaining_slices_generator_ = std::move(*decode_result);
-    remaining_slices_iterator_ = remaining_slices_generator_.begin();
+    chunk_ = std::move(chunk);
+    reader_ = std::move(*reader);
+    num_batches_ = reader_->num_record_batches();
+    legacy_ = is_legacy_layout(*reader_->schema());
+    load_statistics();
     return {};
   }
 
   [[nodiscard]] generator<table_slice> slices() const override {
     auto offset = id{};
-    auto i = size_t{};
-    while (true) {
-      if (i < cached_slices_.size()) {
-        TENZIR_ASSERT(offset == cached_slices_[i].offset());
-      } else if (remaining_slices_iterator_
-                 != remaining_slices_generator_.end()) {
-        auto batch = std::move(*remaining_slices_iterator_);
-        TENZIR_ASSERT(batch);
-        ++remaining_slices_iterator_;
-        auto import_time_column = batch->GetColumnByName("import_time");
-        auto slice = cached_slices_.empty()
-                       ? table_slice{unwrap_record_batch(batch)}
-                       : table_slice{unwrap_record_batch(batch),
-                                     cached_slices_[0].schema()};
+    for (auto i = 0; i < num_batches_; ++i) {
+      if (detail::narrow<size_t>(i) == cached_slices_.size()) {
+        auto slice = read_slice(*reader_, i, legacy_,
+                                cached_slices_.empty()
+                                  ? type{}
+                                  : cached_slices_[0].schema());
         slice.offset(offset);
-        slice.import_time(derive_import_time(import_time_column));
         cached_slices_.push_back(std::move(slice));
-      } else {
-        co_return;
       }
+      TENZIR_ASSERT(offset == cached_slices_[i].offset());
       co_yield cached_slices_[i];
       offset += cached_slices_[i].rows();
-      ++i;
     }
   }
 
+  [[nodiscard]] generator<table_slice>
+  extract(expression expr, ids selection,
+          std::optional<std::vector<std::string>> fields) const override {
+    const auto num_batches = num_batches_;
+    auto batches = select_batches(expr, selection);
+    auto indices = std::vector<int>{};
+    // Reading only some columns pays off only if we did not already decode
+    // the entire store for an earlier query.
+    if (fields and not legacy_
+        and cached_slices_.size() != detail::narrow<size_t>(num_batches)) {
+      const auto& arrow_schema = *reader_->schema();
+      for (const auto& field : *fields) {
+        if (auto index = arrow_schema.GetFieldIndex(field); index >= 0) {
+          indices.push_back(index);
+        }
+      }
+      const auto full_schema = type::from_arrow(arrow_schema);
+      std::ranges::copy(top_level_fields(expr, as<record_type>(full_schema)),
+                        std::back_inserter(indices));
+      std::ranges::sort(indices);
+      const auto [first, last] = std::ranges::unique(indices);
+      indices.erase(first, last);
+      if (indices.empty()) {
+        // We need at least one column to retain the number of rows.
+        indices.push_back(0);
+      }
+      if (detail::narrow<int>(indices.size()) == arrow_schema.num_fields()) {
+        indices.clear();
+      }
+    }
+    if (indices.empty()
+        and batches.size() == detail::narrow<size_t>(num_batches)) {
+      return base_store::extract(std::move(expr), std::move(selection),
+                                 std::move(fields));
+    }
+    return extract_batches(std::move(expr), std::move(selection),
+                           std::move(indices), std::move(batches));
+  }
+
   [[nodiscard]] uint64_t num_events() const override {
     if (cached_num_events_ == 0) {
-      cached_num_events_ = rows(collect(slices()));
+      cached_num_events_
+        = detail::narrow<uint64_t>(reader_->CountRows().ValueOrDie());
     }
     return cached_num_events_;
   }
@@ -188,20 +292,158 @@ class passive_feather_store final : public passive_store {
   }
 
 private:
-  generator<std::shared_ptr<arrow::RecordBatch>> remaining_slices_generator_
-    = {};
-  mutable generator<std::shared_ptr<arrow::RecordBatch>>::iterator
-    remaining_slices_iterator_
-    = {};
+  /// Reads the record batch statistics, if the store has them. Stores that
+  /// were written incrementally keep them in the custom metadata of an empty
+  /// record batch at the end, and older stores in the footer metadata.
+  auto load_statistics() -> void {
+    if (legacy_) {
+      return;
+    }
+    auto encoded = std::optional<std::string>{};
+    if (num_batches_ > 0) {
+      auto last = reader_->ReadRecordBatchWithCustomMetadata(num_batches_ - 1);
+      if (last.ok() and last->batch and last->batch->num_rows() == 0
+          and last->custom_metadata) {
+        auto value = last->custom_metadata->Get(std::string{statistics_key});
+        if (value.ok()) {
+          encoded = std::move(*value);
+          --num_batches_;
+        }
+      }
+    }
+    if (not encoded) {
+      const auto& metadata = reader_->metadata();
+      if (not metadata) {
+        return;
+      }
+      auto value = metadata->Get(std::string{statistics_key});
+      if (not value.ok()) {
+        return;
+      }
+      encoded = std::move(*value);
+    }
+    auto statistics = decode_statistics(*encoded);
+    if (not statistics) {
+      TENZIR_WARN("feather store ignores record batch statistics: {}",
+                  statistics.error());
+      return;
+    }
+    if (statistics->size() != detail::narrow<size_t>(num_batches_)) {
+      TENZIR_WARN("feather store ignores record batch statistics: expected "
+                  "{} entries, got {}",
+                  num_batches_, statistics->size());
+      return;
+    }
+    statistics_ = std::move(*statistics);
+    batch_offsets_.reserve(statistics_.size());
+    auto offset = id{};
+    for (const auto& stats : statistics_) {
+      batch_offsets_.push_back(offset);
+      offset += stats.rows;
+    }
+  }
+
+  /// Returns the indices of all record batches that may contain matches for
+  /// `expr` among the ids in `selection`.
+  auto select_batches(const expression& expr, const ids& selection) const
+    -> std::vector<int> {
+    if (statistics_.empty()) {
+      auto result = std::vector<int>(detail::narrow<size_t>(num_batches_));
+      std::iota(result.begin(), result.end(), 0);
+      return result;
+    }
+    return tenzir::select_batches(expr, selection, statistics_);
+  }
+
+  /// Reads the record batches `batches` and filters them with `expr`, which
+  /// must be tailored to the schema of the store, considering only the ids in
+  /// `selection` unless it is empty. If `indices` is not empty, reads only
+  /// those top-level columns.
+  auto extract_batches(expression expr, ids selection, std::vector<int> indices,
+                       std::vector<int> batches) const
+    -> generator<table_slice> {
+    auto reader = reader_;
+    auto full_schema = type{};
+    if (not indices.empty()) {
+      auto options = arrow::ipc::IpcReadOptions::Defaults();
+      options.included_fields = indices;
+      reader = check(open_ipc_file(chunk_, options));
+      full_schema = type::from_arrow(*reader_->schema());
+    }
+    auto schema = type{};
+    auto batch_expr = expr;
+    auto offset = id{};
+    for (auto i : batches) {
+      if (not batch_offsets_.empty()) {
+        offset = batch_offsets_[i];
+      }
+      auto slice = indices.empty()
+                       and detail::narrow<size_t>(i) < cached_slices_.size()
+                     ? cached_slices_[i]
+                     : read_slice(*reader, i, legacy_, schema);
+      if (not schema) {
+        schema = slice.schema();
+        if (not indices.empty()) {
+          batch_expr = project_expression(expr, as<record_type>(full_schema),
+                                          as<record_type>(schema), indices);
+        }
+      }
+      slice.offset(offset);
+      offset += slice.rows();
+      if (auto filtered_slice = filter(slice, batch_expr, selection)) {
+        co_yield std::move(*filtered_slice);
+      }
+    }
+  }
+
+  chunk_ptr chunk_ = {};
+  std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader_ = {};
+  int num_batches_ = {};
+  bool legacy_ = {};
+  std::vector<batch_statistics> statistics_ = {};
+  std::vector<id> batch_offsets_ = {};
   mutable uint64_t cached_num_events_ = {};
   mutable std::vector<table_slice> cached_slices_ = {};
 };
 
+/// The compression settings of the Feather store backend. Stores whose newest
+/// events are older than `cold_after` when they start writing them belong to
+/// the cold storage tier and use a high zstd level to save disk space. All
+/// other stores belong to the hot storage tier and use a codec that is cheaper
+/// to decode, since recent data is queried much more frequently.
+struct store_options {
+  arrow::Compression::type compression = arrow::Compression::ZSTD;
+  int compression_level = arrow::util::kUseDefaultCompressionLevel;
+  std::optional<duration> cold_after = {};
+  int cold_compression_level = 19;
+};
+
+/// The size of the magic bytes and their padding at the start of an Arrow IPC
+/// file. The remainder of the file up to the footer is an Arrow IPC stream.
+constexpr auto ipc_file_header_size = int64_t{8};
+
 class active_feather_store final : public active_store {
 public:
-  active_feather_store() = default;
+  explicit active_feather_store(store_options options)
+    : options_{options} {
+  }
+
+  void stage(std::filesystem::path path) override {
+    staging_path_ = std::move(path);
+  }
+
+  [[nodiscard]] bool has_staging_file() const override {
+    return sink_ and not buffer_;
+  }
+
+  [[nodiscard]] caf::error staging_error() const override {
+    return staging_error_;
+  }
 
   [[nodiscard]] caf::error add(std::vector<table_slice> new_slices) override {
+    if (staging_error_) {
+      return staging_error_;
+    }
     new_slices_.reserve(new_slices.size() + new_slices_.size());
     for (auto& slice : new_slices) {
       // The index already sets the correct offset for this slice, but in some
@@ -215,41 +457,70 @@ public:
       TENZIR_ASSERT(slice.offset() == num_events_);
       num_events_ += slice.rows();
       num_new_events_ += slice.rows();
+      newest_import_time_ = std::max(newest_import_time_, slice.import_time());
       new_slices_.push_back(std::move(slice));
     }
     while (num_new_events_ >= defaults::import::table_slice_size) {
       auto [lhs, rhs] = split(new_slices_, defaults::import::table_slice_size);
-      rebatched_slices_.push_back(concatenate(std::move(lhs)));
       new_slices_ = std::move(rhs);
       num_new_events_ -= defaults::import::table_slice_size;
+      if (auto err = seal(concatenate(std::move(lhs)))) {
+        return err;
+      }
     }
     TENZIR_ASSERT(num_new_events_ == rows(new_slices_));
     return {};
   }
 
   [[nodiscard]] caf::expected<chunk_ptr> finish() override {
+    if (staging_error_) {
+      return staging_error_;
+    }
     if (num_new_events_ > 0) {
-      rebatched_slices_.push_back(concatenate(std::exchange(new_slices_, {})));
-    }
-    auto record_batches = arrow::RecordBatchVector{};
-    record_batches.reserve(rebatched_slices_.size());
-    for (const auto& slice : rebatched_slices_) {
-      record_batches.push_back(wrap_record_batch(slice));
-    }
-    const auto table = ::arrow::Table::FromRecordBatches(record_batches);
-    if (!table.ok()) {
-      return caf::make_error(ec::system_error, table.status().ToString());
-    }
-    auto output_stream = arrow::io::BufferOutputStream::Create().ValueOrDie();
-    auto write_properties = arrow::ipc::feather::WriteProperties::Defaults();
-    // TODO: Set write_properties.chunksize to the expected batch size
-    write_properties.compression = arrow::Compression::ZSTD;
-    const auto write_status = ::arrow::ipc::feather::WriteTable(
-      *table.ValueUnsafe(), output_stream.get(), write_properties);
-    if (!write_status.ok()) {
+      num_new_events_ = 0;
+      if (auto err = seal(concatenate(std::exchange(new_slices_, {})))) {
+        return err;
+      }
+    }
+    if (statistics_.empty()) {
+      return caf::make_error(ec::logic_error, "cannot persist an empty store");
+    }
+    for (const auto& slice : std::exchange(rebatched_slices_, {})) {
+      if (auto err = write(slice)) {
+        return err;
+      }
+    }
+    // The statistics about every record batch go into the custom metadata of
+    // an empty record batch at the end of the file, so that queries can skip
+    // those that cannot match. Unlike the footer metadata, we do not need to
+    // know them before writing the first record batch.
+    auto encoded_statistics = encode_statistics(statistics_);
+    if (not encoded_statistics) {
+      return std::move(encoded_statistics.error());
+    }
+    auto empty_batch = arrow::RecordBatch::MakeEmpty(writer_schema_);
+    if (not empty_batch.ok()) {
+      return caf::make_error(ec::system_error,
+                             empty_batch.status().ToString());
+    }
+    const auto write_status = writer_->WriteRecordBatch(
+      **empty_batch,
+      arrow::key_value_metadata({std::string{statistics_key}},
+                                {std::move(*encoded_statistics)}));
+    if (not write_status.ok()) {
       return caf::make_error(ec::system_error, write_status.ToString());
     }
-    auto buffer = output_stream->Finish();
+    if (const auto close_status = writer_->Close(); not close_status.ok()) {
+      return caf::make_error(ec::system_error, close_status.ToString());
+    }
+    if (not buffer_) {
+      // The store lives in the staging file.
+      if (const auto close_status = sink_->Close(); not close_status.ok()) {
+        return caf::make_error(ec::system_error, close_status.ToString());
+      }
+      return chunk_ptr{};
+    }
+    auto buffer = buffer_->Finish();
     if (!buffer.ok()) {
       return caf::make_error(ec::system_error, buffer.status().ToString());
     }
@@ -261,6 +532,9 @@ public:
     // may get invalidated while we iterate over it.
     auto rebatched_slices = rebatched_slices_;
     auto new_slices = new_slices_;
+    for (auto&& slice : read_staged(num_staged_batches_)) {
+      co_yield std::move(slice);
+    }
     for (auto& slice : rebatched_slices) {
       co_yield std::move(slice);
     }
@@ -274,10 +548,154 @@ public:
   }
 
 private:
+  /// Completes a record batch. If the store has a staging file, the record
+  /// batch goes there immediately, so that the memory usage of the store is
+  /// bounded by the size of a single record batch.
+  auto seal(table_slice slice) -> caf::error {
+    statistics_.push_back(make_batch_statistics(slice));
+    if (staging_path_.empty()) {
+      rebatched_slices_.push_back(std::move(slice));
+      return {};
+    }
+    if (auto err = write(slice)) {
+      return err;
+    }
+    ++num_staged_batches_;
+    return {};
+  }
+
+  /// Writes a record batch, opening the writer on first use. Every top-level
+  /// field becomes a column of its own, so that queries can read only the
+  /// columns they need. The import time moves into the custom metadata of
+  /// each record batch.
+  auto write(const table_slice& slice) -> caf::error {
+    if (not writer_) {
+      if (auto err = open_writer(slice)) {
+        return err;
+      }
+    }
+    const auto metadata = arrow::key_value_metadata(
+      {std::string{import_time_key}},
+      {fmt::to_string(slice.import_time().time_since_epoch().count())});
+    const auto write_status
+      = writer_->WriteRecordBatch(*to_record_batch(slice), metadata);
+    if (not write_status.ok()) {
+      return caf::make_error(ec::system_error, write_status.ToString());
+    }
+    return {};
+  }
+
+  /// Opens the writer and picks the compression tier from the newest import
+  /// time of the events in the store, which is the same threshold that the
+  /// rebuilder applies to the partition. Stores with a staging file open the
+  /// writer when they seal their first record batch, so they only consider
+  /// the events they received until then.
+  auto open_writer(const table_slice& first) -> caf::error {
+    schema_ = first.schema();
+    writer_schema_ = to_record_batch(first)->schema();
+    const auto cold
+      = options_.cold_after
+        and newest_import_time_ + *options_.cold_after < time::clock::now();
+    auto codec
+      = cold ? arrow::util::Codec::Create(arrow::Compression::ZSTD,
+                                          options_.cold_compression_level)
+             : arrow::util::Codec::Create(options_.compression,
+                                          options_.compression_level);
+    if (not codec.ok()) {
+      return caf::make_error(ec::system_error, codec.status().ToString());
+    }
+    auto write_options = arrow::ipc::IpcWriteOptions::Defaults();
+    write_options.codec = codec.MoveValueUnsafe();
+    if (staging_path_.empty()) {
+      buffer_ = arrow::io::BufferOutputStream::Create().ValueOrDie();
+      sink_ = buffer_;
+    } else {
+      auto err = std::error_code{};
+      std::filesystem::create_directories(staging_path_.parent_path(), err);
+      if (err) {
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to create directory {}: {}",
+                                           staging_path_.parent_path(),
+                                           err.message()));
+      }
+      auto file = arrow::io::FileOutputStream::Open(staging_path_.string());
+      if (not file.ok()) {
+        return caf::make_error(ec::filesystem_error,
+                               file.status().ToString());
+      }
+      sink_ = file.MoveValueUnsafe();
+    }
+    auto writer
+      = arrow::ipc::MakeFileWriter(sink_, writer_schema_, write_options);
+    if (not writer.ok()) {
+      return caf::make_error(ec::system_error, writer.status().ToString());
+    }
+    writer_ = writer.MoveValueUnsafe();
+    return {};
+  }
+
+  /// Reads back the first `count` record batches from the staging file. On
+  /// failure, the generator ends early and the store remembers the error.
+  auto read_staged(size_t count) const -> generator<table_slice> {
+    if (count == 0) {
+      co_return;
+    }
+    auto fail = [&](const arrow::Status& status) {
+      TENZIR_ERROR("feather store failed to read back record batches from {}: "
+                   "{}",
+                   staging_path_, status.ToString());
+      if (not staging_error_) {
+        staging_error_ = caf::make_error(
+          ec::filesystem_error,
+          fmt::format("failed to read back record batches from {}: {}",
+                      staging_path_, status.ToString()));
+      }
+    };
+    auto file = arrow::io::ReadableFile::Open(staging_path_.string());
+    if (not file.ok()) {
+      fail(file.status());
+      co_return;
+    }
+    if (auto status = (*file)->Seek(ipc_file_header_size); not status.ok()) {
+      fail(status);
+      co_return;
+    }
+    auto reader = arrow::ipc::RecordBatchStreamReader::Open(*file);
+    if (not reader.ok()) {
+      fail(reader.status());
+      co_return;
+    }
+    auto offset = id{};
+    for (auto i = size_t{0}; i < count; ++i) {
+      auto batch = std::shared_ptr<arrow::RecordBatch>{};
+      if (auto status = (*reader)->ReadNext(&batch); not status.ok()) {
+        fail(status);
+        co_return;
+      }
+      TENZIR_ASSERT(batch);
+      auto slice = table_slice{batch, schema_};
+      slice.offset(offset);
+      slice.import_time(statistics_[i].import_time);
+      offset += slice.rows();
+      co_yield std::move(slice);
+    }
+  }
+
+  store_options options_ = {};
+  std::filesystem::path staging_path_ = {};
+  type schema_ = {};
+  std::shared_ptr<arrow::Schema> writer_schema_ = {};
+  std::shared_ptr<arrow::io::BufferOutputStream> buffer_ = {};
+  std::shared_ptr<arrow::io::OutputStream> sink_ = {};
+  std::shared_ptr<arrow::ipc::RecordBatchWriter> writer_ = {};
+  std::vector<batch_statistics> statistics_ = {};
+  size_t num_staged_batches_ = {};
+  mutable caf::error staging_error_ = {};
   std::vector<table_slice> rebatched_slices_ = {};
   std::vector<table_slice> new_slices_ = {};
   size_t num_new_events_ = {};
   size_t num_events_ = {};
+  time newest_import_time_ = {};
 };
 
 } // namespace store
@@ -534,6 +952,79 @@ class plugin final : public virtual parser_plugin<feather_parser>,
     return "feather";
   }
 
+  auto initialize(const record& plugin_config, const record& global_config)
+    -> caf::error override {
+    (void)plugin_config;
+    auto compression = try_get_or<std::string>(
+      global_config, "tenzir.store-compression", "zstd");
+    if (not compression) {
+      return std::move(compression.error());
+    }
+    auto compression_type
+      = arrow::util::Codec::GetCompressionType(*compression);
+    if (not compression_type.ok()
+        or not(*compression_type == arrow::Compression::ZSTD
+               or *compression_type == arrow::Compression::LZ4_FRAME
+               or *compression_type == arrow::Compression::UNCOMPRESSED)) {
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("invalid value `{}` for option "
+                                         "`tenzir.store-compression`: must be "
+                                         "`zstd`, `lz4`, or `uncompressed`",
+                                         *compression));
+    }
+    store_options_.compression = *compression_type;
+    if (store_options_.compression == arrow::Compression::ZSTD) {
+      auto level = try_get_or<int64_t>(
+        global_config, "tenzir.zstd-compression-level",
+        int64_t{arrow::util::kUseDefaultCompressionLevel});
+      if (not level) {
+        return std::move(level.error());
+      }
+      store_options_.compression_level = detail::narrow<int>(*level);
+    }
+    auto cold_level = try_get_or<int64_t>(
+      global_config, "tenzir.cold-zstd-compression-level",
+      int64_t{store_options_.cold_compression_level});
+    if (not cold_level) {
+      return std::move(cold_level.error());
+    }
+    store_options_.cold_compression_level = detail::narrow<int>(*cold_level);
+    if (const auto* cold_after
+        = get_if<duration>(&global_config, "tenzir.cold-store-after")) {
+      store_options_.cold_after = *cold_after;
+    } else if (const auto* cold_after = get_if<std::string>(
+                 &global_config, "tenzir.cold-store-after")) {
+      if (not parsers::duration(*cold_after,
+                                store_options_.cold_after.emplace())) {
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("invalid value `{}` for option "
+                                           "`tenzir.cold-store-after`: "
+                                           "expected a duration",
+                                           *cold_after));
+      }
+    }
+    if (store_options_.cold_after
+        and *store_options_.cold_after <= duration::zero()) {
+      store_options_.cold_after.reset();
+    }
+    // Fail early for invalid compression levels rather than when persisting
+    // the first partition.
+    for (auto [type, level] :
+         {std::pair{store_options_.compression,
+                    store_options_.compression_level},
+          std::pair{arrow::Compression::ZSTD,
+                    store_options_.cold_compression_level}}) {
+      auto codec = arrow::util::Codec::Create(type, level);
+      if (not codec.ok()) {
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("failed to create codec for the "
+                                           "feather store: {}",
+                                           codec.status().ToString()));
+      }
+    }
+    return {};
+  }
+
   auto parse_parser(parser_interface& p) const
     -> std::unique_ptr<plugin_parser> override {
     auto parser = argument_parser{"feather", "https://docs.tenzir.com/"
@@ -561,8 +1052,11 @@ class plugin final : public virtual parser_plugin<feather_parser>,
 
   [[nodiscard]] caf::expected<std::unique_ptr<active_store>>
   make_active_store() const override {
-    return std::make_unique<store::active_feather_store>();
+    return std::make_unique<store::active_feather_store>(store_options_);
   }
+
+private:
+  store::store_options store_options_ = {};
 };
 
 class read_plugin final
@@ -12,6 +12,7 @@
 #include <tenzir/multi_series_builder.hpp>
 #include <tenzir/multi_series_builder_argument_parser.hpp>
 #include <tenzir/plugin.hpp>
+#include <tenzir/regex_set.hpp>
 #include <tenzir/series_builder.hpp>
 #include <tenzir/to_lines.hpp>
 #include <tenzir/tql2/eval.hpp>
@@ -27,12 +28,14 @@
 // the built-in patterns need.
 //
 // Boost.Regex _could_ be used for both, but it's slow, so we're using RE2 where
-// we can.
+// we can. This includes selecting the candidates among multiple patterns, if
+// all of them are supported by RE2.
 #include <boost/regex.hpp>
 #include <caf/make_copy_on_write.hpp>
 #include <re2/re2.h>
 
 #include <algorithm>
+#include <numeric>
 #include <ranges>
 #include <span>
 
@@ -450,11 +453,10 @@ public:
     = std::optional<std::variant<located<std::string>, located<record>>>;
 
   grok_parser(pattern_definitions_type pattern_definitions,
-              located<std::string> pattern, bool indexed_captures,
-              bool include_unnamed, multi_series_builder::options opts,
-              diagnostic_handler& dh)
+              std::vector<located<std::string>> input_patterns,
+              bool indexed_captures, bool include_unnamed,
+              multi_series_builder::options opts, diagnostic_handler& dh)
     : patterns_{get_builtin_pattern_store(dh)},
-      input_pattern_{std::move(pattern)},
       indexed_captures_{indexed_captures},
       include_unnamed_{include_unnamed},
       opts_{std::move(opts)} {
@@ -467,8 +469,27 @@ public:
       patterns_->patterns | std::views::values, [](const auto& p) -> bool {
         return p.resolved_pattern.has_value();
       }));
-    input_pattern_.resolve(*patterns_, false);
-    TENZIR_ASSERT(input_pattern_.resolved_pattern);
+    TENZIR_ASSERT(not input_patterns.empty());
+    for (auto& input_pattern : input_patterns) {
+      auto& p = input_patterns_.emplace_back(std::move(input_pattern));
+      p.resolve(*patterns_, false);
+      TENZIR_ASSERT(p.resolved_pattern);
+    }
+    // With multiple patterns, we let RE2 scan each line once for all of them
+    // to find the candidates that Boost.Regex needs to try. This only works if
+    // RE2 supports all the resolved patterns, which is not the case for many
+    // of the built-in ones. Boost.Regex matches bytes rather than code points,
+    // so RE2 must do the same to not miss any candidates.
+    if (input_patterns_.size() > 1) {
+      auto resolved = std::vector<std::string>{};
+      for (const auto& p : input_patterns_) {
+        resolved.push_back(p.resolved_pattern->str());
+      }
+      if (auto set = regex_set::make(std::move(resolved), true,
+                                     regex_set::encoding::latin1)) {
+        prefilter_ = std::move(*set);
+      }
+    }
   }
 
   auto name() const -> std::string override {
@@ -484,27 +505,8 @@ public:
   auto parse_line(multi_series_builder& builder, diagnostic_handler& dh,
                   std::string_view line) const -> bool {
     auto matches = boost::cmatch{};
-    try {
-      if (not boost::regex_match(line.begin(), line.end(), matches,
-                                 *input_pattern_.resolved_pattern)) {
-        diagnostic::warning("pattern could not be matched")
-          .hint("input: `{}`", line)
-          .hint("pattern: `{}`", input_pattern_.resolved_pattern->str())
-          .primary(input_pattern_.loc)
-          .emit(dh);
-        builder.null();
-        return false;
-      }
-    } catch (const boost::regex_error& e) {
-      if (e.code() != boost::regex_constants::error_complexity) {
-        throw;
-      }
-      diagnostic::warning("failed to apply grok pattern due to its complexity")
-        .note("example input: {:?}", line)
-        .hint("try to simplify or optimize your grok pattern")
-        .hint("pattern: `{}`", input_pattern_.resolved_pattern->str())
-        .primary(input_pattern_.loc)
-        .emit(dh);
+    const auto* input_pattern = match_line(dh, line, matches);
+    if (not input_pattern) {
       builder.null();
       return false;
     }
@@ -553,7 +555,7 @@ public:
     };
     if (indexed_captures_) {
       for (int i = 0; i < static_cast<int>(
-                        input_pattern_.resolved_pattern->mark_count() + 1);
+                        input_pattern->resolved_pattern->mark_count() + 1);
            ++i) {
         const auto& match = matches[i];
         // Find the same capture as a named capture,
@@ -561,13 +563,13 @@ public:
         // If there isn't a matching named capture,
         // use the (stringified) index as the field name
         if (auto named_capture_it
-            = std::ranges::find_if(input_pattern_.named_captures,
+            = std::ranges::find_if(input_pattern->named_captures,
                                    [&](const auto& elem) {
                                      const auto& other_match
                                        = matches[elem.first];
                                      return match == other_match;
                                    });
-            named_capture_it != input_pattern_.named_captures.end()) {
+            named_capture_it != input_pattern->named_captures.end()) {
           const auto& [name, type] = *named_capture_it;
           TENZIR_ASSERT(not name.empty());
           add_field(name, match, type);
@@ -577,7 +579,7 @@ public:
         }
       }
     } else {
-      for (auto&& [name, type] : input_pattern_.named_captures) {
+      for (auto&& [name, type] : input_pattern->named_captures) {
         TENZIR_ASSERT(not name.empty());
         add_field(name, matches[name], type);
       }
@@ -621,18 +623,72 @@ public:
     return f.object(x)
       .pretty_name("grok_parser")
       .fields(f.field("patterns", get_patterns, set_patterns),
-              f.field("input_pattern", x.input_pattern_),
+              f.field("input_patterns", x.input_patterns_),
+              f.field("prefilter", x.prefilter_),
               f.field("indexed_captures", x.indexed_captures_),
               f.field("include_unnamed", x.include_unnamed_),
               f.field("opts", x.opts_));
   }
 
 private:
+  // Finds the first input pattern that matches the entire line, and stores its
+  // captures in `matches`. Emits a warning and returns a null pointer if no
+  // pattern matches.
+  auto match_line(diagnostic_handler& dh, std::string_view line,
+                  boost::cmatch& matches) const -> const pattern* {
+    auto candidates = std::vector<int>{};
+    if (prefilter_) {
+      prefilter_->match_all(line, candidates);
+    } else {
+      candidates.resize(input_patterns_.size());
+      std::iota(candidates.begin(), candidates.end(), 0);
+    }
+    auto too_complex = false;
+    for (auto index : candidates) {
+      const auto& p = input_patterns_[index];
+      try {
+        if (boost::regex_match(line.begin(), line.end(), matches,
+                               *p.resolved_pattern)) {
+          return &p;
+        }
+      } catch (const boost::regex_error& e) {
+        if (e.code() != boost::regex_constants::error_complexity) {
+          throw;
+        }
+        diagnostic::warning(
+          "failed to apply grok pattern due to its complexity")
+          .note("example input: {:?}", line)
+          .hint("try to simplify or optimize your grok pattern")
+          .hint("pattern: `{}`", p.resolved_pattern->str())
+          .primary(p.loc)
+          .emit(dh);
+        too_complex = true;
+      }
+    }
+    if (not too_complex) {
+      auto diag = diagnostic::warning("pattern could not be matched")
+                    .hint("input: `{}`", line)
+                    .primary(input_patterns_.front().loc);
+      if (input_patterns_.size() == 1) {
+        diag = std::move(diag).hint(
+          "pattern: `{}`", input_patterns_.front().resolved_pattern->str());
+      } else {
+        diag = std::move(diag).note("none of the {} patterns matched",
+                                    input_patterns_.size());
+      }
+      std::move(diag).emit(dh);
+    }
+    return nullptr;
+  }
+
   // FIXME: The CoW semantics aren't really being taken advantage of here,
   // because inspect() has to create a copy of this every time.
   caf::intrusive_cow_ptr<pattern_store> patterns_{
     caf::make_copy_on_write<pattern_store>()};
-  pattern input_pattern_{};
+  std::vector<pattern> input_patterns_{};
+  // Selects the candidates among multiple input patterns, if RE2 supports all
+  // of them.
+  std::optional<regex_set> prefilter_{};
   bool indexed_captures_{false};
   bool include_unnamed_{false};
   multi_series_builder::options opts_;
@@ -691,10 +747,10 @@ public:
       }
     }
     msb_opts->settings.default_schema_name = "tenzir.grok";
-    return std::make_unique<grok_parser>(std::move(pattern_definitions),
-                                         std::move(raw_pattern),
-                                         indexed_captures, include_unnamed,
-                                         std::move(*msb_opts), dh);
+    return std::make_unique<grok_parser>(
+      std::move(pattern_definitions),
+      std::vector<located<std::string>>{std::move(raw_pattern)},
+      indexed_captures, include_unnamed, std::move(*msb_opts), dh);
   }
 };
 
@@ -724,6 +780,35 @@ auto extract_pattern_definitions(std::optional<ast::expression> expr,
     });
 }
 
+auto extract_input_patterns(located<data> patterns, session ctx)
+  -> failure_or<std::vector<located<std::string>>> {
+  auto result = std::vector<located<std::string>>{};
+  auto error = [&] {
+    auto t = type::infer(patterns.inner);
+    diagnostic::error("`pattern` must be `{}` or `list<string>`",
+                      type{string_type{}}.kind())
+      .primary(patterns, "got `{}`", t ? t->kind() : type_kind{})
+      .emit(ctx);
+    return failure::promise();
+  };
+  if (auto* str = try_as<std::string>(&patterns.inner)) {
+    result.emplace_back(std::move(*str), patterns.source);
+    return result;
+  }
+  auto* xs = try_as<list>(&patterns.inner);
+  if (not xs or xs->empty()) {
+    return error();
+  }
+  for (auto& x : *xs) {
+    auto* str = try_as<std::string>(&x);
+    if (not str) {
+      return error();
+    }
+    result.emplace_back(std::move(*str), patterns.source);
+  }
+  return result;
+}
+
 class read_grok_plugin : public operator_plugin2<parser_adapter<grok_parser>> {
 public:
   auto name() const -> std::string override {
@@ -734,10 +819,10 @@ public:
     -> failure_or<operator_ptr> override {
     auto parser = argument_parser2::operator_(name());
     auto pattern_definitions_expression = std::optional<ast::expression>{};
-    auto raw_pattern = located<std::string>{};
+    auto raw_patterns = located<data>{};
     auto indexed_captures = false;
     auto include_unnamed = false;
-    parser.positional("pattern", raw_pattern);
+    parser.positional("pattern", raw_patterns, "string|list<string>");
     parser.named("pattern_definitions", pattern_definitions_expression,
                  "record|string");
     parser.named("indexed_captures", indexed_captures);
@@ -750,9 +835,11 @@ public:
     TRY(auto pattern_definitions,
         extract_pattern_definitions(std::move(pattern_definitions_expression),
                                     ctx));
+    TRY(auto input_patterns, extract_input_patterns(std::move(raw_patterns),
+                                                    ctx));
     try {
       return std::make_unique<parser_adapter<grok_parser>>(grok_parser{
-        std::move(pattern_definitions), std::move(raw_pattern),
+        std::move(pattern_definitions), std::move(input_patterns),
         indexed_captures, include_unnamed, std::move(opts), ctx.dh()});
     } catch (diagnostic diag) {
       std::move(diag).modify().emit(ctx);
@@ -795,7 +882,7 @@ public:
     try {
       auto p = grok_parser{
         std::move(pattern_definitions),
-        std::move(pattern),
+        std::vector<located<std::string>>{std::move(pattern)},
         indexed_captures,
         include_unnamed,
         std::move(msb_opts),
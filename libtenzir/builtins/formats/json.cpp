@@ -11,6 +11,7 @@
 #include <tenzir/argument_parser.hpp>
 #include <tenzir/arrow_table_slice.hpp>
 #include <tenzir/cast.hpp>
+#include <tenzir/columnar_json_printer.hpp>
 #include <tenzir/concept/parseable/tenzir/data.hpp>
 #include <tenzir/concept/printable/tenzir/json.hpp>
 #include <tenzir/config_options.hpp>
@@ -27,6 +28,7 @@
 #include <tenzir/multi_series_builder.hpp>
 #include <tenzir/multi_series_builder_argument_parser.hpp>
 #include <tenzir/operator_control_plane.hpp>
+#include <tenzir/parallel_parse.hpp>
 #include <tenzir/plugin.hpp>
 #include <tenzir/series_builder.hpp>
 #include <tenzir/si_literals.hpp>
@@ -183,293 +185,37 @@ struct parser_args {
   }
 };
 
-/// Split the incoming byte stream at newlines such that the concatenation of
-/// each resulting chunk vector is a self-contained unit for parallelization.
-///
-/// Only yields an empty vector if the input yielded an empty chunk, which means
-/// that the operator's input buffer is exhausted.
-auto split_for_parallelization(generator<chunk_ptr> input, std::byte splitter)
-  -> generator<std::vector<chunk_ptr>> {
-  // Split at the next newline after the given number of bytes.
-  constexpr auto split_after_size = size_t{1'000'000};
-  // The duration after which to yield incoming lines at the latest.
-  constexpr auto timeout = defaults::import::batch_timeout;
-  // Accumulates all chunks that should be part of the next chunk group. This is
-  // for example needed in case the last newline is in the middle of a batch.
-  auto current = std::vector<chunk_ptr>{};
-  // The total size of all batches in `current`.
-  auto current_size = size_t{0};
-  auto next_timeout = time::clock::now() + timeout;
-  auto pop_before_last_linebreak
-    = [&]() -> std::optional<std::vector<chunk_ptr>> {
-    // We have to search all chunks here because the last newline is not
-    // necessarily in the last chunk.
-    for (auto& chunk : std::views::reverse(current)) {
-      auto bytes = as_bytes(chunk);
-      for (const auto& byte : std::views::reverse(bytes)) {
-        if (byte == splitter) {
-          auto end = detail::narrow<size_t>(&byte - bytes.data());
-          auto rest = std::vector<chunk_ptr>{};
-          // Move the remainder of the chunk where the newline is in.
-          if (end + 1 != bytes.size()) {
-            rest.push_back(chunk->slice(end + 1, bytes.size()));
-          }
-          if (end != 0) {
-            chunk = chunk->slice(0, end);
-          }
-          // Move the subsequent chunks.
-          auto chunk_index = &chunk - current.data();
-          rest.insert(rest.end(),
-                      std::move_iterator{current.begin() + chunk_index + 1},
-                      std::move_iterator{current.end()});
-          current.erase(current.begin() + chunk_index + 1, current.end());
-          // Return everything up the newline and continue with the rest.
-          auto result = std::move(current);
-          current = std::move(rest);
-          current_size = 0;
-          for (auto& chunk : current) {
-            current_size += chunk->size();
-          }
-          return result;
-        }
-      }
-    }
-    return std::nullopt;
-  };
-  for (auto&& chunk : input) {
-    auto now = time::clock::now();
-    if (now > next_timeout) {
-      if (auto pop = pop_before_last_linebreak()) {
-        co_yield std::move(*pop);
-      }
-      // Even if we couldn't pop anything, we still reset the timeout to prevent
-      // looping there over and over again.
-      next_timeout = now + timeout;
-    }
-    if (not chunk) {
-      // This means that the operator has no more input. We propagate that
-      // information up by yielding an empty vector.
-      co_yield {};
-      continue;
-    }
-    TENZIR_ASSERT(chunk->size() != 0);
-    if (current.empty()) {
-      next_timeout = now + timeout;
-    }
-    // If we are under our splitting minimum, we just have to insert the batch.
-    if (current_size + chunk->size() < split_after_size
-        and now < next_timeout) {
-      current.push_back(std::move(chunk));
-      current_size += current.back()->size();
-      continue;
-    }
-    // Otherwise, we find the last linebreak and yield everything before that.
-    auto yielded = false;
-    auto bytes = as_bytes(chunk);
-    for (const auto& byte : std::views::reverse(bytes)) {
-      // This handles both LF and CRLF. In the latter case, the CR becomes part
-      // of the chunk but is ignored later.
-      if (byte == splitter) {
-        auto end = detail::narrow<size_t>(&byte - bytes.data());
-        if (end != 0) {
-          current.push_back(chunk->slice(0, end));
-          current_size += current.back()->size();
-        }
-        co_yield std::move(current);
-        yielded = true;
-        current.clear();
-        current_size = 0;
-        // Remember the rest of the current chunk, if there is any.
-        if (end + 1 != bytes.size()) {
-          current.push_back(chunk->slice(end + 1, bytes.size()));
-          current_size += current.back()->size();
-        }
-        next_timeout = now + timeout;
-        break;
-      }
-    }
-    // If there was no linebreak, we have to insert the entire chunk.
-    if (not yielded) {
-      current.push_back(std::move(chunk));
-      current_size += current.back()->size();
-      // We do not yield here. Instead, we decided to very quickly drain the
-      // input buffer if there are no newlines in the current input buffer. Once
-      // it is drained, we get an empty chunk, which then leads to a yield.
-    }
-  }
-  // There can be remaining chunks if the last one didn't end with a newline.
-  if (not current.empty()) {
-    co_yield std::move(current);
-  }
-}
-
 /// Parse the incoming NDJSON byte stream in multiple threads.
-///
-/// The current implementation always assumes that it can reorder the output.
 auto parse_parallelized(generator<chunk_ptr> input, parser_args args,
                         operator_control_plane& ctrl)
   -> generator<table_slice> {
-  // TODO: We assume here that we can reorder outputs. However, even if we
-  // maintain the order if we are not allowed to reorder, the output can
-  // slightly change because we use separate builders.
-  args.builder_options.settings.ordered = false;
-  // We use a single input queue to communicate with all worker threads. Putting
-  // the empty vector in here tells the thread to stop.
-  auto inputs = std::deque<std::vector<chunk_ptr>>{};
-  auto inputs_mutex = std::mutex{};
-  auto inputs_cv = std::condition_variable{};
-  // All worker threads write to the same output queue. Note that there is no
-  // condition variable for the output. This is because we need to run the
-  // distributing thread if we get new input from the preceding operator. We
-  // would thus need to block on a combination of getting new input and
-  // receiving output from one of our workers, but that doesn't seem to be
-  // possible within the constraints of the current implementation.
-  auto outputs = std::deque<table_slice>{};
-  auto outputs_mutex = std::mutex{};
-  auto work = [&](shared_diagnostic_handler dh) {
-    caf::detail::set_thread_name("read_work");
-    // We reuse the parser throughout all iterations.
-    auto parser = ndjson_parser{args.parser_name, dh, args.builder_options};
-    while (true) {
-      auto inputs_lock = std::unique_lock{inputs_mutex};
-      inputs_cv.wait(inputs_lock, [&] {
-        return not inputs.empty();
-      });
-      auto stop = inputs.front().empty();
-      if (stop) {
-        // We intentionally don't pop the element so that the other threads can
-        // also get to see it.
-        return;
-      }
-      auto input = std::move(inputs.front());
-      inputs.pop_front();
-      inputs_lock.unlock();
-      auto input_gen = std::invoke(
-        [](std::vector<chunk_ptr> input) -> generator<chunk_ptr> {
-          for (auto& chunk : input) {
-            co_yield std::move(chunk);
-          }
-        },
-        std::move(input));
+  auto options = parallel_parse_options{
+    .jobs = args.jobs,
+    .separator = args.split_mode == split_at::null ? std::byte{'\0'}
+                                                   : std::byte{'\n'},
+    .ordered = args.builder_options.settings.ordered,
+  };
+  auto make_parser = [args](diagnostic_handler& dh) -> parallel_parse_function {
+    // We reuse the parser throughout all invocations of a worker.
+    auto parser = std::make_shared<ndjson_parser>(args.parser_name, dh,
+                                                  args.builder_options);
+    return [parser, split_mode = args.split_mode](generator<chunk_ptr> input) {
       auto split_gen = std::invoke([&] {
-        switch (args.split_mode) {
+        switch (split_mode) {
           case split_at::newline:
-            return split_at_crlf(std::move(input_gen));
+            return split_at_crlf(std::move(input));
           case split_at::null:
-            return split_at_null(std::move(input_gen));
+            return split_at_null(std::move(input));
           case split_at::none:
             TENZIR_UNREACHABLE();
         }
         TENZIR_UNREACHABLE();
       });
-      auto parsed = parser_loop<ndjson_parser&>(std::move(split_gen), parser);
-      for (auto slice : parsed) {
-        if (slice.rows() == 0) {
-          // We don't care, because our input is already fully there.
-          continue;
-        }
-        auto outputs_lock = std::unique_lock{outputs_mutex};
-        outputs.push_back(std::move(slice));
-      }
-    }
-  };
-  // Set up the threads.
-  TENZIR_ASSERT(args.jobs > 0);
-  auto threads = std::vector<std::thread>{};
-  for (auto i = uint64_t{0}; i < args.jobs; ++i) {
-    threads.emplace_back(work, ctrl.shared_diagnostics());
-  }
-  // With the current execution model, the generator can be destroyed at any
-  // yield. Because we are running threads, we need to protect against that.
-  auto guard = detail::scope_guard{[&]() noexcept {
-    auto inputs_lock = std::unique_lock{inputs_mutex};
-    // We clear the inputs here because we don't care about the output anymore.
-    inputs.clear();
-    inputs.emplace_back();
-    inputs_lock.unlock();
-    inputs_cv.notify_all();
-    for (auto& thread : threads) {
-      thread.join();
-    }
-  }};
-  auto pop_output = [&]() -> std::optional<table_slice> {
-    auto outputs_lock = std::unique_lock{outputs_mutex};
-    if (outputs.empty()) {
-      return std::nullopt;
-    }
-    auto output = std::move(outputs.front());
-    outputs.pop_front();
-    return output;
+      return parser_loop<ndjson_parser&>(std::move(split_gen), *parser);
+    };
   };
-  auto splitter = std::invoke([&] {
-    switch (args.split_mode) {
-      case split_at::newline:
-        return std::byte{'\n'};
-      case split_at::null:
-        return std::byte{'\0'};
-      case split_at::none:
-        TENZIR_UNREACHABLE();
-    }
-    TENZIR_UNREACHABLE();
-  });
-  for (auto split : split_for_parallelization(std::move(input), splitter)) {
-    auto yielded = false;
-    if (split.empty()) {
-      // We got a signal that there is no more input. Thus, we'd like to sleep.
-      while (auto output = pop_output()) {
-        co_yield std::move(*output);
-        yielded = true;
-      }
-      // If we had some output above, we already gave the execution node a
-      // chance to refill our input buffer. Hence, we directly try again.
-      if (not yielded) {
-        co_yield {};
-      }
-      continue;
-    }
-    auto inputs_lock = std::unique_lock{inputs_mutex};
-    // If this is already too full, wait for a bit to provide backpressure.
-    while (inputs.size() > 3 * args.jobs) {
-      inputs_lock.unlock();
-      while (auto output = pop_output()) {
-        co_yield std::move(*output);
-        yielded = true;
-      }
-      if (not yielded) {
-        co_yield {};
-      }
-      inputs_lock.lock();
-    }
-    inputs.push_back(std::move(split));
-    inputs_lock.unlock();
-    inputs_cv.notify_one();
-    while (auto output = pop_output()) {
-      co_yield std::move(*output);
-      yielded = true;
-    }
-    if (not yielded) {
-      co_yield {};
-    }
-  }
-  // Once we reach this, the task of joining the threads is not longer handled
-  // by the guard. Note that no yield come in between this and joining the
-  // threads, so we can be sure that we join all threads before the next yield.
-  guard.disable();
-  auto inputs_lock = std::unique_lock{inputs_mutex};
-  inputs.emplace_back();
-  inputs_lock.unlock();
-  inputs_cv.notify_all();
-  // Wait for completion.
-  for (auto& thread : threads) {
-    thread.join();
-  }
-  // Should be done now.
-  TENZIR_ASSERT(inputs.size() == 1);
-  TENZIR_ASSERT(inputs[0].empty());
-  // Yield the remaining outputs.
-  for (auto& output : outputs) {
-    co_yield std::move(output);
-  }
+  return tenzir::parse_parallelized(std::move(input), ctrl, options,
+                                    std::move(make_parser));
 }
 
 class json_parser final : public plugin_parser {
@@ -617,15 +363,9 @@ public:
         co_yield {};
         co_return;
       }
-      auto printer = tenzir::json_printer{opts_};
-      // TODO: Since this printer is per-schema we can write an optimized
-      // version of it that gets the schema ahead of time and only expects
-      // data corresponding to exactly that schema.
       auto buffer = std::vector<char>{};
       auto resolved_slice = resolve_enumerations(slice);
       auto out_iter = std::back_inserter(buffer);
-      auto rows = values3(resolved_slice);
-      auto row = rows.begin();
       if (arrays_of_objects_) {
         if (array_open_written_) {
           *out_iter++ = ',';
@@ -637,22 +377,28 @@ public:
           array_open_written_ = true;
         }
       }
-      if (row != rows.end()) {
-        const auto ok = printer.print(out_iter, *row);
-        TENZIR_ASSERT(ok);
-        ++row;
-      }
-      for (; row != rows.end(); ++row) {
-        if (arrays_of_objects_) {
-          *out_iter++ = ',';
-          if (not opts_.oneline) {
-            *out_iter++ = '\n';
+      const auto separator = std::string_view{
+        not arrays_of_objects_ ? "\n" : opts_.oneline ? "," : ",\n"};
+      if (columnar_json_printer::supports(opts_)) {
+        // The columnar printer prepares everything that only depends on the
+        // schema once, so we keep one per schema.
+        const auto& schema = resolved_slice.schema();
+        auto printer = printers_.find(schema);
+        if (printer == printers_.end()) {
+          printer = printers_.try_emplace(schema, schema, opts_).first;
+        }
+        printer->second.print(resolved_slice, separator, buffer);
+      } else {
+        auto printer = tenzir::json_printer{opts_};
+        auto first = true;
+        for (auto&& row : values3(resolved_slice)) {
+          if (not first) {
+            out_iter = std::copy(separator.begin(), separator.end(), out_iter);
           }
-        } else {
-          out_iter = fmt::format_to(out_iter, "\n");
+          first = false;
+          const auto ok = printer.print(out_iter, row);
+          TENZIR_ASSERT(ok);
         }
-        const auto ok = printer.print(out_iter, *row);
-        TENZIR_ASSERT(ok);
       }
       if (not arrays_of_objects_) {
         *out_iter++ = '\n';
@@ -677,6 +423,7 @@ public:
     const json_printer_options opts_;
     const bool arrays_of_objects_ = false;
     bool array_open_written_ = false;
+    std::unordered_map<type, columnar_json_printer> printers_;
   };
 
   auto instantiate_impl() const
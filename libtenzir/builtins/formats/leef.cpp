@@ -21,6 +21,7 @@
 #include <tenzir/module.hpp>
 #include <tenzir/multi_series_builder.hpp>
 #include <tenzir/multi_series_builder_argument_parser.hpp>
+#include <tenzir/parallel_parse.hpp>
 #include <tenzir/plugin.hpp>
 #include <tenzir/series_builder.hpp>
 #include <tenzir/to_lines.hpp>
@@ -299,29 +300,53 @@ public:
 
   leef_parser() = default;
 
-  explicit leef_parser(multi_series_builder::options options)
-    : options_{std::move(options)} {
+  explicit leef_parser(multi_series_builder::options options,
+                       uint64_t jobs = 0)
+    : options_{std::move(options)}, jobs_{jobs} {
     options_.settings.default_schema_name = "leef.event";
   }
 
   auto optimize(event_order order) -> std::unique_ptr<plugin_parser> override {
     auto opts = options_;
     opts.settings.ordered = order == event_order::ordered;
-    return std::make_unique<leef_parser>(std::move(opts));
+    return std::make_unique<leef_parser>(std::move(opts), jobs_);
   }
 
   auto
   instantiate(generator<chunk_ptr> input, operator_control_plane& ctrl) const
     -> std::optional<generator<table_slice>> override {
+    if (jobs_ > 0) {
+      auto make_parser = [options = options_](diagnostic_handler& dh) {
+        return [&dh, options](generator<chunk_ptr> input) {
+          return parse_loop(to_lines(std::move(input)), dh, options);
+        };
+      };
+      return parse_parallelized(std::move(input), ctrl,
+                                parallel_parse_options{
+                                  .jobs = jobs_,
+                                  .ordered = options_.settings.ordered,
+                                },
+                                std::move(make_parser));
+    }
     return parse_loop(to_lines(std::move(input)), ctrl.diagnostics(), options_);
   }
 
+  auto idle_after() const -> duration override {
+    return jobs_ == 0 ? duration::zero() : duration::max();
+  }
+
+  auto detached() const -> bool override {
+    return jobs_ > 0;
+  }
+
   friend auto inspect(auto& f, leef_parser& x) -> bool {
-    return f.apply(x.options_);
+    return f.object(x).fields(f.field("options", x.options_),
+                              f.field("jobs", x.jobs_));
   }
 
 private:
   multi_series_builder::options options_ = {};
+  uint64_t jobs_ = 0;
 };
 
 class leef_plugin final : public virtual parser_plugin<leef_parser> {
@@ -354,10 +379,12 @@ public:
     auto parser = argument_parser2::operator_(name());
     auto msb_parser = multi_series_builder_argument_parser{};
     msb_parser.add_all_to_parser(parser);
+    auto jobs = uint64_t{0};
+    parser.named_optional("_jobs", jobs);
     TRY(parser.parse(inv, ctx));
     TRY(auto opts, msb_parser.get_options(ctx.dh()));
     return std::make_unique<parser_adapter<leef_parser>>(
-      leef_parser{std::move(opts)});
+      leef_parser{std::move(opts), jobs});
   }
 };
 
@@ -21,6 +21,7 @@
 #include <tenzir/concept/printable/to_string.hpp>
 #include <tenzir/multi_series_builder.hpp>
 #include <tenzir/multi_series_builder_argument_parser.hpp>
+#include <tenzir/parallel_parse.hpp>
 #include <tenzir/plugin.hpp>
 #include <tenzir/to_lines.hpp>
 
@@ -568,12 +569,12 @@ public:
 };
 
 auto parse_loop(generator<std::optional<std::string_view>> lines,
-                operator_control_plane& ctrl,
+                diagnostic_handler& parent_dh,
                 multi_series_builder::options opts) -> generator<table_slice> {
   std::variant<syslog_builder, legacy_syslog_builder, unknown_syslog_builder>
     builder{std::in_place_type<unknown_syslog_builder>};
   auto dh = transforming_diagnostic_handler{
-    ctrl.diagnostics(), [](auto diag) {
+    parent_dh, [](auto diag) {
       diag.message = fmt::format("syslog parser: {}", diag.message);
       return diag;
     }};
@@ -715,7 +716,8 @@ class syslog_parser final : public plugin_parser {
 public:
   syslog_parser() = default;
 
-  syslog_parser(multi_series_builder::options opts) : opts_{std::move(opts)} {
+  syslog_parser(multi_series_builder::options opts, uint64_t jobs = 0)
+    : opts_{std::move(opts)}, jobs_{jobs} {
   }
 
   auto name() const -> std::string override {
@@ -725,15 +727,40 @@ public:
   auto
   instantiate(generator<chunk_ptr> input, operator_control_plane& ctrl) const
     -> std::optional<generator<table_slice>> override {
-    return parse_loop(to_lines(std::move(input)), ctrl, opts_);
+    if (jobs_ > 0) {
+      // Lines are split into independent units for the workers, so a
+      // multi-line message that straddles two units is parsed as two events.
+      auto make_parser = [opts = opts_](diagnostic_handler& dh) {
+        return [&dh, opts](generator<chunk_ptr> input) {
+          return parse_loop(to_lines(std::move(input)), dh, opts);
+        };
+      };
+      return parse_parallelized(std::move(input), ctrl,
+                                parallel_parse_options{
+                                  .jobs = jobs_,
+                                  .ordered = opts_.settings.ordered,
+                                },
+                                std::move(make_parser));
+    }
+    return parse_loop(to_lines(std::move(input)), ctrl.diagnostics(), opts_);
+  }
+
+  auto idle_after() const -> duration override {
+    return jobs_ == 0 ? duration::zero() : duration::max();
+  }
+
+  auto detached() const -> bool override {
+    return jobs_ > 0;
   }
 
   friend auto inspect(auto& f, syslog_parser& x) -> bool {
-    return f.apply(x.opts_);
+    return f.object(x).fields(f.field("opts", x.opts_),
+                              f.field("jobs", x.jobs_));
   }
 
 private:
   multi_series_builder::options opts_;
+  uint64_t jobs_ = 0;
 };
 
 auto make_root_field(std::string field) -> ast::root_field {
@@ -1071,10 +1098,12 @@ class read_syslog final
     auto parser = argument_parser2::operator_("read_syslog");
     auto msb_parser = multi_series_builder_argument_parser{};
     msb_parser.add_all_to_parser(parser);
+    auto jobs = uint64_t{0};
+    parser.named_optional("_jobs", jobs);
     TRY(parser.parse(inv, ctx));
     TRY(auto opts, msb_parser.get_options(ctx.dh()));
     return std::make_unique<parser_adapter<syslog_parser>>(
-      syslog_parser{std::move(opts)});
+      syslog_parser{std::move(opts), jobs});
   }
 };
 
@@ -27,9 +27,13 @@
 #include <tenzir/plugin.hpp>
 #include <tenzir/tql2/plugin.hpp>
 
+#include <arrow/array/array_binary.h>
+#include <arrow/array/builder_binary.h>
 #include <arrow/scalar.h>
 #include <fmt/format.h>
 
+#include <array>
+#include <charconv>
 #include <string_view>
 
 namespace tenzir::plugins::hash {
@@ -80,21 +84,24 @@ public:
                                std::shared_ptr<arrow::Array> array) noexcept
       -> std::vector<
         std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>> {
-      auto hashes_builder
-        = string_type::make_arrow_builder(arrow::default_memory_pool());
+      auto hashes_builder = arrow::StringBuilder{};
+      check(hashes_builder.Reserve(array->length()));
+      // A 64-bit digest has at most 16 hex digits.
+      check(hashes_builder.ReserveData(array->length() * 16));
+      auto append = [&](uint64_t digest) {
+        auto buffer = std::array<char, 16>{};
+        const auto [end, ec] = std::to_chars(
+          buffer.data(), buffer.data() + buffer.size(), digest, 16);
+        TENZIR_ASSERT(ec == std::errc{});
+        hashes_builder.UnsafeAppend(std::string_view{buffer.data(), end});
+      };
       if (config_.salt) {
         for (const auto& value : values(field.type, *array)) {
-          const auto digest = tenzir::hash(value, *config_.salt);
-          const auto append_result
-            = hashes_builder->Append(fmt::format("{:x}", digest));
-          TENZIR_ASSERT(append_result.ok(), append_result.ToString().c_str());
+          append(tenzir::hash(value, *config_.salt));
         }
       } else {
         for (const auto& value : values(field.type, *array)) {
-          const auto digest = tenzir::hash(value);
-          const auto append_result
-            = hashes_builder->Append(fmt::format("{:x}", digest));
-          TENZIR_ASSERT(append_result.ok(), append_result.ToString().c_str());
+          append(tenzir::hash(value));
         }
       }
       return {
@@ -107,7 +114,7 @@ public:
             config_.out,
             string_type{},
           },
-          hashes_builder->Finish().ValueOrDie(),
+          finish(hashes_builder),
         },
       };
     };
@@ -201,6 +208,104 @@ public:
   }
 };
 
+/// Computes the digest of a single value, which the hash functions return in
+/// network byte order.
+template <class HashAlgorithm>
+auto digest(const std::optional<std::string>& seed, const auto& x) {
+  // We only hash the bytes and the length. Users expect that the
+  // resulting digest is the same as in other tools, which hash the
+  // sequence of bytes. This includes hashing the seed.
+  HashAlgorithm hasher{};
+  if (seed) {
+    hasher.add(as_bytes(*seed));
+  }
+  auto f = detail::overload{
+    [&](const auto& value) {
+      hash_append(hasher, value);
+    },
+    [&](std::string_view str) {
+      hasher.add(as_bytes(str));
+    },
+  };
+  f(x);
+  auto result = std::move(hasher).finish();
+  if constexpr (concepts::integer<typename HashAlgorithm::result_type>
+                and HashAlgorithm::endian == std::endian::little) {
+    result = detail::to_network_order(result);
+  }
+  return result;
+}
+
+/// Computes the digests of all values of a series and writes them as hex
+/// strings or as blobs.
+template <class HashAlgorithm>
+auto hash_series(const series& s, const std::optional<std::string>& seed,
+                 bool binary) -> series {
+  // Every digest has the same length, which lets us reserve the data buffer of
+  // the result up front. The digest of null is the same for every row, so we
+  // only compute it once.
+  const auto null_digest = digest<HashAlgorithm>(seed, caf::none);
+  const auto digest_size
+    = detail::narrow<int64_t>(as_bytes(null_digest).size());
+  const auto length = s.length();
+  auto hex = std::string{};
+  hex.resize(2 * digest_size);
+  auto string_builder = arrow::StringBuilder{};
+  auto blob_builder = arrow::BinaryBuilder{};
+  if (binary) {
+    check(blob_builder.Reserve(length));
+    check(blob_builder.ReserveData(length * digest_size));
+  } else {
+    check(string_builder.Reserve(length));
+    check(string_builder.ReserveData(length * hex.size()));
+  }
+  auto append = [&](const auto& x) {
+    const auto bytes = as_bytes(x);
+    TENZIR_ASSERT(std::ssize(bytes) == digest_size);
+    if (binary) {
+      blob_builder.UnsafeAppend(std::string_view{
+        reinterpret_cast<const char*>(bytes.data()), bytes.size()});
+      return;
+    }
+    detail::hexify(bytes, hex.data());
+    string_builder.UnsafeAppend(hex);
+  };
+  // For strings and blobs, we read the values directly from the Arrow array
+  // instead of going through the generic data views.
+  auto hash_all = detail::overload{
+    [&]<class Array>(const Array& array)
+      requires concepts::one_of<Array, arrow::StringArray, arrow::BinaryArray>
+    {
+      for (auto i = int64_t{0}; i < array.length(); ++i) {
+        if (array.IsNull(i)) {
+          append(null_digest);
+          continue;
+        }
+        const auto value = array.GetView(i);
+        if constexpr (std::same_as<Array, arrow::StringArray>) {
+          append(digest<HashAlgorithm>(seed, value));
+        } else {
+          append(digest<HashAlgorithm>(
+            seed, blob_view{reinterpret_cast<const std::byte*>(value.data()),
+                            value.size()}));
+        }
+      }
+    },
+    [&](const arrow::Array&) {
+      for (const auto& value : s.values()) {
+        match(value, [&](const auto& x) {
+          append(digest<HashAlgorithm>(seed, x));
+        });
+      }
+    },
+  };
+  match(*s.array, hash_all);
+  if (binary) {
+    return {blob_type{}, finish(blob_builder)};
+  }
+  return {string_type{}, finish(string_builder)};
+}
+
 template <class HashAlgorithm, detail::string_literal Name>
 class fun : public virtual function_plugin {
   auto name() const -> std::string override {
@@ -211,44 +316,18 @@ class fun : public virtual function_plugin {
     -> failure_or<function_ptr> override {
     auto expr = ast::expression{};
     auto seed = std::optional<std::string>{};
+    auto binary = false;
     TRY(argument_parser2::function(name())
           .positional("x", expr, "any")
           .named("seed", seed)
+          .named("binary", binary)
           .parse(inv, ctx));
     return function_use::make(
-      [expr_ = std::move(expr), seed_ = std::move(seed)](evaluator eval,
-                                                         session) -> series {
-        const auto& s = eval(expr_);
-        auto hash = [&](const auto& x) {
-          // We only hash the bytes and the length. Users expect that the
-          // resulting digest is the same as in other tools, which hash the
-          // sequence of bytes. This includes hashing the seed.
-          HashAlgorithm hasher{};
-          if (seed_) {
-            hasher.add(as_bytes(*seed_));
-          }
-          auto f = detail::overload{
-            [&](const auto& value) {
-              hash_append(hasher, value);
-            },
-            [&](std::string_view str) {
-              hasher.add(as_bytes(str));
-            },
-          };
-          match(x, f);
-          return std::move(hasher).finish();
-        };
-        auto b = string_type::make_arrow_builder(arrow::default_memory_pool());
-        for (const auto& value : s.values()) {
-          auto digest = hash(value);
-          if constexpr (concepts::integer<typename HashAlgorithm::result_type>
-                        and HashAlgorithm::endian == std::endian::little) {
-            digest = detail::to_network_order(digest);
-          }
-          auto hex = detail::hexify(as_bytes(digest));
-          check(b->Append(hex));
-        }
-        return {string_type{}, finish(*b)};
+      [expr_ = std::move(expr), seed_ = std::move(seed),
+       binary](evaluator eval, session) -> multi_series {
+        return map_series(eval(expr_), [&](series s) -> multi_series {
+          return hash_series<HashAlgorithm>(s, seed_, binary);
+        });
       });
   }
 };
@@ -135,6 +135,12 @@ public:
     return count_;
   }
 
+  auto merge(const aggregation_instance& other, session) -> void override {
+    const auto* rhs = dynamic_cast<const count_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    count_ += rhs->count_;
+  }
+
   auto save() const -> chunk_ptr override {
     auto fbb = flatbuffers::FlatBufferBuilder{};
     const auto fb_count = fbs::aggregation::CreateCount(fbb, count_);
@@ -255,6 +261,27 @@ public:
     TENZIR_UNREACHABLE();
   }
 
+  auto merge(const aggregation_instance& other, session ctx) -> void override {
+    const auto* rhs = dynamic_cast<const quantile_instance*>(&other);
+    TENZIR_ASSERT(rhs);
+    if (state_ == state::failed or rhs->state_ == state::none) {
+      return;
+    }
+    if (rhs->state_ == state::failed) {
+      state_ = state::failed;
+      return;
+    }
+    if (state_ != state::none and state_ != rhs->state_) {
+      diagnostic::warning("got incompatible types `duration` and `number`")
+        .primary(expr_)
+        .emit(ctx);
+      state_ = state::failed;
+      return;
+    }
+    state_ = rhs->state_;
+    digest_.Merge(rhs->digest_);
+  }
+
   auto save() const -> chunk_ptr override {
     return {};
   }
@@ -8,6 +8,7 @@
 
 #include "tenzir/concept/printable/tenzir/json.hpp"
 #include "tenzir/concept/printable/tenzir/json_printer_options.hpp"
+#include "tenzir/regex_set.hpp"
 #include "tenzir/table_slice.hpp"
 
 #include <tenzir/arrow_utils.hpp>
@@ -142,6 +143,63 @@ public:
   }
 };
 
+class match_any_regex : public virtual function_plugin {
+public:
+  auto name() const -> std::string override {
+    return "match_any_regex";
+  }
+
+  auto make_function(invocation inv, session ctx) const
+    -> failure_or<function_ptr> override {
+    auto subject_expr = ast::expression{};
+    auto patterns = located<list>{};
+    TRY(argument_parser2::function(name())
+          .positional("input", subject_expr, "string")
+          .positional("regexes", patterns, "list<string>")
+          .parse(inv, ctx));
+    auto strings = std::vector<std::string>{};
+    strings.reserve(patterns.inner.size());
+    for (auto& pattern : patterns.inner) {
+      auto* str = try_as<std::string>(&pattern);
+      if (not str) {
+        diagnostic::error("expected `list<string>`")
+          .primary(patterns, "contains `{}`",
+                   type::infer(pattern).value_or(type{}).kind())
+          .emit(ctx);
+        return failure::promise();
+      }
+      strings.push_back(std::move(*str));
+    }
+    auto regexes = regex_set::make(std::move(strings));
+    if (not regexes) {
+      diagnostic::error("{}", regexes.error()).primary(patterns).emit(ctx);
+      return failure::promise();
+    }
+    return function_use::make(
+      [this, subject_expr = std::move(subject_expr),
+       regexes = std::move(*regexes)](evaluator eval, session ctx) {
+        return map_series(eval(subject_expr), [&](series subject) {
+          auto f = detail::overload{
+            [&](const arrow::StringArray& array) -> multi_series {
+              return series{int64_type{}, regexes.match_first(array)};
+            },
+            [&](const arrow::NullArray& array) -> multi_series {
+              return series::null(int64_type{}, array.length());
+            },
+            [&](const auto&) -> multi_series {
+              diagnostic::warning("`{}` expected `string`, but got `{}`",
+                                  name(), subject.type.kind())
+                .primary(subject_expr)
+                .emit(ctx);
+              return series::null(int64_type{}, subject.length());
+            },
+          };
+          return match(*subject.array, f);
+        });
+      });
+  }
+};
+
 class trim : public virtual function_plugin {
 public:
   explicit trim(std::string name, std::string fn_name)
@@ -643,6 +701,7 @@ TENZIR_REGISTER_PLUGIN(starts_or_ends_with{true})
 TENZIR_REGISTER_PLUGIN(starts_or_ends_with{false})
 
 TENZIR_REGISTER_PLUGIN(match_regex)
+TENZIR_REGISTER_PLUGIN(match_any_regex)
 
 TENZIR_REGISTER_PLUGIN(trim{"trim", "utf8_trim"})
 TENZIR_REGISTER_PLUGIN(trim{"trim_start", "utf8_ltrim"})
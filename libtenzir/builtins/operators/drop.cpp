@@ -173,6 +173,7 @@ public:
   auto
   operator()(generator<table_slice> input, operator_control_plane& ctrl) const
     -> generator<table_slice> {
+    auto resolver = selector_resolver{};
     for (auto&& slice : input) {
       if (slice.rows() == 0) {
         co_yield {};
@@ -180,7 +181,7 @@ public:
       }
       auto transformations = std::vector<indexed_transformation>{};
       for (auto& sel : selectors_) {
-        auto resolved = resolve(sel, slice.schema());
+        auto resolved = resolver.resolve(sel, slice.schema());
         std::move(resolved).match(
           [&](offset off) {
             TENZIR_ASSERT(not off.empty());
@@ -19,7 +19,6 @@
 #include <tenzir/logger.hpp>
 #include <tenzir/metric_handler.hpp>
 #include <tenzir/modules.hpp>
-#include <tenzir/passive_partition.hpp>
 #include <tenzir/pipeline.hpp>
 #include <tenzir/plugin.hpp>
 #include <tenzir/query_context.hpp>
@@ -37,6 +36,7 @@
 #include <caf/timespan.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <algorithm>
 #include <queue>
 
 namespace tenzir::plugins::export_ {
@@ -74,6 +74,7 @@ struct bridge_state {
   caf::actor_addr importer_address = {};
   tenzir::taxonomies taxonomies = {};
   expression expr = {};
+  std::optional<std::vector<std::string>> fields = {};
   std::unordered_map<type, caf::expected<expression>> bound_exprs = {};
 
   export_mode mode = {};
@@ -84,7 +85,7 @@ struct bridge_state {
   std::queue<std::pair<partition_info, query_context>> queued_partitions = {};
   std::optional<std::vector<table_slice>> unpersisted_events = {};
 
-  filesystem_actor filesystem = {};
+  index_actor index = {};
 
   struct metric {
     size_t emitted = {};
@@ -149,24 +150,31 @@ struct bridge_state {
       --inflight_partitions;
       try_pop_partition();
     };
-    // TODO: We may want to monitor the spawned partitions to be able to return
-    // better diagnostics. As-is, we only get a caf::sec::request_receiver_down
-    // if they quit, but not their actual error message.
-    const auto partition = self->spawn(
-      passive_partition, info.uuid, filesystem,
-      std::filesystem::path{fmt::format("index/{:l}", info.uuid)});
-    self->mail(atom::query_v, std::move(ctx))
-      .request(partition, caf::infinite)
+    auto on_error = [this, next, uuid = info.uuid](const caf::error& error) {
+      diagnostic::warning(error)
+        .note("failed to open partition {}", uuid)
+        .emit(diagnostics_handler);
+      next();
+    };
+    // The index shares its cache of loaded partitions with us, so that
+    // repeated queries do not need to load the same partitions from disk.
+    // TODO: We may want to monitor the partitions to be able to return better
+    // diagnostics. As-is, we only get a caf::sec::request_receiver_down if they
+    // quit, but not their actual error message.
+    self->mail(atom::load_v, info.uuid)
+      .request(index, caf::infinite)
       .then(
-        [next](uint64_t) {
-          next();
+        [this, next, on_error, ctx = std::move(ctx)](
+          partition_actor& partition) mutable {
+          self->mail(atom::query_v, std::move(ctx))
+            .request(partition, caf::infinite)
+            .then(
+              [next](uint64_t) {
+                next();
+              },
+              on_error);
         },
-        [this, next, uuid = info.uuid](const caf::error& error) mutable {
-          diagnostic::warning(error)
-            .note("failed to open partition {}", uuid)
-            .emit(diagnostics_handler);
-          next();
-        });
+        on_error);
   }
 
   auto emit_metrics() -> void {
@@ -235,18 +243,20 @@ struct bridge_state {
 };
 
 auto make_bridge(caf::stateful_actor<bridge_state>* self, expression expr,
-                 export_mode mode, filesystem_actor filesystem,
+                 std::optional<std::vector<std::string>> fields,
+                 export_mode mode, index_actor index,
                  metric_handler metrics_handler,
                  shared_diagnostic_handler diagnostics_handler)
   -> caf::behavior {
   self->state().self = self;
   self->state().taxonomies.concepts = modules::concepts();
   self->state().expr = normalize(std::move(expr));
+  self->state().fields = std::move(fields);
   self->state().mode = mode;
   self->state().metrics_handler = std::move(metrics_handler);
   self->state().diagnostics_handler = std::move(diagnostics_handler);
-  self->state().filesystem = std::move(filesystem);
-  TENZIR_ASSERT(self->state().filesystem);
+  self->state().index = std::move(index);
+  TENZIR_ASSERT(self->state().index);
   if (not self->state().mode.internal) {
     detail::weak_run_delayed_loop(self, defaults::metrics_interval, [self] {
       self->state().emit_metrics();
@@ -283,6 +293,7 @@ auto make_bridge(caf::stateful_actor<bridge_state>* self, expression expr,
     TENZIR_ASSERT(catalog);
     auto query_context
       = tenzir::query_context::make_extract("export", self, self->state().expr);
+    as<extract_query_context>(query_context.cmd).fields = self->state().fields;
     query_context.id = uuid::random();
     TENZIR_DEBUG("export operator starts catalog lookup with id {} and "
                  "expression {}",
@@ -293,6 +304,8 @@ auto make_bridge(caf::stateful_actor<bridge_state>* self, expression expr,
         [self, query_context](catalog_lookup_result& result) {
           self->state().checked_candidates = true;
           auto max_import_time = time::min();
+          auto candidates
+            = std::vector<std::pair<partition_info, query_context>>{};
           for (auto& [type, info] : result.candidate_infos) {
             if (info.partition_infos.empty()) {
               continue;
@@ -307,9 +320,20 @@ auto make_bridge(caf::stateful_actor<bridge_state>* self, expression expr,
             for (auto& partition_info : info.partition_infos) {
               max_import_time
                 = std::max(max_import_time, partition_info.max_import_time);
-              self->state().queued_partitions.emplace(std::move(partition_info),
-                                                      ctx);
+              candidates.emplace_back(std::move(partition_info), ctx);
             }
+          }
+          // Open the newest partitions across all schemas first, so that
+          // pipelines that only need the most recent events, e.g., with a
+          // `head` after the `export`, finish before touching older data.
+          std::ranges::stable_sort(candidates, std::ranges::greater{},
+                                   [](const auto& candidate) {
+                                     return candidate.first.max_import_time;
+                                   });
+          for (auto& candidate : candidates) {
+            self->state().queued_partitions.push(std::move(candidate));
+          }
+          if (not candidates.empty()) {
             while (self->state().open_partitions
                    < self->state().mode.parallel) {
               ++self->state().open_partitions;
@@ -386,10 +410,9 @@ public:
   auto operator()(operator_control_plane& ctrl) const
     -> generator<table_slice> {
     co_yield {};
-    const auto filesystem
-      = ctrl.self().system().registry().get<filesystem_actor>(
-        "tenzir.filesystem");
-    TENZIR_ASSERT(filesystem);
+    const auto index
+      = ctrl.self().system().registry().get<index_actor>("tenzir.index");
+    TENZIR_ASSERT(index);
     auto metrics_handler = ctrl.metrics({
       "tenzir.metrics.export",
       record_type{
@@ -401,7 +424,7 @@ public:
     });
     auto diagnostics_handler = ctrl.shared_diagnostics();
     auto bridge = ctrl.self().spawn<caf::linked>(
-      make_bridge, expr_, mode_, std::move(filesystem),
+      make_bridge, expr_, fields_, mode_, std::move(index),
       std::move(metrics_handler), std::move(diagnostics_handler));
     co_yield {};
     while (true) {
@@ -458,18 +481,28 @@ public:
                   ? trivially_true_expression()
                   : (clauses.size() == 1 ? std::move(clauses[0])
                                          : conjunction{std::move(clauses)});
+    auto result = std::make_unique<export_operator>(std::move(expr), mode_);
+    result->fields_ = fields_;
     return optimize_result{trivially_true_expression(), event_order::ordered,
-                           std::make_unique<export_operator>(std::move(expr),
-                                                             mode_)};
+                           std::move(result)};
+  }
+
+  auto project(const std::vector<std::string>& fields) const
+    -> operator_ptr override {
+    auto result = std::make_unique<export_operator>(expr_, mode_);
+    result->fields_ = fields;
+    return result;
   }
 
   friend auto inspect(auto& f, export_operator& x) -> bool {
     return f.object(x).fields(f.field("expression", x.expr_),
+                              f.field("fields", x.fields_),
                               f.field("mode", x.mode_));
   }
 
 private:
   expression expr_;
+  std::optional<std::vector<std::string>> fields_;
   export_mode mode_;
 };
 
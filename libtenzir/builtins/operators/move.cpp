@@ -31,6 +31,7 @@ struct move_operator final : public crtp_operator<move_operator> {
   operator()(generator<table_slice> input, operator_control_plane& ctrl) const
     -> generator<table_slice> {
     auto& dh = ctrl.diagnostics();
+    auto resolver = selector_resolver{};
     for (auto&& slice : input) {
       if (slice.rows() == 0) {
         co_yield {};
@@ -43,7 +44,7 @@ struct move_operator final : public crtp_operator<move_operator> {
       auto offsets = std::unordered_set<offset>{};
       for (const auto& r : rhs_) {
         match(
-          resolve(r, slice.schema()),
+          resolver.resolve(r, slice.schema()),
           [&](const offset& of) {
             auto [ty, ptr] = of.get(slice);
             rights.emplace_back(std::move(ty), std::move(ptr));
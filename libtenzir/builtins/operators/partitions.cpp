@@ -75,6 +75,7 @@ public:
       event.field("min_import_time").data(synopsis.synopsis->min_import_time);
       event.field("max_import_time").data(synopsis.synopsis->max_import_time);
       event.field("version").data(synopsis.synopsis->version);
+      event.field("store_time").data(synopsis.synopsis->store_time);
       event.field("schema").data(synopsis.synopsis->schema.name());
       event.field("schema_id")
         .data(synopsis.synopsis->schema.make_fingerprint());
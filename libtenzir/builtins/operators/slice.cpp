@@ -324,6 +324,19 @@ public:
     };
   }
 
+  auto head_limit() const -> std::optional<uint64_t> override {
+    if (begin_.value_or(0) != 0 or not end_ or *end_ < 0
+        or stride_.value_or(1) != 1) {
+      return std::nullopt;
+    }
+    return static_cast<uint64_t>(*end_);
+  }
+
+  auto input_fields(const std::optional<std::vector<std::string>>& fields) const
+    -> std::optional<std::vector<std::string>> override {
+    return fields;
+  }
+
   friend auto inspect(auto& f, slice_operator& x) -> bool {
     return f.object(x)
       .pretty_name("tenzir.plugin.slice.slice_operator")
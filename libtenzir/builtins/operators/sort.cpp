@@ -10,6 +10,9 @@
 #include <tenzir/arrow_utils.hpp>
 #include <tenzir/concept/parseable/numeric/integral.hpp>
 #include <tenzir/concept/parseable/tenzir/pipeline.hpp>
+#include <tenzir/defaults.hpp>
+#include <tenzir/detail/function.hpp>
+#include <tenzir/diagnostics.hpp>
 #include <tenzir/error.hpp>
 #include <tenzir/logger.hpp>
 #include <tenzir/pipeline.hpp>
@@ -19,10 +22,20 @@
 #include <tenzir/tql2/eval.hpp>
 #include <tenzir/tql2/plugin.hpp>
 #include <tenzir/type.hpp>
+#include <tenzir/uuid.hpp>
 
 #include <arrow/compute/api_vector.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
 #include <arrow/record_batch.h>
+#include <arrow/util/compression.h>
 
+#include <algorithm>
+#include <compare>
+#include <filesystem>
+#include <functional>
+#include <numeric>
 #include <ranges>
 #include <string_view>
 
@@ -80,11 +93,564 @@ auto sort_record(const series& input) -> series {
   };
 }
 
+/// Returns whether `lhs` sorts before `rhs`. NaN sorts after all other numbers,
+/// and values of different types are ordered by their type.
+auto sort_value_less(const data_view& lhs, const data_view& rhs) -> bool {
+  // TODO: Implement this directly on data and data_view. That is
+  // non-trivial however.
+  // TODO: This does not do the correct recursive application of the
+  // comparator to nested structural types. It turns out that is a
+  // non-trivial task as well.
+  const auto cmp = detail::overload{
+    [](const concepts::integer auto& l, const concepts::integer auto& r) {
+      return std::cmp_less(l, r);
+    },
+    []<concepts::number L, concepts::number R>(const L& l, const R& r) {
+      if constexpr (std::same_as<L, double>) {
+        if (std::isnan(l)) {
+          return false;
+        }
+      }
+      if constexpr (std::same_as<R, double>) {
+        if (std::isnan(r)) {
+          return true;
+        }
+      }
+      return l < r;
+    },
+    [&](const auto& l, const auto& r) {
+      if constexpr (std::same_as<decltype(l), decltype(r)>) {
+        return l < r;
+      }
+      return lhs.index() < rhs.index();
+    },
+  };
+  return match(std::tie(lhs, rhs), cmp);
+}
+
+/// Three-way compares a row of two sort key columns. Nulls sort last,
+/// independent of the sort order.
+auto compare_sort_key(const multi_series& lhs, int64_t lhs_row,
+                      const multi_series& rhs, int64_t rhs_row, bool reverse)
+  -> std::weak_ordering {
+  const auto lhs_null = lhs.is_null(lhs_row);
+  const auto rhs_null = rhs.is_null(rhs_row);
+  if (lhs_null or rhs_null) {
+    return lhs_null <=> rhs_null;
+  }
+  const auto lhs_value = lhs.value_at(lhs_row);
+  const auto rhs_value = rhs.value_at(rhs_row);
+  if (sort_value_less(lhs_value, rhs_value)) {
+    return reverse ? std::weak_ordering::greater : std::weak_ordering::less;
+  }
+  if (sort_value_less(rhs_value, lhs_value)) {
+    return reverse ? std::weak_ordering::less : std::weak_ordering::greater;
+  }
+  return std::weak_ordering::equivalent;
+}
+
+// -- spilling to disk ---------------------------------------------------------
+
+/// Three-way compares two rows given their evaluated sort keys.
+using sort_key_comparator
+  = std::function<auto(std::span<const multi_series>, int64_t,
+                       std::span<const multi_series>, int64_t)
+                    ->std::weak_ordering>;
+
+/// A single row of a series.
+struct series_row {
+  const series* values = {};
+  int64_t row = {};
+};
+
+/// Returns the part of a multi-series that holds the given row.
+auto find_row(const multi_series& x, int64_t row) -> series_row {
+  for (const auto& part : x.parts()) {
+    if (row < part.length()) {
+      return {&part, row};
+    }
+    row -= part.length();
+  }
+  TENZIR_UNREACHABLE();
+}
+
+/// A file that holds the events of a single schema from a sorted run, together
+/// with their evaluated sort keys.
+struct run_file {
+  std::filesystem::path path = {};
+  type schema = {};
+  std::vector<type> key_types = {};
+
+  /// Checks whether two files hold events of the same schema and sort key
+  /// types, such that merging them yields a single file.
+  auto same_layout(const run_file& other) const -> bool {
+    return schema == other.schema and key_types == other.key_types;
+  }
+};
+
+/// Writes a sorted run into one Arrow IPC stream per combination of schema and
+/// sort key types. As Arrow IPC requires a fixed schema per stream, we cannot
+/// write a run into a single file. Every file is sorted on its own, which
+/// suffices for merging them. Next to the events, we store their evaluated
+/// sort keys, so that merging the runs does not need to evaluate them again,
+/// and the rank of every event, which allows for breaking ties between equal
+/// events of different files. The ranks continue across runs, so they follow
+/// the order of the input for equal events.
+class run_writer {
+public:
+  run_writer(std::filesystem::path directory, size_t run, int64_t first_rank)
+    : directory_{std::move(directory)}, run_{run}, next_rank_{first_rank} {
+  }
+
+  /// Adds the next event of the run in sorted order. The events must be the
+  /// struct array of a batch with the given schema.
+  auto add(const type& schema, const arrow::StructArray& events, int64_t row,
+           std::span<const series_row> keys) -> void {
+    add(schema, events, row, keys, next_rank_++);
+  }
+
+  /// Adds the next event of the run in sorted order with the given rank. This
+  /// is used for merging runs into an intermediate run, which keeps the ranks
+  /// of the merged runs.
+  auto add(const type& schema, const arrow::StructArray& events, int64_t row,
+           std::span<const series_row> keys, int64_t rank) -> void {
+    auto& file = file_for(schema, keys);
+    check(append_array_slice(*file.events, schema, events, row, 1));
+    for (size_t i = 0; i < keys.size(); ++i) {
+      check(append_array_slice(*file.keys[i], keys[i].values->type,
+                               *keys[i].values->array, keys[i].row, 1));
+    }
+    file.ranks.push_back(rank);
+    if (file.ranks.size() >= defaults::import::table_slice_size) {
+      flush(file);
+    }
+  }
+
+  /// Returns the rank of the next event that gets added without a rank.
+  auto next_rank() const -> int64_t {
+    return next_rank_;
+  }
+
+  /// Flushes all buffered events and closes the files of the run.
+  auto finish() && -> std::vector<run_file> {
+    auto result = std::vector<run_file>{};
+    result.reserve(files_.size());
+    for (auto& file : files_) {
+      flush(file);
+      auto status = file.writer->Close();
+      if (status.ok()) {
+        status = file.sink->Close();
+      }
+      if (not status.ok()) {
+        diagnostic::error("{}", status.ToStringWithoutContextLines())
+          .note("failed to finish sorted run `{}`", file.path)
+          .note("from `sort`")
+          .throw_();
+      }
+      result.push_back({
+        .path = std::move(file.path),
+        .schema = std::move(file.schema),
+        .key_types = std::move(file.key_types),
+      });
+    }
+    return result;
+  }
+
+private:
+  struct file_state {
+    type schema = {};
+    std::vector<type> key_types = {};
+    std::filesystem::path path = {};
+    std::shared_ptr<arrow::io::FileOutputStream> sink = {};
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> writer = {};
+    std::shared_ptr<arrow::ArrayBuilder> events = {};
+    std::vector<std::shared_ptr<arrow::ArrayBuilder>> keys = {};
+    std::vector<int64_t> ranks = {};
+  };
+
+  /// Returns the file for events of the given schema and sort key types.
+  auto file_for(const type& schema, std::span<const series_row> keys)
+    -> file_state& {
+    const auto matches = [&](const file_state& file) {
+      if (file.schema != schema) {
+        return false;
+      }
+      for (size_t i = 0; i < keys.size(); ++i) {
+        if (file.key_types[i] != keys[i].values->type) {
+          return false;
+        }
+      }
+      return true;
+    };
+    // Consecutive events usually end up in the same file.
+    if (last_ < files_.size() and matches(files_[last_])) {
+      return files_[last_];
+    }
+    const auto it = std::ranges::find_if(files_, matches);
+    last_ = std::distance(files_.begin(), it);
+    if (it != files_.end()) {
+      return *it;
+    }
+    auto& file = files_.emplace_back();
+    file.schema = schema;
+    file.events = as<record_type>(schema).make_arrow_builder(
+      arrow::default_memory_pool());
+    for (const auto& key : keys) {
+      file.key_types.push_back(key.values->type);
+      file.keys.push_back(
+        key.values->type.make_arrow_builder(arrow::default_memory_pool()));
+    }
+    return file;
+  }
+
+  auto flush(file_state& file) -> void {
+    if (file.ranks.empty()) {
+      return;
+    }
+    const auto num_rows = detail::narrow<int64_t>(file.ranks.size());
+    auto rank_builder = arrow::Int64Builder{};
+    check(rank_builder.AppendValues(file.ranks));
+    file.ranks.clear();
+    auto fields = arrow::FieldVector{
+      arrow::field("rank", arrow::int64()),
+      arrow::field("event", file.schema.to_arrow_type(),
+                   file.schema.to_arrow_schema()->metadata()),
+    };
+    auto columns = arrow::ArrayVector{
+      tenzir::finish(rank_builder),
+      check(file.events->Finish()),
+    };
+    for (size_t i = 0; i < file.keys.size(); ++i) {
+      fields.push_back(arrow::field(fmt::format("key-{}", i),
+                                    file.key_types[i].to_arrow_type()));
+      columns.push_back(check(file.keys[i]->Finish()));
+    }
+    auto schema = arrow::schema(std::move(fields));
+    auto batch = arrow::RecordBatch::Make(schema, num_rows, std::move(columns));
+    if (not file.writer) {
+      file.path = directory_
+                  / fmt::format("run-{}-{}.arrow", run_, num_files_++);
+      auto open = [&]() -> arrow::Status {
+        ARROW_ASSIGN_OR_RAISE(file.sink,
+                              arrow::io::FileOutputStream::Open(file.path));
+        auto options = arrow::ipc::IpcWriteOptions::Defaults();
+        ARROW_ASSIGN_OR_RAISE(options.codec, arrow::util::Codec::Create(
+                                               arrow::Compression::LZ4_FRAME));
+        ARROW_ASSIGN_OR_RAISE(file.writer, arrow::ipc::MakeStreamWriter(
+                                             file.sink, schema, options));
+        return arrow::Status::OK();
+      };
+      if (auto status = open(); not status.ok()) {
+        diagnostic::error("{}", status.ToStringWithoutContextLines())
+          .note("failed to create sorted run `{}`", file.path)
+          .note("from `sort`")
+          .throw_();
+      }
+    }
+    if (auto status = file.writer->WriteRecordBatch(*batch); not status.ok()) {
+      diagnostic::error("{}", status.ToStringWithoutContextLines())
+        .note("failed to write sorted run `{}`", file.path)
+        .note("from `sort`")
+        .throw_();
+    }
+  }
+
+  std::filesystem::path directory_ = {};
+  size_t run_ = {};
+  int64_t next_rank_ = {};
+  size_t num_files_ = {};
+  std::vector<file_state> files_ = {};
+  size_t last_ = {};
+};
+
+/// A cursor into a single run file that is being merged.
+struct run_cursor {
+  const run_file* file = {};
+  std::shared_ptr<arrow::ipc::RecordBatchReader> reader = {};
+  table_slice events = {};
+  std::shared_ptr<arrow::StructArray> event_array = {};
+  std::shared_ptr<arrow::Int64Array> ranks = {};
+  std::vector<multi_series> keys = {};
+  int64_t row = {};
+
+  /// Reads the next batch from the run file. Returns false if the file is
+  /// exhausted.
+  auto next() -> bool {
+    auto batch = std::shared_ptr<arrow::RecordBatch>{};
+    if (auto status = reader->ReadNext(&batch); not status.ok()) {
+      diagnostic::error("{}", status.ToStringWithoutContextLines())
+        .note("failed to read sorted run `{}`", file->path)
+        .note("from `sort`")
+        .throw_();
+    }
+    if (not batch) {
+      return false;
+    }
+    event_array = std::static_pointer_cast<arrow::StructArray>(
+      batch->GetColumnByName("event"));
+    events = table_slice{
+      arrow::RecordBatch::Make(file->schema.to_arrow_schema(),
+                               batch->num_rows(), event_array->fields()),
+      file->schema,
+    };
+    ranks = std::static_pointer_cast<arrow::Int64Array>(
+      batch->GetColumnByName("rank"));
+    keys.clear();
+    for (size_t i = 0; i < file->key_types.size(); ++i) {
+      keys.emplace_back(series{file->key_types[i],
+                               batch->GetColumnByName(fmt::format("key-{}", i))});
+    }
+    row = 0;
+    return true;
+  }
+};
+
+/// Spills sorted runs to disk once the events buffered by `sort` exceed the
+/// configured memory limit, and merges them back together with a streaming
+/// k-way merge. Removes the spilled runs on destruction.
+class spill_state {
+public:
+  explicit spill_state(operator_control_plane& ctrl) {
+    const auto& config = content(ctrl.self().home_system().config());
+    memory_limit_
+      = caf::get_or(config, "tenzir.sort.memory-limit", uint64_t{0});
+    max_open_runs_ = std::max(
+      caf::get_or(config, "tenzir.sort.max-open-runs", uint64_t{64}),
+      uint64_t{2});
+    state_directory_ = std::filesystem::path{caf::get_or(
+      config, "tenzir.state-directory", defaults::state_directory.data())};
+  }
+
+  spill_state(const spill_state&) = delete;
+  auto operator=(const spill_state&) -> spill_state& = delete;
+  spill_state(spill_state&&) = delete;
+  auto operator=(spill_state&&) -> spill_state& = delete;
+
+  ~spill_state() noexcept {
+    if (not directory_.empty()) {
+      auto ec = std::error_code{};
+      std::filesystem::remove_all(directory_, ec);
+      if (ec) {
+        TENZIR_WARN("failed to remove sort spill directory {}: {}", directory_,
+                    ec.message());
+      }
+    }
+  }
+
+  /// Returns whether the given number of buffered bytes requires spilling.
+  auto exceeded(uint64_t num_buffered_bytes) const -> bool {
+    return memory_limit_ != 0 and num_buffered_bytes >= memory_limit_;
+  }
+
+  /// Returns whether any runs were spilled to disk.
+  auto empty() const -> bool {
+    return files_.empty();
+  }
+
+  /// Writes a new run, whose events the given function adds to the writer in
+  /// sorted order.
+  auto spill(detail::function_view<auto(run_writer&)->void> write) -> void {
+    if (directory_.empty()) {
+      auto ec = std::error_code{};
+      directory_ = std::filesystem::absolute(state_directory_, ec) / "sort"
+                   / fmt::to_string(uuid::random());
+      std::filesystem::create_directories(directory_, ec);
+      if (ec) {
+        diagnostic::error("{}", ec.message())
+          .note("failed to create spill directory `{}`", directory_)
+          .note("from `sort`")
+          .throw_();
+      }
+    }
+    auto writer = run_writer{directory_, num_runs_++, next_rank_};
+    write(writer);
+    next_rank_ = writer.next_rank();
+    auto files = std::move(writer).finish();
+    TENZIR_DEBUG("sort spilled run {} into {} files", num_runs_ - 1,
+                 files.size());
+    files_.insert(files_.end(), std::make_move_iterator(files.begin()),
+                  std::make_move_iterator(files.end()));
+  }
+
+  /// Merges all spilled runs, yielding batches of events in sorted order. To
+  /// bound the number of open files and of batches that are held in memory,
+  /// we first merge groups of files with the same layout into intermediate
+  /// runs until no more than the configured maximum number of files remain.
+  /// Files of different layouts cannot be merged into one, so the final merge
+  /// opens at least one file per layout.
+  auto merge(sort_key_comparator comparator) -> generator<table_slice> {
+    while (files_.size() > max_open_runs_) {
+      if (not merge_pass(comparator)) {
+        break;
+      }
+    }
+    auto buffer = std::vector<table_slice>{};
+    auto num_buffered = uint64_t{0};
+    for (auto&& [cursor, begin, end] : merge_files(files_, comparator)) {
+      auto events = subslice(cursor->events, begin, end);
+      if (not buffer.empty() and buffer.back().schema() != events.schema()) {
+        co_yield concatenate(std::exchange(buffer, {}));
+        num_buffered = 0;
+      }
+      num_buffered += events.rows();
+      buffer.push_back(std::move(events));
+      while (num_buffered >= defaults::import::table_slice_size) {
+        auto [lhs, rhs] = split(buffer, defaults::import::table_slice_size);
+        auto result = concatenate(std::move(lhs));
+        num_buffered -= result.rows();
+        co_yield std::move(result);
+        buffer = std::move(rhs);
+      }
+    }
+    if (not buffer.empty()) {
+      co_yield concatenate(std::move(buffer));
+    }
+  }
+
+private:
+  /// A range of consecutive events of a cursor that come next in the merged
+  /// order.
+  struct merged_range {
+    const run_cursor* cursor = {};
+    int64_t begin = {};
+    int64_t end = {};
+  };
+
+  /// Merges the given files with a k-way heap merge, yielding the ranges of
+  /// events in sorted order. A range is only valid until the next one is
+  /// requested. Ties between equal events are broken by their rank, which
+  /// makes the merge stable.
+  static auto merge_files(std::span<const run_file> files,
+                          sort_key_comparator comparator)
+    -> generator<merged_range> {
+    auto cursors = std::vector<run_cursor>{};
+    cursors.reserve(files.size());
+    for (const auto& file : files) {
+      auto open = [&]() -> arrow::Result<
+                          std::shared_ptr<arrow::ipc::RecordBatchReader>> {
+        ARROW_ASSIGN_OR_RAISE(auto input,
+                              arrow::io::ReadableFile::Open(file.path));
+        return arrow::ipc::RecordBatchStreamReader::Open(input);
+      };
+      auto reader = open();
+      if (not reader.ok()) {
+        diagnostic::error("{}",
+                          reader.status().ToStringWithoutContextLines())
+          .note("failed to open sorted run `{}`", file.path)
+          .note("from `sort`")
+          .throw_();
+      }
+      auto& cursor = cursors.emplace_back();
+      cursor.file = &file;
+      cursor.reader = reader.MoveValueUnsafe();
+      if (not cursor.next()) {
+        cursors.pop_back();
+      }
+    }
+    const auto sorts_before = [&](size_t lhs, size_t rhs) {
+      const auto& l = cursors[lhs];
+      const auto& r = cursors[rhs];
+      const auto order = comparator(l.keys, l.row, r.keys, r.row);
+      if (order != std::weak_ordering::equivalent) {
+        return order < 0;
+      }
+      return l.ranks->Value(l.row) < r.ranks->Value(r.row);
+    };
+    const auto heap_order = [&](size_t lhs, size_t rhs) {
+      return sorts_before(rhs, lhs);
+    };
+    auto heap = std::vector<size_t>(cursors.size());
+    std::iota(heap.begin(), heap.end(), size_t{0});
+    std::ranges::make_heap(heap, heap_order);
+    while (not heap.empty()) {
+      std::ranges::pop_heap(heap, heap_order);
+      const auto index = heap.back();
+      heap.pop_back();
+      auto& cursor = cursors[index];
+      // Take as many consecutive events from the cursor as possible before
+      // another cursor takes precedence.
+      const auto begin = cursor.row;
+      const auto end = detail::narrow<int64_t>(cursor.events.rows());
+      do {
+        ++cursor.row;
+      } while (cursor.row < end
+               and (heap.empty() or sorts_before(index, heap.front())));
+      co_yield merged_range{&cursor, begin, cursor.row};
+      if (cursor.row < end or cursor.next()) {
+        heap.push_back(index);
+        std::ranges::push_heap(heap, heap_order);
+      }
+    }
+  }
+
+  /// Merges groups of up to `max_open_runs_` files with the same layout into
+  /// intermediate runs and removes the merged files. Returns false if there
+  /// was nothing left to merge, i.e., every layout has a single file.
+  auto merge_pass(const sort_key_comparator& comparator) -> bool {
+    auto layouts = std::vector<std::vector<run_file>>{};
+    for (auto& file : files_) {
+      const auto it
+        = std::ranges::find_if(layouts, [&](const std::vector<run_file>& xs) {
+            return xs.front().same_layout(file);
+          });
+      if (it == layouts.end()) {
+        layouts.emplace_back().push_back(std::move(file));
+      } else {
+        it->push_back(std::move(file));
+      }
+    }
+    files_.clear();
+    auto merged = false;
+    for (const auto& layout : layouts) {
+      for (auto i = size_t{0}; i < layout.size(); i += max_open_runs_) {
+        const auto group = std::span{layout}.subspan(
+          i, std::min(max_open_runs_, layout.size() - i));
+        if (group.size() == 1) {
+          files_.push_back(group.front());
+          continue;
+        }
+        merged = true;
+        auto writer = run_writer{directory_, num_runs_++, 0};
+        auto keys = std::vector<series_row>{};
+        for (auto&& [cursor, begin, end] : merge_files(group, comparator)) {
+          keys.resize(cursor->keys.size());
+          for (auto row = begin; row < end; ++row) {
+            for (size_t k = 0; k < keys.size(); ++k) {
+              keys[k] = find_row(cursor->keys[k], row);
+            }
+            writer.add(cursor->file->schema, *cursor->event_array, row, keys,
+                       cursor->ranks->Value(row));
+          }
+        }
+        auto files = std::move(writer).finish();
+        TENZIR_DEBUG("sort merged {} files into intermediate run {}",
+                     group.size(), num_runs_ - 1);
+        for (const auto& file : group) {
+          auto ec = std::error_code{};
+          std::filesystem::remove(file.path, ec);
+        }
+        files_.insert(files_.end(), std::make_move_iterator(files.begin()),
+                      std::make_move_iterator(files.end()));
+      }
+    }
+    return merged;
+  }
+
+  uint64_t memory_limit_ = {};
+  size_t max_open_runs_ = {};
+  std::filesystem::path state_directory_ = {};
+  std::filesystem::path directory_ = {};
+  size_t num_runs_ = {};
+  int64_t next_rank_ = {};
+  std::vector<run_file> files_ = {};
+};
+
 class sort_state {
 public:
   sort_state(const std::string& key,
-             const arrow::compute::ArraySortOptions& sort_options)
-    : key_{key}, sort_options_{sort_options} {
+             const arrow::compute::ArraySortOptions& sort_options,
+             operator_control_plane& ctrl)
+    : key_{key}, sort_options_{sort_options}, spill_{ctrl} {
   }
 
   auto try_add(table_slice slice, operator_control_plane& ctrl) -> table_slice {
@@ -110,23 +676,110 @@ public:
     }
     offset_table_.push_back(offset_table_.back()
                             + detail::narrow_cast<int64_t>(slice.rows()));
+    num_buffered_bytes_ += slice.approx_bytes();
     cache_.push_back(std::move(slice));
+    if (spill_.exceeded(num_buffered_bytes_)) {
+      spill_cache();
+    }
     return {};
   }
 
   auto sorted() && -> generator<table_slice> {
-    // If there is nothing to sort, then we can just return early.
-    if (cache_.empty()) {
+    if (spill_.empty()) {
+      for (auto&& slice : sort_cache()) {
+        co_yield std::move(slice);
+      }
       co_return;
     }
-    // Arrow's sort function returns us an Int64Array of indices, which are
-    // guaranteed not to be null. We map these in a two-step process onto our
-    // cached table slices, and yield slices of size 1 for each returned row.
-    // The algorithm below uses an offset table that has an additional 0 value
-    // at the start, and uses std::upper_bound to find the entry in the cache
-    // using the offset table.
-    const auto chunked_key
-      = arrow::ChunkedArray::Make(std::move(sort_keys_)).ValueOrDie();
+    // Once we started spilling, we also spill the remainder so that we can
+    // merge all runs uniformly.
+    spill_cache();
+    auto comparator = [this](std::span<const multi_series> lhs,
+                             int64_t lhs_row, std::span<const multi_series> rhs,
+                             int64_t rhs_row) {
+      return compare_keys(lhs[0], lhs_row, rhs[0], rhs_row);
+    };
+    for (auto&& slice : spill_.merge(comparator)) {
+      co_yield std::move(slice);
+    }
+  }
+
+private:
+  /// Sorts the cached events as a single run and writes it to disk.
+  auto spill_cache() -> void {
+    if (cache_.empty()) {
+      return;
+    }
+    const auto indices = sort_cache_indices();
+    spill_.spill([&](run_writer& writer) {
+      TENZIR_ASSERT(key_type_);
+      auto events = std::vector<std::shared_ptr<arrow::StructArray>>{};
+      auto keys = std::vector<series>{};
+      events.reserve(cache_.size());
+      keys.reserve(cache_.size());
+      for (const auto& slice : cache_) {
+        const auto batch = to_record_batch(slice);
+        const auto& path = key_field_path_.at(slice.schema());
+        TENZIR_ASSERT(path);
+        events.push_back(check(batch->ToStructArray()));
+        keys.emplace_back(*key_type_, path->get(*batch));
+      }
+      for (const auto& index : *indices) {
+        TENZIR_ASSERT(index.has_value());
+        const auto [cache_index, row] = locate(*index);
+        const auto key = series_row{&keys[cache_index], row};
+        writer.add(cache_[cache_index].schema(), *events[cache_index], row,
+                   {&key, 1});
+      }
+    });
+    cache_.clear();
+    offset_table_ = {0};
+    sort_keys_.clear();
+    num_buffered_bytes_ = 0;
+  }
+
+  /// Three-way compares two sort key values in the same order as
+  /// `arrow::compute::SortIndices` does, i.e., nulls and NaN values are placed
+  /// according to the null placement, independent of the sort order.
+  auto compare_keys(const multi_series& lhs, int64_t lhs_row,
+                    const multi_series& rhs, int64_t rhs_row) const
+    -> std::weak_ordering {
+    const auto nulls_first
+      = sort_options_.null_placement == arrow::compute::NullPlacement::AtStart;
+    const auto lhs_null = lhs.is_null(lhs_row);
+    const auto rhs_null = rhs.is_null(rhs_row);
+    if (lhs_null or rhs_null) {
+      return nulls_first ? rhs_null <=> lhs_null : lhs_null <=> rhs_null;
+    }
+    const auto lhs_value = lhs.value_at(lhs_row);
+    const auto rhs_value = rhs.value_at(rhs_row);
+    const auto is_nan = [](const data_view& value) {
+      const auto* x = try_as<double>(value);
+      return x and std::isnan(*x);
+    };
+    const auto lhs_nan = is_nan(lhs_value);
+    const auto rhs_nan = is_nan(rhs_value);
+    if (lhs_nan or rhs_nan) {
+      return nulls_first ? rhs_nan <=> lhs_nan : lhs_nan <=> rhs_nan;
+    }
+    const auto descending
+      = sort_options_.order == arrow::compute::SortOrder::Descending;
+    if (sort_value_less(lhs_value, rhs_value)) {
+      return descending ? std::weak_ordering::greater
+                        : std::weak_ordering::less;
+    }
+    if (sort_value_less(rhs_value, lhs_value)) {
+      return descending ? std::weak_ordering::less
+                        : std::weak_ordering::greater;
+    }
+    return std::weak_ordering::equivalent;
+  }
+
+  /// Sorts the cached events, returning the indices of the events in sorted
+  /// order. Arrow's sort function returns us an Int64Array of indices, which
+  /// are guaranteed not to be null.
+  auto sort_cache_indices() const -> std::shared_ptr<arrow::Int64Array> {
+    const auto chunked_key = arrow::ChunkedArray::Make(sort_keys_).ValueOrDie();
     const auto indices
       = arrow::compute::SortIndices(*chunked_key, sort_options_);
     if (not indices.ok()) {
@@ -134,14 +787,30 @@ public:
         .note("failed to sort `{}`", key_)
         .throw_();
     }
-    auto result_buffer = std::vector<table_slice>{};
-    for (const auto& index :
-         static_cast<const arrow::Int64Array&>(*indices.ValueUnsafe())) {
+    return std::static_pointer_cast<arrow::Int64Array>(indices.ValueUnsafe());
+  }
+
+  /// Maps an index returned by `sort_cache_indices` onto the cached slices.
+  /// The offset table has an additional 0 value at the start, which allows for
+  /// using std::upper_bound to find the entry in the cache.
+  auto locate(int64_t index) const -> std::pair<size_t, int64_t> {
+    const auto offset = std::prev(
+      std::upper_bound(offset_table_.begin(), offset_table_.end(), index));
+    return {
+      detail::narrow<size_t>(std::distance(offset_table_.begin(), offset)),
+      index - *offset,
+    };
+  }
+
+  /// Sorts the cached events, yielding them one by one.
+  auto sort_cache() const -> generator<table_slice> {
+    // If there is nothing to sort, then we can just return early.
+    if (cache_.empty()) {
+      co_return;
+    }
+    for (const auto& index : *sort_cache_indices()) {
       TENZIR_ASSERT(index.has_value());
-      const auto offset = std::prev(
-        std::upper_bound(offset_table_.begin(), offset_table_.end(), *index));
-      const auto cache_index = std::distance(offset_table_.begin(), offset);
-      const auto row = *index - *offset;
+      const auto [cache_index, row] = locate(*index);
       const auto& slice = cache_[cache_index];
       auto result = subslice(slice, row, row + 1);
       TENZIR_ASSERT(result.rows() == 1);
@@ -149,7 +818,6 @@ public:
     }
   }
 
-private:
   auto find_or_create_path(const type& schema, operator_control_plane& ctrl)
     -> const std::optional<offset>& {
     auto key_path = key_field_path_.find(schema);
@@ -220,6 +888,12 @@ private:
 
   /// The type of the sorted-by field.
   std::optional<type> key_type_ = {};
+
+  /// The approximate size of the cached slices in bytes.
+  uint64_t num_buffered_bytes_ = {};
+
+  /// The sorted runs that were spilled to disk.
+  spill_state spill_;
 };
 
 class sort_operator final : public crtp_operator<sort_operator> {
@@ -242,7 +916,7 @@ public:
     options.null_placement = nulls_first_
                                ? arrow::compute::NullPlacement::AtStart
                                : arrow::compute::NullPlacement::AtEnd;
-    auto state = sort_state{key_, options};
+    auto state = sort_state{key_, options, ctrl};
     co_yield {};
     for (auto&& slice : input) {
       co_yield state.try_add(std::move(slice), ctrl);
@@ -391,8 +1065,9 @@ class sort_operator2 final : public crtp_operator<sort_operator2> {
 public:
   sort_operator2() = default;
 
-  explicit sort_operator2(std::vector<sort_expression> sort_exprs)
-    : sort_exprs_{std::move(sort_exprs)} {
+  explicit sort_operator2(std::vector<sort_expression> sort_exprs,
+                          std::optional<uint64_t> limit = std::nullopt)
+    : sort_exprs_{std::move(sort_exprs)}, limit_{limit} {
   }
 
   auto name() const -> std::string override {
@@ -402,13 +1077,66 @@ public:
   auto
   operator()(generator<table_slice> input, operator_control_plane& ctrl) const
     -> generator<table_slice> {
+    if (limit_) {
+      return top_k(std::move(input), ctrl, *limit_);
+    }
+    return full_sort(std::move(input), ctrl);
+  }
+
+  auto full_sort(generator<table_slice> input,
+                 operator_control_plane& ctrl) const
+    -> generator<table_slice> {
     auto events = std::vector<table_slice>{};
     auto indices = std::vector<sort_index>{};
     auto sort_keys = std::vector<sort_key>{};
+    auto num_buffered_bytes = uint64_t{0};
+    auto spill = spill_state{ctrl};
     sort_keys.reserve(sort_exprs_.size());
     for (const auto& sort_expr : sort_exprs_) {
       sort_keys.emplace_back().reverse = sort_expr.reverse;
     }
+    const auto sort_indices = [&] {
+      std::ranges::sort(indices, [&](const sort_index& lhs,
+                                     const sort_index& rhs) {
+        for (const auto& sort_key : sort_keys) {
+          const auto order = compare_sort_key(
+            sort_key.chunks[lhs.slice], lhs.event, sort_key.chunks[rhs.slice],
+            rhs.event, sort_key.reverse);
+          if (order != std::weak_ordering::equivalent) {
+            return order < 0;
+          }
+        }
+        // If we're here then it's a tie.
+        return false;
+      });
+    };
+    const auto spill_events = [&] {
+      if (indices.empty()) {
+        return;
+      }
+      sort_indices();
+      spill.spill([&](run_writer& writer) {
+        auto structs = std::vector<std::shared_ptr<arrow::StructArray>>{};
+        structs.reserve(events.size());
+        for (const auto& slice : events) {
+          structs.push_back(check(to_record_batch(slice)->ToStructArray()));
+        }
+        auto keys = std::vector<series_row>(sort_keys.size());
+        for (const auto& index : indices) {
+          for (size_t i = 0; i < sort_keys.size(); ++i) {
+            keys[i] = find_row(sort_keys[i].chunks[index.slice], index.event);
+          }
+          writer.add(events[index.slice].schema(), *structs[index.slice],
+                     index.event, keys);
+        }
+      });
+      events.clear();
+      indices.clear();
+      for (auto& sort_key : sort_keys) {
+        sort_key.chunks.clear();
+      }
+      num_buffered_bytes = 0;
+    };
     for (auto&& slice : input) {
       if (slice.rows() == 0) {
         co_yield {};
@@ -426,7 +1154,33 @@ public:
         sort_keys[i].chunks.push_back(
           eval(sort_exprs_[i].expr, slice, ctrl.diagnostics()));
       }
+      num_buffered_bytes += slice.approx_bytes();
       events.push_back(std::move(slice));
+      if (spill.exceeded(num_buffered_bytes)) {
+        spill_events();
+      }
+    }
+    if (not spill.empty()) {
+      // Once we started spilling, we also spill the remainder so that we can
+      // merge all runs uniformly.
+      spill_events();
+      auto comparator = [this](std::span<const multi_series> lhs,
+                               int64_t lhs_row,
+                               std::span<const multi_series> rhs,
+                               int64_t rhs_row) {
+        for (size_t i = 0; i < sort_exprs_.size(); ++i) {
+          const auto order = compare_sort_key(lhs[i], lhs_row, rhs[i], rhs_row,
+                                              sort_exprs_[i].reverse);
+          if (order != std::weak_ordering::equivalent) {
+            return order;
+          }
+        }
+        return std::weak_ordering::equivalent;
+      };
+      for (auto&& slice : spill.merge(comparator)) {
+        co_yield std::move(slice);
+      }
+      co_return;
     }
     if (indices.empty()) {
       co_return;
@@ -434,64 +1188,107 @@ public:
     // TODO: If all chunks for a sort key evaluate to the same type, then we can
     // choose a faster path where we do not need to evaluate the sort key's type
     // for each row individually. That may be significantly faster.
-    std::ranges::sort(indices, [&](const sort_index& lhs,
-                                   const sort_index& rhs) {
+    sort_indices();
+    // Lastly, assemble the result by fetching the rows in their sorted order.
+    auto batch = std::vector<table_slice>{};
+    for (const auto& index : indices) {
+      if (not batch.empty()
+          and batch.back().schema() != events[index.slice].schema()) {
+        co_yield concatenate(std::exchange(batch, {}));
+      }
+      if (batch.size() >= defaults::import::table_slice_size) {
+        co_yield concatenate(std::exchange(batch, {}));
+      }
+      batch.push_back(
+        subslice(events[index.slice], index.event, index.event + 1));
+    }
+    if (not batch.empty()) {
+      co_yield concatenate(std::exchange(batch, {}));
+    }
+  }
+
+  /// Yields the first `limit` events in sort order. Instead of sorting the
+  /// entire input, this keeps a heap of the best `limit` events seen so far,
+  /// and only retains the batches that hold at least one of them.
+  auto top_k(generator<table_slice> input, operator_control_plane& ctrl,
+             uint64_t limit) const -> generator<table_slice> {
+    auto events = std::vector<table_slice>{};
+    auto references = std::vector<size_t>{};
+    auto sort_keys = std::vector<sort_key>{};
+    sort_keys.reserve(sort_exprs_.size());
+    for (const auto& sort_expr : sort_exprs_) {
+      sort_keys.emplace_back().reverse = sort_expr.reverse;
+    }
+    // Ties are broken by the arrival order, which makes this equivalent to a
+    // stable sort followed by `head`.
+    const auto sorts_before = [&](const sort_index& lhs,
+                                  const sort_index& rhs) {
       for (const auto& sort_key : sort_keys) {
-        const auto& lhs_key = sort_key.chunks[lhs.slice];
-        const auto& rhs_key = sort_key.chunks[rhs.slice];
-        const auto lhs_null = lhs_key.is_null(lhs.event);
-        const auto rhs_null = rhs_key.is_null(rhs.event);
-        if (lhs_null and rhs_null) {
-          continue;
+        const auto order = compare_sort_key(
+          sort_key.chunks[lhs.slice], lhs.event, sort_key.chunks[rhs.slice],
+          rhs.event, sort_key.reverse);
+        if (order != std::weak_ordering::equivalent) {
+          return order < 0;
         }
-        if (lhs_null or rhs_null) {
-          // Nulls last, independent of sort order.
-          return rhs_null;
+      }
+      return std::tie(lhs.slice, lhs.event) < std::tie(rhs.slice, rhs.event);
+    };
+    // Releases a reference to a batch, dropping the batch once no event in the
+    // heap refers to it anymore.
+    const auto release = [&](size_t slice) {
+      TENZIR_ASSERT(references[slice] > 0);
+      if (--references[slice] == 0) {
+        events[slice] = {};
+        for (auto& sort_key : sort_keys) {
+          sort_key.chunks[slice] = {};
         }
-        const auto& lhs_value = lhs_key.value_at(lhs.event);
-        const auto& rhs_value = rhs_key.value_at(rhs.event);
-        // TODO: Implement this directly on data and data_view. That is
-        // non-trivial however.
-        // TODO: This does not do the correct recursive application of the
-        // comparator to nested structural types. It turns out that is a
-        // non-trivial task as well.
-        const auto cmp = detail::overload{
-          [](const concepts::integer auto& l, const concepts::integer auto& r) {
-            return std::cmp_less(l, r);
-          },
-          []<concepts::number L, concepts::number R>(const L& l, const R& r) {
-            if constexpr (std::same_as<L, double>) {
-              if (std::isnan(l)) {
-                return false;
-              }
-            }
-            if constexpr (std::same_as<R, double>) {
-              if (std::isnan(r)) {
-                return true;
-              }
-            }
-            return l < r;
-          },
-          [&](const auto& l, const auto& r) {
-            if constexpr (std::same_as<decltype(l), decltype(r)>) {
-              return l < r;
-            }
-            return lhs_value.index() < rhs_value.index();
-          },
+      }
+    };
+    // The heap has the event that sorts last at its front, so that we can
+    // replace it quickly once we see a better one.
+    auto heap = std::vector<sort_index>{};
+    heap.reserve(limit);
+    for (auto&& slice : input) {
+      if (slice.rows() == 0 or limit == 0) {
+        co_yield {};
+        continue;
+      }
+      const auto index = events.size();
+      for (size_t i = 0; i < sort_exprs_.size(); ++i) {
+        sort_keys[i].chunks.push_back(
+          eval(sort_exprs_[i].expr, slice, ctrl.diagnostics()));
+      }
+      const auto length = detail::narrow<int64_t>(slice.rows());
+      events.push_back(std::move(slice));
+      // We hold an additional reference while processing the batch so that it
+      // does not get released early.
+      references.push_back(1);
+      for (int64_t i = 0; i < length; ++i) {
+        const auto candidate = sort_index{
+          .slice = index,
+          .event = i,
         };
-        if (match(std::tie(lhs_value, rhs_value), cmp)) {
-          return not sort_key.reverse;
+        if (heap.size() < limit) {
+          heap.push_back(candidate);
+          std::ranges::push_heap(heap, sorts_before);
+          ++references[index];
+          continue;
         }
-        if (match(std::tie(rhs_value, lhs_value), cmp)) {
-          return sort_key.reverse;
+        if (not sorts_before(candidate, heap.front())) {
+          continue;
         }
+        std::ranges::pop_heap(heap, sorts_before);
+        const auto evicted = heap.back().slice;
+        heap.back() = candidate;
+        std::ranges::push_heap(heap, sorts_before);
+        ++references[index];
+        release(evicted);
       }
-      // If we're here then it's a tie.
-      return false;
-    });
-    // Lastly, assemble the result by fetching the rows in their sorted order.
+      release(index);
+    }
+    std::ranges::sort_heap(heap, sorts_before);
     auto batch = std::vector<table_slice>{};
-    for (const auto& index : indices) {
+    for (const auto& index : heap) {
       if (not batch.empty()
           and batch.back().schema() != events[index.slice].schema()) {
         co_yield concatenate(std::exchange(batch, {}));
@@ -510,20 +1307,51 @@ public:
   auto optimize(const expression& filter, event_order order) const
     -> optimize_result override {
     // Our upstream can always be unordered. If our downstream did already not
-    // care about ordering, we can skip sorting entirely.
+    // care about ordering, we can skip sorting entirely, unless we must select
+    // the first events in sort order.
     return optimize_result{
       filter,
       event_order::unordered,
-      order == event_order::unordered ? nullptr : copy(),
+      order == event_order::unordered and not limit_ ? nullptr : copy(),
     };
   }
 
+  auto fuse(const operator_base& next) const -> operator_ptr override {
+    const auto limit = next.head_limit();
+    if (not limit) {
+      return nullptr;
+    }
+    return std::make_unique<sort_operator2>(
+      sort_exprs_, limit_ ? std::min(*limit_, *limit) : *limit);
+  }
+
+  auto input_fields(const std::optional<std::vector<std::string>>& fields) const
+    -> std::optional<std::vector<std::string>> override {
+    if (not fields) {
+      return std::nullopt;
+    }
+    auto result = *fields;
+    for (const auto& sort_expr : sort_exprs_) {
+      auto expr_fields = sort_expr.expr.root_fields();
+      if (not expr_fields) {
+        return std::nullopt;
+      }
+      result.insert(result.end(), expr_fields->begin(), expr_fields->end());
+    }
+    std::ranges::sort(result);
+    const auto [first, last] = std::ranges::unique(result);
+    result.erase(first, last);
+    return result;
+  }
+
   friend auto inspect(auto& f, sort_operator2& x) -> bool {
-    return f.apply(x.sort_exprs_);
+    return f.object(x).fields(f.field("sort_exprs", x.sort_exprs_),
+                              f.field("limit", x.limit_));
   }
 
 private:
   std::vector<sort_expression> sort_exprs_ = {};
+  std::optional<uint64_t> limit_ = {};
 };
 
 class plugin2 final : public virtual operator_plugin2<sort_operator2>,
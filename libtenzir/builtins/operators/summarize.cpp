@@ -15,28 +15,48 @@
 #include <tenzir/concept/parseable/core.hpp>
 #include <tenzir/concept/parseable/tenzir/pipeline.hpp>
 #include <tenzir/concept/parseable/tenzir/time.hpp>
+#include <tenzir/defaults.hpp>
+#include <tenzir/detail/scope_guard.hpp>
 #include <tenzir/detail/zip_iterator.hpp>
 #include <tenzir/error.hpp>
+#include <tenzir/group_table.hpp>
 #include <tenzir/hash/hash_append.hpp>
+#include <tenzir/io/read.hpp>
+#include <tenzir/io/save.hpp>
+#include <tenzir/logger.hpp>
 #include <tenzir/operator_control_plane.hpp>
 #include <tenzir/parser_interface.hpp>
 #include <tenzir/pipeline.hpp>
 #include <tenzir/plugin.hpp>
 #include <tenzir/series_builder.hpp>
+#include <tenzir/shared_diagnostic_handler.hpp>
 #include <tenzir/tql2/eval.hpp>
 #include <tenzir/tql2/plugin.hpp>
 #include <tenzir/tql2/registry.hpp>
 #include <tenzir/type.hpp>
+#include <tenzir/uuid.hpp>
 
 #include <arrow/compute/api_scalar.h>
+#include <arrow/compute/api_vector.h>
 #include <arrow/record_batch.h>
 #include <arrow/type.h>
+#include <caf/binary_deserializer.hpp>
+#include <caf/binary_serializer.hpp>
+#include <caf/detail/set_thread_name.hpp>
 #include <caf/expected.hpp>
 #include <tsl/robin_map.h>
 
 #include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <mutex>
 #include <ranges>
 #include <string_view>
+#include <thread>
 #include <utility>
 #include <variant>
 
@@ -933,25 +953,163 @@ struct config {
   /// corresponds to `aggregates`, otherwise `groups[-index - 1]`.
   std::vector<int64_t> indices;
 
+  /// The number of worker threads, or zero to aggregate in the operator itself.
+  uint64_t jobs = 0;
+
   friend auto inspect(auto& f, config& x) -> bool {
     return f.object(x).fields(f.field("aggregates", x.aggregates),
                               f.field("groups", x.groups),
-                              f.field("indices", x.indices));
+                              f.field("indices", x.indices),
+                              f.field("jobs", x.jobs));
   }
 };
 
-template <class Value>
-using group_map
-  = tsl::robin_map<group_by_key, Value, group_by_key_hash, group_by_key_equal>;
-
 struct bucket2 {
   std::vector<std::unique_ptr<aggregation_instance>> aggregations{};
 };
 
+/// The serialized state of a group that was spilled to disk.
+struct spilled_group {
+  std::vector<data> key;
+  std::vector<caf::byte_buffer> states;
+
+  friend auto inspect(auto& f, spilled_group& x) -> bool {
+    return f.object(x).fields(f.field("key", x.key),
+                              f.field("states", x.states));
+  }
+};
+
+/// Writes the groups of `summarize` to disk once they exceed the configured
+/// memory limit. The groups are hash-partitioned by their key, so that every
+/// partition can be re-aggregated on its own at the end of the input. Removes
+/// the spilled partitions on destruction.
+class spill_state {
+public:
+  /// The groups are partitioned by the high bits of their digests.
+  static constexpr auto partition_bits = 6;
+  static constexpr auto num_partitions = size_t{1} << partition_bits;
+
+  spill_state(uint64_t memory_limit, std::filesystem::path state_directory)
+    : memory_limit_{memory_limit},
+      state_directory_{std::move(state_directory)} {
+  }
+
+  spill_state(const spill_state&) = delete;
+  auto operator=(const spill_state&) -> spill_state& = delete;
+  spill_state(spill_state&&) = delete;
+  auto operator=(spill_state&&) -> spill_state& = delete;
+
+  ~spill_state() noexcept {
+    if (not directory_.empty()) {
+      auto ec = std::error_code{};
+      std::filesystem::remove_all(directory_, ec);
+      if (ec) {
+        TENZIR_WARN("failed to remove summarize spill directory {}: {}",
+                    directory_, ec.message());
+      }
+    }
+  }
+
+  /// Returns whether the given number of bytes requires spilling.
+  auto exceeded(uint64_t num_bytes) const -> bool {
+    return num_bytes >= memory_limit_;
+  }
+
+  /// Returns whether any groups were spilled to disk.
+  auto empty() const -> bool {
+    return num_spills_ == 0;
+  }
+
+  /// Returns the partition of a group given the digest of its key.
+  static auto partition_of(uint64_t digest) -> size_t {
+    return detail::narrow<size_t>(digest >> (64 - partition_bits));
+  }
+
+  /// Starts a new spill, i.e., a new set of partition files.
+  auto begin_spill() -> void {
+    if (directory_.empty()) {
+      auto ec = std::error_code{};
+      directory_ = std::filesystem::absolute(state_directory_, ec)
+                   / "summarize" / fmt::to_string(uuid::random());
+      std::filesystem::create_directories(directory_, ec);
+      if (ec) {
+        diagnostic::error("{}", ec.message())
+          .note("failed to create spill directory `{}`", directory_)
+          .note("from `summarize`")
+          .throw_();
+      }
+    }
+    ++num_spills_;
+  }
+
+  /// Writes the groups of a partition for the current spill.
+  auto write(size_t partition, const std::vector<spilled_group>& groups)
+    -> void {
+    TENZIR_ASSERT(partition < num_partitions);
+    TENZIR_ASSERT(num_spills_ > 0);
+    auto buffer = caf::byte_buffer{};
+    auto f = caf::binary_serializer{buffer};
+    if (not f.apply(groups)) {
+      diagnostic::error("{}", f.get_error())
+        .note("failed to serialize spilled groups")
+        .note("from `summarize`")
+        .throw_();
+    }
+    auto path = directory_
+                / fmt::format("partition-{}-{}.bin", partition,
+                              num_spills_ - 1);
+    if (auto err = io::save(path, as_bytes(buffer))) {
+      diagnostic::error("{}", err)
+        .note("failed to write spilled groups to `{}`", path)
+        .note("from `summarize`")
+        .throw_();
+    }
+    files_[partition].push_back(std::move(path));
+  }
+
+  /// Reads back the spilled groups of a partition, one file at a time, and
+  /// removes the files afterwards.
+  auto read(size_t partition) -> generator<std::vector<spilled_group>> {
+    TENZIR_ASSERT(partition < num_partitions);
+    for (auto& path : std::exchange(files_[partition], {})) {
+      auto buffer = io::read(path);
+      if (not buffer) {
+        diagnostic::error("{}", buffer.error())
+          .note("failed to read spilled groups from `{}`", path)
+          .note("from `summarize`")
+          .throw_();
+      }
+      auto groups = std::vector<spilled_group>{};
+      auto f = caf::binary_deserializer{buffer->data(), buffer->size()};
+      if (not f.apply(groups)) {
+        diagnostic::error("{}", f.get_error())
+          .note("failed to deserialize spilled groups from `{}`", path)
+          .note("from `summarize`")
+          .throw_();
+      }
+      buffer = {};
+      auto ec = std::error_code{};
+      std::filesystem::remove(path, ec);
+      co_yield std::move(groups);
+    }
+  }
+
+private:
+  uint64_t memory_limit_ = {};
+  std::filesystem::path state_directory_ = {};
+  std::filesystem::path directory_ = {};
+  size_t num_spills_ = {};
+  std::array<std::vector<std::filesystem::path>, num_partitions> files_ = {};
+};
+
 class implementation2 {
 public:
-  explicit implementation2(const config& cfg, session ctx)
-    : cfg_{cfg}, ctx_{ctx} {
+  /// Creates an implementation that keeps all groups in memory, unless
+  /// *spill* is given, in which case groups are spilled to disk once they
+  /// exceed its memory limit.
+  explicit implementation2(const config& cfg, session ctx,
+                           std::unique_ptr<spill_state> spill = nullptr)
+    : cfg_{cfg}, ctx_{ctx}, spill_{std::move(spill)} {
   }
 
   auto make_bucket() -> std::unique_ptr<bucket2> {
@@ -969,42 +1127,253 @@ public:
   }
 
   void add(const table_slice& slice) {
+    update(slice);
+    rows_since_sample_ += slice.rows();
+    if (spill_ and spill_->exceeded(approx_bytes())) {
+      spill();
+    }
+  }
+
+  /// Merges the groups of another implementation into this one, leaving the
+  /// other one in a moved-from state.
+  void merge(implementation2& other) {
+    TENZIR_ASSERT(not spill_ and not other.spill_);
+    for (auto id = uint32_t{0}; id < other.groups_.size(); ++id) {
+      const auto target = groups_.insert(other.groups_.key(id));
+      if (target == buckets_.size()) {
+        buckets_.push_back(std::move(other.buckets_[id]));
+        continue;
+      }
+      for (auto&& [lhs, rhs] :
+           detail::zip_equal(buckets_[target]->aggregations,
+                             other.buckets_[id]->aggregations)) {
+        lhs->merge(*rhs, ctx_);
+      }
+    }
+    other.groups_.clear();
+    other.buckets_.clear();
+  }
+
+  auto finish() -> generator<table_slice> {
+    if (not spill_ or spill_->empty()) {
+      for (auto&& slice : finish_groups()) {
+        co_yield std::move(slice);
+      }
+      co_return;
+    }
+    // Once we spilled, we also spill the remaining groups so that every
+    // partition can be re-aggregated on its own.
+    spill();
+    for (auto partition = size_t{0}; partition < spill_state::num_partitions;
+         ++partition) {
+      for (auto&& groups : spill_->read(partition)) {
+        for (auto& group : groups) {
+          restore(group);
+        }
+      }
+      if (groups_.empty()) {
+        continue;
+      }
+      for (auto&& slice : finish_groups()) {
+        co_yield std::move(slice);
+      }
+      groups_.clear();
+      buckets_.clear();
+      local_ids_.clear();
+    }
+  }
+
+private:
+  static constexpr auto no_local_id = std::numeric_limits<uint32_t>::max();
+
+  /// The assumed overhead of an aggregation instance in addition to its saved
+  /// state.
+  static constexpr auto instance_overhead = size_t{128};
+
+  /// The number of events after which `approx_bytes` samples the saved state
+  /// of the groups again.
+  static constexpr auto sample_interval = uint64_t{1} << 16;
+
+  void update(const table_slice& slice) {
     auto group_values = std::vector<multi_series>{};
     for (auto& group : cfg_.groups) {
       group_values.push_back(eval(group.expr.inner(), slice, ctx_));
     }
-    auto key = group_by_key_view{};
-    key.resize(cfg_.groups.size());
-    auto update_group = [&](bucket2& group, int64_t begin, int64_t end) {
-      for (auto&& aggr : group.aggregations) {
-        aggr->update(subslice(slice, begin, end), ctx_);
+    const auto total_rows = detail::narrow<int64_t>(slice.rows());
+    const auto ids = groups_.insert(group_values, total_rows);
+    while (buckets_.size() < groups_.size()) {
+      buckets_.push_back(make_bucket());
+    }
+    local_ids_.resize(groups_.size(), no_local_id);
+    // Assign batch-local indices to the groups in order of appearance, and
+    // check whether every group forms a single contiguous run of rows.
+    auto batch_groups = std::vector<uint32_t>{};
+    auto counts = std::vector<int64_t>{};
+    auto local = std::vector<uint32_t>(ids.size());
+    auto num_runs = size_t{0};
+    for (auto row = size_t{0}; row < ids.size(); ++row) {
+      auto& local_id = local_ids_[ids[row]];
+      if (local_id == no_local_id) {
+        local_id = detail::narrow<uint32_t>(batch_groups.size());
+        batch_groups.push_back(ids[row]);
+        counts.push_back(0);
       }
-    };
-    auto find_or_create_group = [&](int64_t row) -> bucket2* {
-      for (auto&& [key_value, group] : detail::zip_equal(key, group_values)) {
-        key_value = group.value_at(row);
+      local[row] = local_id;
+      ++counts[local_id];
+      if (row == 0 or ids[row] != ids[row - 1]) {
+        ++num_runs;
       }
-      auto it = groups_.find(key);
-      if (it == groups_.end()) {
-        it = groups_.emplace_hint(it, materialize(key), make_bucket());
+    }
+    for (auto id : batch_groups) {
+      local_ids_[id] = no_local_id;
+    }
+    auto update_group = [&](const table_slice& input, uint32_t id,
+                            int64_t begin, int64_t end) {
+      for (auto&& aggr : buckets_[id]->aggregations) {
+        aggr->update(subslice(input, begin, end), ctx_);
       }
-      return &*it->second;
     };
-    auto total_rows = detail::narrow<int64_t>(slice.rows());
-    auto current_group = find_or_create_group(0);
-    auto current_begin = int64_t{0};
-    for (auto row = int64_t{1}; row < total_rows; ++row) {
-      auto group = find_or_create_group(row);
-      if (current_group != group) {
-        update_group(*current_group, current_begin, row);
-        current_group = group;
-        current_begin = row;
+    if (num_runs == batch_groups.size()) {
+      auto begin = int64_t{0};
+      for (auto i = size_t{0}; i < batch_groups.size(); ++i) {
+        update_group(slice, batch_groups[i], begin, begin + counts[i]);
+        begin += counts[i];
+      }
+      return;
+    }
+    // The groups are interleaved, so we gather the rows of each group with a
+    // stable counting sort and a single take. This way, every aggregation is
+    // updated exactly once per group and batch.
+    auto offsets = std::vector<int64_t>(batch_groups.size() + 1);
+    for (auto i = size_t{0}; i < counts.size(); ++i) {
+      offsets[i + 1] = offsets[i] + counts[i];
+    }
+    auto positions = std::vector<int64_t>(ids.size());
+    {
+      auto next = offsets;
+      for (auto row = size_t{0}; row < ids.size(); ++row) {
+        positions[next[local[row]]++] = detail::narrow<int64_t>(row);
       }
     }
-    update_group(*current_group, current_begin, total_rows);
+    auto indices = arrow::Int64Builder{};
+    check(indices.AppendValues(positions));
+    auto take_result = arrow::compute::Take(to_record_batch(slice),
+                                            tenzir::finish(indices));
+    if (not take_result.ok()) {
+      diagnostic::error("{}", take_result.status().ToString())
+        .note("failed to gather groups")
+        .throw_();
+    }
+    const auto datum = take_result.MoveValueUnsafe();
+    TENZIR_ASSERT(datum.kind() == arrow::Datum::Kind::RECORD_BATCH);
+    const auto gathered = table_slice{datum.record_batch(), slice.schema()};
+    for (auto i = size_t{0}; i < batch_groups.size(); ++i) {
+      update_group(gathered, batch_groups[i], offsets[i], offsets[i + 1]);
+    }
+  }
+
+  /// Returns the approximate number of bytes that the groups occupy. Measuring
+  /// the state of every aggregation would be too expensive, so we extrapolate
+  /// from the saved state of a sample of the groups. The sample is only taken
+  /// again once the number of groups doubled or enough events arrived to grow
+  /// the states of the existing groups.
+  auto approx_bytes() -> uint64_t {
+    auto result = groups_.approx_bytes()
+                  + buckets_.capacity() * sizeof(std::unique_ptr<bucket2>);
+    if (buckets_.empty()) {
+      return result;
+    }
+    if (buckets_.size() >= 2 * sampled_groups_
+        or rows_since_sample_ >= sample_interval) {
+      constexpr auto max_samples = size_t{32};
+      const auto stride = std::max(size_t{1}, buckets_.size() / max_samples);
+      auto num_samples = size_t{0};
+      auto sampled_bytes = size_t{0};
+      for (auto id = size_t{0}; id < buckets_.size(); id += stride) {
+        for (const auto& aggr : buckets_[id]->aggregations) {
+          const auto state = aggr->save();
+          sampled_bytes += instance_overhead + (state ? state->size() : 0);
+        }
+        ++num_samples;
+      }
+      bytes_per_group_ = sampled_bytes / num_samples;
+      sampled_groups_ = buckets_.size();
+      rows_since_sample_ = 0;
+    }
+    return result + buckets_.size() * (sizeof(bucket2) + bytes_per_group_);
   }
 
-  auto finish() -> std::vector<table_slice> {
+  /// Writes all groups to disk, partitioned by their key, and releases them.
+  void spill() {
+    TENZIR_ASSERT(spill_);
+    if (groups_.empty()) {
+      return;
+    }
+    // Not every aggregation can save its state, and the ones that cannot do so
+    // for all groups alike.
+    for (const auto& aggr : buckets_.front()->aggregations) {
+      if (not aggr->save()) {
+        TENZIR_ASSERT(spill_->empty());
+        diagnostic::warning("`summarize` cannot spill groups to disk")
+          .note("an aggregation function does not support saving its state")
+          .note("keeping all groups in memory instead")
+          .emit(ctx_);
+        spill_ = nullptr;
+        return;
+      }
+    }
+    auto partitions
+      = std::vector<std::vector<uint32_t>>(spill_state::num_partitions);
+    for (auto id = uint32_t{0}; id < groups_.size(); ++id) {
+      partitions[spill_state::partition_of(groups_.digest(id))].push_back(id);
+    }
+    spill_->begin_spill();
+    for (auto partition = size_t{0}; partition < partitions.size();
+         ++partition) {
+      if (partitions[partition].empty()) {
+        continue;
+      }
+      auto groups = std::vector<spilled_group>{};
+      groups.reserve(partitions[partition].size());
+      for (auto id : partitions[partition]) {
+        auto& group = groups.emplace_back();
+        group.key = groups_.key(id);
+        for (const auto& aggr : buckets_[id]->aggregations) {
+          const auto state = aggr->save();
+          const auto bytes = as_bytes(state);
+          group.states.emplace_back(bytes.begin(), bytes.end());
+        }
+        // Release the group right away to keep the peak memory usage low.
+        buckets_[id] = nullptr;
+      }
+      spill_->write(partition, groups);
+    }
+    TENZIR_DEBUG("summarize spilled {} groups", groups_.size());
+    groups_.clear();
+    buckets_ = {};
+    local_ids_ = {};
+    sampled_groups_ = 0;
+  }
+
+  /// Restores a spilled group, merging it into an existing group if needed.
+  void restore(spilled_group& group) {
+    const auto id = groups_.insert(group.key);
+    auto bucket = make_bucket();
+    for (auto&& [aggr, state] :
+         detail::zip_equal(bucket->aggregations, group.states)) {
+      aggr->restore(chunk::make(std::move(state)), ctx_);
+    }
+    if (id == buckets_.size()) {
+      buckets_.push_back(std::move(bucket));
+      return;
+    }
+    for (auto&& [lhs, rhs] : detail::zip_equal(buckets_[id]->aggregations,
+                                               bucket->aggregations)) {
+      lhs->merge(*rhs, ctx_);
+    }
+  }
+
+  auto finish_groups() -> std::vector<table_slice> {
     auto emplace
       = [](record& root, const ast::simple_selector& sel, data value) {
           if (sel.path().empty()) {
@@ -1087,16 +1456,24 @@ public:
     }
     // TODO: Group by schema again to make this more efficient.
     auto b = series_builder{};
-    for (const auto& [key, group] : groups_) {
-      b.data(finish_group(key, group));
+    for (auto id = uint32_t{0}; id < groups_.size(); ++id) {
+      b.data(finish_group(groups_.key(id), buckets_[id]));
     }
     return b.finish_as_table_slice();
   }
 
-private:
   const config& cfg_;
   session ctx_;
-  group_map<std::unique_ptr<bucket2>> groups_;
+  std::unique_ptr<spill_state> spill_;
+  group_table groups_{cfg_.groups.size()};
+  std::vector<std::unique_ptr<bucket2>> buckets_;
+  /// Scratch space for mapping group ids to batch-local indices in `add`.
+  std::vector<uint32_t> local_ids_;
+  /// The sampled size of the aggregation states per group, the number of
+  /// groups at the time of sampling, and the number of events since then.
+  size_t bytes_per_group_ = {};
+  size_t sampled_groups_ = {};
+  uint64_t rows_since_sample_ = {};
 };
 
 class summarize_operator2 final : public crtp_operator<summarize_operator2> {
@@ -1110,12 +1487,37 @@ public:
     return "tql2.summarize";
   }
 
+  auto detached() const -> bool override {
+    return cfg_.jobs > 0;
+  }
+
+  auto idle_after() const -> duration override {
+    return cfg_.jobs == 0 ? duration::zero() : duration::max();
+  }
+
   auto
   operator()(generator<table_slice> input, operator_control_plane& ctrl) const
     -> generator<table_slice> {
+    if (cfg_.jobs > 0) {
+      for (auto&& slice : parallel(std::move(input), ctrl)) {
+        co_yield std::move(slice);
+      }
+      co_return;
+    }
     // TODO: Do not create a new session here.
     auto provider = session_provider::make(ctrl.diagnostics());
-    auto impl = implementation2{cfg_, provider.as_session()};
+    const auto& config = content(ctrl.self().home_system().config());
+    const auto memory_limit
+      = caf::get_or(config, "tenzir.summarize.memory-limit", uint64_t{0});
+    auto spill = std::unique_ptr<spill_state>{};
+    if (memory_limit != 0) {
+      spill = std::make_unique<spill_state>(
+        memory_limit,
+        std::filesystem::path{caf::get_or(config, "tenzir.state-directory",
+                                          defaults::state_directory.data())});
+    }
+    auto impl
+      = implementation2{cfg_, provider.as_session(), std::move(spill)};
     for (auto&& slice : input) {
       if (slice.rows() == 0) {
         co_yield {};
@@ -1128,12 +1530,147 @@ public:
     }
   }
 
+  /// Distributes the input across worker threads that each aggregate their
+  /// share independently, and merges the partial results at the end.
+  auto parallel(generator<table_slice> input,
+                operator_control_plane& ctrl) const -> generator<table_slice> {
+    struct worker {
+      worker(const config& cfg, shared_diagnostic_handler dh)
+        : dh{std::move(dh)},
+          provider{session_provider::make(this->dh)},
+          impl{cfg, provider.as_session()} {
+      }
+
+      shared_diagnostic_handler dh;
+      session_provider provider;
+      implementation2 impl;
+      std::exception_ptr error = {};
+    };
+    // All workers take their input from the same queue. An empty slice tells
+    // the workers to stop.
+    auto inputs = std::deque<table_slice>{};
+    auto inputs_mutex = std::mutex{};
+    auto inputs_cv = std::condition_variable{};
+    auto workers = std::vector<std::unique_ptr<worker>>{};
+    for (auto i = uint64_t{0}; i < cfg_.jobs; ++i) {
+      workers.push_back(
+        std::make_unique<worker>(cfg_, ctrl.shared_diagnostics()));
+    }
+    auto work = [&](worker& state) {
+      caf::detail::set_thread_name("summarize_work");
+      while (true) {
+        auto inputs_lock = std::unique_lock{inputs_mutex};
+        inputs_cv.wait(inputs_lock, [&] {
+          return not inputs.empty();
+        });
+        if (inputs.front().rows() == 0) {
+          // We intentionally don't pop the sentinel so that the other
+          // workers can also see it.
+          return;
+        }
+        auto slice = std::move(inputs.front());
+        inputs.pop_front();
+        inputs_lock.unlock();
+        // Once a worker failed, it only drains its share of the input.
+        if (state.error) {
+          continue;
+        }
+        try {
+          state.impl.add(slice);
+        } catch (...) {
+          state.error = std::current_exception();
+        }
+      }
+    };
+    auto threads = std::vector<std::thread>{};
+    for (auto& state : workers) {
+      threads.emplace_back(work, std::ref(*state));
+    }
+    auto stop = [&](bool discard) {
+      {
+        auto inputs_lock = std::unique_lock{inputs_mutex};
+        if (discard) {
+          inputs.clear();
+        }
+        inputs.emplace_back();
+      }
+      inputs_cv.notify_all();
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    };
+    // With the current execution model, the generator can be destroyed at any
+    // yield. Because we are running threads, we need to protect against that.
+    auto guard = detail::scope_guard{[&]() noexcept {
+      stop(true);
+    }};
+    for (auto&& slice : input) {
+      if (slice.rows() == 0) {
+        co_yield {};
+        continue;
+      }
+      auto inputs_lock = std::unique_lock{inputs_mutex};
+      // Provide backpressure if the workers cannot keep up.
+      while (inputs.size() > 2 * cfg_.jobs) {
+        inputs_lock.unlock();
+        co_yield {};
+        inputs_lock.lock();
+      }
+      inputs.push_back(std::move(slice));
+      inputs_lock.unlock();
+      inputs_cv.notify_one();
+    }
+    // No yield may happen between disabling the guard and joining the threads.
+    guard.disable();
+    stop(false);
+    for (auto& state : workers) {
+      if (state->error) {
+        std::rethrow_exception(state->error);
+      }
+    }
+    auto& result = workers.front()->impl;
+    for (auto& state : workers | std::views::drop(1)) {
+      result.merge(state->impl);
+    }
+    for (auto slice : result.finish()) {
+      co_yield std::move(slice);
+    }
+  }
+
   auto optimize(expression const& filter, event_order order) const
     -> optimize_result override {
     (void)filter, (void)order;
     return optimize_result{std::nullopt, event_order::unordered, copy()};
   }
 
+  auto input_fields(const std::optional<std::vector<std::string>>& fields) const
+    -> std::optional<std::vector<std::string>> override {
+    // The output consists only of groups and aggregates, so the fields that
+    // subsequent operators read do not matter.
+    TENZIR_UNUSED(fields);
+    auto exprs = std::vector<const ast::expression*>{};
+    for (const auto& group : cfg_.groups) {
+      exprs.push_back(&group.expr.inner());
+    }
+    for (const auto& aggr : cfg_.aggregates) {
+      for (const auto& arg : aggr.call.args) {
+        exprs.push_back(&arg);
+      }
+    }
+    auto result = std::vector<std::string>{};
+    for (const auto* expr : exprs) {
+      auto expr_fields = expr->root_fields();
+      if (not expr_fields) {
+        return std::nullopt;
+      }
+      result.insert(result.end(), expr_fields->begin(), expr_fields->end());
+    }
+    std::ranges::sort(result);
+    const auto [first, last] = std::ranges::unique(result);
+    result.erase(first, last);
+    return result;
+  }
+
   friend auto inspect(auto& f, summarize_operator2& x) -> bool {
     return f.apply(x.cfg_);
   }
@@ -1142,79 +1679,120 @@ private:
   config cfg_;
 };
 
+/// Creates the configuration of `summarize` from the arguments of the
+/// operator.
+auto make_config(std::vector<ast::expression> args, session ctx) -> config {
+  auto cfg = config{};
+  auto add_aggregate = [&](std::optional<ast::simple_selector> dest,
+                           ast::function_call call) {
+    // TODO: Improve this and try to forward function handle directly.
+    auto fn = dynamic_cast<const aggregation_plugin*>(&ctx.reg().get(call));
+    if (not fn) {
+      diagnostic::error("function does not support aggregations")
+        .primary(call.fn)
+        .hint("if you want to group by this, use assignment before")
+        .docs("https://docs.tenzir.com/operators/summarize")
+        .emit(ctx);
+      return;
+    }
+    // We test the arguments by making and discarding it. This is a bit
+    // hacky and should be improved in the future.
+    if (fn->make_aggregation(aggregation_plugin::invocation{call}, ctx)) {
+      auto index = detail::narrow<int64_t>(cfg.aggregates.size());
+      cfg.indices.push_back(index);
+      cfg.aggregates.emplace_back(std::move(dest), std::move(call));
+    }
+  };
+  auto add_group = [&](std::optional<ast::simple_selector> dest,
+                       ast::simple_selector expr) {
+    auto index = -detail::narrow<int64_t>(cfg.groups.size()) - 1;
+    cfg.indices.push_back(index);
+    cfg.groups.emplace_back(std::move(dest), std::move(expr));
+  };
+  for (auto& arg : args) {
+    arg.match(
+      [&](ast::function_call& arg) {
+        add_aggregate(std::nullopt, std::move(arg));
+      },
+      [&](ast::assignment& arg) {
+        auto left = std::get_if<ast::simple_selector>(&arg.left);
+        if (not left) {
+          // TODO
+          diagnostic::error("expected data selector, not meta")
+            .primary(arg.left)
+            .emit(ctx);
+          return;
+        }
+        arg.right.match(
+          [&](ast::function_call& right) {
+            add_aggregate(std::move(*left), std::move(right));
+          },
+          [&](auto&) {
+            auto right = ast::simple_selector::try_from(arg.right);
+            if (right) {
+              add_group(std::move(*left), std::move(*right));
+            } else {
+              diagnostic::error(
+                "expected selector or aggregation function call")
+                .primary(arg.right)
+                .emit(ctx);
+            }
+          });
+      },
+      [&](auto&) {
+        auto selector = ast::simple_selector::try_from(arg);
+        if (selector) {
+          add_group(std::nullopt, std::move(*selector));
+        } else {
+          diagnostic::error(
+            "expected selector, assignment or aggregation function call")
+            .primary(arg)
+            .emit(ctx);
+        }
+      });
+  }
+  return cfg;
+}
+
 class plugin2 final : public operator_plugin2<summarize_operator2> {
 public:
   auto make(invocation inv, session ctx) const
     -> failure_or<operator_ptr> override {
-    auto cfg = config{};
-    auto add_aggregate = [&](std::optional<ast::simple_selector> dest,
-                             ast::function_call call) {
-      // TODO: Improve this and try to forward function handle directly.
-      auto fn = dynamic_cast<const aggregation_plugin*>(&ctx.reg().get(call));
-      if (not fn) {
-        diagnostic::error("function does not support aggregations")
-          .primary(call.fn)
-          .hint("if you want to group by this, use assignment before")
-          .docs("https://docs.tenzir.com/operators/summarize")
-          .emit(ctx);
-        return;
-      }
-      // We test the arguments by making and discarding it. This is a bit
-      // hacky and should be improved in the future.
-      if (fn->make_aggregation(aggregation_plugin::invocation{call}, ctx)) {
-        auto index = detail::narrow<int64_t>(cfg.aggregates.size());
-        cfg.indices.push_back(index);
-        cfg.aggregates.emplace_back(std::move(dest), std::move(call));
-      }
-    };
-    auto add_group = [&](std::optional<ast::simple_selector> dest,
-                         ast::simple_selector expr) {
-      auto index = -detail::narrow<int64_t>(cfg.groups.size()) - 1;
-      cfg.indices.push_back(index);
-      cfg.groups.emplace_back(std::move(dest), std::move(expr));
-    };
-    for (auto& arg : inv.args) {
-      arg.match(
-        [&](ast::function_call& arg) {
-          add_aggregate(std::nullopt, std::move(arg));
-        },
-        [&](ast::assignment& arg) {
-          auto left = std::get_if<ast::simple_selector>(&arg.left);
-          if (not left) {
-            // TODO
-            diagnostic::error("expected data selector, not meta")
-              .primary(arg.left)
-              .emit(ctx);
-            return;
-          }
-          arg.right.match(
-            [&](ast::function_call& right) {
-              add_aggregate(std::move(*left), std::move(right));
-            },
-            [&](auto&) {
-              auto right = ast::simple_selector::try_from(arg.right);
-              if (right) {
-                add_group(std::move(*left), std::move(*right));
-              } else {
-                diagnostic::error(
-                  "expected selector or aggregation function call")
-                  .primary(arg.right)
-                  .emit(ctx);
-              }
-            });
-        },
-        [&](auto&) {
-          auto selector = ast::simple_selector::try_from(arg);
-          if (selector) {
-            add_group(std::nullopt, std::move(*selector));
-          } else {
-            diagnostic::error(
-              "expected selector, assignment or aggregation function call")
-              .primary(arg)
-              .emit(ctx);
-          }
-        });
+    return std::make_unique<summarize_operator2>(
+      make_config(std::move(inv.args), ctx));
+  }
+};
+
+/// The `_summarize_parallel <jobs>, ...` operator is `summarize` with the
+/// given number of worker threads, which aggregate disjoint parts of the input
+/// whose results are merged at the end. It is hidden until parallel
+/// aggregation has seen more testing.
+class parallel_plugin2 final : public virtual operator_factory_plugin {
+public:
+  auto name() const -> std::string override {
+    return "_summarize_parallel";
+  }
+
+  auto make(invocation inv, session ctx) const
+    -> failure_or<operator_ptr> override {
+    if (inv.args.empty()) {
+      diagnostic::error("expected the number of jobs")
+        .primary(inv.self)
+        .usage("_summarize_parallel <jobs>, (<group>|<aggregation>)...")
+        .emit(ctx);
+      return failure::promise();
+    }
+    TRY(auto value, const_eval(inv.args.front(), ctx));
+    const auto* jobs = try_as<int64_t>(&value);
+    if (not jobs or *jobs <= 0) {
+      diagnostic::error("the number of jobs must be a positive integer")
+        .primary(inv.args.front())
+        .emit(ctx);
+      return failure::promise();
     }
+    inv.args.erase(inv.args.begin());
+    auto cfg = make_config(std::move(inv.args), ctx);
+    cfg.jobs = detail::narrow<uint64_t>(*jobs);
     return std::make_unique<summarize_operator2>(std::move(cfg));
   }
 };
@@ -1225,3 +1803,4 @@ public:
 
 TENZIR_REGISTER_PLUGIN(tenzir::plugins::summarize::plugin)
 TENZIR_REGISTER_PLUGIN(tenzir::plugins::summarize::plugin2)
+TENZIR_REGISTER_PLUGIN(tenzir::plugins::summarize::parallel_plugin2)
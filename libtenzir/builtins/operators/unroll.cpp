@@ -213,6 +213,7 @@ public:
   auto
   operator()(generator<table_slice> input, operator_control_plane& ctrl) const
     -> generator<table_slice> {
+    auto resolver = selector_resolver{};
     const auto get_offset = field_.match<
       std::function<auto(const table_slice&)->std::optional<offset>>>(
       [&](const located<std::string>& field) {
@@ -252,7 +253,7 @@ public:
       },
       [&](const ast::simple_selector& field) {
         return [&](const table_slice& slice) {
-          return resolve(field, slice.schema())
+          return resolver.resolve(field, slice.schema())
             .match(
               [&](offset result) -> std::optional<offset> {
                 if (result.empty()) {
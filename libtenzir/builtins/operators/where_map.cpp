@@ -16,6 +16,7 @@
 #include <tenzir/concept/parseable/tenzir/pipeline.hpp>
 #include <tenzir/concept/parseable/to.hpp>
 #include <tenzir/detail/debug_writer.hpp>
+#include <tenzir/detail/narrow.hpp>
 #include <tenzir/diagnostics.hpp>
 #include <tenzir/error.hpp>
 #include <tenzir/exec.hpp>
@@ -39,9 +40,14 @@
 
 #include <arrow/compute/api.h>
 #include <arrow/type.h>
+#include <arrow/util/bit_run_reader.h>
+#include <arrow/util/bitmap_ops.h>
 #include <arrow/util/bitmap_writer.h>
 #include <caf/expected.hpp>
 
+#include <algorithm>
+#include <span>
+
 namespace tenzir::plugins::where {
 
 namespace {
@@ -145,6 +151,198 @@ public:
   }
 };
 
+/// A range `[begin, end)` of rows.
+using row_range = std::pair<int64_t, int64_t>;
+
+/// The number of ranges up to which we evaluate a predicate range by range
+/// instead of copying the selected rows first.
+constexpr auto max_lazy_ranges = size_t{16};
+
+/// Evaluates a predicate for a range of rows that starts at `offset`, and
+/// appends the ranges of rows for which it holds to `selection`.
+auto select_rows(compiled_expression& expr, const table_slice& slice,
+                 int64_t offset, std::vector<row_range>& selection, bool warn,
+                 bool& warned, diagnostic_handler& dh) -> void {
+  const auto append = [&](int64_t begin, int64_t end) {
+    if (not selection.empty() and selection.back().second == begin) {
+      selection.back().second = end;
+      return;
+    }
+    selection.emplace_back(begin, end);
+  };
+  for (auto& filter : expr.eval(slice)) {
+    const auto length = filter.array->length();
+    auto array = try_as<arrow::BooleanArray>(&*filter.array);
+    if (not array) {
+      diagnostic::warning("expected `bool`, got `{}`", filter.type.kind())
+        .primary(expr.expr())
+        .emit(dh);
+      offset += length;
+      continue;
+    }
+    if (array->true_count() == length) {
+      append(offset, offset + length);
+      offset += length;
+      continue;
+    }
+    if (not warned) {
+      if (array->null_count() > 0) {
+        diagnostic::warning("expected `bool`, got `null`")
+          .primary(expr.expr())
+          .emit(dh);
+      }
+      if (warn) {
+        diagnostic::warning("assertion failure").primary(expr.expr()).emit(dh);
+      }
+      warned = array->null_count() > 0 or warn;
+    }
+    // We keep the rows where the predicate is both valid and true, and find
+    // the runs of such rows a word at a time instead of row by row.
+    const auto* selected = array->values()->data();
+    auto selected_offset = array->offset();
+    auto storage = std::shared_ptr<arrow::Buffer>{};
+    if (array->null_count() > 0) {
+      storage = check(arrow::internal::BitmapAnd(
+        arrow::default_memory_pool(), selected, selected_offset,
+        array->null_bitmap_data(), array->offset(), length, 0));
+      selected = storage->data();
+      selected_offset = 0;
+    }
+    auto runs
+      = arrow::internal::SetBitRunReader{selected, selected_offset, length};
+    for (auto run = runs.NextRun(); run.length > 0; run = runs.NextRun()) {
+      append(offset + run.position, offset + run.position + run.length);
+    }
+    offset += length;
+  }
+}
+
+/// Returns the selected rows of a slice.
+auto materialize(const table_slice& slice,
+                 const std::vector<row_range>& selection) -> table_slice {
+  if (selection.size() == 1 and selection[0].first == 0
+      and selection[0].second == detail::narrow<int64_t>(slice.rows())) {
+    return slice;
+  }
+  auto results = std::vector<table_slice>{};
+  results.reserve(selection.size());
+  for (const auto& [begin, end] : selection) {
+    results.push_back(subslice(slice, begin, end));
+  }
+  return concatenate(std::move(results));
+}
+
+/// Keeps the rows for which all predicates hold. The predicates are evaluated
+/// one after another, and every predicate only for the rows that passed the
+/// ones before.
+auto filter_rows(generator<table_slice> input, operator_control_plane& ctrl,
+                 std::vector<ast::expression> predicates, bool warn)
+  -> generator<table_slice> {
+  auto exprs = std::vector<compiled_expression>{};
+  exprs.reserve(predicates.size());
+  for (const auto& predicate : predicates) {
+    exprs.emplace_back(predicate, ctrl.diagnostics());
+  }
+  for (auto&& slice : input) {
+    if (slice.rows() == 0) {
+      co_yield {};
+      continue;
+    }
+    // The selection holds the ranges of rows of `current` that passed all
+    // predicates so far. Every predicate is evaluated only for the selected
+    // rows, and we copy the selected rows only if the selection gets too
+    // fragmented to evaluate the next predicate range by range, and at the
+    // very end.
+    auto current = slice;
+    auto selection = std::vector<row_range>{
+      {0, detail::narrow<int64_t>(slice.rows())},
+    };
+    for (auto& expr : exprs) {
+      if (selection.empty()) {
+        break;
+      }
+      if (selection.size() > max_lazy_ranges) {
+        current = materialize(current, selection);
+        selection = {{0, detail::narrow<int64_t>(current.rows())}};
+      }
+      auto next = std::vector<row_range>{};
+      auto warned = false;
+      for (const auto& [begin, end] : selection) {
+        select_rows(expr, subslice(current, begin, end), begin, next, warn,
+                    warned, ctrl.diagnostics());
+      }
+      selection = std::move(next);
+    }
+    co_yield materialize(current, selection);
+  }
+}
+
+/// Creates the operator that filters with the given predicates, or `nullptr`
+/// if there are none.
+auto make_filter_operator(std::vector<ast::expression> predicates)
+  -> operator_ptr;
+
+/// Fuses the predicates of a `where` with a subsequent `where`, or returns
+/// `nullptr` if `next` is not one.
+auto fuse_filter_operator(std::vector<ast::expression> predicates,
+                          const operator_base& next) -> operator_ptr;
+
+/// Pushes the parts of the predicates that legacy expressions can express
+/// upstream.
+auto optimize_predicates(std::span<const ast::expression> predicates,
+                         expression const& filter, event_order order)
+  -> optimize_result {
+  auto legacy = conjunction{};
+  auto remainder = std::vector<ast::expression>{};
+  for (const auto& predicate : predicates) {
+    auto [predicate_legacy, predicate_remainder]
+      = split_legacy_expression(predicate);
+    if (predicate_legacy != trivially_true_expression()) {
+      legacy.push_back(std::move(predicate_legacy));
+    }
+    if (not is_true_literal(predicate_remainder)) {
+      remainder.push_back(std::move(predicate_remainder));
+    }
+  }
+  auto remainder_op = make_filter_operator(std::move(remainder));
+  if (filter != trivially_true_expression()) {
+    legacy.push_back(filter);
+  }
+  if (legacy.empty()) {
+    return optimize_result{trivially_true_expression(), order,
+                           std::move(remainder_op)};
+  }
+  if (legacy.size() == 1) {
+    return optimize_result{std::move(legacy[0]), order,
+                           std::move(remainder_op)};
+  }
+  auto combined = normalize_and_validate(std::move(legacy));
+  TENZIR_ASSERT(combined);
+  return optimize_result{std::move(*combined), order, std::move(remainder_op)};
+}
+
+/// Returns the fields that filtering with the given predicates reads.
+auto predicate_input_fields(std::span<const ast::expression> predicates,
+                            const std::optional<std::vector<std::string>>& fields)
+  -> std::optional<std::vector<std::string>> {
+  if (not fields) {
+    return std::nullopt;
+  }
+  auto result = *fields;
+  for (const auto& predicate : predicates) {
+    auto predicate_fields = predicate.root_fields();
+    if (not predicate_fields) {
+      return std::nullopt;
+    }
+    result.insert(result.end(), predicate_fields->begin(),
+                  predicate_fields->end());
+  }
+  std::ranges::sort(result);
+  const auto [first, last] = std::ranges::unique(result);
+  result.erase(first, last);
+  return result;
+}
+
 class where_assert_operator final
   : public crtp_operator<where_assert_operator> {
 public:
@@ -161,59 +359,7 @@ public:
   auto
   operator()(generator<table_slice> input, operator_control_plane& ctrl) const
     -> generator<table_slice> {
-    // TODO: This might be quite inefficient compared to what we could do.
-    for (auto&& slice : input) {
-      if (slice.rows() == 0) {
-        co_yield {};
-        continue;
-      }
-      auto offset = int64_t{0};
-      for (auto& filter : eval(expr_, slice, ctrl.diagnostics())) {
-        auto array = try_as<arrow::BooleanArray>(&*filter.array);
-        if (not array) {
-          diagnostic::warning("expected `bool`, got `{}`", filter.type.kind())
-            .primary(expr_)
-            .emit(ctrl.diagnostics());
-          offset += filter.array->length();
-          co_yield {};
-          continue;
-        }
-        if (array->true_count() == array->length()) {
-          co_yield subslice(slice, offset, offset + array->length());
-          offset += array->length();
-          continue;
-        }
-        if (array->null_count() > 0) {
-          diagnostic::warning("expected `bool`, got `null`")
-            .primary(expr_)
-            .emit(ctrl.diagnostics());
-        }
-        if (warn_) {
-          diagnostic::warning("assertion failure")
-            .primary(expr_)
-            .emit(ctrl.diagnostics());
-        }
-        auto length = array->length();
-        auto current_value = array->Value(0);
-        auto current_begin = int64_t{0};
-        // We add an artificial `false` at index `length` to flush.
-        auto results = std::vector<table_slice>{};
-        for (auto i = int64_t{1}; i < length + 1; ++i) {
-          const auto next = i != length && array->IsValid(i) && array->Value(i);
-          if (current_value == next) {
-            continue;
-          }
-          if (current_value) {
-            results.push_back(
-              subslice(slice, offset + current_begin, offset + i));
-          }
-          current_value = next;
-          current_begin = i;
-        }
-        co_yield concatenate(std::move(results));
-        offset += length;
-      }
-    }
+    return filter_rows(std::move(input), ctrl, {expr_}, warn_);
   }
 
   auto optimize(expression const& filter, event_order order) const
@@ -221,19 +367,20 @@ public:
     if (warn_) {
       return optimize_result::order_invariant(*this, order);
     }
-    auto [legacy, remainder] = split_legacy_expression(expr_);
-    auto remainder_op = is_true_literal(remainder)
-                          ? nullptr
-                          : std::make_unique<where_assert_operator>(
-                              std::move(remainder), warn_);
-    if (filter == trivially_true_expression()) {
-      return optimize_result{std::move(legacy), order, std::move(remainder_op)};
+    return optimize_predicates({&expr_, 1}, filter, order);
+  }
+
+  auto fuse(const operator_base& next) const -> operator_ptr override {
+    // `assert` must keep blocking filter pushdown past itself.
+    if (warn_) {
+      return nullptr;
     }
-    auto combined
-      = normalize_and_validate(conjunction{std::move(legacy), filter});
-    TENZIR_ASSERT(combined);
-    return optimize_result{std::move(*combined), order,
-                           std::move(remainder_op)};
+    return fuse_filter_operator({expr_}, next);
+  }
+
+  auto input_fields(const std::optional<std::vector<std::string>>& fields) const
+    -> std::optional<std::vector<std::string>> override {
+    return predicate_input_fields({&expr_, 1}, fields);
   }
 
   friend auto inspect(auto& f, where_assert_operator& x) -> bool {
@@ -242,10 +389,90 @@ public:
   }
 
 private:
+  friend auto fuse_filter_operator(std::vector<ast::expression> predicates,
+                                   const operator_base& next) -> operator_ptr;
+
   ast::expression expr_;
   bool warn_;
 };
 
+/// Consecutive `where` operators become a single one, which evaluates its
+/// predicates one after another and copies the selected rows only once. This
+/// is a separate operator, so that the serialization of `where` does not
+/// change.
+class fused_where_operator final
+  : public crtp_operator<fused_where_operator> {
+public:
+  fused_where_operator() = default;
+
+  explicit fused_where_operator(std::vector<ast::expression> exprs)
+    : exprs_{std::move(exprs)} {
+  }
+
+  auto name() const -> std::string override {
+    return "fused_where_operator";
+  }
+
+  auto
+  operator()(generator<table_slice> input, operator_control_plane& ctrl) const
+    -> generator<table_slice> {
+    return filter_rows(std::move(input), ctrl, exprs_, false);
+  }
+
+  auto optimize(expression const& filter, event_order order) const
+    -> optimize_result override {
+    return optimize_predicates(exprs_, filter, order);
+  }
+
+  auto fuse(const operator_base& next) const -> operator_ptr override {
+    return fuse_filter_operator(exprs_, next);
+  }
+
+  auto input_fields(const std::optional<std::vector<std::string>>& fields) const
+    -> std::optional<std::vector<std::string>> override {
+    return predicate_input_fields(exprs_, fields);
+  }
+
+  friend auto inspect(auto& f, fused_where_operator& x) -> bool {
+    return f.object(x).fields(f.field("expressions", x.exprs_));
+  }
+
+private:
+  friend auto fuse_filter_operator(std::vector<ast::expression> predicates,
+                                   const operator_base& next) -> operator_ptr;
+
+  std::vector<ast::expression> exprs_;
+};
+
+auto make_filter_operator(std::vector<ast::expression> predicates)
+  -> operator_ptr {
+  if (predicates.empty()) {
+    return nullptr;
+  }
+  if (predicates.size() == 1) {
+    return std::make_unique<where_assert_operator>(std::move(predicates[0]),
+                                                   false);
+  }
+  return std::make_unique<fused_where_operator>(std::move(predicates));
+}
+
+auto fuse_filter_operator(std::vector<ast::expression> predicates,
+                          const operator_base& next) -> operator_ptr {
+  if (const auto* other = dynamic_cast<const where_assert_operator*>(&next)) {
+    if (other->warn_) {
+      return nullptr;
+    }
+    predicates.push_back(other->expr_);
+  } else if (const auto* other
+             = dynamic_cast<const fused_where_operator*>(&next)) {
+    predicates.insert(predicates.end(), other->exprs_.begin(),
+                      other->exprs_.end());
+  } else {
+    return nullptr;
+  }
+  return make_filter_operator(std::move(predicates));
+}
+
 struct arguments {
   ast::expression field;
   ast::simple_selector capture;
@@ -670,6 +897,7 @@ auto make_map_function(function_plugin::invocation inv, session ctx)
 }
 
 using where_assert_plugin = operator_inspection_plugin<where_assert_operator>;
+using fused_where_plugin = operator_inspection_plugin<fused_where_operator>;
 
 class assert_plugin final : public virtual operator_factory_plugin {
 public:
@@ -823,4 +1051,5 @@ TENZIR_REGISTER_PLUGIN(tenzir::plugins::where::tql1_plugin)
 TENZIR_REGISTER_PLUGIN(tenzir::plugins::where::assert_plugin)
 TENZIR_REGISTER_PLUGIN(tenzir::plugins::where::where_plugin)
 TENZIR_REGISTER_PLUGIN(tenzir::plugins::where::where_assert_plugin)
+TENZIR_REGISTER_PLUGIN(tenzir::plugins::where::fused_where_plugin)
 TENZIR_REGISTER_PLUGIN(tenzir::plugins::where::map_plugin)
@@ -22,6 +22,7 @@
 #include "tenzir/query_context.hpp"
 #include "tenzir/type.hpp"
 #include "tenzir/uuid.hpp"
+#include "tenzir/value_index.hpp"
 
 #include <caf/typed_event_based_actor.hpp>
 
@@ -40,6 +41,19 @@ struct active_partition_state {
 
   // -- member types -----------------------------------------------------------
 
+  /// A secondary value index for a single field of the partition.
+  struct indexed_field {
+    /// The key of the field relative to the partition schema, e.g.,
+    /// "id.orig_h" for the field "zeek.conn.id.orig_h".
+    std::string name = {};
+
+    /// The flat index of the field in the partition schema.
+    size_t column = {};
+
+    /// The index over the values of the field.
+    value_index index = {};
+  };
+
   /// Contains all the data necessary to create a partition flatbuffer.
   struct serialization_data {
     /// Uniquely identifies this partition.
@@ -67,6 +81,9 @@ struct active_partition_state {
     /// sent back to the partition after persisting to minimize memory footprint
     /// of the catalog.
     partition_synopsis_ptr synopsis = {};
+
+    /// Secondary value indexes for the fields that are configured for them.
+    std::vector<indexed_field> value_indexes = {};
   };
 
   // -- inbound path -----------------------------------------------------------
@@ -199,6 +199,9 @@ using index_actor = typed_actor_fwd<
   auto(atom::resolve, expression)->caf::result<catalog_lookup_result>,
   // Queries PARTITION actors for a given query id.
   auto(atom::query, uuid, uint32_t)->caf::result<void>,
+  // Returns a persisted PARTITION from the shared partition cache, loading it
+  // from disk if needed.
+  auto(atom::load, uuid)->caf::result<partition_actor>,
   // Erases the given partition from the INDEX.
   auto(atom::erase, uuid)->caf::result<atom::done>,
   // Erases the given set of partitions from the INDEX.
@@ -0,0 +1,66 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "tenzir/fwd.hpp"
+
+#include "tenzir/synopsis.hpp"
+
+#include <span>
+#include <vector>
+
+namespace tenzir {
+
+/// Statistics about a leaf column of a record batch.
+struct column_statistics {
+  /// The number of null values.
+  uint64_t null_count = {};
+
+  /// A synopsis of all other values, e.g., their minimum and maximum or a
+  /// Bloom filter, or `nullptr` if the type of the column has none.
+  synopsis_ptr synopsis = {};
+
+  friend auto inspect(auto& f, column_statistics& x) -> bool {
+    return f.object(x).fields(f.field("null-count", x.null_count),
+                              f.field("synopsis", x.synopsis));
+  }
+};
+
+/// Statistics about a record batch, which allow for skipping it if a query
+/// cannot match any of its rows.
+struct batch_statistics {
+  uint64_t rows = {};
+  time import_time = {};
+
+  /// The statistics for every leaf column, in order of their flat index.
+  std::vector<column_statistics> columns = {};
+
+  friend auto inspect(auto& f, batch_statistics& x) -> bool {
+    return f.object(x).fields(f.field("rows", x.rows),
+                              f.field("import-time", x.import_time),
+                              f.field("columns", x.columns));
+  }
+};
+
+/// Computes the statistics of a table slice.
+auto make_batch_statistics(const table_slice& slice) -> batch_statistics;
+
+/// Checks whether an expression tailored to the schema of a record batch may
+/// hold for any of its rows.
+auto may_match(const expression& expr, const batch_statistics& stats) -> bool;
+
+/// Returns the indices of all record batches whose statistics do not rule out
+/// that `expr` matches some of their rows, and that contain at least one of
+/// the ids in `selection` unless it is empty. The record batches must be
+/// consecutive, starting at id 0.
+auto select_batches(const expression& expr, const ids& selection,
+                    std::span<const batch_statistics> statistics)
+  -> std::vector<int>;
+
+} // namespace tenzir
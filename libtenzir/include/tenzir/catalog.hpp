@@ -16,12 +16,15 @@
 #include "tenzir/detail/inspection_common.hpp"
 #include "tenzir/expression.hpp"
 #include "tenzir/partition_synopsis.hpp"
+#include "tenzir/synopsis_columns.hpp"
 #include "tenzir/taxonomies.hpp"
 #include "tenzir/uuid.hpp"
 
 #include <caf/settings.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace tenzir {
@@ -55,6 +58,49 @@ struct catalog_lookup_result {
   }
 };
 
+/// An immutable snapshot of the partition synopses known to the catalog.
+/// Lookups operate on snapshots, which allows them to run concurrently with
+/// each other and with updates to the catalog. Updates replace the snapshot
+/// instead of modifying it, copying only the maps they change.
+struct catalog_snapshot {
+  using synopsis_map = detail::flat_map<uuid, partition_synopsis_ptr>;
+
+  /// Retrieves the list of candidate partition IDs for a given expression.
+  /// @param expr The expression to lookup.
+  /// @returns A lookup result of candidate partitions categorized by type.
+  auto lookup(expression expr) const -> caf::expected<catalog_lookup_result>;
+
+  /// Retrieves the candidate partitions for a subset of the schemas.
+  /// @param normalized The normalized and validated expression to lookup.
+  /// @param schemas The schemas to consider.
+  /// @returns A lookup result of candidate partitions categorized by type.
+  auto lookup(const expression& normalized, std::span<const type> schemas) const
+    -> caf::expected<catalog_lookup_result>;
+
+  auto lookup_impl(const expression& expr, const type& schema) const
+    -> catalog_lookup_result::candidate_info;
+
+  /// For each type, maps a partition ID to the synopses for that partition.
+  // We mainly iterate over the whole map and return a sorted set, for which
+  // the `flat_map` proves to be much faster than `std::{unordered_,}set`.
+  // See also ae9dbed.
+  std::unordered_map<tenzir::type, std::shared_ptr<const synopsis_map>>
+    synopses_per_type = {};
+
+  /// For each type, the columnar representation of the synopses in
+  /// `synopses_per_type`, which the lookup scans instead of visiting every
+  /// partition synopsis.
+  std::unordered_map<tenzir::type, std::shared_ptr<const synopsis_columns>>
+    columns_per_type = {};
+
+  /// The set of fields that should not be touched by the pruner.
+  std::shared_ptr<const detail::heterogeneous_string_hashset> unprunable_fields
+    = std::make_shared<detail::heterogeneous_string_hashset>();
+
+  std::shared_ptr<const tenzir::taxonomies> taxonomies
+    = std::make_shared<tenzir::taxonomies>();
+};
+
 /// The state of the CATALOG actor.
 struct catalog_state {
 public:
@@ -71,41 +117,29 @@ public:
   auto merge(std::vector<partition_synopsis_pair> partitions)
     -> caf::result<atom::ok>;
 
-  /// Erase this partition from the catalog.
-  void erase(const uuid& partition);
+  /// Erase these partitions from the catalog.
+  void erase(const std::vector<uuid>& partitions);
 
   /// Retrieves the list of candidate partition IDs for a given expression.
+  /// The lookup is spread over short-lived worker actors that each handle a
+  /// subset of the schemas, so that it neither blocks the catalog nor other
+  /// lookups.
   /// @param expr The expression to lookup.
   /// @returns A lookup result of candidate partitions categorized by type.
-  auto lookup(expression expr) const -> caf::expected<catalog_lookup_result>;
-
-  auto lookup_impl(const expression& expr, const type& schema) const
-    -> catalog_lookup_result::candidate_info;
+  auto lookup(expression expr) -> caf::result<catalog_lookup_result>;
 
   /// @returns A best-effort estimate of the amount of memory used for this
   /// catalog (in bytes).
   auto memusage() const -> size_t;
 
-  /// Update the list of fields that should not be touched by the pruner.
-  void update_unprunable_fields(const partition_synopsis& ps);
-
   // -- data members -----------------------------------------------------------
 
   /// A pointer to the parent actor.
   catalog_actor::pointer self = {};
 
-  /// For each type, maps a partition ID to the synopses for that partition.
-  // We mainly iterate over the whole map and return a sorted set, for which
-  // the `flat_map` proves to be much faster than `std::{unordered_,}set`.
-  // See also ae9dbed.
-  std::unordered_map<tenzir::type,
-                     detail::flat_map<uuid, partition_synopsis_ptr>>
-    synopses_per_type = {};
-
-  /// The set of fields that should not be touched by the pruner.
-  detail::heterogeneous_string_hashset unprunable_fields;
-
-  tenzir::taxonomies taxonomies = {};
+  /// The current snapshot of the catalog.
+  std::shared_ptr<const catalog_snapshot> snapshot
+    = std::make_shared<catalog_snapshot>();
 };
 
 /// The CATALOG is the first index actor that queries hit. The result
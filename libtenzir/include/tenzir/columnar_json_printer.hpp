@@ -0,0 +1,64 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "tenzir/fwd.hpp"
+
+#include "tenzir/concept/printable/tenzir/json_printer_options.hpp"
+#include "tenzir/type.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tenzir {
+
+/// A JSON printer for the table slices of a single schema. Where
+/// `json_printer` visits every value through a variant of views, this printer
+/// precomputes the escaped field names along with the separators and
+/// indentation surrounding them once per schema, and then reads the values
+/// directly from the typed Arrow arrays of a batch.
+///
+/// The output is identical to that of `json_printer` with the same options.
+class columnar_json_printer {
+public:
+  /// Returns whether the printer supports the given options. Colored output,
+  /// TQL syntax, trailing commas, and omitting values require `json_printer`.
+  static auto supports(const json_printer_options& options) -> bool;
+
+  /// Creates a printer for slices of the given schema.
+  /// @pre `supports(options)`
+  columnar_json_printer(const type& schema, json_printer_options options);
+
+  /// Appends one JSON object per row of the slice to `out`, separating
+  /// consecutive rows with `separator`.
+  /// @pre `slice.schema()` is the schema of the printer and its enumerations
+  /// are resolved.
+  auto print(const table_slice& slice, std::string_view separator,
+             std::vector<char>& out) const -> void;
+
+  /// The literal text that surrounds the values of a field. For records, the
+  /// prefixes contain one entry per field, consisting of the separator, the
+  /// indentation, and the escaped field name. For lists, they contain the text
+  /// preceding the first and the subsequent elements.
+  struct layout {
+    std::vector<std::string> prefixes = {};
+    std::string suffix = {};
+    std::vector<layout> children = {};
+  };
+
+private:
+  auto make_layout(const type& t, size_t depth) const -> layout;
+
+  type schema_ = {};
+  json_printer_options options_ = {};
+  layout layout_ = {};
+};
+
+} // namespace tenzir
@@ -226,8 +226,8 @@ inline constexpr caf::timespan active_partition_timeout
 /// Timeout after which a new automatic rebuild is triggered.
 inline constexpr caf::timespan rebuild_interval = std::chrono::minutes{120};
 
-/// Maximum number of in-memory INDEX partitions.
-inline constexpr size_t max_in_mem_partitions = 1;
+/// Maximum combined size of in-memory INDEX partitions in bytes.
+inline constexpr size_t partition_cache_size = 1'073'741'824; // 1 Gi
 
 /// Number of immediately scheduled INDEX partitions.
 inline constexpr size_t taste_partitions = 5;
@@ -271,6 +271,16 @@ inline constexpr double fp_rate = 0.01;
 /// Flag that enables creation of partition indexes in the database.
 inline constexpr bool create_partition_index = true;
 
+/// Flag that enables creation of secondary value indexes in partitions.
+inline constexpr bool create_value_index = false;
+
+/// The bin width of partition indexes for time and duration fields.
+inline constexpr duration value_index_resolution = std::chrono::seconds{1};
+
+/// The interval in which the index consolidates the synopses of new partitions
+/// into the catalog snapshot.
+inline constexpr auto catalog_snapshot_interval = std::chrono::minutes{10};
+
 /// Time to wait before trying to make another connection attempt to a remote
 /// Tenzir node.
 inline constexpr auto node_connection_retry_delay = std::chrono::seconds{3u};
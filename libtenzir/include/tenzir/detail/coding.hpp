@@ -10,6 +10,7 @@
 
 #include "tenzir/detail/type_traits.hpp"
 
+#include <array>
 #include <cstddef>
 #include <span>
 #include <string>
@@ -64,17 +65,41 @@ constexpr auto byte_to_hex(T x) -> std::pair<char, char> {
   }
 }
 
+/// Converts a byte range into hex characters by looking up both nibbles of a
+/// byte at once.
+/// @param xs The byte sequence to convert into hex characters.
+/// @param out The output buffer, which must have room for `2 * xs.size()`
+///            characters.
+/// @returns The end of the written characters.
+/// @relates byte_to_hex
+template <class Policy = policy::lowercase>
+auto hexify(std::span<const std::byte> xs, char* out) -> char* {
+  static constexpr auto table = [] {
+    auto result = std::array<char, 512>{};
+    for (auto i = size_t{0}; i < 256; ++i) {
+      auto [hi, lo] = byte_to_hex<Policy>(i);
+      result[2 * i] = hi;
+      result[2 * i + 1] = lo;
+    }
+    return result;
+  }();
+  for (auto x : xs) {
+    const auto* hex = &table[2 * static_cast<size_t>(x)];
+    *out++ = hex[0];
+    *out++ = hex[1];
+  }
+  return out;
+}
+
 /// Converts a byte range into a hex string.
 /// @param xs The byte sequence to convert into a hex string.
 /// @param result The string to append to.
 /// @relates byte_to_hex
 template <class Policy = policy::lowercase>
 void hexify(std::span<const std::byte> xs, std::string& result) {
-  for (auto x : xs) {
-    auto [hi, lo] = byte_to_hex<Policy>(x);
-    result += hi;
-    result += lo;
-  }
+  const auto size = result.size();
+  result.resize(size + 2 * xs.size());
+  hexify<Policy>(xs, result.data() + size);
 }
 
 /// Converts a byte range into a hex string.
@@ -26,6 +26,8 @@
 //  * Added member function `resize()`
 //  * Added member function `clear()`
 //  * Added member function `eject()`
+//  * Entries have a weight, and the maximum size bounds the sum of all weights
+//  * Added hit, miss, and eviction counters
 
 #pragma once
 
@@ -37,7 +39,17 @@
 
 namespace tenzir::detail {
 
-template <typename Key, typename Value, typename Factory>
+/// Assigns every entry a weight of one, so that the maximum size of an LRU
+/// cache bounds the number of its entries.
+struct unit_weigher {
+  template <class Key, class Value>
+  size_t operator()(const Key&, const Value&) const {
+    return 1;
+  }
+};
+
+template <typename Key, typename Value, typename Factory,
+          typename Weigher = unit_weigher>
 class lru_cache {
 public:
   using key_value_pair = std::pair<Key, Value>;
@@ -45,26 +57,21 @@ public:
   using const_list_iterator =
     typename std::list<key_value_pair>::const_iterator;
 
-  lru_cache(size_t max_size, Factory factory)
-    : max_size_(max_size), factory_(std::move(factory)) {
+  lru_cache(size_t max_size, Factory factory, Weigher weigher = {})
+    : max_size_(max_size),
+      factory_(std::move(factory)),
+      weigher_(std::move(weigher)) {
   }
 
   void clear() {
     cache_items_map_.clear();
     cache_items_list_.clear();
+    weight_ = 0;
   }
 
   void resize(size_t max_size) {
-    // FIXME: write unit test for this
-    if (cache_items_list_.size() > max_size) {
-      auto new_end = std::next(cache_items_list_.begin(), max_size);
-      while (new_end != cache_items_list_.end()) {
-        cache_items_map_.erase(new_end->first);
-        auto position = new_end++;
-        cache_items_list_.erase(position);
-      }
-    }
     max_size_ = max_size;
+    evict(0);
   }
 
   list_iterator begin() {
@@ -83,39 +90,36 @@ public:
     return cache_items_list_.end();
   }
 
+  // Inserts or replaces an item. The inserted item itself is never evicted,
+  // even if its weight alone exceeds the maximum size.
   const Value& put(Key key, Value value) {
-    auto it = cache_items_map_.find(key);
-    cache_items_list_.push_front(
-      key_value_pair(std::move(key), std::move(value)));
-    if (it != cache_items_map_.end()) {
-      cache_items_list_.erase(it->second);
-      cache_items_map_.erase(it);
-    }
-    auto& result = cache_items_list_.begin()->second;
-    cache_items_map_[key] = cache_items_list_.begin();
-    if (cache_items_map_.size() > max_size_) {
-      auto last = cache_items_list_.end();
-      last--;
-      cache_items_map_.erase(last->first);
-      cache_items_list_.pop_back();
-    }
-    return result;
+    drop(key);
+    cache_items_list_.emplace_front(std::move(key), std::move(value));
+    auto& [k, v] = cache_items_list_.front();
+    const auto weight = weigher_(k, v);
+    cache_items_map_.emplace(k, entry{cache_items_list_.begin(), weight});
+    weight_ += weight;
+    evict(1);
+    return v;
   }
 
   const Value& get_or_load(const Key& key) {
     auto it = cache_items_map_.find(key);
     if (it != cache_items_map_.end()) {
+      ++hits_;
       cache_items_list_.splice(cache_items_list_.begin(), cache_items_list_,
-                               it->second);
-      return it->second->second;
+                               it->second.position);
+      return it->second.position->second;
     }
+    ++misses_;
     return put(key, factory_(key));
   }
 
   void drop(const Key& key) {
     auto it = cache_items_map_.find(key);
     if (it != cache_items_map_.end()) {
-      cache_items_list_.erase(it->second);
+      weight_ -= it->second.weight;
+      cache_items_list_.erase(it->second.position);
       cache_items_map_.erase(it);
     }
   }
@@ -126,7 +130,8 @@ public:
     auto it = cache_items_map_.find(key);
     if (it != cache_items_map_.end()) {
       std::list<key_value_pair> tmp;
-      tmp.splice(tmp.end(), cache_items_list_, it->second);
+      tmp.splice(tmp.end(), cache_items_list_, it->second.position);
+      weight_ -= it->second.weight;
       cache_items_map_.erase(it);
       return std::move(tmp.front().second);
     } else {
@@ -142,15 +147,61 @@ public:
     return cache_items_map_.size();
   }
 
+  /// Returns the sum of the weights of all entries.
+  [[nodiscard]] size_t weight() const {
+    return weight_;
+  }
+
+  [[nodiscard]] size_t max_size() const {
+    return max_size_;
+  }
+
+  /// Returns how often `get_or_load()` found an existing entry.
+  [[nodiscard]] size_t hits() const {
+    return hits_;
+  }
+
+  /// Returns how often `get_or_load()` had to create a new entry.
+  [[nodiscard]] size_t misses() const {
+    return misses_;
+  }
+
+  /// Returns how many entries were removed to stay within the maximum size.
+  [[nodiscard]] size_t evictions() const {
+    return evictions_;
+  }
+
   Factory& factory() {
     return factory_;
   }
 
 private:
+  struct entry {
+    list_iterator position;
+    size_t weight;
+  };
+
+  // Removes the least recently used entries until the cache fits into its
+  // maximum size again, but keeps at least the `keep` most recent entries.
+  void evict(size_t keep) {
+    while (weight_ > max_size_ && cache_items_list_.size() > keep) {
+      auto it = cache_items_map_.find(cache_items_list_.back().first);
+      weight_ -= it->second.weight;
+      cache_items_map_.erase(it);
+      cache_items_list_.pop_back();
+      ++evictions_;
+    }
+  }
+
   std::list<key_value_pair> cache_items_list_;
-  std::unordered_map<Key, list_iterator> cache_items_map_;
+  std::unordered_map<Key, entry> cache_items_map_;
   size_t max_size_;
+  size_t weight_ = 0;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+  size_t evictions_ = 0;
   Factory factory_;
+  Weigher weigher_;
 };
 
 } // namespace tenzir::detail
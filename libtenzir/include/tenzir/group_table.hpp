@@ -0,0 +1,147 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "tenzir/data.hpp"
+#include "tenzir/multi_series.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tenzir {
+
+namespace detail {
+
+/// The kind of a value in a group key. Values of the common key types are
+/// stored, hashed, and compared without going through `data`.
+enum class group_key_kind : uint8_t {
+  null,
+  int64,
+  uint64,
+  double_,
+  bool_,
+  string,
+  time,
+  duration,
+  other,
+};
+
+/// The values of a single key column for all groups of a `group_table`.
+///
+/// Every group has a kind and a 64-bit payload. For numbers, booleans, times,
+/// and durations, the payload is the value itself. For strings, it refers to
+/// a range in a shared character buffer, and for all other types it indexes
+/// into a list of materialized values.
+class group_key_column {
+public:
+  /// Appends the value of a column at the given row as the key of a new group.
+  auto append(group_key_kind kind, const series& column, int64_t row) -> void;
+
+  /// Appends a single value as the key of a new group.
+  auto append(const data& value) -> void;
+
+  /// Checks whether the value of a column at the given row equals the key of
+  /// the group with the given id.
+  /// @pre `kind` is the kind of the values of `column`.
+  auto equals(uint32_t id, group_key_kind kind, const series& column,
+              int64_t row) const -> bool;
+
+  /// Checks whether a single value equals the key of the group with the given
+  /// id.
+  auto equals(uint32_t id, const data& value) const -> bool;
+
+  /// Returns the key of the group with the given id.
+  auto get(uint32_t id) const -> data;
+
+  /// Returns the approximate number of bytes that the column occupies.
+  auto approx_bytes() const -> size_t;
+
+private:
+  auto push(group_key_kind kind, uint64_t payload) -> void;
+
+  auto string_at(uint64_t index) const -> std::string_view;
+
+  std::vector<group_key_kind> kinds_ = {};
+  std::vector<uint64_t> payloads_ = {};
+  std::string strings_ = {};
+  /// The end offsets of the strings in `strings_`.
+  std::vector<size_t> string_ends_ = {};
+  std::vector<data> others_ = {};
+  /// The bytes that the values in `others_` occupy outside of `others_`.
+  size_t other_bytes_ = {};
+};
+
+} // namespace detail
+
+/// A hash table that assigns dense group ids to the rows of a batch of key
+/// columns.
+///
+/// Unlike a map keyed by a vector of values, the table hashes and compares
+/// whole columns at once, with dedicated loops for the most common key types.
+/// The keys of all groups are stored column-wise in typed buffers, and the
+/// group ids are assigned in order of first appearance, i.e., the first group
+/// has id 0, the second group has id 1, and so on.
+class group_table {
+public:
+  /// Creates a table for keys that consist of `num_keys` columns.
+  explicit group_table(size_t num_keys = 0);
+
+  /// Returns the group id for every row of the given key columns, creating
+  /// new groups as necessary.
+  /// @param keys The key columns, which must all have length *rows*.
+  /// @param rows The number of rows, which is required as there may be no key
+  /// columns at all, in which case all rows belong to the same group.
+  /// @pre `keys.size() == num_keys`
+  auto insert(std::span<const multi_series> keys, int64_t rows)
+    -> std::vector<uint32_t>;
+
+  /// Returns the group id for a single key, creating a new group if necessary.
+  /// @pre `key.size() == num_keys`
+  auto insert(std::span<const data> key) -> uint32_t;
+
+  /// Returns the number of groups.
+  auto size() const -> size_t;
+
+  /// Returns whether the table contains no groups.
+  auto empty() const -> bool;
+
+  /// Returns the key of the group with the given id.
+  /// @pre `id < size()`
+  auto key(uint32_t id) const -> std::vector<data>;
+
+  /// Returns the digest of the key of the group with the given id. The high
+  /// bits of the digest are independent from the slot of the group, which
+  /// makes them suitable for partitioning the groups.
+  /// @pre `id < size()`
+  auto digest(uint32_t id) const -> uint64_t;
+
+  /// Returns the approximate number of bytes that the table occupies.
+  auto approx_bytes() const -> size_t;
+
+  /// Removes all groups and releases their memory.
+  auto clear() -> void;
+
+private:
+  /// Registers a new group whose key was already appended to the key columns.
+  auto add_group(size_t slot, uint64_t digest) -> uint32_t;
+
+  /// Doubles the number of slots and re-inserts all groups.
+  auto grow() -> void;
+
+  size_t num_keys_ = {};
+  size_t num_groups_ = {};
+  std::vector<uint32_t> slots_ = {};
+  std::vector<uint64_t> digests_ = {};
+  std::vector<detail::group_key_column> keys_ = {};
+};
+
+} // namespace tenzir
@@ -68,6 +68,22 @@ caf::error
 extract_partition_synopsis(const std::filesystem::path& partition_path,
                            const std::filesystem::path& partition_synopsis_path);
 
+/// Maps the catalog snapshot at `path` and returns the partition synopsis
+/// flatbuffers it contains, which share the lifetime of the mapping. Returns
+/// an empty map if there is no usable snapshot.
+auto load_catalog_snapshot(const std::filesystem::path& path)
+  -> std::unordered_map<uuid, chunk_ptr>;
+
+/// Replaces the catalog snapshot at `path` with one that contains the
+/// synopses of `partitions`, given as pairs of partition ids and the paths of
+/// their synopsis files. Synopses contained in the previous snapshot are taken
+/// from there, so only those of new partitions are read from their files.
+/// @returns The number of partitions in the snapshot.
+auto write_catalog_snapshot(
+  const std::filesystem::path& path,
+  std::vector<std::pair<uuid, std::filesystem::path>> partitions)
+  -> caf::expected<size_t>;
+
 /// Flatbuffer integration. Note that this is only one-way, restoring
 /// the index state needs additional runtime information.
 // TODO: Pull out the persisted part of the state into a separate struct
@@ -114,6 +130,18 @@ private:
   mutable size_t materializations_ = 0;
 };
 
+/// Weighs passive partitions by the size of their partition and store files,
+/// which approximates the memory they occupy once loaded.
+class partition_weigher {
+public:
+  explicit partition_weigher(index_state& state);
+
+  size_t operator()(const uuid& id, const partition_actor& partition) const;
+
+private:
+  const index_state& state_;
+};
+
 /// Event counters for metrics.
 struct index_counters {
   /// Stores how many passive partitions were loaded from disk until the last
@@ -170,10 +198,18 @@ struct index_state {
   [[nodiscard]] std::string
   transformer_partition_synopsis_path_template() const;
 
+  /// The location of the consolidated catalog snapshot.
+  [[nodiscard]] std::filesystem::path catalog_snapshot_path() const;
+
   caf::error load_from_disk();
 
   void flush_to_disk();
 
+  /// Writes the synopses of all persisted partitions into a single catalog
+  /// snapshot, such that the next startup needs to read only the synopsis
+  /// files of partitions created after the snapshot.
+  void write_catalog_snapshot();
+
   // -- inbound path -----------------------------------------------------------
 
   void handle_slice(table_slice slice);
@@ -233,11 +269,20 @@ struct index_state {
 
   /// The set of passive (read-only) partitions currently loaded into memory.
   /// Uses the `partition_factory` to load new partitions as needed, and evicts
-  /// old entries when the size exceeds `max_inmem_partitions`.
-  detail::lru_cache<uuid, partition_actor, partition_factory> inmem_partitions;
+  /// old entries when their combined size exceeds `partition_cache_size`.
+  /// Shared with other components via the `atom::load` handler.
+  detail::lru_cache<uuid, partition_actor, partition_factory, partition_weigher>
+    inmem_partitions;
+
+  /// The partitions that exist on disk, together with the number of bytes
+  /// that loading them takes according to their synopses.
+  std::unordered_map<uuid, size_t> persisted_partitions = {};
+
+  /// Set if the catalog snapshot does not match the persisted partitions.
+  bool catalog_snapshot_outdated = false;
 
-  /// The set of partitions that exist on disk.
-  std::unordered_set<uuid> persisted_partitions = {};
+  /// Set while the catalog snapshot is being written.
+  bool writing_catalog_snapshot = false;
 
   /// This set to true after the index finished reading the catalog state
   /// from disk.
@@ -249,9 +294,8 @@ struct index_state {
   /// Timeout after which an active partition is forcibly flushed.
   duration active_partition_timeout = {};
 
-  /// The maximum size of the partition LRU cache (or the maximum number of
-  /// read-only partition loaded to memory).
-  size_t max_inmem_partitions = {};
+  /// The maximum size of the partition LRU cache in bytes.
+  size_t partition_cache_size = {};
 
   /// The number of partitions initially returned for a query.
   uint32_t taste_partitions = {};
@@ -334,8 +378,8 @@ struct index_state {
 /// @param partition_capacity The maximum number of events per partition.
 /// @param active_partition_timeout Timeout after which an active partition is
 /// forcibly flushed.
-/// @param max_inmem_partitions The maximum number of passive partitions loaded
-/// into memory.
+/// @param partition_cache_size The maximum combined size of passive partitions
+/// loaded into memory in bytes.
 /// @param taste_partitions How many lookup partitions to schedule immediately.
 /// @param max_concurrent_partition_lookups The maximum amount of concurrent
 /// lookups.
@@ -349,7 +393,7 @@ index(index_actor::stateful_pointer<index_state> self,
       filesystem_actor filesystem, catalog_actor catalog,
       const std::filesystem::path& dir, std::string store_backend,
       size_t partition_capacity, duration active_partition_timeout,
-      size_t max_inmem_partitions, size_t taste_partitions,
+      size_t partition_cache_size, size_t taste_partitions,
       size_t max_concurrent_partition_lookups,
       const std::filesystem::path& catalog_dir, index_config);
 
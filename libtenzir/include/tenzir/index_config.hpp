@@ -12,8 +12,10 @@
 
 #include "tenzir/defaults.hpp"
 #include "tenzir/detail/inspection_common.hpp"
+#include "tenzir/offset.hpp"
 #include "tenzir/type.hpp"
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -27,11 +29,12 @@ struct index_config {
     std::vector<std::string> targets = {};
     double fp_rate = defaults::fp_rate;
     bool create_partition_index = defaults::create_partition_index;
+    bool create_value_index = defaults::create_value_index;
 
     template <class Inspector>
     friend auto inspect(Inspector& f, rule& x) {
       return detail::apply_all(f, x.targets, x.fp_rate,
-                               x.create_partition_index);
+                               x.create_partition_index, x.create_value_index);
     }
 
     static inline const record_type& schema() noexcept {
@@ -39,6 +42,7 @@ struct index_config {
         {"targets", list_type{string_type{}}},
         {"fp-rate", double_type{}},
         {"partition-index", bool_type{}},
+        {"value-index", bool_type{}},
       };
       return result;
     }
@@ -47,15 +51,20 @@ struct index_config {
   std::vector<rule> rules = {};
   double default_fp_rate = defaults::fp_rate;
 
+  /// The targets that select the time field by which rebuilt partitions are
+  /// sorted, in order of preference.
+  std::vector<std::string> sort_by = {};
+
   template <class Inspector>
   friend auto inspect(Inspector& f, index_config& x) {
-    return detail::apply_all(f, x.rules, x.default_fp_rate);
+    return detail::apply_all(f, x.rules, x.default_fp_rate, x.sort_by);
   }
 
   static inline const record_type& schema() noexcept {
     static auto result = record_type{
       {"rules", list_type{rule::schema()}},
       {"default-fp-rate", double_type{}},
+      {"sort-by", list_type{string_type{}}},
     };
     return result;
   }
@@ -64,4 +73,16 @@ struct index_config {
 bool should_create_partition_index(const qualified_record_field& index_qf,
                                    const std::vector<index_config::rule>& rules);
 
+/// Checks whether a partition should maintain a secondary value index for the
+/// given field. Unlike the dense indexes, value indexes are opt-in: they are
+/// only created for fields that a rule with `value-index: true` targets.
+bool should_create_value_index(const qualified_record_field& index_qf,
+                               const std::vector<index_config::rule>& rules);
+
+/// Finds the field by which to sort the events of a partition with the given
+/// schema, i.e., the first leaf field of type `time` that a target selects,
+/// trying the targets in order.
+std::optional<offset>
+find_sort_field(const type& schema, const std::vector<std::string>& targets);
+
 } // namespace tenzir
@@ -0,0 +1,71 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "tenzir/fwd.hpp"
+
+#include "tenzir/chunk.hpp"
+#include "tenzir/generator.hpp"
+#include "tenzir/table_slice.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace tenzir {
+
+/// Parses a self-contained sequence of chunks into table slices.
+using parallel_parse_function
+  = std::function<auto(generator<chunk_ptr>)->generator<table_slice>>;
+
+/// Creates the parse function of a single worker thread. It is invoked once
+/// per worker, such that the returned function may keep state such as a
+/// builder across invocations. The diagnostic handler may be used from the
+/// worker thread.
+using parallel_parse_factory
+  = std::function<auto(diagnostic_handler&)->parallel_parse_function>;
+
+/// Options for `parse_parallelized`.
+struct parallel_parse_options {
+  /// The number of worker threads; must be larger than zero.
+  uint64_t jobs = 0;
+
+  /// The byte that separates events in the input.
+  std::byte separator = std::byte{'\n'};
+
+  /// Whether to yield the results in the order of the input.
+  bool ordered = true;
+};
+
+/// Splits the incoming byte stream at separators such that the concatenation
+/// of each resulting chunk vector is a self-contained unit for
+/// parallelization.
+///
+/// Only yields an empty vector if the input yielded an empty chunk, which means
+/// that the operator's input buffer is exhausted.
+auto split_for_parallelization(generator<chunk_ptr> input, std::byte separator)
+  -> generator<std::vector<chunk_ptr>>;
+
+/// Parses a separator-delimited byte stream in multiple threads. The input is
+/// split into units of about a megabyte, which are fanned out to a pool of
+/// worker threads that each own a parse function created by `make_parser`.
+///
+/// If the options require ordered output, the results of all units are
+/// yielded in the order of the input. Otherwise, results are yielded as soon
+/// as they become available.
+///
+/// The returned generator polls the workers for results, so operators that use
+/// it should be detached and must not become idle.
+auto parse_parallelized(generator<chunk_ptr> input,
+                        operator_control_plane& ctrl,
+                        parallel_parse_options options,
+                        parallel_parse_factory make_parser)
+  -> generator<table_slice>;
+
+} // namespace tenzir
@@ -47,6 +47,11 @@ struct partition_synopsis final : public caf::ref_counted {
   /// @related buffered_synopsis
   void shrink();
 
+  /// Removes the `field -> nullptr` mappings for fields without a dedicated
+  /// synopsis. Consumers that need the list of fields must then take it from
+  /// the schema, like the catalog does.
+  void drop_empty_field_synopses();
+
   /// Estimate the memory footprint of this partition synopsis.
   /// @returns A best-effort estimate of the amount of memory used by this
   ///          synopsis.
@@ -73,6 +78,10 @@ struct partition_synopsis final : public caf::ref_counted {
   /// The version number of this partition.
   uint64_t version = version::current_partition_version;
 
+  /// The time at which the store of this partition was written, or the epoch
+  /// if unknown.
+  time store_time = {};
+
   /// The schema of this partition. This is only set for partition synopses with
   /// a version >= 1, because they are guaranteed to be homogenous.
   type schema = {};
@@ -123,7 +132,7 @@ struct partition_info {
   partition_info(class uuid uuid, const partition_synopsis& synopsis)
     : partition_info{uuid, synopsis.events, synopsis.max_import_time,
                      synopsis.schema, synopsis.version} {
-    // nop
+    store_time = synopsis.store_time;
   }
 
   /// The partition id.
@@ -142,6 +151,20 @@ struct partition_info {
   /// The internal version of the partition.
   uint64_t version = {};
 
+  /// The time at which the store of the partition was written, or the epoch
+  /// if unknown.
+  time store_time = {};
+
+  /// Checks whether the partition crossed the age threshold of the cold
+  /// storage tier only after its store was written. The store backend picks
+  /// the compression of the tier from the age of the data at the time it
+  /// writes the store file, so such partitions still use the compression of
+  /// the hot tier, and rebuilding them recompresses them for the cold tier.
+  /// Partitions without a store time were written right after their newest
+  /// events arrived.
+  [[nodiscard]] auto is_due_for_cold_tier(duration cold_store_after,
+                                          time now) const -> bool;
+
   friend std::strong_ordering
   operator<=>(const partition_info& lhs, const partition_info& rhs) noexcept {
     return lhs.uuid <=> rhs.uuid;
@@ -168,7 +191,8 @@ struct partition_info {
       .pretty_name("tenzir.partition-info")
       .fields(f.field("uuid", x.uuid), f.field("events", x.events),
               f.field("max-import-time", x.max_import_time),
-              f.field("schema", x.schema), f.field("version", x.version));
+              f.field("schema", x.schema), f.field("version", x.version),
+              f.field("store-time", x.store_time));
   }
 };
 
@@ -15,6 +15,7 @@
 
 #include <caf/typed_event_based_actor.hpp>
 
+#include <string>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -138,6 +139,17 @@ struct partition_transformer_state {
     shutdown_state;
 };
 
+/// Sorts the events of a partition by the time field that the targets select,
+/// such that the record batches of its store cover mostly disjoint time ranges
+/// and the per-batch statistics can rule out more of them. The sort must
+/// happen before the events get their ids assigned. The sort spans all slices
+/// of the partition, and the result is split wherever the import time of
+/// consecutive events changes, so that every event retains its import time.
+/// Events without a timestamp sort last.
+auto sort_by_time(std::vector<table_slice> slices,
+                  const std::vector<std::string>& targets)
+  -> std::vector<table_slice>;
+
 /// Spawns a PARTITION TRANSFORMER actor with the given parameters.
 /// This actor
 auto partition_transformer(
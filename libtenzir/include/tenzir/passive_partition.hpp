@@ -19,6 +19,7 @@
 #include "tenzir/query_context.hpp"
 #include "tenzir/type.hpp"
 #include "tenzir/uuid.hpp"
+#include "tenzir/value_index.hpp"
 
 #include <caf/typed_event_based_actor.hpp>
 
@@ -43,6 +44,17 @@ struct passive_partition_state {
 
   const std::unordered_map<std::string, ids>& type_ids() const;
 
+  /// Returns the rows that may match the expression according to the value
+  /// indexes of the partition, or `std::nullopt` if they cannot tell.
+  std::optional<ids> lookup(const expression& expr);
+
+  /// Like `lookup`, but for an expression that is already tailored to the
+  /// schema of the partition.
+  std::optional<ids> lookup_tailored(const expression& expr);
+
+  /// Returns the value index for the field with the given flat index, if any.
+  const value_index* value_index_for(size_t column);
+
   // -- data members -----------------------------------------------------------
 
   /// Pointer to the parent actor.
@@ -57,9 +69,21 @@ struct passive_partition_state {
   /// The combined type of all columns of this partition.
   std::optional<record_type> combined_schema_ = {};
 
+  /// The schema of the events in this partition. Only set for partitions with
+  /// value indexes.
+  type schema = {};
+
   /// Maps type names to ids. Used the answer #schema queries.
   std::unordered_map<std::string, ids> type_ids_ = {};
 
+  /// Maps the flat index of a field to the position of its value index in the
+  /// flatbuffer container.
+  std::unordered_map<size_t, size_t> value_index_positions_ = {};
+
+  /// The value indexes that were already deserialized, keyed by the flat
+  /// index of their field.
+  std::unordered_map<size_t, value_index> value_indexes_ = {};
+
   /// A readable name for this partition.
   static constexpr auto name = "passive-partition";
 
@@ -372,6 +372,44 @@ public:
     -> optimize_result
     = 0;
 
+  /// Returns `N` if the operator forwards only the first `N` events of its
+  /// input and discards the rest, like `head N` does.
+  virtual auto head_limit() const -> std::optional<uint64_t> {
+    return std::nullopt;
+  }
+
+  /// Returns an operator that is equivalent to this operator followed by
+  /// `next`, or `nullptr` if the operator cannot take advantage of that.
+  ///
+  /// The pipeline optimizer uses this to fuse adjacent operators, e.g., to turn
+  /// `sort x | head 10` into a top-k selection.
+  virtual auto fuse(const operator_base& next) const -> operator_ptr {
+    (void)next;
+    return nullptr;
+  }
+
+  /// Returns the top-level fields of its input that the operator reads, given
+  /// that subsequent operators read only the top-level `fields` of its output,
+  /// or `std::nullopt` if it may read all of them.
+  ///
+  /// The pipeline optimizer uses this to tell sources which fields they can
+  /// omit, e.g., to read only `x` from disk for `export | select x`.
+  virtual auto input_fields(const std::optional<std::vector<std::string>>&
+                              fields) const
+    -> std::optional<std::vector<std::string>> {
+    (void)fields;
+    return std::nullopt;
+  }
+
+  /// Returns an operator that is equivalent to this operator if subsequent
+  /// operators read only the top-level `fields` of its output, or `nullptr`
+  /// if the operator cannot take advantage of that.
+  virtual auto project(const std::vector<std::string>& fields) const
+    -> operator_ptr {
+    (void)fields;
+    return nullptr;
+  }
+
   /// Returns the location of the operator.
   virtual auto location() const -> operator_location {
     return operator_location::anywhere;
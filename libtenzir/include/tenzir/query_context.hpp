@@ -11,6 +11,7 @@
 #include "tenzir/actors.hpp"
 #include "tenzir/detail/overload.hpp"
 #include "tenzir/expression.hpp"
+#include "tenzir/ids.hpp"
 #include "tenzir/uuid.hpp"
 
 #include <caf/typed_actor_view.hpp>
@@ -21,16 +22,19 @@ namespace tenzir {
 struct extract_query_context {
   receiver_actor<table_slice> sink;
 
+  /// The top-level fields that the sink needs, or `std::nullopt` for all.
+  std::optional<std::vector<std::string>> fields = {};
+
   friend bool operator==(const extract_query_context& lhs,
                          const extract_query_context& rhs) {
-    return lhs.sink == rhs.sink;
+    return lhs.sink == rhs.sink && lhs.fields == rhs.fields;
   }
 
   template <class Inspector>
   friend auto inspect(Inspector& f, extract_query_context& x) {
     return f.object(x)
       .pretty_name("tenzir.query.extract")
-      .fields(f.field("sink", x.sink));
+      .fields(f.field("sink", x.sink), f.field("fields", x.fields));
   }
 };
 
@@ -70,7 +74,7 @@ struct query_context {
 
   friend bool operator==(const query_context& lhs, const query_context& rhs) {
     return lhs.cmd == rhs.cmd && lhs.expr == rhs.expr
-           && lhs.priority == rhs.priority;
+           && lhs.selection == rhs.selection && lhs.priority == rhs.priority;
   }
 
   template <class Inspector>
@@ -78,8 +82,8 @@ struct query_context {
     return f.object(q)
       .pretty_name("tenzir.query")
       .fields(f.field("id", q.id), f.field("cmd", q.cmd),
-              f.field("expr", q.expr), f.field("priority", q.priority),
-              f.field("issuer", q.issuer));
+              f.field("expr", q.expr), f.field("selection", q.selection),
+              f.field("priority", q.priority), f.field("issuer", q.issuer));
   }
 
   std::size_t memusage() const {
@@ -97,6 +101,10 @@ struct query_context {
   /// The query expression.
   expression expr = {};
 
+  /// The rows of the partition that may match the expression, or an empty
+  /// set if unknown.
+  ids selection = {};
+
   /// The initial taste size.
   std::optional<uint32_t> taste = std::nullopt;
 
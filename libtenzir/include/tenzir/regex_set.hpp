@@ -0,0 +1,98 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "tenzir/fwd.hpp"
+
+#include "tenzir/detail/inspection_common.hpp"
+
+#include <caf/expected.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tenzir {
+
+/// A set of regular expressions in RE2 syntax that is compiled once into a
+/// single automaton, such that a string is scanned once for all patterns
+/// instead of once per pattern.
+class regex_set {
+public:
+  /// The encoding of the patterns and of the inputs.
+  enum class encoding {
+    /// Patterns and inputs are UTF-8, so `.` matches a code point.
+    utf8,
+    /// Patterns and inputs are Latin-1, so `.` matches a single byte. This
+    /// matches the semantics of byte-oriented regex engines such as
+    /// Boost.Regex for any input.
+    latin1,
+  };
+
+  friend auto inspect(auto& f, encoding& x) -> bool {
+    return detail::inspect_enum(f, x);
+  }
+
+  regex_set() = default;
+
+  /// Compiles a set of patterns. If `full_match` is true, a pattern must
+  /// match the entire input instead of a substring of it.
+  static auto make(std::vector<std::string> patterns, bool full_match = false,
+                   encoding text_encoding = encoding::utf8)
+    -> caf::expected<regex_set>;
+
+  /// Returns the number of patterns in the set.
+  auto size() const -> size_t;
+
+  /// Returns the patterns of the set.
+  auto patterns() const -> const std::vector<std::string>&;
+
+  /// Returns the index of the first pattern that matches the input, if any.
+  auto match_first(std::string_view input) const -> std::optional<size_t>;
+
+  /// Stores the indices of all patterns that match the input in ascending
+  /// order in `result`, replacing its previous contents.
+  auto match_all(std::string_view input, std::vector<int>& result) const
+    -> void;
+
+  /// Returns the index of the first matching pattern for every element of the
+  /// array, or null if the element is null or no pattern matches it.
+  auto match_first(const arrow::StringArray& input) const
+    -> std::shared_ptr<arrow::Int64Array>;
+
+  friend auto inspect(auto& f, regex_set& x) -> bool {
+    auto compile = [&] {
+      auto result
+        = make(std::move(x.patterns_), x.full_match_, x.encoding_);
+      if (not result) {
+        return false;
+      }
+      x = std::move(*result);
+      return true;
+    };
+    return f.object(x)
+      .pretty_name("tenzir.regex_set")
+      .on_load(compile)
+      .fields(f.field("patterns", x.patterns_),
+              f.field("full_match", x.full_match_),
+              f.field("encoding", x.encoding_));
+  }
+
+private:
+  struct impl;
+
+  std::vector<std::string> patterns_ = {};
+  bool full_match_ = false;
+  encoding encoding_ = encoding::utf8;
+  std::shared_ptr<const impl> impl_ = {};
+};
+
+} // namespace tenzir
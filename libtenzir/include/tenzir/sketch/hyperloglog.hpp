@@ -0,0 +1,101 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+//
+// This HyperLogLog sketch follows the design of HyperLogLog++ by Heule et al.:
+// it consumes 64-bit hash digests and starts out with a sparse representation
+// at a higher precision that only turns into the dense register array once it
+// would take up more space. Instead of the empirical bias correction tables of
+// HyperLogLog++, the dense estimate uses the improved estimator by Otmar Ertl,
+// which is unbiased over the full range of cardinalities without any tables.
+//
+#pragma once
+
+#include <caf/expected.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace tenzir::sketch {
+
+/// A HyperLogLog sketch for estimating the number of distinct hash digests.
+class hyperloglog {
+public:
+  /// The supported range for the precision of the dense representation.
+  static constexpr auto min_precision = uint8_t{4};
+  static constexpr auto max_precision = uint8_t{18};
+
+  /// The precision of the sparse representation.
+  static constexpr auto sparse_precision = uint8_t{25};
+
+  /// Constructs an empty sketch.
+  /// @param precision The number of digest bits that select a register. The
+  /// dense representation uses `2^precision` registers of one byte each, and
+  /// the relative standard error is about `1.04 / sqrt(2^precision)`.
+  /// @returns The sketch iff the precision is within the supported range.
+  static auto make(uint8_t precision) -> caf::expected<hyperloglog>;
+
+  /// Reconstructs a sketch from its representation.
+  /// @param precision The precision of the dense representation.
+  /// @param sparse The sparse entries, which must be empty if *dense* is not.
+  /// @param dense The registers of the dense representation, if any.
+  /// @returns The sketch iff the representation is valid.
+  static auto make(uint8_t precision, std::span<const uint32_t> sparse,
+                   std::span<const uint8_t> dense)
+    -> caf::expected<hyperloglog>;
+
+  /// Adds a hash digest to the sketch.
+  void add(uint64_t digest);
+
+  /// Merges another sketch into this one.
+  /// @pre `other.precision() == precision()`
+  void merge(const hyperloglog& other);
+
+  /// Estimates the number of distinct digests added to the sketch.
+  auto estimate() const -> double;
+
+  /// Returns the precision of the dense representation.
+  auto precision() const -> uint8_t;
+
+  /// Returns the entries of the sparse representation, which is empty if the
+  /// sketch uses the dense representation.
+  auto sparse() const -> std::span<const uint32_t>;
+
+  /// Returns the registers of the dense representation, which is empty if the
+  /// sketch uses the sparse representation.
+  auto dense() const -> std::span<const uint8_t>;
+
+  // -- concepts --------------------------------------------------------------
+
+  friend auto mem_usage(const hyperloglog& x) -> size_t;
+
+private:
+  explicit hyperloglog(uint8_t precision);
+
+  /// Sorts the sparse entries and keeps only the largest entry per index.
+  void compact() const;
+
+  /// Returns whether the sparse entries take up at least as much space as the
+  /// dense registers.
+  auto sparse_exceeds_dense() const -> bool;
+
+  /// Switches from the sparse to the dense representation.
+  void densify();
+
+  uint8_t precision_ = {};
+
+  /// The sparse entries; only the first `sorted_` entries are compacted.
+  mutable std::vector<uint32_t> sparse_ = {};
+  mutable size_t sorted_ = {};
+
+  /// The dense registers, or empty for the sparse representation.
+  std::vector<uint8_t> dense_ = {};
+};
+
+} // namespace tenzir::sketch
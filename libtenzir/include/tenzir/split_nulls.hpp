@@ -11,6 +11,7 @@
 #include "tenzir/chunk.hpp"
 #include "tenzir/generator.hpp"
 
+#include <cstring>
 #include <string_view>
 
 namespace tenzir {
@@ -28,10 +29,10 @@ inline auto split_nulls(generator<chunk_ptr> input)
     }
     const auto* begin = reinterpret_cast<const char*>(chunk->data());
     const auto* const end = begin + chunk->size();
-    for (const auto* current = begin; current != end; ++current) {
-      if (*current != '\0') {
-        continue;
-      }
+    // `std::memchr` is implemented with vectorized instructions, which is a
+    // lot faster than inspecting every byte individually.
+    while (const auto* current = static_cast<const char*>(
+             std::memchr(begin, '\0', static_cast<size_t>(end - begin)))) {
       if (buffer.empty()) {
         co_yield std::string_view{begin, current};
       } else {
@@ -49,9 +49,14 @@ public:
 
   /// Execute an extract query against the store.
   /// @param expr The expression to filter events.
-  /// @param selection Pre-filtered ids to consider.
+  /// @param selection Pre-filtered ids to consider, or an empty set for all.
+  /// @param fields The top-level fields that the results must contain, or
+  /// `std::nullopt` for all fields. Stores may return more fields than
+  /// requested.
   /// @return The results of applying the extract query to each table slice.
-  [[nodiscard]] virtual generator<table_slice> extract(expression expr) const;
+  [[nodiscard]] virtual generator<table_slice>
+  extract(expression expr, ids selection,
+          std::optional<std::vector<std::string>> fields) const;
 };
 
 /// A base class for passive stores used by the store plugin.
@@ -71,9 +76,27 @@ public:
   [[nodiscard]] virtual caf::error add(std::vector<table_slice> slices) = 0;
 
   /// Persist the store contents to a contiguous buffer.
-  /// @returns A chunk containing the serialized store contents, or an error on
+  /// @returns A chunk containing the serialized store contents, a null chunk
+  /// if the store wrote its contents to the staging file, or an error on
   /// failure.
   [[nodiscard]] virtual caf::expected<chunk_ptr> finish() = 0;
+
+  /// Provide a staging file that the store may write its contents to while it
+  /// is being built, such that it does not need to hold all of them in memory
+  /// until `finish()`. The store builder moves the staging file to the final
+  /// path of the store if `finish()` returns a null chunk, and deletes it if
+  /// the store gets erased. The default implementation ignores the file.
+  /// @param path The path of the staging file.
+  virtual void stage(std::filesystem::path path);
+
+  /// Checks whether the store created its staging file.
+  [[nodiscard]] virtual bool has_staging_file() const;
+
+  /// Returns the first error that the store encountered while reading back
+  /// from its staging file, if any. Such errors cannot be reported through
+  /// the generators returned by `slices()`, `count()`, and `extract()`, which
+  /// end early instead.
+  [[nodiscard]] virtual caf::error staging_error() const;
 };
 
 /// Shared state for in-flight queries for both count and extract operations.
@@ -134,6 +157,7 @@ struct default_active_store_state {
   filesystem_actor filesystem = {};
   std::unique_ptr<active_store> store = {};
   std::filesystem::path path = {};
+  std::filesystem::path staging_path = {};
   std::string store_type = {};
   std::unordered_map<uuid, extract_query_state> running_extractions = {};
   std::unordered_map<uuid, count_query_state> running_counts = {};
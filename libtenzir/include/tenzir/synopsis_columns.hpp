@@ -0,0 +1,99 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "tenzir/fwd.hpp"
+
+#include "tenzir/data.hpp"
+#include "tenzir/detail/flat_map.hpp"
+#include "tenzir/operator.hpp"
+#include "tenzir/partition_synopsis.hpp"
+#include "tenzir/qualified_record_field.hpp"
+#include "tenzir/time.hpp"
+#include "tenzir/type.hpp"
+#include "tenzir/uuid.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+namespace tenzir {
+
+/// The partition synopses of a single schema in a columnar layout. The
+/// partition metadata and the minimum and maximum values of all fields with a
+/// min-max synopsis are stored in contiguous arrays, such that the catalog can
+/// evaluate predicates on them with a linear scan over all partitions instead
+/// of visiting each synopsis individually. The leaf fields of the schema are
+/// stored once rather than once per partition.
+class synopsis_columns {
+public:
+  using synopsis_map = detail::flat_map<uuid, partition_synopsis_ptr>;
+
+  /// A byte per partition that is non-zero if the partition is a candidate.
+  using candidate_mask = std::vector<uint8_t>;
+
+  synopsis_columns() = default;
+
+  /// Builds the columns from the synopses of the partitions of a schema. The
+  /// position of a partition in the columns equals its position in the map.
+  synopsis_columns(const type& schema, const synopsis_map& partitions);
+
+  /// Returns the number of partitions.
+  [[nodiscard]] auto size() const noexcept -> size_t;
+
+  /// Returns the leaf fields of the schema.
+  [[nodiscard]] auto fields() const noexcept
+    -> std::span<const qualified_record_field>;
+
+  /// Returns the partitions whose import time range may satisfy `op rhs`.
+  [[nodiscard]] auto lookup_import_time(relational_operator op, time rhs) const
+    -> candidate_mask;
+
+  /// Returns the partitions whose values for the field at the given position
+  /// may satisfy `op rhs`, or nullopt if the columns cannot answer the
+  /// predicate and the caller must consult the synopses instead.
+  [[nodiscard]] auto
+  lookup(size_t field, relational_operator op, const data& rhs) const
+    -> std::optional<candidate_mask>;
+
+  /// Returns the partition info for the partition at the given position.
+  [[nodiscard]] auto info(size_t position) const -> partition_info;
+
+  /// Returns an estimate of the memory usage in bytes.
+  [[nodiscard]] auto memusage() const -> size_t;
+
+private:
+  /// The ranges of a single field. Partitions without a min-max synopsis for
+  /// the field are marked as unknown and always returned as candidates.
+  template <class T>
+  struct range_column {
+    std::vector<T> min = {};
+    std::vector<T> max = {};
+    std::vector<uint8_t> unknown = {};
+  };
+
+  using range_column_variant
+    = std::variant<std::monostate, range_column<time>, range_column<duration>,
+                   range_column<int64_t>, range_column<uint64_t>,
+                   range_column<double>>;
+
+  type schema_ = {};
+  std::vector<uuid> uuids_ = {};
+  std::vector<uint64_t> events_ = {};
+  std::vector<time> min_import_times_ = {};
+  std::vector<time> max_import_times_ = {};
+  std::vector<time> store_times_ = {};
+  std::vector<uint64_t> versions_ = {};
+  std::vector<qualified_record_field> fields_ = {};
+  std::vector<range_column_variant> ranges_ = {};
+};
+
+} // namespace tenzir
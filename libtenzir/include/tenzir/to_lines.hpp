@@ -11,6 +11,7 @@
 #include "tenzir/chunk.hpp"
 #include "tenzir/generator.hpp"
 
+#include <cstring>
 #include <string_view>
 
 namespace tenzir {
@@ -33,9 +34,23 @@ inline auto to_lines(generator<chunk_ptr> input)
       ++begin;
     };
     ended_on_carriage_return = false;
-    for (const auto* current = begin; current != end; ++current) {
-      if (*current != '\n' && *current != '\r') {
-        continue;
+    // We search for line breaks with `std::memchr`, which the standard library
+    // implements with vectorized instructions. Carriage returns are rare, so
+    // we remember the position of the next one instead of searching for it
+    // again for every line, and only search for newlines up to it.
+    auto find = [](const char* first, const char* last, char c) {
+      const auto* result = static_cast<const char*>(
+        std::memchr(first, c, static_cast<size_t>(last - first)));
+      return result ? result : last;
+    };
+    const auto* next_carriage_return = find(begin, end, '\r');
+    while (begin != end) {
+      if (next_carriage_return < begin) {
+        next_carriage_return = find(begin, end, '\r');
+      }
+      const auto* current = find(begin, next_carriage_return, '\n');
+      if (current == end) {
+        break;
       }
       if (buffer.empty()) {
         co_yield std::string_view{begin, current};
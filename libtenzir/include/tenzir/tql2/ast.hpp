@@ -251,6 +251,10 @@ struct expression {
 
   /// Returns true if the expression always returns the same value.
   auto is_deterministic(const registry& reg) const -> bool;
+
+  /// Returns the names of the top-level fields that the expression reads, or
+  /// `std::nullopt` if it may read all of them, e.g., because it uses `this`.
+  auto root_fields() const -> std::optional<std::vector<std::string>>;
 };
 
 /// A "simple selector" has a path that contains only constant field names.
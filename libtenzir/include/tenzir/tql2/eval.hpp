@@ -14,6 +14,10 @@
 #include "tenzir/tql2/ast.hpp"
 #include "tenzir/type.hpp"
 
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
 namespace tenzir {
 
 auto eval(const ast::expression& expr, const table_slice& input,
@@ -23,6 +27,32 @@ auto eval(const ast::expression& expr, const table_slice& input,
 auto eval(const ast::simple_selector& expr, const table_slice& input,
           diagnostic_handler& dh) -> series;
 
+/// Evaluates an expression for many batches of input. The expression is lowered
+/// into a plan for every schema on its first batch, and the plan is reused for
+/// all later batches of that schema: Field paths are resolved to column indices
+/// only once, constant subexpressions are folded, and functions are
+/// instantiated only once.
+/// @note The expression and the diagnostic handler must outlive this object.
+class compiled_expression {
+public:
+  compiled_expression(const ast::expression& expr, diagnostic_handler& dh);
+  ~compiled_expression() noexcept;
+  compiled_expression(const compiled_expression&) = delete;
+  auto operator=(const compiled_expression&) -> compiled_expression& = delete;
+  compiled_expression(compiled_expression&&) noexcept;
+  auto operator=(compiled_expression&&) noexcept -> compiled_expression&;
+
+  /// Evaluates the expression for a batch of input.
+  auto eval(const table_slice& input) -> multi_series;
+
+  /// Returns the compiled expression.
+  auto expr() const -> const ast::expression&;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
 auto const_eval(const ast::expression& expr, diagnostic_handler& dh)
   -> failure_or<data>;
 
@@ -53,4 +83,34 @@ auto resolve(const ast::simple_selector& sel, const table_slice& slice)
 auto resolve(const ast::simple_selector& sel, type ty)
   -> variant<offset, resolve_error>;
 
+/// Resolves selectors against the schemas of many batches. Every selector is
+/// resolved only once per schema, and the fields of every record type along the
+/// way are looked up by name in a hash table instead of a linear scan, which
+/// matters for wide schemas.
+/// @note The selectors must outlive this object.
+class selector_resolver {
+public:
+  auto resolve(const ast::simple_selector& sel, const type& schema)
+    -> variant<offset, resolve_error>;
+
+  auto resolve(const ast::simple_selector& sel, const table_slice& slice)
+    -> variant<series, resolve_error>;
+
+private:
+  /// The number of schemas whose resolutions we keep at most.
+  static constexpr auto max_schemas = size_t{1024};
+
+  struct schema_state {
+    /// The indices of the fields by name for the record types, keyed by the
+    /// offset of the record type in the schema.
+    std::unordered_map<offset, std::unordered_map<std::string_view, size_t>>
+      fields;
+    std::unordered_map<const ast::simple_selector*,
+                       variant<offset, resolve_error>>
+      selectors;
+  };
+
+  std::unordered_map<type, schema_state> schemas_;
+};
+
 } // namespace tenzir
@@ -14,17 +14,52 @@
 #include "tenzir/session.hpp"
 #include "tenzir/table_slice.hpp"
 #include "tenzir/tql2/ast.hpp"
+#include "tenzir/tql2/plugin.hpp"
 
 #include <arrow/api.h>
 
+#include <optional>
+#include <unordered_map>
+
 namespace tenzir {
 
+/// The state that an evaluator reuses across batches of the same schema. The
+/// evaluator fills the plan lazily while interpreting the expression, and
+/// consults it before interpreting a node again.
+struct expression_plan {
+  /// A field that was resolved to a column of the schema.
+  struct column {
+    /// The indices of the fields along the path to the column, starting at the
+    /// top-level record. Empty for `this`.
+    std::vector<int> path;
+    type ty;
+  };
+
+  /// The resolved columns of the schema, or `std::nullopt` for nodes that do
+  /// not refer to a column of the schema.
+  std::unordered_map<const ast::expression_kind*, std::optional<column>>
+    columns;
+
+  /// The folded values of constant subexpressions, or `std::nullopt` for nodes
+  /// that cannot be folded. Shared between the plans of all schemas.
+  std::unordered_map<const ast::expression_kind*, std::optional<data>>*
+    constants
+    = nullptr;
+
+  /// The instantiated functions, or `nullptr` if the instantiation failed.
+  /// Shared between the plans of all schemas.
+  std::unordered_map<const ast::function_call*, function_ptr>* functions
+    = nullptr;
+};
+
 class evaluator {
 public:
-  explicit evaluator(const table_slice* input, session ctx)
+  explicit evaluator(const table_slice* input, session ctx,
+                     expression_plan* plan = nullptr)
     : input_{input},
       length_{input ? detail::narrow<int64_t>(input->rows()) : 1},
-      ctx_{ctx} {
+      ctx_{ctx},
+      plan_{plan} {
   }
 
   auto slice(int64_t begin, int64_t end) const -> evaluator {
@@ -77,6 +112,10 @@ public:
 
   auto to_series(const data& x) const -> series;
 
+  /// Returns the value of the expression if it is a constant, or if the plan
+  /// folded it into one.
+  auto try_constant(const ast::expression& x) -> std::optional<data>;
+
   auto input_or_throw(into_location location) -> const table_slice&;
 
   auto null() const -> series {
@@ -111,9 +150,19 @@ public:
   }
 
 private:
+  /// Returns the column that the expression refers to, resolving it if the
+  /// plan does not know it yet.
+  auto lower_column(const ast::expression& x)
+    -> const std::optional<expression_plan::column>&;
+
+  /// Returns the value of a constant subexpression, folding it if the plan
+  /// does not know it yet.
+  auto lower_constant(const ast::expression& x) -> const std::optional<data>&;
+
   variant<const table_slice*, table_slice> input_;
   int64_t length_;
   session ctx_;
+  expression_plan* plan_;
 };
 
 } // namespace tenzir
@@ -180,6 +180,14 @@ public:
 
   virtual auto reset() -> void = 0;
 
+  /// Merges the state of another instance into this one, as if this instance
+  /// had also seen all input of the other instance. This makes it possible to
+  /// aggregate partitions of the input independently, e.g., on multiple
+  /// threads, and to combine the partial results afterwards.
+  /// @pre `other` was created by the same plugin with the same invocation.
+  virtual auto merge(const aggregation_instance& other, session ctx)
+    -> void = 0;
+
   /// Save and restore the state of the aggregation instance. Note that the
   /// restore function should eventually be moved into `aggregation_plugin`, but
   /// we cannot do that yet as quite a few aggregation instances store
@@ -73,6 +73,9 @@ public:
     return do_not_optimize(*this);
   }
 
+  auto input_fields(const std::optional<std::vector<std::string>>& fields) const
+    -> std::optional<std::vector<std::string>> override;
+
   friend auto inspect(auto& f, set_operator& x) -> bool {
     return f.apply(x.assignments_);
   }
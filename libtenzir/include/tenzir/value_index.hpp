@@ -0,0 +1,81 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "tenzir/fwd.hpp"
+
+#include "tenzir/data.hpp"
+#include "tenzir/defaults.hpp"
+#include "tenzir/detail/inspection_common.hpp"
+#include "tenzir/ewah_bitmap.hpp"
+#include "tenzir/ids.hpp"
+#include "tenzir/operator.hpp"
+#include "tenzir/type.hpp"
+#include "tenzir/view.hpp"
+
+#include <map>
+#include <optional>
+
+namespace tenzir {
+
+/// A secondary index for a single column of a partition that maps keys to the
+/// bitmap of rows containing them. Strings are keyed by their hash digest,
+/// times and durations by the bin of width `resolution` they fall into, and
+/// all other supported types by their exact value. Lookups therefore return a
+/// superset of the matching rows, which the store narrows down by evaluating
+/// the predicate on the selected rows only.
+class value_index {
+public:
+  value_index() = default;
+
+  /// Creates an index for values of the given type, or returns nullopt if the
+  /// type is not indexable.
+  static auto make(const type& t,
+                   duration resolution = defaults::value_index_resolution)
+    -> std::optional<value_index>;
+
+  /// Adds a value for the row with the given id. Null values are ignored.
+  /// @pre `id` must be greater than any previously appended id.
+  void append(data_view x, id row);
+
+  /// Returns the candidate rows for the predicate `x op rhs`, or nullopt if
+  /// the index cannot answer the predicate.
+  [[nodiscard]] auto lookup(relational_operator op, data_view rhs) const
+    -> std::optional<ids>;
+
+  /// Returns the type of the indexed values.
+  [[nodiscard]] auto value_type() const -> const type&;
+
+  /// Returns the number of distinct keys.
+  [[nodiscard]] auto size() const -> size_t;
+
+  /// Returns an estimate of the memory usage in bytes.
+  [[nodiscard]] auto memusage() const -> size_t;
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, value_index& x) {
+    return f.object(x)
+      .pretty_name("tenzir.value_index")
+      .fields(f.field("type", x.type_), f.field("resolution", x.resolution_),
+              f.field("entries", x.entries_));
+  }
+
+private:
+  [[nodiscard]] auto make_key(data_view x) const -> std::optional<data>;
+
+  [[nodiscard]] auto is_ordered() const -> bool;
+
+  [[nodiscard]] auto is_binned() const -> bool;
+
+  type type_ = {};
+  duration resolution_ = {};
+  std::map<data, ewah_bitmap> entries_ = {};
+};
+
+} // namespace tenzir
@@ -16,6 +16,7 @@
 #include "tenzir/concept/printable/tenzir/uuid.hpp"
 #include "tenzir/detail/assert.hpp"
 #include "tenzir/detail/fill_status_map.hpp"
+#include "tenzir/detail/serialize.hpp"
 #include "tenzir/fbs/flatbuffer_container.hpp"
 #include "tenzir/fbs/partition.hpp"
 #include "tenzir/fbs/utils.hpp"
@@ -30,6 +31,7 @@
 #include "tenzir/taxonomies.hpp"
 #include "tenzir/terminate.hpp"
 #include "tenzir/type.hpp"
+#include "tenzir/value_index.hpp"
 
 #include <caf/deserializer.hpp>
 #include <caf/error.hpp>
@@ -70,6 +72,7 @@ void serialize(
   // TODO: It would probably make more sense if the partition
   // synopsis keeps track of offset/events internally.
   mutable_synopsis.events = self->state().data.events;
+  mutable_synopsis.store_time = time::clock::now();
   const auto& schema = self->state().data.synopsis->schema;
   auto fields = std::vector<struct record_type::field>{};
   for (const auto& [field, offset] : as<record_type>(schema).leaves()) {
@@ -169,6 +172,12 @@ void active_partition_state::handle_slice(table_slice x) {
   // Mark the ids of this table slice for the current type.
   ids.append_bits(false, first - ids.size());
   ids.append_bits(true, last - first);
+  for (auto& field : data.value_indexes) {
+    const auto& field_type = field.index.value_type();
+    for (auto row = size_t{0}; row < x.rows(); ++row) {
+      field.index.append(x.at(row, field.column, field_type), first + row);
+    }
+  }
   data.events += x.rows();
   data.synopsis.unshared().add(x, partition_capacity, synopsis_index_config);
   self->mail(x).send(store_builder);
@@ -204,6 +213,31 @@ pack_full(const active_partition_state::serialization_data& x,
   if (!maybe_ps) {
     return maybe_ps.error();
   }
+  // Serialize value indexes. Their data lives in separate segments of the
+  // container, which start at index 1 because the partition occupies index 0.
+  auto value_index_buffers = std::vector<caf::byte_buffer>{};
+  value_index_buffers.reserve(x.value_indexes.size());
+  std::vector<flatbuffers::Offset<fbs::value_index::LegacyQualifiedValueIndex>>
+    qualified_value_indexes;
+  for (const auto& field : x.value_indexes) {
+    auto& buffer = value_index_buffers.emplace_back();
+    // The inspector API requires a mutable reference even for serialization.
+    if (not detail::serialize(buffer, const_cast<value_index&>(field.index))) {
+      return caf::make_error(ec::serialization_error,
+                             fmt::format("failed to serialize value index for "
+                                         "field {}",
+                                         field.name));
+    }
+    auto name = builder.CreateString(field.name);
+    fbs::value_index::detail::LegacyValueIndexBuilder vi_builder(builder);
+    vi_builder.add_caf_0_18_external_container_idx(value_index_buffers.size());
+    auto vi = vi_builder.Finish();
+    fbs::value_index::LegacyQualifiedValueIndexBuilder qvi_builder(builder);
+    qvi_builder.add_field_name(name);
+    qvi_builder.add_value_index(vi);
+    qualified_value_indexes.push_back(qvi_builder.Finish());
+  }
+  auto value_indexes = builder.CreateVector(qualified_value_indexes);
   flatbuffers::Offset<fbs::partition::detail::StoreHeader> store_header = {};
   auto store_name = builder.CreateString(x.store_id);
   auto store_data = builder.CreateVector(
@@ -220,6 +254,7 @@ pack_full(const active_partition_state::serialization_data& x,
   legacy_builder.add_schema(schema_offset);
   legacy_builder.add_type_ids(type_ids);
   legacy_builder.add_store(store_header);
+  legacy_builder.add_value_indexes(value_indexes);
   auto partition_v0 = legacy_builder.Finish();
   fbs::PartitionBuilder partition_builder(builder);
   partition_builder.add_partition_type(fbs::partition::Partition::legacy);
@@ -231,6 +266,9 @@ pack_full(const active_partition_state::serialization_data& x,
   // even if all indices are inline.
   fbs::flatbuffer_container_builder cbuilder;
   cbuilder.add(as_bytes(chunk));
+  for (const auto& buffer : value_index_buffers) {
+    cbuilder.add(buffer);
+  }
   auto container = std::move(cbuilder).finish(fbs::PartitionIdentifier());
   return std::move(container).dissolve();
 }
@@ -251,6 +289,22 @@ active_partition_actor::behavior_type active_partition(
   self->state().partition_capacity
     = get_or(index_opts, "cardinality", defaults::max_partition_size);
   self->state().synopsis_index_config = synopsis_opts;
+  const auto& partition_schema = self->state().data.synopsis->schema;
+  const auto& partition_record = as<record_type>(partition_schema);
+  auto column = size_t{0};
+  for (const auto& [field, offset] : partition_record.leaves()) {
+    const auto qf = qualified_record_field{partition_schema, offset};
+    if (should_create_value_index(qf, synopsis_opts.rules)) {
+      if (auto index = value_index::make(field.type)) {
+        self->state().data.value_indexes.push_back({
+          .name = partition_record.key(offset),
+          .column = column,
+          .index = std::move(*index),
+        });
+      }
+    }
+    ++column;
+  }
   self->state().store_plugin = store_plugin;
   self->state().taxonomies = taxonomies;
   self->state().data.store_id = self->state().store_plugin->name();
@@ -97,6 +97,9 @@ void add_root_opts(command& cmd) {
   cmd.options.add<duration>("?tenzir", "active-partition-timeout",
                             "timespan after which an active partition is "
                             "forcibly flushed (default: 30s)");
+  cmd.options.add<int64_t>("?tenzir", "partition-cache-size",
+                           "maximum combined size of partitions kept in "
+                           "memory in bytes (default: 1Gi)");
   cmd.options.add<duration>("?tenzir", "rebuild-interval",
                             "timespan after which an automatic rebuild is "
                             "triggered (default: 2h)");
@@ -0,0 +1,203 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/batch_statistics.hpp"
+
+#include "tenzir/arrow_table_slice.hpp"
+#include "tenzir/bitmap_algorithms.hpp"
+#include "tenzir/defaults.hpp"
+#include "tenzir/detail/narrow.hpp"
+#include "tenzir/expression.hpp"
+#include "tenzir/synopsis_factory.hpp"
+#include "tenzir/table_slice.hpp"
+
+#include <arrow/array.h>
+#include <arrow/record_batch.h>
+
+#include <algorithm>
+
+namespace tenzir {
+
+namespace {
+
+/// Collects the leaf arrays of an array in order of their flat index.
+auto collect_leaves(const std::shared_ptr<arrow::Array>& array,
+                    arrow::ArrayVector& out) -> void {
+  match(
+    *array,
+    [&](const auto&) {
+      out.push_back(array);
+    },
+    [&](const arrow::StructArray& s) {
+      for (const auto& field : s.fields()) {
+        collect_leaves(field, out);
+      }
+    });
+}
+
+/// Checks whether a predicate of a tailored expression may hold for any row of
+/// a record batch.
+auto may_match(const predicate& pred, const batch_statistics& stats) -> bool {
+  const auto* rhs = try_as<data>(pred.rhs);
+  if (not rhs) {
+    return true;
+  }
+  if (const auto* ex = try_as<meta_extractor>(pred.lhs)) {
+    if (ex->kind == meta_extractor::import_time) {
+      return evaluate(data{stats.import_time}, pred.op, *rhs);
+    }
+    return true;
+  }
+  const auto* ex = try_as<data_extractor>(pred.lhs);
+  if (not ex or ex->column >= stats.columns.size()) {
+    return true;
+  }
+  const auto& column = stats.columns[ex->column];
+  if (is<caf::none_t>(*rhs)) {
+    switch (pred.op) {
+      case relational_operator::equal:
+        return column.null_count > 0;
+      case relational_operator::not_equal:
+        return column.null_count < stats.rows;
+      default:
+        return true;
+    }
+  }
+  switch (pred.op) {
+    case relational_operator::not_equal:
+    case relational_operator::not_in:
+    case relational_operator::not_ni:
+      // Null values satisfy negated predicates, but the synopsis does not
+      // know about them.
+      if (column.null_count > 0) {
+        return true;
+      }
+      break;
+    default:
+      if (column.null_count == stats.rows) {
+        return false;
+      }
+      break;
+  }
+  if (not column.synopsis) {
+    return true;
+  }
+  return column.synopsis->lookup(pred.op, make_view(*rhs)).value_or(true);
+}
+
+} // namespace
+
+auto make_batch_statistics(const table_slice& slice) -> batch_statistics {
+  // These options must be kept in sync with tenzir/ip_synopsis.hpp and
+  // tenzir/string_synopsis.hpp respectively.
+  auto synopsis_opts = caf::settings{};
+  synopsis_opts["buffer-input-data"] = true;
+  synopsis_opts["max-partition-size"] = slice.rows();
+  synopsis_opts["string-synopsis-fp-rate"] = defaults::fp_rate;
+  synopsis_opts["address-synopsis-fp-rate"] = defaults::fp_rate;
+  auto result = batch_statistics{
+    .rows = slice.rows(),
+    .import_time = slice.import_time(),
+  };
+  auto arrays = arrow::ArrayVector{};
+  for (const auto& column : to_record_batch(slice)->columns()) {
+    collect_leaves(column, arrays);
+  }
+  result.columns.reserve(arrays.size());
+  auto array = arrays.begin();
+  for (const auto& leaf : as<record_type>(slice.schema()).leaves()) {
+    TENZIR_ASSERT(array != arrays.end());
+    auto& stats = result.columns.emplace_back();
+    stats.null_count = detail::narrow<uint64_t>((*array)->null_count());
+    if (not leaf.field.type.attribute("skip")
+        and stats.null_count < result.rows) {
+      stats.synopsis = factory<synopsis>::make(leaf.field.type, synopsis_opts);
+    }
+    if (stats.synopsis) {
+      for (auto&& value : values(leaf.field.type, **array)) {
+        if (not is<caf::none_t>(value)) {
+          stats.synopsis->add(std::move(value));
+        }
+      }
+      if (auto shrinked = stats.synopsis->shrink()) {
+        stats.synopsis = std::move(shrinked);
+      }
+    }
+    ++array;
+  }
+  return result;
+}
+
+auto may_match(const expression& expr, const batch_statistics& stats) -> bool {
+  return match(
+    expr,
+    [&](const conjunction& x) {
+      return std::ranges::all_of(x, [&](const expression& operand) {
+        return may_match(operand, stats);
+      });
+    },
+    [&](const disjunction& x) {
+      return std::ranges::any_of(x, [&](const expression& operand) {
+        return may_match(operand, stats);
+      });
+    },
+    [](const negation&) {
+      // A synopsis may return false positives, and negating them would cause
+      // false negatives.
+      return true;
+    },
+    [&](const predicate& x) {
+      return may_match(x, stats);
+    },
+    [](caf::none_t) {
+      return true;
+    });
+}
+
+auto select_batches(const expression& expr, const ids& selection,
+                    std::span<const batch_statistics> statistics)
+  -> std::vector<int> {
+  auto result = std::vector<int>{};
+  result.reserve(statistics.size());
+  for (auto i = size_t{0}; i < statistics.size(); ++i) {
+    if (may_match(expr, statistics[i])) {
+      result.push_back(detail::narrow<int>(i));
+    }
+  }
+  if (selection.empty()) {
+    return result;
+  }
+  // Both the selected runs and the record batches are ordered by id, so we
+  // can intersect them in a single pass.
+  auto offsets = std::vector<id>{};
+  offsets.reserve(statistics.size());
+  auto offset = id{};
+  for (const auto& stats : statistics) {
+    offsets.push_back(offset);
+    offset += stats.rows;
+  }
+  auto selected = std::vector<int>{};
+  auto run = select_runs(selection);
+  auto current = run.begin();
+  for (auto i : result) {
+    const auto first = offsets[i];
+    const auto last = first + statistics[i].rows;
+    while (current != run.end() and (*current).last <= first) {
+      ++current;
+    }
+    if (current == run.end()) {
+      break;
+    }
+    if ((*current).first < last) {
+      selected.push_back(i);
+    }
+  }
+  return selected;
+}
+
+} // namespace tenzir
@@ -28,14 +28,18 @@
 #include "tenzir/query_context.hpp"
 #include "tenzir/status.hpp"
 #include "tenzir/synopsis.hpp"
+#include "tenzir/synopsis_columns.hpp"
 #include "tenzir/taxonomies.hpp"
-#include "tenzir/time_synopsis.hpp"
 
 #include <caf/binary_serializer.hpp>
 #include <caf/detail/set_thread_name.hpp>
 #include <caf/expected.hpp>
+#include <caf/policy/select_all.hpp>
 
+#include <algorithm>
 #include <string_view>
+#include <thread>
+#include <unordered_set>
 
 namespace tenzir {
 
@@ -51,6 +55,116 @@ auto catalog_lookup_result::empty() const noexcept -> bool {
   return candidate_infos.empty();
 }
 
+namespace {
+
+/// Adds the string fields with a dedicated synopsis to the set of fields that
+/// should not be touched by the pruner, copying the set only if necessary.
+void update_unprunable_fields(
+  std::shared_ptr<const detail::heterogeneous_string_hashset>& fields,
+  const partition_synopsis& ps) {
+  auto updated = std::shared_ptr<detail::heterogeneous_string_hashset>{};
+  for (auto const& [field, synopsis] : ps.field_synopses_) {
+    if (synopsis != nullptr && is<string_type>(field.type())
+        && not fields->contains(field.name())) {
+      if (not updated) {
+        updated
+          = std::make_shared<detail::heterogeneous_string_hashset>(*fields);
+      }
+      updated->insert(std::string{field.name()});
+    }
+  }
+  if (updated) {
+    fields = std::move(updated);
+  }
+  // TODO/BUG: We also need to prevent pruning for enum types,
+  // which also use string literals for lookup. We must be even
+  // more strict here than with string fields, because incorrectly
+  // pruning string fields will only cause false positives, but
+  // incorrectly pruning enum fields can actually cause false negatives.
+  //
+  // else if (field.type() == enumeration_type{}) {
+  //   auto full_name = field.name();
+  //   for (auto suffix : detail::all_suffixes(full_name, "."))
+  //     unprunable_fields.insert(suffix);
+  // }
+}
+
+/// Drops the placeholders for fields without a dedicated synopsis if the
+/// catalog is the only owner of the synopsis, because the lookup takes the list
+/// of fields from the columns of the schema instead.
+void compact(partition_synopsis_ptr& synopsis) {
+  if (synopsis->get_reference_count() == 1ull) {
+    synopsis.unshared().drop_empty_field_synopses();
+  }
+}
+
+/// Rebuilds the columns for a schema after its synopses changed.
+void update_columns(catalog_snapshot& snapshot, const type& schema) {
+  auto it = snapshot.synopses_per_type.find(schema);
+  if (it == snapshot.synopses_per_type.end()) {
+    snapshot.columns_per_type.erase(schema);
+    return;
+  }
+  snapshot.columns_per_type[schema]
+    = std::make_shared<synopsis_columns>(schema, *it->second);
+}
+
+void log_lookup(const catalog_lookup_result& result,
+                std::chrono::steady_clock::time_point start) {
+  auto num_candidate_partitions = size_t{0};
+  auto num_candidate_events = size_t{0};
+  for (const auto& [_, candidates] : result.candidate_infos) {
+    num_candidate_partitions += candidates.partition_infos.size();
+    num_candidate_events
+      += std::transform_reduce(candidates.partition_infos.begin(),
+                               candidates.partition_infos.end(), size_t{0},
+                               std::plus<>{}, [](const auto& partition) {
+                                 return partition.events;
+                               });
+  }
+  auto delta = std::chrono::duration_cast<std::chrono::microseconds>(
+    stopwatch::now() - start);
+  TENZIR_VERBOSE("catalog found {} candidate partitions ({} events) in "
+                 "{} microseconds",
+                 num_candidate_partitions, num_candidate_events, delta.count());
+  TENZIR_TRACEPOINT(catalog_lookup, delta.count(), num_candidate_partitions);
+}
+
+/// A short-lived actor that looks up the candidates for a subset of the
+/// schemas of a catalog snapshot.
+using catalog_lookup_actor = typed_actor_fwd<
+  auto(atom::candidates)->caf::result<catalog_lookup_result>>::unwrap;
+
+auto catalog_lookup(catalog_lookup_actor::pointer self,
+                    std::shared_ptr<const catalog_snapshot> snapshot,
+                    expression normalized, std::vector<type> schemas)
+  -> catalog_lookup_actor::behavior_type {
+  return {
+    [self, snapshot = std::move(snapshot), normalized = std::move(normalized),
+     schemas = std::move(schemas)](
+      atom::candidates) -> caf::result<catalog_lookup_result> {
+      self->quit();
+      return snapshot->lookup(normalized, schemas);
+    },
+  };
+}
+
+auto normalize_for_lookup(expression expr) -> caf::expected<expression> {
+  if (expr == caf::none) {
+    expr = trivially_true_expression();
+  }
+  auto normalized = normalize_and_validate(expr);
+  if (not normalized) {
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("catalog failed to normalize and "
+                                       "validate epxression {}: {}",
+                                       expr, normalized.error()));
+  }
+  return normalized;
+}
+
+} // namespace
+
 auto catalog_state::initialize(
   std::shared_ptr<std::unordered_map<uuid, partition_synopsis_ptr>> ps)
   -> caf::result<atom::ok> {
@@ -75,11 +189,13 @@ auto catalog_state::initialize(
                     .introduced,
                   fmt::join(unsupported_partitions, ", ")));
   }
+  auto next = std::make_shared<catalog_snapshot>(*snapshot);
   auto flat_data_map = std::unordered_map<
     tenzir::type, std::vector<std::pair<uuid, partition_synopsis_ptr>>>{};
   for (auto& [uuid, synopsis] : *ps) {
     TENZIR_ASSERT(synopsis->get_reference_count() == 1ull);
-    update_unprunable_fields(*synopsis);
+    update_unprunable_fields(next->unprunable_fields, *synopsis);
+    compact(synopsis);
     flat_data_map[synopsis->schema].emplace_back(uuid, std::move(synopsis));
   }
   for (auto& [type, flat_data] : flat_data_map) {
@@ -88,60 +204,158 @@ auto catalog_state::initialize(
                  const std::pair<uuid, partition_synopsis_ptr>& rhs) {
                 return lhs.first < rhs.first;
               });
-    synopses_per_type[type]
-      = decltype(synopses_per_type)::value_type::second_type::make_unsafe(
-        std::move(flat_data));
+    next->synopses_per_type[type] = std::make_shared<
+      catalog_snapshot::synopsis_map>(
+      catalog_snapshot::synopsis_map::make_unsafe(std::move(flat_data)));
+    update_columns(*next, type);
   }
+  snapshot = std::move(next);
   return atom::ok_v;
 }
 
 auto catalog_state::merge(std::vector<partition_synopsis_pair> partitions)
   -> caf::result<atom::ok> {
+  auto next = std::make_shared<catalog_snapshot>(*snapshot);
+  // Copy every affected map only once, even if many partitions share a type.
+  auto updated = std::unordered_map<
+    tenzir::type, std::shared_ptr<catalog_snapshot::synopsis_map>>{};
   for (auto& [id, synopsis] : partitions) {
-    update_unprunable_fields(*synopsis);
-    auto& entry = synopses_per_type[synopsis->schema][id];
-    entry = std::move(synopsis);
+    update_unprunable_fields(next->unprunable_fields, *synopsis);
+    compact(synopsis);
+    auto [it, inserted] = updated.try_emplace(synopsis->schema);
+    if (inserted) {
+      auto& current = next->synopses_per_type[synopsis->schema];
+      it->second = current
+                     ? std::make_shared<catalog_snapshot::synopsis_map>(*current)
+                     : std::make_shared<catalog_snapshot::synopsis_map>();
+      current = it->second;
+    }
+    (*it->second)[id] = std::move(synopsis);
   }
+  for (const auto& [type, _] : updated) {
+    update_columns(*next, type);
+  }
+  snapshot = std::move(next);
   return atom::ok_v;
 }
 
-void catalog_state::erase(const uuid& partition) {
-  for (auto& [type, uuid_synopsis_map] : synopses_per_type) {
-    const auto num_erased = uuid_synopsis_map.erase(partition);
-    if (num_erased > 0) {
-      if (uuid_synopsis_map.empty()) {
-        synopses_per_type.erase(type);
-      }
-      return;
+void catalog_state::erase(const std::vector<uuid>& partitions) {
+  auto next = std::shared_ptr<catalog_snapshot>{};
+  auto updated = std::unordered_set<tenzir::type>{};
+  for (const auto& partition : partitions) {
+    const auto& current = next ? *next : *snapshot;
+    auto it = std::ranges::find_if(current.synopses_per_type,
+                                   [&](const auto& entry) {
+                                     return entry.second->contains(partition);
+                                   });
+    if (it == current.synopses_per_type.end()) {
+      continue;
+    }
+    auto type = it->first;
+    auto synopses
+      = std::make_shared<catalog_snapshot::synopsis_map>(*it->second);
+    synopses->erase(partition);
+    if (not next) {
+      next = std::make_shared<catalog_snapshot>(*snapshot);
+    }
+    if (synopses->empty()) {
+      next->synopses_per_type.erase(type);
+    } else {
+      next->synopses_per_type[type] = std::move(synopses);
+    }
+    updated.insert(std::move(type));
+  }
+  if (next) {
+    for (const auto& type : updated) {
+      update_columns(*next, type);
     }
+    snapshot = std::move(next);
   }
 }
 
-auto catalog_state::lookup(expression expr) const
-  -> caf::expected<catalog_lookup_result> {
-  auto start = stopwatch::now();
-  auto total_candidates = catalog_lookup_result{};
-  auto num_candidate_partitions = size_t{0};
-  auto num_candidate_events = size_t{0};
-  if (expr == caf::none) {
-    expr = trivially_true_expression();
+auto catalog_state::lookup(expression expr)
+  -> caf::result<catalog_lookup_result> {
+  const auto start = stopwatch::now();
+  auto normalized = normalize_for_lookup(std::move(expr));
+  if (not normalized) {
+    return std::move(normalized.error());
   }
-  auto normalized = normalize_and_validate(expr);
+  // Spread the schemas over the workers such that the ones with the most
+  // partitions are distributed evenly.
+  auto schemas = std::vector<std::pair<size_t, type>>{};
+  schemas.reserve(snapshot->synopses_per_type.size());
+  for (const auto& [type, partitions] : snapshot->synopses_per_type) {
+    schemas.emplace_back(partitions->size(), type);
+  }
+  if (schemas.empty()) {
+    return catalog_lookup_result{};
+  }
+  std::ranges::sort(schemas, std::ranges::greater{},
+                    &std::pair<size_t, type>::first);
+  const auto num_workers = std::clamp(
+    size_t{std::thread::hardware_concurrency()}, size_t{1}, schemas.size());
+  auto schemas_per_worker = std::vector<std::vector<type>>(num_workers);
+  for (auto i = size_t{0}; i < schemas.size(); ++i) {
+    schemas_per_worker[i % num_workers].push_back(
+      std::move(schemas[i].second));
+  }
+  auto workers = std::vector<catalog_lookup_actor>{};
+  workers.reserve(num_workers);
+  for (auto& worker_schemas : schemas_per_worker) {
+    workers.push_back(self->spawn(catalog_lookup, snapshot, *normalized,
+                                  std::move(worker_schemas)));
+  }
+  auto rp = self->make_response_promise<catalog_lookup_result>();
+  self
+    ->fan_out_request<caf::policy::select_all>(workers, caf::infinite,
+                                               atom::candidates_v)
+    .then(
+      [rp, start](std::vector<catalog_lookup_result> results) mutable {
+        auto result = catalog_lookup_result{};
+        for (auto& partial : results) {
+          result.candidate_infos.merge(partial.candidate_infos);
+        }
+        log_lookup(result, start);
+        rp.deliver(std::move(result));
+      },
+      [rp](const caf::error& err) mutable {
+        rp.deliver(err);
+      });
+  return rp;
+}
+
+auto catalog_snapshot::lookup(expression expr) const
+  -> caf::expected<catalog_lookup_result> {
+  const auto start = stopwatch::now();
+  auto normalized = normalize_for_lookup(std::move(expr));
   if (not normalized) {
-    return caf::make_error(ec::invalid_argument,
-                           fmt::format("{} failed to normalize and validate "
-                                       "epxression {}: {}",
-                                       *self, expr, normalized.error()));
+    return std::move(normalized.error());
   }
+  auto schemas = std::vector<type>{};
+  schemas.reserve(synopses_per_type.size());
   for (const auto& [type, _] : synopses_per_type) {
-    auto resolved = resolve(taxonomies, *normalized, type);
+    schemas.push_back(type);
+  }
+  auto result = lookup(*normalized, schemas);
+  if (result) {
+    log_lookup(*result, start);
+  }
+  return result;
+}
+
+auto catalog_snapshot::lookup(const expression& normalized,
+                              std::span<const type> schemas) const
+  -> caf::expected<catalog_lookup_result> {
+  auto total_candidates = catalog_lookup_result{};
+  for (const auto& type : schemas) {
+    auto resolved = resolve(*taxonomies, normalized, type);
     if (not resolved) {
       return caf::make_error(ec::invalid_argument,
-                             fmt::format("{} failed to resolve epxression {}: "
-                                         "{}",
-                                         *self, expr, resolved.error()));
+                             fmt::format("catalog failed to resolve "
+                                         "epxression {}: {}",
+                                         normalized, resolved.error()));
     }
-    auto pruned = prune(*resolved, unprunable_fields);
+    auto pruned = prune(*resolved, *unprunable_fields);
     auto candidates_per_type = lookup_impl(pruned, type);
     // Sort partitions by their max import time, returning the most recent
     // partitions first.
@@ -150,32 +364,22 @@ auto catalog_state::lookup(expression expr) const
               [&](const partition_info& lhs, const partition_info& rhs) {
                 return lhs.max_import_time > rhs.max_import_time;
               });
-    num_candidate_partitions += candidates_per_type.partition_infos.size();
-    num_candidate_events
-      += std::transform_reduce(candidates_per_type.partition_infos.begin(),
-                               candidates_per_type.partition_infos.end(),
-                               size_t{0}, std::plus<>{},
-                               [](const auto& partition) {
-                                 return partition.events;
-                               });
     total_candidates.candidate_infos[type] = std::move(candidates_per_type);
   }
-  auto delta = std::chrono::duration_cast<std::chrono::microseconds>(
-    stopwatch::now() - start);
-  TENZIR_VERBOSE("catalog found {} candidate partitions ({} events) in "
-                 "{} microseconds",
-                 num_candidate_partitions, num_candidate_events, delta.count());
-  TENZIR_TRACEPOINT(catalog_lookup, delta.count(), num_candidate_partitions);
   return total_candidates;
 }
 
-auto catalog_state::lookup_impl(const expression& expr,
-                                const type& schema) const
+auto catalog_snapshot::lookup_impl(const expression& expr,
+                                   const type& schema) const
   -> catalog_lookup_result::candidate_info {
   TENZIR_ASSERT(!is<caf::none_t>(expr));
   auto synopsis_map_per_type_it = synopses_per_type.find(schema);
   TENZIR_ASSERT(synopsis_map_per_type_it != synopses_per_type.end());
-  const auto& partition_synopses = synopsis_map_per_type_it->second;
+  const auto& partition_synopses = *synopsis_map_per_type_it->second;
+  auto columns_per_type_it = columns_per_type.find(schema);
+  TENZIR_ASSERT(columns_per_type_it != columns_per_type.end());
+  const auto& columns = *columns_per_type_it->second;
+  TENZIR_ASSERT(columns.size() == partition_synopses.size());
   // The partition UUIDs must be sorted, otherwise the invariants of the
   // inplace union and intersection algorithms are violated, leading to
   // wrong results. So all places where we return an assembled set must
@@ -184,15 +388,26 @@ auto catalog_state::lookup_impl(const expression& expr,
   // no separate sorting step is required.
   auto memoized_partitions = catalog_lookup_result::candidate_info{};
   auto all_partitions = [&] {
-    if (!memoized_partitions.partition_infos.empty()
-        || partition_synopses.empty()) {
+    if (!memoized_partitions.partition_infos.empty() || columns.size() == 0) {
       return memoized_partitions;
     }
-    for (const auto& [partition_id, synopsis] : partition_synopses) {
-      memoized_partitions.partition_infos.emplace_back(partition_id, *synopsis);
+    memoized_partitions.partition_infos.reserve(columns.size());
+    for (auto position = size_t{0}; position < columns.size(); ++position) {
+      memoized_partitions.partition_infos.push_back(columns.info(position));
     }
     return memoized_partitions;
   };
+  // Positions in the columns follow the order of the partition IDs, so the
+  // result is sorted as well.
+  auto to_candidates = [&](const synopsis_columns::candidate_mask& mask) {
+    auto result = catalog_lookup_result::candidate_info{};
+    for (auto position = size_t{0}; position < mask.size(); ++position) {
+      if (mask[position] != 0) {
+        result.partition_infos.push_back(columns.info(position));
+      }
+    }
+    return result;
+  };
   auto f = detail::overload{
     [&](const conjunction& x) -> catalog_lookup_result::candidate_info {
       TENZIR_ASSERT(!x.empty());
@@ -247,54 +462,66 @@ auto catalog_state::lookup_impl(const expression& expr,
       auto search = [&](auto match) {
         TENZIR_ASSERT(is<data>(x.rhs));
         const auto& rhs = as<data>(x.rhs);
-        catalog_lookup_result::candidate_info result;
-        // dont iterate through all synopses, rewrite lookup_impl to use a
-        // singular type all synopses loops -> relevant anymore? Use type as
-        // synopses key
-        for (const auto& [part_id, part_syn] : partition_synopses) {
-          for (const auto& [field, syn] : part_syn->field_synopses_) {
-            if (match(field)) {
-              // We need to prune the type's metadata here by converting it to
-              // a concrete type and back, because the type synopses are
-              // looked up independent from names and attributes.
-              auto prune = [&]<concrete_type T>(const T& x) {
-                return type{x};
-              };
-              auto cleaned_type = tenzir::match(field.type(), prune);
-              // We rely on having a field -> nullptr mapping here for the
-              // fields that don't have their own synopsis.
-              if (syn) {
-                auto opt = syn->lookup(x.op, make_view(rhs));
-                if (!opt || *opt) {
-                  TENZIR_TRACE("{} selects {} at predicate {}",
-                               detail::pretty_type_name(this), part_id, x);
-                  result.partition_infos.emplace_back(part_id, *part_syn);
-                  break;
-                }
-                // The field has no dedicated synopsis. Check if there is one
-                // for the type in general.
-              } else if (auto it = part_syn->type_synopses_.find(cleaned_type);
-                         it != part_syn->type_synopses_.end() && it->second) {
-                auto opt = it->second->lookup(x.op, make_view(rhs));
-                if (!opt || *opt) {
-                  TENZIR_TRACE("{} selects {} at predicate {}",
-                               detail::pretty_type_name(this), part_id, x);
-                  result.partition_infos.emplace_back(part_id, *part_syn);
-                  break;
-                }
-              } else {
-                // The catalog couldn't rule out this partition, so we have
-                // to include it in the result set.
-                result.partition_infos.emplace_back(part_id, *part_syn);
-                break;
+        auto candidates
+          = synopsis_columns::candidate_mask(columns.size(), uint8_t{0});
+        const auto fields = columns.fields();
+        for (auto field = size_t{0}; field < fields.size(); ++field) {
+          if (!match(fields[field])) {
+            continue;
+          }
+          // Fields with a min-max synopsis are answered by a single scan over
+          // the columns.
+          if (auto mask = columns.lookup(field, x.op, rhs)) {
+            for (auto position = size_t{0}; position < candidates.size();
+                 ++position) {
+              candidates[position] |= (*mask)[position];
+            }
+            continue;
+          }
+          // For all other fields we need to ask the synopses of the partitions
+          // that are not yet selected. We need to prune the type's metadata
+          // here by converting it to a concrete type and back, because the
+          // type synopses are looked up independent from names and
+          // attributes.
+          auto prune = [&]<concrete_type T>(const T& x) {
+            return type{x};
+          };
+          auto cleaned_type = tenzir::match(fields[field].type(), prune);
+          auto position = size_t{0};
+          for (const auto& [part_id, part_syn] : partition_synopses) {
+            auto& candidate = candidates[position++];
+            if (candidate != 0) {
+              continue;
+            }
+            const synopsis* syn = nullptr;
+            if (auto it = part_syn->field_synopses_.find(fields[field]);
+                it != part_syn->field_synopses_.end()) {
+              syn = it->second.get();
+            }
+            // The field has no dedicated synopsis. Check if there is one for
+            // the type in general.
+            if (!syn) {
+              if (auto it = part_syn->type_synopses_.find(cleaned_type);
+                  it != part_syn->type_synopses_.end()) {
+                syn = it->second.get();
               }
             }
+            // If there is no synopsis at all, the catalog couldn't rule out
+            // this partition, so we have to include it in the result set.
+            auto opt = syn ? syn->lookup(x.op, make_view(rhs))
+                           : std::optional<bool>{};
+            if (!opt || *opt) {
+              TENZIR_TRACE("{} selects {} at predicate {}",
+                           detail::pretty_type_name(this), part_id, x);
+              candidate = 1;
+            }
           }
         }
+        auto result = to_candidates(candidates);
         TENZIR_DEBUG("{} checked {} partitions for predicate {} and got {} "
                      "results",
-                     detail::pretty_type_name(this), synopses_per_type.size(),
-                     x, result.partition_infos.size());
+                     detail::pretty_type_name(this), columns.size(), x,
+                     result.partition_infos.size());
         // Some calling paths require the result to be sorted.
         TENZIR_ASSERT_EXPENSIVE(std::is_sorted(result.partition_infos.begin(),
                                                result.partition_infos.end()));
@@ -306,71 +533,35 @@ auto catalog_state::lookup_impl(const expression& expr,
           switch (lhs.kind) {
             case meta_extractor::schema: {
               // We don't have to look into the synopses for type queries, just
-              // at the schema names.
-              catalog_lookup_result::candidate_info result;
-              for (const auto& [part_id, part_syn] : partition_synopses) {
-                for (const auto& [fqf, _] : part_syn->field_synopses_) {
-                  // TODO: provide an overload for view of evaluate() so that
-                  // we can use string_view here. Fortunately type names are
-                  // short, so we're probably not hitting the allocator due to
-                  // SSO.
-                  if (evaluate(std::string{fqf.schema_name()}, x.op, d)) {
-                    result.partition_infos.emplace_back(part_id, *part_syn);
-                    break;
-                  }
-                }
+              // at the schema name, which is the same for all partitions.
+              // TODO: provide an overload for view of evaluate() so that we
+              // can use string_view here. Fortunately type names are short, so
+              // we're probably not hitting the allocator due to SSO.
+              if (evaluate(std::string{schema.name()}, x.op, d)) {
+                return all_partitions();
               }
-              TENZIR_ASSERT_EXPENSIVE(std::is_sorted(
-                result.partition_infos.begin(), result.partition_infos.end()));
-              return result;
+              return {};
             }
             case meta_extractor::schema_id: {
-              auto result = catalog_lookup_result::candidate_info{};
-              for (const auto& [part_id, part_syn] : partition_synopses) {
-                TENZIR_ASSERT_EXPENSIVE(part_syn->schema == schema);
-              }
               if (evaluate(schema.make_fingerprint(), x.op, d)) {
-                for (const auto& [part_id, part_syn] : partition_synopses) {
-                  result.partition_infos.emplace_back(part_id, *part_syn);
-                }
+                return all_partitions();
               }
-              TENZIR_ASSERT_EXPENSIVE(std::is_sorted(
-                result.partition_infos.begin(), result.partition_infos.end()));
-              return result;
+              return {};
             }
             case meta_extractor::import_time: {
-              catalog_lookup_result::candidate_info result;
-              for (const auto& [part_id, part_syn] : partition_synopses) {
-                TENZIR_ASSERT(
-                  part_syn->min_import_time <= part_syn->max_import_time,
-                  "encountered empty or moved-from partition synopsis");
-                auto ts = time_synopsis{
-                  part_syn->min_import_time,
-                  part_syn->max_import_time,
-                };
-                auto add = ts.lookup(x.op, as<tenzir::time>(d));
-                if (!add || *add) {
-                  result.partition_infos.emplace_back(part_id, *part_syn);
-                }
-              }
+              auto result = to_candidates(
+                columns.lookup_import_time(x.op, as<tenzir::time>(d)));
               TENZIR_ASSERT_EXPENSIVE(std::is_sorted(
                 result.partition_infos.begin(), result.partition_infos.end()));
               return result;
             }
             case meta_extractor::internal: {
-              auto result = catalog_lookup_result::candidate_info{};
-              for (const auto& [part_id, part_syn] : partition_synopses) {
-                auto internal = false;
-                if (part_syn->schema) {
-                  internal = part_syn->schema.attribute("internal").has_value();
-                }
-                if (evaluate(internal, x.op, d)) {
-                  result.partition_infos.emplace_back(part_id, *part_syn);
-                }
-              };
-              TENZIR_ASSERT_EXPENSIVE(std::is_sorted(
-                result.partition_infos.begin(), result.partition_infos.end()));
-              return result;
+              const auto internal
+                = schema && schema.attribute("internal").has_value();
+              if (evaluate(internal, x.op, d)) {
+                return all_partitions();
+              }
+              return {};
             }
           }
           TENZIR_WARN("{} cannot process meta extractor: {}",
@@ -453,31 +644,15 @@ auto catalog_state::lookup_impl(const expression& expr,
 
 auto catalog_state::memusage() const -> size_t {
   size_t result = 0;
-  for (const auto& [type, id_synopsis_map] : synopses_per_type) {
-    for (const auto& [id, synopsis] : id_synopsis_map) {
+  for (const auto& [type, id_synopsis_map] : snapshot->synopses_per_type) {
+    for (const auto& [id, synopsis] : *id_synopsis_map) {
       result += synopsis->memusage();
     }
   }
-  return result;
-}
-
-void catalog_state::update_unprunable_fields(const partition_synopsis& ps) {
-  for (auto const& [field, synopsis] : ps.field_synopses_) {
-    if (synopsis != nullptr && is<string_type>(field.type())) {
-      unprunable_fields.insert(std::string{field.name()});
-    }
+  for (const auto& [type, columns] : snapshot->columns_per_type) {
+    result += columns->memusage();
   }
-  // TODO/BUG: We also need to prevent pruning for enum types,
-  // which also use string literals for lookup. We must be even
-  // more strict here than with string fields, because incorrectly
-  // pruning string fields will only cause false positives, but
-  // incorrectly pruning enum fields can actually cause false negatives.
-  //
-  // else if (field.type() == enumeration_type{}) {
-  //   auto full_name = field.name();
-  //   for (auto suffix : detail::all_suffixes(full_name, "."))
-  //     unprunable_fields.insert(suffix);
-  // }
+  return result;
 }
 
 auto catalog(catalog_actor::stateful_pointer<catalog_state> self)
@@ -486,7 +661,11 @@ auto catalog(catalog_actor::stateful_pointer<catalog_state> self)
     caf::detail::set_thread_name("tnz.catalog");
   }
   self->state().self = self;
-  self->state().taxonomies.concepts = modules::concepts();
+  auto taxonomies = std::make_shared<tenzir::taxonomies>();
+  taxonomies->concepts = modules::concepts();
+  auto snapshot = std::make_shared<catalog_snapshot>();
+  snapshot->taxonomies = std::move(taxonomies);
+  self->state().snapshot = std::move(snapshot);
   return {
     [self](
       atom::merge,
@@ -499,10 +678,10 @@ auto catalog(catalog_actor::stateful_pointer<catalog_state> self)
     },
     [self](atom::get) -> std::vector<partition_synopsis_pair> {
       std::vector<partition_synopsis_pair> result;
-      result.reserve(self->state().synopses_per_type.size());
-      for (const auto& [type, id_synopsis_map] :
-           self->state().synopses_per_type) {
-        for (const auto& [id, synopsis] : id_synopsis_map) {
+      const auto& synopses_per_type = self->state().snapshot->synopses_per_type;
+      result.reserve(synopses_per_type.size());
+      for (const auto& [type, id_synopsis_map] : synopses_per_type) {
+        for (const auto& [id, synopsis] : *id_synopsis_map) {
           result.push_back({id, synopsis});
         }
       }
@@ -511,19 +690,19 @@ auto catalog(catalog_actor::stateful_pointer<catalog_state> self)
     [self](atom::get, const expression& filter)
       -> caf::result<std::vector<partition_synopsis_pair>> {
       auto result = std::vector<partition_synopsis_pair>{};
-      const auto candidates = self->state().lookup(filter);
+      const auto snapshot = self->state().snapshot;
+      const auto candidates = snapshot->lookup(filter);
       if (not candidates) {
         return candidates.error();
       }
       for (const auto& [schema, candidate] : candidates->candidate_infos) {
         const auto& partition_synopses
-          = self->state().synopses_per_type.find(schema);
-        TENZIR_ASSERT(partition_synopses
-                      != self->state().synopses_per_type.end());
+          = snapshot->synopses_per_type.find(schema);
+        TENZIR_ASSERT(partition_synopses != snapshot->synopses_per_type.end());
         for (const auto& partition : candidate.partition_infos) {
           const auto& synopsis
-            = partition_synopses->second.find(partition.uuid);
-          if (synopsis == partition_synopses->second.end()) {
+            = partition_synopses->second->find(partition.uuid);
+          if (synopsis == partition_synopses->second->end()) {
             continue;
           }
           result.push_back({synopsis->first, synopsis->second});
@@ -532,14 +711,12 @@ auto catalog(catalog_actor::stateful_pointer<catalog_state> self)
       return result;
     },
     [self](atom::erase, uuid partition) {
-      self->state().erase(partition);
+      self->state().erase({partition});
       return atom::ok_v;
     },
     [self](atom::replace, const std::vector<uuid>& old_uuids,
            std::vector<partition_synopsis_pair>& new_synopses) {
-      for (auto const& uuid : old_uuids) {
-        self->state().erase(uuid);
-      }
+      self->state().erase(old_uuids);
       return self->state().merge(std::move(new_synopses));
     },
     [self](atom::candidates, const tenzir::query_context& query_context)
@@ -548,8 +725,9 @@ auto catalog(catalog_actor::stateful_pointer<catalog_state> self)
       return self->state().lookup(query_context.expr);
     },
     [self](atom::get, uuid uuid) -> caf::result<partition_info> {
-      for (const auto& [type, synopses] : self->state().synopses_per_type) {
-        if (auto it = synopses.find(uuid); it != synopses.end()) {
+      for (const auto& [type, synopses] :
+           self->state().snapshot->synopses_per_type) {
+        if (auto it = synopses->find(uuid); it != synopses->end()) {
           return partition_info{uuid, *it->second};
         }
       }
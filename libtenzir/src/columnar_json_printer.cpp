@@ -0,0 +1,382 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/columnar_json_printer.hpp"
+
+#include "tenzir/arrow_table_slice.hpp"
+#include "tenzir/arrow_utils.hpp"
+#include "tenzir/concept/printable/std/chrono.hpp"
+#include "tenzir/concept/printable/tenzir/ip.hpp"
+#include "tenzir/concept/printable/tenzir/subnet.hpp"
+#include "tenzir/concepts.hpp"
+#include "tenzir/detail/assert.hpp"
+#include "tenzir/detail/base64.hpp"
+#include "tenzir/detail/escapers.hpp"
+#include "tenzir/detail/narrow.hpp"
+#include "tenzir/detail/string.hpp"
+#include "tenzir/table_slice.hpp"
+
+#include <arrow/array.h>
+#include <fmt/format.h>
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace tenzir {
+
+namespace {
+
+auto is_unstyled(const fmt::text_style& style) -> bool {
+  return not style.has_foreground() and not style.has_background()
+         and not style.has_emphasis();
+}
+
+auto append(std::vector<char>& out, std::string_view str) -> void {
+  out.insert(out.end(), str.begin(), str.end());
+}
+
+auto needs_escape(char c) -> bool {
+  const auto x = static_cast<unsigned char>(c);
+  return x < 0x20 or x == '"' or x == '\\' or x == 0x7f;
+}
+
+/// Returns the first character in `[first, last)` that must be escaped in a
+/// JSON string. Such characters are rare, so we test eight bytes at once with
+/// bit manipulation before looking at the individual bytes.
+auto find_escape(const char* first, const char* last) -> const char* {
+  constexpr auto ones = uint64_t{0x0101010101010101};
+  constexpr auto highs = ones * 0x80;
+  const auto has_less = [](uint64_t x, uint64_t n) {
+    return (x - ones * n) & ~x & highs;
+  };
+  const auto has_byte = [&](uint64_t x, uint64_t n) {
+    return has_less(x ^ (ones * n), 1);
+  };
+  while (last - first >= 8) {
+    auto x = uint64_t{};
+    std::memcpy(&x, first, sizeof(x));
+    if ((has_less(x, 0x20) | has_byte(x, '"') | has_byte(x, '\\')
+         | has_byte(x, 0x7f))
+        != 0) {
+      break;
+    }
+    first += 8;
+  }
+  while (first != last and not needs_escape(*first)) {
+    ++first;
+  }
+  return first;
+}
+
+auto append_string(std::vector<char>& out, std::string_view str) -> void {
+  out.push_back('"');
+  const auto* first = str.data();
+  const auto* const last = first + str.size();
+  while (first != last) {
+    const auto* escape = find_escape(first, last);
+    out.insert(out.end(), first, escape);
+    first = escape;
+    if (first != last) {
+      detail::json_escaper(first, std::back_inserter(out));
+    }
+  }
+  out.push_back('"');
+}
+
+template <class T>
+auto append_integer(std::vector<char>& out, T x) -> void {
+  auto buffer = std::array<char, 24>{};
+  const auto [end, ec] = std::to_chars(buffer.begin(), buffer.end(), x);
+  TENZIR_ASSERT(ec == std::errc{});
+  out.insert(out.end(), buffer.begin(), end);
+}
+
+auto append_double(std::vector<char>& out, double x) -> void {
+  switch (std::fpclassify(x)) {
+    case FP_NORMAL:
+    case FP_SUBNORMAL:
+    case FP_ZERO:
+      break;
+    default:
+      append(out, "null");
+      return;
+  }
+  if (double i; std::modf(x, &i) == 0.0) { // NOLINT
+    fmt::format_to(std::back_inserter(out), "{}.0", i);
+  } else {
+    fmt::format_to(std::back_inserter(out), "{}", x);
+  }
+}
+
+/// Appends a value that is printed with its regular printer as a string.
+template <class T>
+auto append_printed(std::vector<char>& out, const T& x) -> void {
+  out.push_back('"');
+  auto it = std::back_inserter(out);
+  const auto ok = make_printer<T>{}.print(it, x);
+  TENZIR_ASSERT(ok);
+  out.push_back('"');
+}
+
+/// Writes the values of an array that is bound once per batch.
+class writer {
+public:
+  virtual ~writer() noexcept = default;
+
+  virtual auto write(int64_t row, std::vector<char>& out) const -> void = 0;
+};
+
+auto make_writer(std::shared_ptr<arrow::Array> array,
+                 const columnar_json_printer::layout& layout,
+                 const json_printer_options& options)
+  -> std::unique_ptr<writer>;
+
+template <class Array>
+class value_writer final : public writer {
+public:
+  value_writer(std::shared_ptr<arrow::Array> array,
+               const json_printer_options& options)
+    : array_{std::move(array)},
+      typed_array_{static_cast<const Array&>(*array_)},
+      options_{options} {
+  }
+
+  auto write(int64_t row, std::vector<char>& out) const -> void override {
+    if (typed_array_.IsNull(row)) {
+      append(out, "null");
+      return;
+    }
+    if constexpr (std::same_as<Array, arrow::NullArray>) {
+      TENZIR_UNREACHABLE();
+    } else {
+      using value_type = type_to_data_t<type_from_arrow_t<Array>>;
+      const auto x = value_at(type_from_arrow_t<Array>{}, typed_array_, row);
+      if constexpr (std::same_as<value_type, bool>) {
+        append(out, x ? "true" : "false");
+      } else if constexpr (std::same_as<value_type, int64_t>
+                           or std::same_as<value_type, uint64_t>) {
+        append_integer(out, x);
+      } else if constexpr (std::same_as<value_type, enumeration>) {
+        append_integer(out, static_cast<unsigned>(x));
+      } else if constexpr (std::same_as<value_type, double>) {
+        append_double(out, x);
+      } else if constexpr (std::same_as<value_type, duration>) {
+        if (options_.numeric_durations) {
+          using seconds = std::chrono::duration<double>;
+          append_double(out, std::chrono::duration_cast<seconds>(x).count());
+        } else {
+          append_printed(out, x);
+        }
+      } else if constexpr (std::same_as<value_type, std::string>) {
+        append_string(out, x);
+      } else if constexpr (std::same_as<value_type, blob>) {
+        // Base64 never needs escaping, so we encode directly into the output.
+        const auto offset = out.size();
+        out.resize(offset + detail::base64::encoded_size(x.size()) + 2);
+        out[offset] = '"';
+        const auto size
+          = detail::base64::encode(out.data() + offset + 1, x.data(), x.size());
+        out.resize(offset + size + 1);
+        out.push_back('"');
+      } else {
+        static_assert(concepts::one_of<value_type, time, ip, subnet>);
+        append_printed(out, x);
+      }
+    }
+  }
+
+private:
+  std::shared_ptr<arrow::Array> array_;
+  const Array& typed_array_;
+  const json_printer_options& options_;
+};
+
+class record_writer final : public writer {
+public:
+  record_writer(std::shared_ptr<arrow::Array> array,
+                const columnar_json_printer::layout& layout,
+                const json_printer_options& options)
+    : array_{std::move(array)}, layout_{layout} {
+    const auto& struct_array = static_cast<const arrow::StructArray&>(*array_);
+    TENZIR_ASSERT(struct_array.num_fields()
+                  == detail::narrow<int>(layout_.children.size()));
+    for (auto i = 0; i < struct_array.num_fields(); ++i) {
+      fields_.push_back(
+        make_writer(struct_array.field(i), layout_.children[i], options));
+    }
+  }
+
+  auto write(int64_t row, std::vector<char>& out) const -> void override {
+    if (array_->IsNull(row)) {
+      append(out, "null");
+      return;
+    }
+    if (fields_.empty()) {
+      append(out, "{}");
+      return;
+    }
+    for (auto i = size_t{0}; i < fields_.size(); ++i) {
+      append(out, layout_.prefixes[i]);
+      fields_[i]->write(row, out);
+    }
+    append(out, layout_.suffix);
+  }
+
+private:
+  std::shared_ptr<arrow::Array> array_;
+  const columnar_json_printer::layout& layout_;
+  std::vector<std::unique_ptr<writer>> fields_;
+};
+
+class list_writer final : public writer {
+public:
+  list_writer(std::shared_ptr<arrow::Array> array,
+              const columnar_json_printer::layout& layout,
+              const json_printer_options& options)
+    : array_{std::move(array)},
+      list_array_{static_cast<const arrow::ListArray&>(*array_)},
+      layout_{layout} {
+    TENZIR_ASSERT(layout_.prefixes.size() == 2);
+    TENZIR_ASSERT(layout_.children.size() == 1);
+    values_
+      = make_writer(list_array_.values(), layout_.children.front(), options);
+  }
+
+  auto write(int64_t row, std::vector<char>& out) const -> void override {
+    if (list_array_.IsNull(row)) {
+      append(out, "null");
+      return;
+    }
+    const auto begin = list_array_.value_offset(row);
+    const auto end = list_array_.value_offset(row + 1);
+    if (begin == end) {
+      append(out, "[]");
+      return;
+    }
+    for (auto i = begin; i < end; ++i) {
+      append(out, layout_.prefixes[i == begin ? 0 : 1]);
+      values_->write(i, out);
+    }
+    append(out, layout_.suffix);
+  }
+
+private:
+  std::shared_ptr<arrow::Array> array_;
+  const arrow::ListArray& list_array_;
+  const columnar_json_printer::layout& layout_;
+  std::unique_ptr<writer> values_;
+};
+
+auto make_writer(std::shared_ptr<arrow::Array> array,
+                 const columnar_json_printer::layout& layout,
+                 const json_printer_options& options)
+  -> std::unique_ptr<writer> {
+  TENZIR_ASSERT(array);
+  const auto& ref = *array;
+  return match(
+    ref,
+    [&](const arrow::StructArray&) -> std::unique_ptr<writer> {
+      return std::make_unique<record_writer>(std::move(array), layout,
+                                             options);
+    },
+    [&](const arrow::ListArray&) -> std::unique_ptr<writer> {
+      return std::make_unique<list_writer>(std::move(array), layout, options);
+    },
+    [&](const arrow::MapArray&) -> std::unique_ptr<writer> {
+      TENZIR_UNREACHABLE();
+    },
+    [&]<class Array>(const Array&) -> std::unique_ptr<writer> {
+      return std::make_unique<value_writer<Array>>(std::move(array), options);
+    });
+}
+
+} // namespace
+
+auto columnar_json_printer::supports(const json_printer_options& options)
+  -> bool {
+  const auto& style = options.style;
+  const auto unstyled
+    = is_unstyled(style.null_) and is_unstyled(style.false_)
+      and is_unstyled(style.true_) and is_unstyled(style.number)
+      and is_unstyled(style.string) and is_unstyled(style.array)
+      and is_unstyled(style.object) and is_unstyled(style.field)
+      and is_unstyled(style.comma) and is_unstyled(style.duration)
+      and is_unstyled(style.time) and is_unstyled(style.subnet)
+      and is_unstyled(style.ip) and is_unstyled(style.blob)
+      and is_unstyled(style.colon);
+  return unstyled and not options.tql
+         and not options.trailing_commas.value_or(false)
+         and not options.omit_null_fields and not options.omit_nulls_in_lists
+         and not options.omit_empty_records and not options.omit_empty_lists;
+}
+
+columnar_json_printer::columnar_json_printer(const type& schema,
+                                             json_printer_options options)
+  : schema_{schema}, options_{std::move(options)} {
+  TENZIR_ASSERT(supports(options_));
+  TENZIR_ASSERT(is<record_type>(schema_));
+  layout_ = make_layout(schema_, 0);
+}
+
+auto columnar_json_printer::print(const table_slice& slice,
+                                  std::string_view separator,
+                                  std::vector<char>& out) const -> void {
+  TENZIR_ASSERT(slice.schema() == schema_);
+  if (slice.rows() == 0) {
+    return;
+  }
+  auto array = std::shared_ptr<arrow::Array>{
+    check(to_record_batch(slice)->ToStructArray())};
+  const auto writer = make_writer(std::move(array), layout_, options_);
+  const auto rows = detail::narrow<int64_t>(slice.rows());
+  writer->write(0, out);
+  for (auto row = int64_t{1}; row < rows; ++row) {
+    append(out, separator);
+    writer->write(row, out);
+  }
+}
+
+auto columnar_json_printer::make_layout(const type& t, size_t depth) const
+  -> layout {
+  const auto newline = [&](size_t depth) {
+    if (options_.oneline) {
+      return std::string{};
+    }
+    return '\n' + std::string(depth * options_.indentation, ' ');
+  };
+  return match(
+    t,
+    [&](const record_type& rt) {
+      auto result = layout{};
+      const auto colon = options_.oneline ? ":" : ": ";
+      for (auto&& field : rt.fields()) {
+        result.prefixes.push_back(fmt::format(
+          "{}{}{}{}", result.prefixes.empty() ? "{" : ",", newline(depth + 1),
+          detail::json_escape(field.name), colon));
+        result.children.push_back(make_layout(field.type, depth + 1));
+      }
+      result.suffix = newline(depth) + "}";
+      return result;
+    },
+    [&](const list_type& lt) {
+      auto result = layout{};
+      result.prefixes.push_back("[" + newline(depth + 1));
+      result.prefixes.push_back("," + newline(depth + 1));
+      result.children.push_back(make_layout(lt.value_type(), depth + 1));
+      result.suffix = newline(depth) + "]";
+      return result;
+    },
+    [](const auto&) {
+      return layout{};
+    });
+}
+
+} // namespace tenzir
@@ -0,0 +1,528 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/group_table.hpp"
+
+#include "tenzir/arrow_table_slice.hpp"
+#include "tenzir/as_bytes.hpp"
+#include "tenzir/detail/narrow.hpp"
+#include "tenzir/detail/type_traits.hpp"
+#include "tenzir/hash/hash.hpp"
+#include "tenzir/hash/xxhash.hpp"
+#include "tenzir/tag.hpp"
+#include "tenzir/type.hpp"
+
+#include <arrow/array.h>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace tenzir {
+
+namespace {
+
+constexpr auto empty_slot = std::numeric_limits<uint32_t>::max();
+
+constexpr auto initial_slots = size_t{64};
+
+/// The digest of a null value. This must not depend on the type of the column,
+/// as nulls of different types compare equal.
+constexpr auto null_digest = uint64_t{0x7f4a7c159e3779b9};
+
+auto combine(uint64_t seed, uint64_t digest) -> uint64_t {
+  return seed ^ (digest + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+using key_kind = detail::group_key_kind;
+
+auto kind_of(const type& ty) -> key_kind {
+  return match(ty, []<concrete_type Type>(const Type&) {
+    if constexpr (std::same_as<Type, int64_type>) {
+      return key_kind::int64;
+    } else if constexpr (std::same_as<Type, uint64_type>) {
+      return key_kind::uint64;
+    } else if constexpr (std::same_as<Type, double_type>) {
+      return key_kind::double_;
+    } else if constexpr (std::same_as<Type, bool_type>) {
+      return key_kind::bool_;
+    } else if constexpr (std::same_as<Type, string_type>) {
+      return key_kind::string;
+    } else if constexpr (std::same_as<Type, time_type>) {
+      return key_kind::time;
+    } else if constexpr (std::same_as<Type, duration_type>) {
+      return key_kind::duration;
+    } else {
+      return key_kind::other;
+    }
+  });
+}
+
+template <class Array, class Hash>
+auto hash_column(const Array& array, std::span<uint64_t> digests, Hash f)
+  -> void {
+  for (auto row = int64_t{0}; row < array.length(); ++row) {
+    const auto digest
+      = array.IsNull(row) ? null_digest : f(array.GetView(row));
+    digests[row] = combine(digests[row], digest);
+  }
+}
+
+/// Combines the digests of all values of a column into the given digests.
+auto hash_column(key_kind kind, const series& column,
+                 std::span<uint64_t> digests) -> void {
+  const auto hash_number = [](auto x) {
+    return xxh3_64::make(as_bytes(x));
+  };
+  switch (kind) {
+    case key_kind::null:
+      break;
+    case key_kind::int64:
+      return hash_column(as<arrow::Int64Array>(*column.array), digests,
+                         hash_number);
+    case key_kind::uint64:
+      return hash_column(as<arrow::UInt64Array>(*column.array), digests,
+                         hash_number);
+    case key_kind::double_:
+      return hash_column(as<arrow::DoubleArray>(*column.array), digests,
+                         [&](double x) {
+                           // Positive and negative zero compare equal, so
+                           // they must also hash equally.
+                           return hash_number(x == 0.0 ? 0.0 : x);
+                         });
+    case key_kind::bool_:
+      return hash_column(as<arrow::BooleanArray>(*column.array), digests,
+                         [&](bool x) {
+                           return hash_number(uint64_t{x});
+                         });
+    case key_kind::string:
+      return hash_column(as<arrow::StringArray>(*column.array), digests,
+                         [](std::string_view x) {
+                           return xxh3_64::make(as_bytes(x.data(), x.size()));
+                         });
+    case key_kind::time:
+      return hash_column(as<arrow::TimestampArray>(*column.array), digests,
+                         hash_number);
+    case key_kind::duration:
+      return hash_column(as<arrow::DurationArray>(*column.array), digests,
+                         hash_number);
+    case key_kind::other:
+      for (auto row = int64_t{0}; row < column.length(); ++row) {
+        const auto digest
+          = column.array->IsNull(row)
+              ? null_digest
+              : hash(value_at(column.type, *column.array, row));
+        digests[row] = combine(digests[row], digest);
+      }
+      return;
+  }
+  TENZIR_UNREACHABLE();
+}
+
+/// Computes the digest of a single value, consistent with `hash_column`.
+auto digest_of(const data& value) -> uint64_t {
+  const auto hash_number = [](auto x) {
+    return xxh3_64::make(as_bytes(x));
+  };
+  return match(value, [&]<class T>(const T& x) -> uint64_t {
+    if constexpr (std::same_as<T, caf::none_t>) {
+      return null_digest;
+    } else if constexpr (detail::is_any_v<T, int64_t, uint64_t>) {
+      return hash_number(x);
+    } else if constexpr (std::same_as<T, double>) {
+      return hash_number(x == 0.0 ? 0.0 : x);
+    } else if constexpr (std::same_as<T, bool>) {
+      return hash_number(uint64_t{x});
+    } else if constexpr (std::same_as<T, std::string>) {
+      return xxh3_64::make(as_bytes(x.data(), x.size()));
+    } else if constexpr (std::same_as<T, time>) {
+      return hash_number(x.time_since_epoch().count());
+    } else if constexpr (std::same_as<T, duration>) {
+      return hash_number(x.count());
+    } else {
+      return hash(make_view(value));
+    }
+  });
+}
+
+/// Estimates the number of bytes that a value occupies on the heap.
+auto heap_bytes(const data& value) -> size_t {
+  return match(value, [&]<class T>(const T& x) -> size_t {
+    if constexpr (detail::is_any_v<T, std::string, blob>) {
+      return x.size();
+    } else if constexpr (std::same_as<T, list>) {
+      auto result = x.size() * sizeof(data);
+      for (const auto& element : x) {
+        result += heap_bytes(element);
+      }
+      return result;
+    } else if constexpr (std::same_as<T, record>) {
+      auto result = x.size() * sizeof(record::value_type);
+      for (const auto& [field, element] : x) {
+        result += field.size() + heap_bytes(element);
+      }
+      return result;
+    } else {
+      return 0;
+    }
+  });
+}
+
+} // namespace
+
+namespace detail {
+
+auto group_key_column::append(group_key_kind kind, const series& column,
+                              int64_t row) -> void {
+  if (column.array->IsNull(row)) {
+    return push(key_kind::null, 0);
+  }
+  const auto value = [&]<class Array>(tag<Array>) {
+    return as<Array>(*column.array).Value(row);
+  };
+  switch (kind) {
+    case key_kind::null:
+      break;
+    case key_kind::int64:
+      return push(kind,
+                  std::bit_cast<uint64_t>(value(tag_v<arrow::Int64Array>)));
+    case key_kind::uint64:
+      return push(kind, value(tag_v<arrow::UInt64Array>));
+    case key_kind::double_:
+      return push(kind,
+                  std::bit_cast<uint64_t>(value(tag_v<arrow::DoubleArray>)));
+    case key_kind::bool_:
+      return push(kind, uint64_t{value(tag_v<arrow::BooleanArray>)});
+    case key_kind::string: {
+      const auto x = as<arrow::StringArray>(*column.array).GetView(row);
+      strings_.append(x.data(), x.size());
+      string_ends_.push_back(strings_.size());
+      return push(kind, string_ends_.size() - 1);
+    }
+    case key_kind::time:
+      return push(kind,
+                  std::bit_cast<uint64_t>(value(tag_v<arrow::TimestampArray>)));
+    case key_kind::duration:
+      return push(kind,
+                  std::bit_cast<uint64_t>(value(tag_v<arrow::DurationArray>)));
+    case key_kind::other:
+      others_.push_back(
+        materialize(value_at(column.type, *column.array, row)));
+      other_bytes_ += heap_bytes(others_.back());
+      return push(kind, others_.size() - 1);
+  }
+  TENZIR_UNREACHABLE();
+}
+
+auto group_key_column::append(const data& value) -> void {
+  match(value, [&]<class T>(const T& x) {
+    if constexpr (std::same_as<T, caf::none_t>) {
+      push(key_kind::null, 0);
+    } else if constexpr (std::same_as<T, int64_t>) {
+      push(key_kind::int64, std::bit_cast<uint64_t>(x));
+    } else if constexpr (std::same_as<T, uint64_t>) {
+      push(key_kind::uint64, x);
+    } else if constexpr (std::same_as<T, double>) {
+      push(key_kind::double_, std::bit_cast<uint64_t>(x));
+    } else if constexpr (std::same_as<T, bool>) {
+      push(key_kind::bool_, uint64_t{x});
+    } else if constexpr (std::same_as<T, std::string>) {
+      strings_.append(x);
+      string_ends_.push_back(strings_.size());
+      push(key_kind::string, string_ends_.size() - 1);
+    } else if constexpr (std::same_as<T, time>) {
+      push(key_kind::time,
+           std::bit_cast<uint64_t>(x.time_since_epoch().count()));
+    } else if constexpr (std::same_as<T, duration>) {
+      push(key_kind::duration, std::bit_cast<uint64_t>(x.count()));
+    } else {
+      others_.push_back(value);
+      other_bytes_ += heap_bytes(value);
+      push(key_kind::other, others_.size() - 1);
+    }
+  });
+}
+
+auto group_key_column::equals(uint32_t id, group_key_kind kind,
+                              const series& column, int64_t row) const
+  -> bool {
+  if (column.array->IsNull(row)) {
+    return kinds_[id] == key_kind::null;
+  }
+  if (kinds_[id] != kind) {
+    return false;
+  }
+  const auto payload = payloads_[id];
+  const auto value = [&]<class Array>(tag<Array>) {
+    return as<Array>(*column.array).Value(row);
+  };
+  switch (kind) {
+    case key_kind::null:
+      break;
+    case key_kind::int64:
+      return std::bit_cast<int64_t>(payload)
+             == value(tag_v<arrow::Int64Array>);
+    case key_kind::uint64:
+      return payload == value(tag_v<arrow::UInt64Array>);
+    case key_kind::double_:
+      // Compare as doubles, as positive and negative zero compare equal.
+      return std::bit_cast<double>(payload)
+             == value(tag_v<arrow::DoubleArray>);
+    case key_kind::bool_:
+      return (payload != 0) == value(tag_v<arrow::BooleanArray>);
+    case key_kind::string:
+      return string_at(payload)
+             == as<arrow::StringArray>(*column.array).GetView(row);
+    case key_kind::time:
+      return std::bit_cast<int64_t>(payload)
+             == value(tag_v<arrow::TimestampArray>);
+    case key_kind::duration:
+      return std::bit_cast<int64_t>(payload)
+             == value(tag_v<arrow::DurationArray>);
+    case key_kind::other:
+      return value_at(column.type, *column.array, row)
+             == make_view(others_[payload]);
+  }
+  TENZIR_UNREACHABLE();
+}
+
+auto group_key_column::equals(uint32_t id, const data& value) const -> bool {
+  const auto kind = kinds_[id];
+  const auto payload = payloads_[id];
+  return match(value, [&]<class T>(const T& x) -> bool {
+    if constexpr (std::same_as<T, caf::none_t>) {
+      return kind == key_kind::null;
+    } else if constexpr (std::same_as<T, int64_t>) {
+      return kind == key_kind::int64 and std::bit_cast<int64_t>(payload) == x;
+    } else if constexpr (std::same_as<T, uint64_t>) {
+      return kind == key_kind::uint64 and payload == x;
+    } else if constexpr (std::same_as<T, double>) {
+      return kind == key_kind::double_ and std::bit_cast<double>(payload) == x;
+    } else if constexpr (std::same_as<T, bool>) {
+      return kind == key_kind::bool_ and (payload != 0) == x;
+    } else if constexpr (std::same_as<T, std::string>) {
+      return kind == key_kind::string and string_at(payload) == x;
+    } else if constexpr (std::same_as<T, time>) {
+      return kind == key_kind::time
+             and std::bit_cast<int64_t>(payload)
+                   == x.time_since_epoch().count();
+    } else if constexpr (std::same_as<T, duration>) {
+      return kind == key_kind::duration
+             and std::bit_cast<int64_t>(payload) == x.count();
+    } else {
+      return kind == key_kind::other and others_[payload] == value;
+    }
+  });
+}
+
+auto group_key_column::get(uint32_t id) const -> data {
+  const auto payload = payloads_[id];
+  switch (kinds_[id]) {
+    case key_kind::null:
+      return data{};
+    case key_kind::int64:
+      return std::bit_cast<int64_t>(payload);
+    case key_kind::uint64:
+      return payload;
+    case key_kind::double_:
+      return std::bit_cast<double>(payload);
+    case key_kind::bool_:
+      return payload != 0;
+    case key_kind::string:
+      return std::string{string_at(payload)};
+    case key_kind::time:
+      return time{duration{std::bit_cast<int64_t>(payload)}};
+    case key_kind::duration:
+      return duration{std::bit_cast<int64_t>(payload)};
+    case key_kind::other:
+      return others_[payload];
+  }
+  TENZIR_UNREACHABLE();
+}
+
+auto group_key_column::approx_bytes() const -> size_t {
+  return kinds_.capacity() * sizeof(group_key_kind)
+         + payloads_.capacity() * sizeof(uint64_t) + strings_.capacity()
+         + string_ends_.capacity() * sizeof(size_t)
+         + others_.capacity() * sizeof(data) + other_bytes_;
+}
+
+auto group_key_column::push(group_key_kind kind, uint64_t payload) -> void {
+  kinds_.push_back(kind);
+  payloads_.push_back(payload);
+}
+
+auto group_key_column::string_at(uint64_t index) const -> std::string_view {
+  const auto begin = index == 0 ? size_t{0} : string_ends_[index - 1];
+  return std::string_view{strings_}.substr(begin, string_ends_[index] - begin);
+}
+
+} // namespace detail
+
+group_table::group_table(size_t num_keys)
+  : num_keys_{num_keys}, keys_(num_keys) {
+}
+
+auto group_table::insert(std::span<const multi_series> keys, int64_t rows)
+  -> std::vector<uint32_t> {
+  TENZIR_ASSERT(keys.size() == num_keys_);
+  auto result = std::vector<uint32_t>(detail::narrow<size_t>(rows));
+  if (rows == 0) {
+    return result;
+  }
+  // Without any key columns, every row belongs to the one and only group.
+  if (num_keys_ == 0) {
+    num_groups_ = 1;
+    return result;
+  }
+  if (slots_.empty()) {
+    slots_.resize(initial_slots, empty_slot);
+  }
+  auto digests = std::vector<uint64_t>(result.size());
+  auto kinds = std::vector<key_kind>(num_keys_);
+  auto offset = int64_t{0};
+  for (auto window : split_multi_series(keys)) {
+    const auto length = window[0].length();
+    auto window_digests = std::span{digests}.subspan(offset, length);
+    for (auto column = size_t{0}; column < num_keys_; ++column) {
+      kinds[column] = kind_of(window[column].type);
+      hash_column(kinds[column], window[column], window_digests);
+    }
+    for (auto row = int64_t{0}; row < length; ++row) {
+      const auto digest = window_digests[row];
+      const auto matches = [&](uint32_t id) {
+        if (digests_[id] != digest) {
+          return false;
+        }
+        for (auto column = size_t{0}; column < num_keys_; ++column) {
+          if (not keys_[column].equals(id, kinds[column], window[column],
+                                       row)) {
+            return false;
+          }
+        }
+        return true;
+      };
+      const auto mask = slots_.size() - 1;
+      auto slot = digest & mask;
+      while (slots_[slot] != empty_slot and not matches(slots_[slot])) {
+        slot = (slot + 1) & mask;
+      }
+      auto id = slots_[slot];
+      if (id == empty_slot) {
+        for (auto column = size_t{0}; column < num_keys_; ++column) {
+          keys_[column].append(kinds[column], window[column], row);
+        }
+        id = add_group(slot, digest);
+      }
+      result[offset + row] = id;
+    }
+    offset += length;
+  }
+  return result;
+}
+
+auto group_table::insert(std::span<const data> key) -> uint32_t {
+  TENZIR_ASSERT(key.size() == num_keys_);
+  if (num_keys_ == 0) {
+    num_groups_ = 1;
+    return 0;
+  }
+  if (slots_.empty()) {
+    slots_.resize(initial_slots, empty_slot);
+  }
+  auto digest = uint64_t{0};
+  for (const auto& value : key) {
+    digest = combine(digest, digest_of(value));
+  }
+  const auto mask = slots_.size() - 1;
+  auto slot = digest & mask;
+  while (slots_[slot] != empty_slot) {
+    const auto id = slots_[slot];
+    const auto matches = [&] {
+      for (auto column = size_t{0}; column < num_keys_; ++column) {
+        if (not keys_[column].equals(id, key[column])) {
+          return false;
+        }
+      }
+      return true;
+    };
+    if (digests_[id] == digest and matches()) {
+      return id;
+    }
+    slot = (slot + 1) & mask;
+  }
+  for (auto column = size_t{0}; column < num_keys_; ++column) {
+    keys_[column].append(key[column]);
+  }
+  return add_group(slot, digest);
+}
+
+auto group_table::size() const -> size_t {
+  return num_groups_;
+}
+
+auto group_table::empty() const -> bool {
+  return num_groups_ == 0;
+}
+
+auto group_table::key(uint32_t id) const -> std::vector<data> {
+  TENZIR_ASSERT(id < num_groups_);
+  auto result = std::vector<data>{};
+  result.reserve(num_keys_);
+  for (const auto& column : keys_) {
+    result.push_back(column.get(id));
+  }
+  return result;
+}
+
+auto group_table::digest(uint32_t id) const -> uint64_t {
+  TENZIR_ASSERT(id < num_groups_);
+  // Without any key columns, there is only a single group and no digests.
+  return num_keys_ == 0 ? 0 : digests_[id];
+}
+
+auto group_table::approx_bytes() const -> size_t {
+  auto result = slots_.capacity() * sizeof(uint32_t)
+                + digests_.capacity() * sizeof(uint64_t);
+  for (const auto& column : keys_) {
+    result += column.approx_bytes();
+  }
+  return result;
+}
+
+auto group_table::clear() -> void {
+  num_groups_ = 0;
+  slots_ = {};
+  digests_ = {};
+  keys_ = std::vector<detail::group_key_column>(num_keys_);
+}
+
+auto group_table::add_group(size_t slot, uint64_t digest) -> uint32_t {
+  const auto id = detail::narrow<uint32_t>(num_groups_++);
+  digests_.push_back(digest);
+  slots_[slot] = id;
+  // Keep the load factor at or below one half.
+  if (num_groups_ * 2 > slots_.size()) {
+    grow();
+  }
+  return id;
+}
+
+auto group_table::grow() -> void {
+  slots_.assign(slots_.size() * 2, empty_slot);
+  const auto mask = slots_.size() - 1;
+  for (auto id = uint32_t{0}; id < num_groups_; ++id) {
+    auto slot = digests_[id] & mask;
+    while (slots_[slot] != empty_slot) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = id;
+  }
+}
+
+} // namespace tenzir
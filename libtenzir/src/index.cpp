@@ -30,6 +30,8 @@
 #include "tenzir/detail/narrow.hpp"
 #include "tenzir/detail/weak_run_delayed.hpp"
 #include "tenzir/error.hpp"
+#include "tenzir/fbs/catalog_snapshot.hpp"
+#include "tenzir/fbs/flatbuffer_container.hpp"
 #include "tenzir/fbs/index.hpp"
 #include "tenzir/fbs/partition.hpp"
 #include "tenzir/fbs/partition_transform.hpp"
@@ -44,6 +46,7 @@
 #include "tenzir/partition_synopsis.hpp"
 #include "tenzir/partition_transformer.hpp"
 #include "tenzir/passive_partition.hpp"
+#include "tenzir/series_builder.hpp"
 #include "tenzir/shutdown.hpp"
 #include "tenzir/status.hpp"
 #include "tenzir/table_slice.hpp"
@@ -232,7 +235,7 @@ pack(flatbuffers::FlatBufferBuilder& builder, const index_state& state) {
                "uuids of maybe persisted partitions",
                state.persisted_partitions.size(), state.unpersisted.size());
   std::vector<flatbuffers::Offset<fbs::LegacyUUID>> partition_offsets;
-  for (const auto& uuid : state.persisted_partitions) {
+  for (const auto& [uuid, _] : state.persisted_partitions) {
     if (auto uuid_fb = pack(builder, uuid)) {
       partition_offsets.push_back(*uuid_fb);
     } else {
@@ -318,10 +321,206 @@ size_t partition_factory::materializations() const {
   return materializations_;
 }
 
+// -- partition_weigher --------------------------------------------------------
+
+namespace {
+
+/// The number of bytes that a passive partition loads, according to the sizes
+/// of its files that the partition synopsis records.
+auto partition_size(const partition_synopsis& synopsis) -> size_t {
+  return synopsis.indexes_file.size + synopsis.store_file.size;
+}
+
+} // namespace
+
+partition_weigher::partition_weigher(index_state& state) : state_{state} {
+  // nop
+}
+
+size_t partition_weigher::operator()(const uuid& id,
+                                     const partition_actor&) const {
+  // We weigh partitions by the file sizes recorded when persisting them
+  // instead of asking the filesystem, as the cache weighs every partition it
+  // loads.
+  const auto it = state_.persisted_partitions.find(id);
+  const auto result
+    = it != state_.persisted_partitions.end() ? it->second : size_t{0};
+  // Partitions whose sizes we do not know still occupy some memory, so we
+  // never weigh them as free.
+  return std::max(result, size_t{1});
+}
+
+// -- partition cache metrics --------------------------------------------------
+
+namespace {
+
+/// The counters of the partition cache at the time of the last metrics
+/// emission, used to report deltas.
+struct partition_cache_counters {
+  size_t hits = {};
+  size_t misses = {};
+  size_t evictions = {};
+};
+
+auto make_partition_cache_metrics_builder() -> series_builder {
+  return series_builder{type{
+    "tenzir.metrics.partition_cache",
+    record_type{
+      {"timestamp", time_type{}},
+      {"hits", uint64_type{}},
+      {"misses", uint64_type{}},
+      {"evictions", uint64_type{}},
+      {"entries", uint64_type{}},
+      {"bytes", uint64_type{}},
+      {"capacity", uint64_type{}},
+    },
+    {{"internal"}},
+  }};
+}
+
+template <class Cache>
+auto generate_partition_cache_metrics(series_builder& builder,
+                                      const Cache& cache,
+                                      partition_cache_counters& previous)
+  -> table_slice {
+  auto metric = builder.record();
+  metric.field("timestamp", time::clock::now());
+  metric.field("hits", uint64_t{cache.hits() - previous.hits});
+  metric.field("misses", uint64_t{cache.misses() - previous.misses});
+  metric.field("evictions", uint64_t{cache.evictions() - previous.evictions});
+  metric.field("entries", uint64_t{cache.size()});
+  metric.field("bytes", uint64_t{cache.weight()});
+  metric.field("capacity", uint64_t{cache.max_size()});
+  previous = {
+    .hits = cache.hits(),
+    .misses = cache.misses(),
+    .evictions = cache.evictions(),
+  };
+  return builder.finish_assert_one_slice();
+}
+
+} // namespace
+
+// -- catalog snapshot ---------------------------------------------------------
+
+auto load_catalog_snapshot(const std::filesystem::path& path)
+  -> std::unordered_map<uuid, chunk_ptr> {
+  auto result = std::unordered_map<uuid, chunk_ptr>{};
+  auto err = std::error_code{};
+  if (not std::filesystem::exists(path, err)) {
+    return result;
+  }
+  auto chunk = chunk::mmap(path);
+  if (not chunk) {
+    TENZIR_WARN("failed to mmap catalog snapshot at {}: {}", path,
+                chunk.error());
+    return result;
+  }
+  auto container = fbs::flatbuffer_container{std::move(*chunk)};
+  if (not container or container.size() == 0) {
+    TENZIR_WARN("ignoring malformed catalog snapshot at {}", path);
+    return result;
+  }
+  auto snapshot
+    = flatbuffer<fbs::CatalogSnapshot>::make(container.get_raw(0));
+  if (not snapshot) {
+    TENZIR_WARN("ignoring malformed catalog snapshot at {}: {}", path,
+                snapshot.error());
+    return result;
+  }
+  if ((*snapshot)->catalog_snapshot_type()
+      != fbs::catalog_snapshot::CatalogSnapshot::v0) {
+    TENZIR_WARN("ignoring catalog snapshot at {} with unknown version", path);
+    return result;
+  }
+  const auto* partitions
+    = (*snapshot)->catalog_snapshot_as_v0()->partitions();
+  if (not partitions or partitions->size() + 1 != container.size()) {
+    TENZIR_WARN("ignoring inconsistent catalog snapshot at {}", path);
+    return result;
+  }
+  result.reserve(partitions->size());
+  for (size_t i = 0; i < partitions->size(); ++i) {
+    auto segment = container.get_raw(i + 1);
+    if (segment->size() == 0) {
+      continue;
+    }
+    result.emplace(uuid::from_flatbuffer(*partitions->Get(i)),
+                   std::move(segment));
+  }
+  return result;
+}
+
+auto write_catalog_snapshot(
+  const std::filesystem::path& path,
+  std::vector<std::pair<uuid, std::filesystem::path>> partitions)
+  -> caf::expected<size_t> {
+  // The synopses of partitions that were already part of the previous
+  // snapshot are copied from there, which only requires a single mapping.
+  auto previous = load_catalog_snapshot(path);
+  std::sort(partitions.begin(), partitions.end());
+  auto builder = flatbuffers::FlatBufferBuilder{};
+  auto partition_offsets
+    = std::vector<flatbuffers::Offset<fbs::LegacyUUID>>{};
+  partition_offsets.reserve(partitions.size());
+  for (const auto& [partition, _] : partitions) {
+    TRY(auto offset, pack(builder, partition));
+    partition_offsets.push_back(offset);
+  }
+  auto partitions_offset = builder.CreateVector(partition_offsets);
+  auto v0_builder = fbs::catalog_snapshot::v0Builder{builder};
+  v0_builder.add_partitions(partitions_offset);
+  auto v0_offset = v0_builder.Finish();
+  auto snapshot_builder = fbs::CatalogSnapshotBuilder{builder};
+  snapshot_builder.add_catalog_snapshot_type(
+    fbs::catalog_snapshot::CatalogSnapshot::v0);
+  snapshot_builder.add_catalog_snapshot(v0_offset.Union());
+  fbs::FinishCatalogSnapshotBuffer(builder, snapshot_builder.Finish());
+  auto header = fbs::release(builder);
+  // We add the synopsis files one by one so that we never hold more than one
+  // mapping for them at a time.
+  auto expected_size = header->size();
+  for (const auto& [partition, synopsis_path] : partitions) {
+    if (auto it = previous.find(partition); it != previous.end()) {
+      expected_size += it->second->size();
+    } else {
+      auto err = std::error_code{};
+      const auto size = std::filesystem::file_size(synopsis_path, err);
+      expected_size += err ? 0 : size;
+    }
+  }
+  auto container_builder = fbs::flatbuffer_container_builder{expected_size};
+  container_builder.add(as_bytes(header));
+  for (const auto& [partition, synopsis_path] : partitions) {
+    if (auto it = previous.find(partition); it != previous.end()) {
+      container_builder.add(as_bytes(it->second));
+    } else if (auto chunk = chunk::mmap(synopsis_path)) {
+      container_builder.add(as_bytes(*chunk));
+    } else {
+      // The empty segment makes the next startup fall back to reading the
+      // synopsis file.
+      TENZIR_DEBUG("skipping synopsis of partition {} in catalog snapshot: {}",
+                   partition, chunk.error());
+      container_builder.add({});
+    }
+  }
+  auto container = std::move(container_builder)
+                     .finish(fbs::CatalogSnapshotIdentifier());
+  // Releasing the mappings of the previous snapshot before replacing it is
+  // not required on POSIX systems, but it keeps the peak memory usage low.
+  previous.clear();
+  const auto snapshot = std::move(container).dissolve();
+  if (auto err = io::save(path, as_bytes(snapshot))) {
+    return err;
+  }
+  return partitions.size();
+}
+
 // -- index_state --------------------------------------------------------------
 
 index_state::index_state(index_actor::pointer self)
-  : self{self}, inmem_partitions{0, partition_factory{*this}} {
+  : self{self},
+    inmem_partitions{0, partition_factory{*this}, partition_weigher{*this}} {
 }
 
 // -- persistence --------------------------------------------------------------
@@ -362,6 +561,10 @@ std::string index_state::transformer_partition_synopsis_path_template() const {
   return (dir / "markers" / "{:l}.mdx").string();
 }
 
+std::filesystem::path index_state::catalog_snapshot_path() const {
+  return synopsisdir / "catalog.bin";
+}
+
 caf::error index_state::load_from_disk() {
   // We dont use the filesystem actor here because this function is only
   // called once during startup, when no other actors exist yet.
@@ -534,6 +737,18 @@ caf::error index_state::load_from_disk() {
     }
     for (auto const& store_file :
          std::filesystem::directory_iterator{store_path}) {
+      // Staging files belong to active stores that did not finish before the
+      // node shut down, so their contents are lost anyway.
+      if (store_file.path().extension() == ".tmp") {
+        TENZIR_DEBUG("{} deletes leftover staging file {}", *self,
+                     store_file.path());
+        std::filesystem::remove(store_file.path(), err);
+        if (err) {
+          TENZIR_WARN("{} failed to delete leftover staging file {}: {}",
+                      *self, store_file.path(), err.message());
+        }
+        continue;
+      }
       tenzir::uuid store_uuid{};
       if (!parsers::uuid(store_file.path().stem().string(), store_uuid)) {
         continue;
@@ -542,6 +757,11 @@ caf::error index_state::load_from_disk() {
     }
     return result;
   }();
+  // Synopses contained in the catalog snapshot don't need to be read from
+  // their individual files. The synopsis files of partitions created after
+  // the snapshot act as its append log.
+  auto snapshot_synopses = load_catalog_snapshot(catalog_snapshot_path());
+  auto num_snapshot_synopses = size_t{0};
   // Now try to load the partitions - with a progress indicator.
   for (size_t idx = 0; idx < partitions.size(); ++idx) {
     auto partition_uuid = partitions[idx];
@@ -549,14 +769,24 @@ caf::error index_state::load_from_disk() {
       auto part_path = partition_path(partition_uuid);
       TENZIR_TRACE("{} unpacks partition {} ({}/{})", *self, partition_uuid,
                    idx, partitions.size());
-      // Generate external partition synopsis file if it doesn't exist.
       auto synopsis_path = partition_synopsis_path(partition_uuid);
-      if (!exists(synopsis_path)) {
-        if (auto error = extract_partition_synopsis(part_path, synopsis_path)) {
-          return error;
+      auto chunk = chunk_ptr{};
+      if (auto it = snapshot_synopses.find(partition_uuid);
+          it != snapshot_synopses.end()) {
+        chunk = std::move(it->second);
+        snapshot_synopses.erase(it);
+        ++num_snapshot_synopses;
+      } else {
+        // Generate external partition synopsis file if it doesn't exist.
+        if (!exists(synopsis_path)) {
+          if (auto error
+              = extract_partition_synopsis(part_path, synopsis_path)) {
+            return error;
+          }
         }
+        TRY(chunk, chunk::mmap(synopsis_path));
+        catalog_snapshot_outdated = true;
       }
-      TRY(auto chunk, chunk::mmap(synopsis_path));
       TRY(const auto ps_flatbuffer,
           flatbuffer<fbs::PartitionSynopsis>::make(std::move(chunk)));
       partition_synopsis_ptr ps = caf::make_copy_on_write<partition_synopsis>();
@@ -621,7 +851,7 @@ caf::error index_state::load_from_disk() {
           };
         }
       }
-      persisted_partitions.emplace(partition_uuid);
+      persisted_partitions.emplace(partition_uuid, partition_size(*ps));
       synopses->emplace(partition_uuid, std::move(ps));
       return caf::none;
     }();
@@ -630,6 +860,13 @@ caf::error index_state::load_from_disk() {
                      partition_uuid, error);
     }
   }
+  // Snapshot entries for partitions that no longer exist are dropped when
+  // writing the next snapshot.
+  if (not snapshot_synopses.empty()) {
+    catalog_snapshot_outdated = true;
+  }
+  TENZIR_VERBOSE("{} read {}/{} partition synopses from the catalog snapshot",
+                 *self, num_snapshot_synopses, partitions.size());
   //  Recommend the user to run 'tenzir-ctl rebuild' if any partition syopses
   //  are outdated. We need to nudge them a bit so we can drop support for older
   //  partition versions more freely.
@@ -662,6 +899,7 @@ caf::error index_state::load_from_disk() {
           rp.delegate(static_cast<index_actor>(self), atom::evaluate_v,
                       std::move(query_context));
         }
+        write_catalog_snapshot();
       },
       [this](caf::error& err) {
         TENZIR_ERROR("{} failed to load catalog state from disk: {}", *self,
@@ -692,6 +930,46 @@ void index_state::flush_to_disk() {
       });
 }
 
+void index_state::write_catalog_snapshot() {
+  if (not catalog_snapshot_outdated or writing_catalog_snapshot) {
+    return;
+  }
+  auto partitions = std::vector<std::pair<uuid, std::filesystem::path>>{};
+  partitions.reserve(persisted_partitions.size());
+  for (const auto& [partition, _] : persisted_partitions) {
+    partitions.emplace_back(partition, partition_synopsis_path(partition));
+  }
+  catalog_snapshot_outdated = false;
+  writing_catalog_snapshot = true;
+  // Building the snapshot maps and copies the synopses of all partitions that
+  // are not yet part of the previous one, so we do that in a detached actor
+  // to keep the index responsive.
+  auto writer = self->spawn<caf::detached>(
+    [path = catalog_snapshot_path(), partitions = std::move(partitions)](
+      caf::event_based_actor* writer) mutable -> caf::behavior {
+      return {
+        [writer, path = std::move(path), partitions = std::move(partitions)](
+          atom::write) mutable -> caf::result<size_t> {
+          writer->quit();
+          return tenzir::write_catalog_snapshot(path, std::move(partitions));
+        },
+      };
+    });
+  self->mail(atom::write_v)
+    .request(writer, caf::infinite)
+    .then(
+      [this](size_t num_partitions) {
+        TENZIR_VERBOSE("{} wrote catalog snapshot with {} partitions", *self,
+                       num_partitions);
+        writing_catalog_snapshot = false;
+      },
+      [this](const caf::error& err) {
+        TENZIR_WARN("{} failed to write catalog snapshot: {}", *self, err);
+        writing_catalog_snapshot = false;
+        catalog_snapshot_outdated = true;
+      });
+}
+
 // -- inbound path -----------------------------------------------------------
 
 void index_state::handle_slice(table_slice x) {
@@ -816,7 +1094,8 @@ void index_state::decommission_active_partition(
                   .send(listener);
               }
               unpersisted.erase(id);
-              persisted_partitions.emplace(id);
+              persisted_partitions.emplace(id, partition_size(*ps));
+              catalog_snapshot_outdated = true;
               self->send_exit(actor, caf::exit_reason::normal);
               if (completion) {
                 completion(caf::none);
@@ -1064,22 +1343,22 @@ index(index_actor::stateful_pointer<index_state> self,
       filesystem_actor filesystem, catalog_actor catalog,
       const std::filesystem::path& dir, std::string store_backend,
       size_t partition_capacity, duration active_partition_timeout,
-      size_t max_inmem_partitions, size_t taste_partitions,
+      size_t partition_cache_size, size_t taste_partitions,
       size_t max_concurrent_partition_lookups,
       const std::filesystem::path& catalog_dir, index_config index_config) {
   TENZIR_TRACE("index {} {} {} {} {} {} {} {} {} {}", TENZIR_ARG(self->id()),
                TENZIR_ARG(filesystem), TENZIR_ARG(dir),
                TENZIR_ARG(partition_capacity),
                TENZIR_ARG(active_partition_timeout),
-               TENZIR_ARG(max_inmem_partitions), TENZIR_ARG(taste_partitions),
+               TENZIR_ARG(partition_cache_size), TENZIR_ARG(taste_partitions),
                TENZIR_ARG(max_concurrent_partition_lookups),
                TENZIR_ARG(catalog_dir), TENZIR_ARG(index_config));
   if (self->getf(caf::scheduled_actor::is_detached_flag)) {
     caf::detail::set_thread_name("tnz.index");
   }
   TENZIR_VERBOSE("{} initializes index in {} with a maximum partition "
-                 "size of {} events and {} resident partitions",
-                 *self, dir, partition_capacity, max_inmem_partitions);
+                 "size of {} events and a partition cache of {} bytes",
+                 *self, dir, partition_capacity, partition_cache_size);
   self->state().index_opts["cardinality"] = partition_capacity;
   self->state().synopsis_opts = std::move(index_config);
   if (dir != catalog_dir) {
@@ -1113,7 +1392,8 @@ index(index_actor::stateful_pointer<index_state> self,
   self->state().taste_partitions = taste_partitions;
   self->state().inmem_partitions.factory().filesystem()
     = self->state().filesystem;
-  self->state().inmem_partitions.resize(max_inmem_partitions);
+  self->state().partition_cache_size = partition_cache_size;
+  self->state().inmem_partitions.resize(partition_cache_size);
   // Read persistent state.
   if (auto err = self->state().load_from_disk()) {
     TENZIR_ERROR("{} failed to load index state from disk: {}", *self,
@@ -1121,10 +1401,18 @@ index(index_actor::stateful_pointer<index_state> self,
     self->quit(err);
     return index_actor::behavior_type::make_empty_behavior();
   }
+  // The first snapshot is written once the catalog finished loading.
+  detail::weak_run_delayed_loop(
+    self, defaults::catalog_snapshot_interval,
+    [self] {
+      self->state().write_catalog_snapshot();
+    },
+    false);
   detail::weak_run_delayed_loop(
     self, defaults::metrics_interval,
-    [self, actor_metrics_builder
-           = detail::make_actor_metrics_builder()]() mutable {
+    [self, actor_metrics_builder = detail::make_actor_metrics_builder(),
+     partition_cache_metrics_builder = make_partition_cache_metrics_builder(),
+     previous = partition_cache_counters{}]() mutable {
       const auto importer
         = self->system().registry().get<importer_actor>("tenzir.importer");
       // There exists a very unlikely scenario where the importer was not
@@ -1138,6 +1426,11 @@ index(index_actor::stateful_pointer<index_state> self,
       }
       self->mail(detail::generate_actor_metrics(actor_metrics_builder, self))
         .send(importer);
+      self
+        ->mail(generate_partition_cache_metrics(
+          partition_cache_metrics_builder, self->state().inmem_partitions,
+          previous))
+        .send(importer);
     });
   return {
     [self](atom::done, uuid partition_id) {
@@ -1340,6 +1633,14 @@ index(index_actor::stateful_pointer<index_state> self,
                    "activate {} partitions for query {}",
                    *self, num_scheduled, num_partitions, query_id);
     },
+    [self](atom::load, uuid partition_id) -> caf::result<partition_actor> {
+      if (not self->state().persisted_partitions.contains(partition_id)) {
+        return caf::make_error(ec::lookup_error,
+                               fmt::format("{} has no persisted partition {}",
+                                           *self, partition_id));
+      }
+      return self->state().inmem_partitions.get_or_load(partition_id);
+    },
     [self](atom::erase, uuid partition_id) -> caf::result<atom::done> {
       TENZIR_VERBOSE("{} erases partition {}", *self, partition_id);
       auto rp = self->make_response_promise<atom::done>();
@@ -1363,6 +1664,7 @@ index(index_actor::stateful_pointer<index_state> self,
             TENZIR_DEBUG("{} erased partition {} from catalog", *self,
                          partition_id);
             self->state().persisted_partitions.erase(partition_id);
+            self->state().catalog_snapshot_outdated = true;
             // We don't remove the partition from the queue directly because the
             // query API requires clients to keep track of the number of
             // candidate partitions. Removing the partition from the queue
@@ -1405,6 +1707,9 @@ index(index_actor::stateful_pointer<index_state> self,
             auto store_path = store_path_for_partition(self->state().dir / "..",
                                                        partition_id);
             if (store_path) {
+              // Readers that still hold the cached partition may finish their
+              // queries, but no new query must reach the erased partition.
+              self->state().inmem_partitions.drop(partition_id);
               erase_dense_index_file();
               rp.delegate(self->state().filesystem, atom::erase_v, *store_path);
               return;
@@ -1692,8 +1997,10 @@ index(index_actor::stateful_pointer<index_state> self,
                                   // persisted partitions.
                                   for (auto const& aps : apsv) {
                                     self->state().persisted_partitions.emplace(
-                                      aps.uuid);
+                                      aps.uuid, partition_size(*aps.synopsis));
                                   }
+                                  self->state().catalog_snapshot_outdated
+                                    = true;
                                   self->state().flush_to_disk();
                                   deliver(std::move(result));
                                 },
@@ -1711,8 +2018,9 @@ index(index_actor::stateful_pointer<index_state> self,
                                apsv](atom::ok) mutable {
                                 for (auto const& aps : apsv) {
                                   self->state().persisted_partitions.emplace(
-                                    aps.uuid);
+                                    aps.uuid, partition_size(*aps.synopsis));
                                 }
+                                self->state().catalog_snapshot_outdated = true;
                                 self->state().flush_to_disk();
                                 self->mail(atom::erase_v, old_partition_ids)
                                   .request(static_cast<index_actor>(self),
@@ -68,4 +68,34 @@ bool should_create_partition_index(
   return true;
 }
 
+bool should_create_value_index(const qualified_record_field& index_qf,
+                               const std::vector<index_config::rule>& rules) {
+  for (const auto& rule : rules) {
+    if (should_use_rule(rule.targets, index_qf)) {
+      return rule.create_value_index;
+    }
+  }
+  return false;
+}
+
+std::optional<offset>
+find_sort_field(const type& schema, const std::vector<std::string>& targets) {
+  const auto* schema_rt = try_as<record_type>(&schema);
+  if (!schema_rt) {
+    return std::nullopt;
+  }
+  for (const auto& target : targets) {
+    for (auto&& leaf : schema_rt->leaves()) {
+      if (!is<time_type>(leaf.field.type)) {
+        continue;
+      }
+      if (is_target_applicable(qualified_record_field{schema, leaf.index},
+                               target)) {
+        return leaf.index;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
 } // namespace tenzir
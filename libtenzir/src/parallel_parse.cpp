@@ -0,0 +1,349 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/parallel_parse.hpp"
+
+#include "tenzir/defaults.hpp"
+#include "tenzir/detail/assert.hpp"
+#include "tenzir/detail/narrow.hpp"
+#include "tenzir/detail/scope_guard.hpp"
+#include "tenzir/operator_control_plane.hpp"
+#include "tenzir/shared_diagnostic_handler.hpp"
+
+#include <caf/detail/set_thread_name.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ranges>
+#include <thread>
+
+namespace tenzir {
+
+auto split_for_parallelization(generator<chunk_ptr> input, std::byte separator)
+  -> generator<std::vector<chunk_ptr>> {
+  // Split at the next newline after the given number of bytes.
+  constexpr auto split_after_size = size_t{1'000'000};
+  // The duration after which to yield incoming lines at the latest.
+  constexpr auto timeout = defaults::import::batch_timeout;
+  // Accumulates all chunks that should be part of the next chunk group. This is
+  // for example needed in case the last newline is in the middle of a batch.
+  auto current = std::vector<chunk_ptr>{};
+  // The total size of all batches in `current`.
+  auto current_size = size_t{0};
+  auto next_timeout = time::clock::now() + timeout;
+  auto pop_before_last_linebreak
+    = [&]() -> std::optional<std::vector<chunk_ptr>> {
+    // We have to search all chunks here because the last newline is not
+    // necessarily in the last chunk.
+    for (auto& chunk : std::views::reverse(current)) {
+      auto bytes = as_bytes(chunk);
+      for (const auto& byte : std::views::reverse(bytes)) {
+        if (byte == separator) {
+          auto end = detail::narrow<size_t>(&byte - bytes.data());
+          auto rest = std::vector<chunk_ptr>{};
+          // Move the remainder of the chunk where the newline is in.
+          if (end + 1 != bytes.size()) {
+            rest.push_back(chunk->slice(end + 1, bytes.size()));
+          }
+          if (end != 0) {
+            chunk = chunk->slice(0, end);
+          }
+          // Move the subsequent chunks.
+          auto chunk_index = &chunk - current.data();
+          rest.insert(rest.end(),
+                      std::move_iterator{current.begin() + chunk_index + 1},
+                      std::move_iterator{current.end()});
+          current.erase(current.begin() + chunk_index + 1, current.end());
+          // Return everything up the newline and continue with the rest.
+          auto result = std::move(current);
+          current = std::move(rest);
+          current_size = 0;
+          for (auto& chunk : current) {
+            current_size += chunk->size();
+          }
+          return result;
+        }
+      }
+    }
+    return std::nullopt;
+  };
+  for (auto&& chunk : input) {
+    auto now = time::clock::now();
+    if (now > next_timeout) {
+      if (auto pop = pop_before_last_linebreak()) {
+        co_yield std::move(*pop);
+      }
+      // Even if we couldn't pop anything, we still reset the timeout to prevent
+      // looping there over and over again.
+      next_timeout = now + timeout;
+    }
+    if (not chunk) {
+      // This means that the operator has no more input. We propagate that
+      // information up by yielding an empty vector.
+      co_yield {};
+      continue;
+    }
+    TENZIR_ASSERT(chunk->size() != 0);
+    if (current.empty()) {
+      next_timeout = now + timeout;
+    }
+    // If we are under our splitting minimum, we just have to insert the batch.
+    if (current_size + chunk->size() < split_after_size
+        and now < next_timeout) {
+      current.push_back(std::move(chunk));
+      current_size += current.back()->size();
+      continue;
+    }
+    // Otherwise, we find the last linebreak and yield everything before that.
+    auto yielded = false;
+    auto bytes = as_bytes(chunk);
+    for (const auto& byte : std::views::reverse(bytes)) {
+      // This handles both LF and CRLF. In the latter case, the CR becomes part
+      // of the chunk but is ignored later.
+      if (byte == separator) {
+        auto end = detail::narrow<size_t>(&byte - bytes.data());
+        if (end != 0) {
+          current.push_back(chunk->slice(0, end));
+          current_size += current.back()->size();
+        }
+        co_yield std::move(current);
+        yielded = true;
+        current.clear();
+        current_size = 0;
+        // Remember the rest of the current chunk, if there is any.
+        if (end + 1 != bytes.size()) {
+          current.push_back(chunk->slice(end + 1, bytes.size()));
+          current_size += current.back()->size();
+        }
+        next_timeout = now + timeout;
+        break;
+      }
+    }
+    // If there was no linebreak, we have to insert the entire chunk.
+    if (not yielded) {
+      current.push_back(std::move(chunk));
+      current_size += current.back()->size();
+      // We do not yield here. Instead, we decided to very quickly drain the
+      // input buffer if there are no newlines in the current input buffer. Once
+      // it is drained, we get an empty chunk, which then leads to a yield.
+    }
+  }
+  // There can be remaining chunks if the last one didn't end with a newline.
+  if (not current.empty()) {
+    co_yield std::move(current);
+  }
+}
+
+auto parse_parallelized(generator<chunk_ptr> input,
+                        operator_control_plane& ctrl,
+                        parallel_parse_options options,
+                        parallel_parse_factory make_parser)
+  -> generator<table_slice> {
+  // A unit of work carries its position in the input, which we use to restore
+  // the order of the results.
+  struct unit {
+    size_t index = {};
+    std::vector<chunk_ptr> chunks = {};
+  };
+  // We use a single input queue to communicate with all worker threads. Putting
+  // a unit without chunks in here tells the thread to stop.
+  auto inputs = std::deque<unit>{};
+  auto inputs_mutex = std::mutex{};
+  auto inputs_cv = std::condition_variable{};
+  auto next_input = size_t{0};
+  // All worker threads write to the same output map, keyed by the position of
+  // the unit. The distributing thread generally does not block on the output,
+  // because it must keep running if we get new input from the preceding
+  // operator. Only while applying backpressure, where it cannot accept new
+  // input anyway, does it briefly wait for one of our workers to finish.
+  auto outputs = std::map<size_t, std::vector<table_slice>>{};
+  auto outputs_mutex = std::mutex{};
+  auto outputs_cv = std::condition_variable{};
+  auto next_output = size_t{0};
+  // Checks whether `pop_outputs` would return something. Must be called with
+  // the output mutex held.
+  auto has_outputs = [&] {
+    return options.ordered ? outputs.contains(next_output)
+                           : not outputs.empty();
+  };
+  auto work = [&](shared_diagnostic_handler dh) {
+    caf::detail::set_thread_name("read_work");
+    // We reuse the parse function throughout all iterations.
+    auto parse = make_parser(dh);
+    while (true) {
+      auto inputs_lock = std::unique_lock{inputs_mutex};
+      inputs_cv.wait(inputs_lock, [&] {
+        return not inputs.empty();
+      });
+      auto stop = inputs.front().chunks.empty();
+      if (stop) {
+        // We intentionally don't pop the element so that the other threads can
+        // also get to see it.
+        return;
+      }
+      auto input = std::move(inputs.front());
+      inputs.pop_front();
+      inputs_lock.unlock();
+      auto input_gen = std::invoke(
+        [](std::vector<chunk_ptr> input) -> generator<chunk_ptr> {
+          for (auto& chunk : input) {
+            co_yield std::move(chunk);
+          }
+        },
+        std::move(input.chunks));
+      // Without ordering requirements, we can hand out every slice as soon as
+      // it's ready. Otherwise, we publish the results of the unit at once, such
+      // that the distributing thread knows when it may move on to the next one.
+      auto results = std::vector<table_slice>{};
+      for (auto slice : parse(std::move(input_gen))) {
+        if (slice.rows() == 0) {
+          // We don't care, because our input is already fully there.
+          continue;
+        }
+        if (options.ordered) {
+          results.push_back(std::move(slice));
+          continue;
+        }
+        auto outputs_lock = std::unique_lock{outputs_mutex};
+        outputs[input.index].push_back(std::move(slice));
+        outputs_lock.unlock();
+        outputs_cv.notify_one();
+      }
+      if (options.ordered) {
+        auto outputs_lock = std::unique_lock{outputs_mutex};
+        auto [_, inserted]
+          = outputs.try_emplace(input.index, std::move(results));
+        TENZIR_ASSERT(inserted);
+        outputs_lock.unlock();
+        outputs_cv.notify_one();
+      }
+    }
+  };
+  // Set up the threads.
+  TENZIR_ASSERT(options.jobs > 0);
+  auto threads = std::vector<std::thread>{};
+  for (auto i = uint64_t{0}; i < options.jobs; ++i) {
+    threads.emplace_back(work, ctrl.shared_diagnostics());
+  }
+  // With the current execution model, the generator can be destroyed at any
+  // yield. Because we are running threads, we need to protect against that.
+  auto guard = detail::scope_guard{[&]() noexcept {
+    auto inputs_lock = std::unique_lock{inputs_mutex};
+    // We clear the inputs here because we don't care about the output anymore.
+    inputs.clear();
+    inputs.emplace_back();
+    inputs_lock.unlock();
+    inputs_cv.notify_all();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }};
+  auto pop_outputs = [&]() -> std::vector<table_slice> {
+    auto result = std::vector<table_slice>{};
+    auto outputs_lock = std::unique_lock{outputs_mutex};
+    auto take = [&](std::vector<table_slice>& slices) {
+      result.insert(result.end(), std::move_iterator{slices.begin()},
+                    std::move_iterator{slices.end()});
+    };
+    if (not options.ordered) {
+      for (auto& [_, slices] : outputs) {
+        take(slices);
+      }
+      outputs.clear();
+      return result;
+    }
+    for (auto it = outputs.find(next_output); it != outputs.end();
+         it = outputs.find(next_output)) {
+      take(it->second);
+      outputs.erase(it);
+      ++next_output;
+    }
+    return result;
+  };
+  for (auto split :
+       split_for_parallelization(std::move(input), options.separator)) {
+    auto yielded = false;
+    if (split.empty()) {
+      // We got a signal that there is no more input. Thus, we'd like to sleep.
+      for (auto& output : pop_outputs()) {
+        co_yield std::move(output);
+        yielded = true;
+      }
+      // If we had some output above, we already gave the execution node a
+      // chance to refill our input buffer. Hence, we directly try again.
+      if (not yielded) {
+        co_yield {};
+      }
+      continue;
+    }
+    auto inputs_lock = std::unique_lock{inputs_mutex};
+    // If this is already too full, wait for a bit to provide backpressure. With
+    // ordered output, we must additionally limit the number of units in flight,
+    // as a single slow unit would otherwise hold back an unbounded number of
+    // results.
+    auto too_full = [&] {
+      return inputs.size() > 3 * options.jobs
+             or (options.ordered and next_input - next_output > 4 * options.jobs);
+    };
+    while (too_full()) {
+      inputs_lock.unlock();
+      {
+        auto outputs_lock = std::unique_lock{outputs_mutex};
+        outputs_cv.wait_for(outputs_lock, std::chrono::milliseconds{10},
+                            has_outputs);
+      }
+      // Every iteration must yield to the execution node, even if we already
+      // yielded results before entering the loop.
+      auto yielded_output = false;
+      for (auto& output : pop_outputs()) {
+        co_yield std::move(output);
+        yielded_output = true;
+      }
+      if (not yielded_output) {
+        co_yield {};
+      }
+      yielded = true;
+      inputs_lock.lock();
+    }
+    inputs.push_back(unit{next_input++, std::move(split)});
+    inputs_lock.unlock();
+    inputs_cv.notify_one();
+    for (auto& output : pop_outputs()) {
+      co_yield std::move(output);
+      yielded = true;
+    }
+    if (not yielded) {
+      co_yield {};
+    }
+  }
+  // Once we reach this, the task of joining the threads is not longer handled
+  // by the guard. Note that no yield come in between this and joining the
+  // threads, so we can be sure that we join all threads before the next yield.
+  guard.disable();
+  auto inputs_lock = std::unique_lock{inputs_mutex};
+  inputs.emplace_back();
+  inputs_lock.unlock();
+  inputs_cv.notify_all();
+  // Wait for completion.
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Should be done now.
+  TENZIR_ASSERT(inputs.size() == 1);
+  TENZIR_ASSERT(inputs[0].chunks.empty());
+  // Yield the remaining outputs.
+  for (auto& output : pop_outputs()) {
+    co_yield std::move(output);
+  }
+  TENZIR_ASSERT(outputs.empty());
+}
+
+} // namespace tenzir
@@ -21,6 +21,7 @@ partition_synopsis::partition_synopsis(partition_synopsis&& that) noexcept {
   min_import_time = std::exchange(that.min_import_time, time::max());
   max_import_time = std::exchange(that.max_import_time, time::min());
   version = std::exchange(that.version, version::current_partition_version);
+  store_time = std::exchange(that.store_time, {});
   schema = std::exchange(that.schema, {});
   type_synopses_ = std::exchange(that.type_synopses_, {});
   field_synopses_ = std::exchange(that.field_synopses_, {});
@@ -34,6 +35,7 @@ partition_synopsis::operator=(partition_synopsis&& that) noexcept {
     min_import_time = std::exchange(that.min_import_time, time::max());
     max_import_time = std::exchange(that.max_import_time, time::min());
     version = std::exchange(that.version, version::current_partition_version);
+    store_time = std::exchange(that.store_time, {});
     schema = std::exchange(that.schema, {});
     type_synopses_ = std::exchange(that.type_synopses_, {});
     field_synopses_ = std::exchange(that.field_synopses_, {});
@@ -63,6 +65,13 @@ void partition_synopsis::shrink() {
   }
 }
 
+void partition_synopsis::drop_empty_field_synopses() {
+  memusage_ = 0; // Invalidate cached size.
+  std::erase_if(field_synopses_, [](const auto& entry) {
+    return entry.second == nullptr;
+  });
+}
+
 // TODO: Use a more efficient data structure for rule lookup.
 std::optional<double> get_field_fprate(const index_config& config,
                                        const qualified_record_field& field) {
@@ -177,6 +186,8 @@ void partition_synopsis::add(const table_slice& slice,
 size_t partition_synopsis::memusage() const {
   size_t result = memusage_;
   if (result == size_t{0}) {
+    result += field_synopses_.size()
+              * sizeof(decltype(field_synopses_)::value_type);
     for (const auto& [field, synopsis] : field_synopses_)
       result += synopsis ? synopsis->memusage() : 0ull;
     for (const auto& [type, synopsis] : type_synopses_)
@@ -192,6 +203,7 @@ partition_synopsis* partition_synopsis::copy() const {
   result->min_import_time = min_import_time;
   result->max_import_time = max_import_time;
   result->version = version;
+  result->store_time = store_time;
   result->schema = schema;
   result->memusage_ = memusage_.load();
   result->type_synopses_.reserve(type_synopses_.size());
@@ -243,6 +255,7 @@ pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis& x) {
   ps_builder.add_import_time_range(&import_time_range);
   ps_builder.add_version(x.version);
   ps_builder.add_schema(schema_vector);
+  ps_builder.add_store_time(x.store_time.time_since_epoch().count());
   return ps_builder.Finish();
 }
 
@@ -274,6 +287,16 @@ caf::error unpack_(
 
 } // namespace
 
+auto partition_info::is_due_for_cold_tier(duration cold_store_after,
+                                          time now) const -> bool {
+  const auto threshold = max_import_time + cold_store_after;
+  if (cold_store_after <= duration::zero() || threshold > now) {
+    return false;
+  }
+  const auto written = store_time == time{} ? max_import_time : store_time;
+  return written < threshold;
+}
+
 caf::error unpack(const fbs::partition_synopsis::LegacyPartitionSynopsis& x,
                   partition_synopsis& ps) {
   if (!x.id_range())
@@ -291,6 +314,7 @@ caf::error unpack(const fbs::partition_synopsis::LegacyPartitionSynopsis& x,
     ps.max_import_time = time{};
   }
   ps.version = x.version();
+  ps.store_time = time{} + duration{x.store_time()};
   if (const auto* schema = x.schema())
     ps.schema = type{chunk::copy(as_bytes(*schema))};
   if (!x.synopses())
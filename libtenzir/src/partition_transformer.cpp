@@ -8,16 +8,23 @@
 
 #include "tenzir/partition_transformer.hpp"
 
+#include "tenzir/arrow_table_slice.hpp"
 #include "tenzir/detail/fanout_counter.hpp"
+#include "tenzir/detail/narrow.hpp"
 #include "tenzir/fbs/utils.hpp"
+#include "tenzir/index_config.hpp"
 #include "tenzir/logger.hpp"
 #include "tenzir/partition_synopsis.hpp"
 #include "tenzir/pipeline.hpp"
 #include "tenzir/plugin.hpp"
 
+#include <arrow/compute/api.h>
+#include <arrow/record_batch.h>
 #include <caf/make_copy_on_write.hpp>
 #include <flatbuffers/flatbuffers.h>
 
+#include <algorithm>
+
 namespace tenzir {
 
 namespace {
@@ -144,6 +151,59 @@ private:
 
 } // namespace
 
+auto sort_by_time(std::vector<table_slice> slices,
+                  const std::vector<std::string>& targets)
+  -> std::vector<table_slice> {
+  if (slices.empty() || targets.empty()) {
+    return slices;
+  }
+  const auto field = find_sort_field(slices[0].schema(), targets);
+  if (!field) {
+    return slices;
+  }
+  // The import time is tracked per record batch, so we remember it for every
+  // event and split the sorted events wherever it changes.
+  auto import_times = std::vector<time>{};
+  import_times.reserve(rows(slices));
+  for (const auto& slice : slices) {
+    import_times.insert(import_times.end(), slice.rows(), slice.import_time());
+  }
+  const auto combined = concatenate(slices);
+  auto sort = [&]()
+    -> arrow::Result<std::pair<arrow::Datum, std::shared_ptr<arrow::Array>>> {
+    const auto [_, key] = field->get(combined);
+    ARROW_ASSIGN_OR_RAISE(
+      auto indices, arrow::compute::SortIndices(
+                      *key, arrow::compute::ArraySortOptions::Defaults()));
+    ARROW_ASSIGN_OR_RAISE(auto sorted, arrow::compute::Take(
+                                         to_record_batch(combined), indices));
+    return std::pair{std::move(sorted), std::move(indices)};
+  };
+  auto sorted = sort();
+  if (!sorted.ok()) {
+    TENZIR_WARN("partition transformer failed to sort events of schema {}: {}",
+                combined.schema(), sorted.status().ToString());
+    return slices;
+  }
+  const auto sorted_slice
+    = table_slice{sorted->first.record_batch(), combined.schema()};
+  const auto& indices = as<arrow::UInt64Array>(*sorted->second);
+  auto result = std::vector<table_slice>{};
+  auto begin = int64_t{0};
+  for (auto row = int64_t{1}; row <= indices.length(); ++row) {
+    const auto import_time = import_times[indices.Value(begin)];
+    if (row < indices.length()
+        && import_times[indices.Value(row)] == import_time) {
+      continue;
+    }
+    result.push_back(subslice(sorted_slice, detail::narrow<size_t>(begin),
+                              detail::narrow<size_t>(row)));
+    result.back().import_time(import_time);
+    begin = row;
+  }
+  return result;
+}
+
 active_partition_state::serialization_data&
 partition_transformer_state::create_or_get_partition(const table_slice& slice) {
   auto const& schema = slice.schema();
@@ -417,6 +477,8 @@ auto partition_transformer(
         auto& mutable_synopsis = data.synopsis.unshared();
         // Push the slices to the store.
         auto& buildup = self->state().partition_buildup.at(data.id);
+        buildup.slices = sort_by_time(std::move(buildup.slices),
+                                      self->state().synopsis_opts.sort_by);
         auto offset = id{0};
         for (auto& slice : buildup.slices) {
           slice.offset(offset);
@@ -431,6 +493,7 @@ auto partition_transformer(
         // synopsis keeps track of offset/events internally.
         mutable_synopsis.shrink();
         mutable_synopsis.events = data.events;
+        mutable_synopsis.store_time = time::clock::now();
       }
       for (auto& [_, partition_data] : self->state().data) {
         self->mail(atom::persist_v)
@@ -480,6 +543,9 @@ auto partition_transformer(
             stream_data.partition_chunks = partition.error();
             return;
           }
+          // The index weighs the partition by this size when caching it.
+          partition_data.synopsis.unshared().indexes_file.size
+            = (*partition)->size();
           stream_data.partition_chunks->emplace_back(
             std::make_tuple(partition_data.id, schema, *partition));
         }
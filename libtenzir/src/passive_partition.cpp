@@ -11,9 +11,11 @@
 #include "tenzir/fwd.hpp"
 
 #include "tenzir/aliases.hpp"
+#include "tenzir/bitmap_algorithms.hpp"
 #include "tenzir/chunk.hpp"
 #include "tenzir/detail/assert.hpp"
 #include "tenzir/detail/tracepoint.hpp"
+#include "tenzir/expression.hpp"
 #include "tenzir/fbs/partition.hpp"
 #include "tenzir/fbs/utils.hpp"
 #include "tenzir/ids.hpp"
@@ -23,7 +25,9 @@
 #include "tenzir/status.hpp"
 #include "tenzir/terminate.hpp"
 #include "tenzir/type.hpp"
+#include "tenzir/value_index.hpp"
 
+#include <caf/binary_deserializer.hpp>
 #include <caf/deserializer.hpp>
 #include <caf/error.hpp>
 #include <caf/sec.hpp>
@@ -87,6 +91,98 @@ passive_partition_state::type_ids() const {
   return type_ids_;
 }
 
+std::optional<ids> passive_partition_state::lookup(const expression& expr) {
+  if (value_index_positions_.empty()) {
+    return std::nullopt;
+  }
+  // The value indexes are keyed by the flat index of their field, so we must
+  // resolve the field extractors of the query against the partition schema.
+  auto tailored = tailor(expr, schema);
+  if (not tailored) {
+    return std::nullopt;
+  }
+  return lookup_tailored(*tailored);
+}
+
+std::optional<ids>
+passive_partition_state::lookup_tailored(const expression& expr) {
+  return match(
+    expr,
+    [&](const conjunction& x) -> std::optional<ids> {
+      // Operands that the value indexes cannot answer do not restrict the
+      // result of a conjunction.
+      auto result = std::optional<ids>{};
+      for (const auto& operand : x) {
+        if (auto operand_ids = lookup_tailored(operand)) {
+          if (result) {
+            *result &= *operand_ids;
+          } else {
+            result = std::move(*operand_ids);
+          }
+        }
+      }
+      return result;
+    },
+    [&](const disjunction& x) -> std::optional<ids> {
+      auto result = ids{};
+      for (const auto& operand : x) {
+        auto operand_ids = lookup_tailored(operand);
+        if (not operand_ids) {
+          return std::nullopt;
+        }
+        result |= *operand_ids;
+      }
+      return result;
+    },
+    [](const negation&) -> std::optional<ids> {
+      return std::nullopt;
+    },
+    [&](const predicate& x) -> std::optional<ids> {
+      const auto* lhs = try_as<data_extractor>(x.lhs);
+      const auto* rhs = try_as<data>(x.rhs);
+      if (not lhs or not rhs) {
+        return std::nullopt;
+      }
+      const auto* index = value_index_for(lhs->column);
+      if (not index) {
+        return std::nullopt;
+      }
+      return index->lookup(x.op, make_view(*rhs));
+    },
+    [](caf::none_t) -> std::optional<ids> {
+      return std::nullopt;
+    });
+}
+
+const value_index* passive_partition_state::value_index_for(size_t column) {
+  if (auto it = value_indexes_.find(column); it != value_indexes_.end()) {
+    return &it->second;
+  }
+  auto position = value_index_positions_.find(column);
+  if (position == value_index_positions_.end()) {
+    return nullptr;
+  }
+  // Value indexes are deserialized lazily because most queries only touch a
+  // small subset of them.
+  if (not container or position->second == 0
+      or position->second >= container->size()) {
+    TENZIR_WARN("{} ignores value index with invalid position {}", *self,
+                position->second);
+    value_index_positions_.erase(position);
+    return nullptr;
+  }
+  auto chunk = container->get_raw(position->second);
+  auto index = value_index{};
+  auto f = caf::binary_deserializer{chunk->data(), chunk->size()};
+  if (not f.apply(index)) {
+    TENZIR_WARN("{} failed to deserialize value index: {}", *self,
+                f.get_error());
+    value_index_positions_.erase(position);
+    return nullptr;
+  }
+  return &value_indexes_.emplace(column, std::move(index)).first->second;
+}
+
 caf::error unpack(const fbs::partition::LegacyPartition& partition,
                   passive_partition_state& state) {
   // Check that all fields exist.
@@ -119,6 +215,43 @@ caf::error unpack(const fbs::partition::LegacyPartition& partition,
   } else {
     return schema.error();
   }
+  if (auto const* value_indexes = partition.value_indexes();
+      value_indexes && value_indexes->size() > 0) {
+    // Value indexes store the key of their field relative to the schema of
+    // the partition, which only the partition synopsis retains. The combined
+    // schema contains the leaves of that schema in the same order, so the
+    // flat index of a field is also its column in the combined schema.
+    auto const* synopsis = partition.partition_synopsis();
+    if (!synopsis || !synopsis->schema()) {
+      return caf::make_error(ec::format_error, //
+                             "missing schema for partition value indexes");
+    }
+    state.schema = type{chunk::copy(as_bytes(*synopsis->schema()))};
+    auto const* schema = try_as<record_type>(&state.schema);
+    if (!schema) {
+      return caf::make_error(ec::format_error, //
+                             "partition synopsis schema is not a record");
+    }
+    const auto num_leaves = state.combined_schema_->num_leaves();
+    for (auto const* qualified_index : *value_indexes) {
+      if (!qualified_index->field_name() || !qualified_index->value_index()) {
+        return caf::make_error(ec::format_error, //
+                               "missing field in partition value index");
+      }
+      const auto key = qualified_index->field_name()->string_view();
+      const auto offset = schema->resolve_key(key);
+      const auto column
+        = offset ? schema->flat_index(*offset) : num_leaves;
+      if (column >= num_leaves) {
+        return caf::make_error(
+          ec::format_error,
+          fmt::format("partition value index for unknown field {}", key));
+      }
+      state.value_index_positions_.emplace(
+        column,
+        qualified_index->value_index()->caf_0_18_external_container_idx());
+    }
+  }
   auto const* type_ids = partition.type_ids();
   for (size_t i = 0; i < type_ids->size(); ++i) {
     auto const* type_ids_tuple = type_ids->Get(i);
@@ -311,6 +444,14 @@ partition_actor::behavior_type passive_partition(
       // We can safely assert that if we have the partition chunk already, all
       // deferred evaluations were taken care of.
       TENZIR_ASSERT(self->state().deferred_evaluations.empty());
+      if (auto selection = self->state().lookup(query_context.expr)) {
+        if (rank(*selection) == 0) {
+          TENZIR_TRACE("{} skips query {} after value index lookup", *self,
+                       query_context.id);
+          return uint64_t{0};
+        }
+        query_context.selection = std::move(*selection);
+      }
       return self->mail(atom::query_v, std::move(query_context))
         .delegate(self->state().store);
     },
@@ -207,11 +207,28 @@ auto pipeline::optimize_into_filter(const expression& filter) const
 
 auto pipeline::optimize(expression const& filter, event_order order) const
   -> optimize_result {
+  // Fuse adjacent operators where possible. This happens before the actual
+  // optimization so that the fused operators can take part in it.
+  auto operators = std::vector<operator_ptr>{};
+  operators.reserve(operators_.size());
+  for (const auto& op : operators_) {
+    TENZIR_ASSERT(op);
+    if (not operators.empty()) {
+      if (auto fused = operators.back()->fuse(*op)) {
+        operators.back() = std::move(fused);
+        continue;
+      }
+    }
+    operators.push_back(op->copy());
+  }
   auto current_filter = filter;
   auto current_order = order;
+  // The top-level fields that the operators after the current one read, or
+  // `std::nullopt` if they may read all of them.
+  auto current_fields = std::optional<std::vector<std::string>>{};
   // Collect the optimized pipeline in reversed order.
   auto result = std::vector<operator_ptr>{};
-  for (auto it = operators_.rbegin(); it != operators_.rend(); ++it) {
+  for (auto it = operators.rbegin(); it != operators.rend(); ++it) {
     TENZIR_ASSERT(*it);
     auto const& op = **it;
     auto opt = op.optimize(current_filter, current_order);
@@ -220,7 +237,7 @@ auto pipeline::optimize(expression const& filter, event_order order) const
     // TQLv2 semantics (including warnings), unless performance demands it. This
     // hack will be fixed by upgrading the catalog to the new expressions.
     if (op.name() == "tql2.where") {
-      auto qualifies = std::ranges::all_of(it, operators_.rend(), [](auto& op) {
+      auto qualifies = std::ranges::all_of(it, operators.rend(), [](auto& op) {
         return op->name() == "tql2.where" || op->name() == "export";
       });
       if (not qualifies) {
@@ -238,11 +255,18 @@ auto pipeline::optimize(expression const& filter, event_order order) const
       TENZIR_ASSERT(ops.size() == 1);
       result.push_back(std::move(ops[0]));
       current_filter = trivially_true_expression();
+      current_fields = std::nullopt;
     }
     if (opt.replacement) {
+      if (current_fields) {
+        if (auto projected = opt.replacement->project(*current_fields)) {
+          opt.replacement = std::move(projected);
+        }
+      }
       result.push_back(std::move(opt.replacement));
     }
     current_order = opt.order;
+    current_fields = op.input_fields(current_fields);
   }
   std::reverse(result.begin(), result.end());
   return optimize_result{current_filter, current_order,
@@ -0,0 +1,146 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/regex_set.hpp"
+
+#include "tenzir/arrow_utils.hpp"
+#include "tenzir/detail/assert.hpp"
+#include "tenzir/error.hpp"
+
+#include <arrow/array/array_binary.h>
+#include <arrow/array/builder_primitive.h>
+#include <fmt/format.h>
+#include <re2/re2.h>
+#include <re2/set.h>
+
+#include <algorithm>
+
+namespace tenzir {
+
+struct regex_set::impl {
+  // The combined automaton of all patterns.
+  re2::RE2::Set set;
+  // The individual patterns, which we fall back to if the combined automaton
+  // exceeds its memory budget for an input.
+  std::vector<std::unique_ptr<const re2::RE2>> regexes;
+  bool full_match;
+
+  impl(const re2::RE2::Options& options, bool full_match)
+    : set{options, full_match ? re2::RE2::ANCHOR_BOTH : re2::RE2::UNANCHORED},
+      full_match{full_match} {
+  }
+
+  auto matches(std::string_view input, size_t index) const -> bool {
+    const auto& regex = *regexes[index];
+    return full_match ? re2::RE2::FullMatch(input, regex)
+                      : re2::RE2::PartialMatch(input, regex);
+  }
+};
+
+auto regex_set::make(std::vector<std::string> patterns, bool full_match,
+                     encoding text_encoding) -> caf::expected<regex_set> {
+  auto options = re2::RE2::Options{re2::RE2::CannedOptions::Quiet};
+  if (text_encoding == encoding::latin1) {
+    options.set_encoding(re2::RE2::Options::EncodingLatin1);
+  }
+  // The default budget of 8 MiB is quickly exhausted by the DFA of a set with
+  // hundreds of patterns, which makes matching fall back to the slow path.
+  options.set_max_mem(int64_t{64} << 20);
+  auto state = std::make_shared<impl>(options, full_match);
+  state->regexes.reserve(patterns.size());
+  for (const auto& pattern : patterns) {
+    auto regex = std::make_unique<const re2::RE2>(pattern, options);
+    if (not regex->ok()) {
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("failed to parse regex `{}`: {}",
+                                         pattern, regex->error()));
+    }
+    auto error = std::string{};
+    if (state->set.Add(pattern, &error) < 0) {
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("failed to parse regex `{}`: {}",
+                                         pattern, error));
+    }
+    state->regexes.push_back(std::move(regex));
+  }
+  if (not state->set.Compile()) {
+    return caf::make_error(ec::unspecified,
+                           "failed to compile regex set: out of memory");
+  }
+  auto result = regex_set{};
+  result.patterns_ = std::move(patterns);
+  result.full_match_ = full_match;
+  result.encoding_ = text_encoding;
+  result.impl_ = std::move(state);
+  return result;
+}
+
+auto regex_set::size() const -> size_t {
+  return patterns_.size();
+}
+
+auto regex_set::patterns() const -> const std::vector<std::string>& {
+  return patterns_;
+}
+
+auto regex_set::match_first(std::string_view input) const
+  -> std::optional<size_t> {
+  auto result = std::vector<int>{};
+  match_all(input, result);
+  if (result.empty()) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(result.front());
+}
+
+auto regex_set::match_all(std::string_view input,
+                          std::vector<int>& result) const -> void {
+  result.clear();
+  if (not impl_) {
+    return;
+  }
+  auto error = re2::RE2::Set::ErrorInfo{};
+  if (impl_->set.Match(input, &result, &error)) {
+    // RE2 does not report the matching patterns in any particular order.
+    std::ranges::sort(result);
+    return;
+  }
+  if (error.kind == re2::RE2::Set::kNoError) {
+    return;
+  }
+  // The automaton ran out of memory for this input, so we check the patterns
+  // one by one instead.
+  result.clear();
+  for (auto i = size_t{0}; i < impl_->regexes.size(); ++i) {
+    if (impl_->matches(input, i)) {
+      result.push_back(static_cast<int>(i));
+    }
+  }
+}
+
+auto regex_set::match_first(const arrow::StringArray& input) const
+  -> std::shared_ptr<arrow::Int64Array> {
+  auto builder = arrow::Int64Builder{};
+  check(builder.Reserve(input.length()));
+  auto matches = std::vector<int>{};
+  for (auto i = int64_t{0}; i < input.length(); ++i) {
+    if (input.IsNull(i)) {
+      builder.UnsafeAppendNull();
+      continue;
+    }
+    match_all(input.GetView(i), matches);
+    if (matches.empty()) {
+      builder.UnsafeAppendNull();
+      continue;
+    }
+    builder.UnsafeAppend(matches.front());
+  }
+  return finish(builder);
+}
+
+} // namespace tenzir
@@ -0,0 +1,275 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/sketch/hyperloglog.hpp"
+
+#include "tenzir/detail/assert.hpp"
+#include "tenzir/error.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace tenzir::sketch {
+
+namespace {
+
+/// The number of bits that encode the rank in a sparse entry.
+constexpr auto rank_bits = uint32_t{6};
+
+/// Splits a digest into the register index and the rank, i.e., the position of
+/// the leftmost one bit in the remaining bits.
+auto split(uint64_t digest, uint8_t precision) -> std::pair<uint32_t, uint8_t> {
+  const auto index = static_cast<uint32_t>(digest >> (64 - precision));
+  const auto rest = digest << precision;
+  const auto rank = rest == 0 ? 64 - precision + 1 : std::countl_zero(rest) + 1;
+  return {index, static_cast<uint8_t>(rank)};
+}
+
+/// Converts a sparse entry into the register index and rank at the given
+/// (lower) precision.
+auto to_dense(uint32_t entry, uint8_t precision)
+  -> std::pair<uint32_t, uint8_t> {
+  const auto sparse_index = entry >> rank_bits;
+  const auto sparse_rank = entry & ((1u << rank_bits) - 1);
+  const auto shift = uint32_t{hyperloglog::sparse_precision} - precision;
+  const auto index = sparse_index >> shift;
+  // The bits that the sparse index has in addition to the dense index are the
+  // leading bits of the remainder at the dense precision.
+  const auto extra = sparse_index & ((1u << shift) - 1);
+  const auto rank = extra != 0 ? std::countl_zero(extra) - (32 - shift) + 1
+                               : shift + sparse_rank;
+  return {index, static_cast<uint8_t>(rank)};
+}
+
+auto sigma(double x) -> double {
+  if (x == 1.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  auto y = 1.0;
+  auto z = x;
+  while (true) {
+    x *= x;
+    const auto previous = z;
+    z += x * y;
+    y += y;
+    if (z == previous) {
+      return z;
+    }
+  }
+}
+
+auto tau(double x) -> double {
+  if (x == 0.0 or x == 1.0) {
+    return 0.0;
+  }
+  auto y = 1.0;
+  auto z = 1.0 - x;
+  while (true) {
+    x = std::sqrt(x);
+    const auto previous = z;
+    y *= 0.5;
+    z -= (1.0 - x) * (1.0 - x) * y;
+    if (z == previous) {
+      return z / 3.0;
+    }
+  }
+}
+
+} // namespace
+
+auto hyperloglog::make(uint8_t precision) -> caf::expected<hyperloglog> {
+  if (precision < min_precision or precision > max_precision) {
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("precision must be in [{}, {}], got {}",
+                                       min_precision, max_precision,
+                                       precision));
+  }
+  return hyperloglog{precision};
+}
+
+auto hyperloglog::make(uint8_t precision, std::span<const uint32_t> sparse,
+                       std::span<const uint8_t> dense)
+  -> caf::expected<hyperloglog> {
+  auto result = make(precision);
+  if (not result) {
+    return result;
+  }
+  if (not dense.empty()) {
+    if (not sparse.empty()) {
+      return caf::make_error(ec::invalid_argument,
+                             "sketch cannot be both sparse and dense");
+    }
+    if (dense.size() != size_t{1} << precision) {
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("expected {} registers, got {}",
+                                         size_t{1} << precision,
+                                         dense.size()));
+    }
+    const auto max_rank = 64 - precision + 1;
+    if (std::ranges::any_of(dense, [&](auto rank) {
+          return rank > max_rank;
+        })) {
+      return caf::make_error(ec::invalid_argument, "invalid register value");
+    }
+    result->dense_.assign(dense.begin(), dense.end());
+    return result;
+  }
+  const auto max_sparse_rank = 64 - sparse_precision + 1;
+  if (std::ranges::any_of(sparse, [&](auto entry) {
+        const auto rank = entry & ((1u << rank_bits) - 1);
+        return rank == 0 or rank > max_sparse_rank
+               or (entry >> rank_bits) >= (1u << sparse_precision);
+      })) {
+    return caf::make_error(ec::invalid_argument, "invalid sparse entry");
+  }
+  result->sparse_.assign(sparse.begin(), sparse.end());
+  return result;
+}
+
+hyperloglog::hyperloglog(uint8_t precision) : precision_{precision} {
+}
+
+void hyperloglog::add(uint64_t digest) {
+  if (not dense_.empty()) {
+    const auto [index, rank] = split(digest, precision_);
+    dense_[index] = std::max(dense_[index], rank);
+    return;
+  }
+  const auto [index, rank] = split(digest, sparse_precision);
+  sparse_.push_back((index << rank_bits) | rank);
+  // We compact the sparse entries in batches to amortize the sorting, and
+  // switch to the dense representation once it takes up less space.
+  const auto num_registers = size_t{1} << precision_;
+  const auto batch_size = std::max(size_t{16}, num_registers / 16);
+  if (sparse_.size() - sorted_ >= batch_size) {
+    compact();
+    if (sparse_exceeds_dense()) {
+      densify();
+    }
+  }
+}
+
+void hyperloglog::merge(const hyperloglog& other) {
+  TENZIR_ASSERT(other.precision_ == precision_);
+  if (not other.dense_.empty()) {
+    if (dense_.empty()) {
+      densify();
+    }
+    for (auto i = size_t{0}; i < dense_.size(); ++i) {
+      dense_[i] = std::max(dense_[i], other.dense_[i]);
+    }
+    return;
+  }
+  if (not dense_.empty()) {
+    for (auto entry : other.sparse_) {
+      const auto [index, rank] = to_dense(entry, precision_);
+      dense_[index] = std::max(dense_[index], rank);
+    }
+    return;
+  }
+  sparse_.insert(sparse_.end(), other.sparse_.begin(), other.sparse_.end());
+  compact();
+  if (sparse_exceeds_dense()) {
+    densify();
+  }
+}
+
+auto hyperloglog::estimate() const -> double {
+  if (dense_.empty()) {
+    // Linear counting at the sparse precision is very accurate for the small
+    // cardinalities that we see in the sparse representation.
+    compact();
+    if (sparse_.empty()) {
+      return 0.0;
+    }
+    // Entries that were added since the last compaction may push the sketch
+    // over the limit of the sparse representation. Estimating it as if it had
+    // switched already makes the estimate independent of how the digests
+    // were batched, e.g., when merging partial sketches.
+    if (sparse_exceeds_dense()) {
+      auto dense = *this;
+      dense.densify();
+      return dense.estimate();
+    }
+    const auto m = static_cast<double>(size_t{1} << sparse_precision);
+    const auto empty = m - static_cast<double>(sparse_.size());
+    return m * std::log(m / empty);
+  }
+  const auto q = 64 - precision_;
+  auto counts = std::vector<uint32_t>(q + 2);
+  for (auto rank : dense_) {
+    ++counts[rank];
+  }
+  const auto m = static_cast<double>(dense_.size());
+  auto z = m * tau(1.0 - counts[q + 1] / m);
+  for (auto k = q; k >= 1; --k) {
+    z = 0.5 * (z + counts[k]);
+  }
+  z += m * sigma(counts[0] / m);
+  return m * m / (2.0 * std::log(2.0) * z);
+}
+
+auto hyperloglog::precision() const -> uint8_t {
+  return precision_;
+}
+
+auto hyperloglog::sparse() const -> std::span<const uint32_t> {
+  compact();
+  return sparse_;
+}
+
+auto hyperloglog::dense() const -> std::span<const uint8_t> {
+  return dense_;
+}
+
+void hyperloglog::compact() const {
+  if (sorted_ == sparse_.size()) {
+    return;
+  }
+  const auto middle = sparse_.begin() + static_cast<ptrdiff_t>(sorted_);
+  std::sort(middle, sparse_.end());
+  std::inplace_merge(sparse_.begin(), middle, sparse_.end());
+  // Entries are ordered by index and then by rank, so the last entry for
+  // every index has the largest rank.
+  auto out = sparse_.begin();
+  for (auto it = sparse_.begin(); it != sparse_.end(); ++it) {
+    const auto next = std::next(it);
+    if (next != sparse_.end() and (*next >> rank_bits) == (*it >> rank_bits)) {
+      continue;
+    }
+    *out++ = *it;
+  }
+  sparse_.erase(out, sparse_.end());
+  sorted_ = sparse_.size();
+}
+
+auto hyperloglog::sparse_exceeds_dense() const -> bool {
+  return sparse_.size() * sizeof(uint32_t) >= (size_t{1} << precision_);
+}
+
+void hyperloglog::densify() {
+  TENZIR_ASSERT(dense_.empty());
+  dense_.resize(size_t{1} << precision_);
+  for (auto entry : sparse_) {
+    const auto [index, rank] = to_dense(entry, precision_);
+    dense_[index] = std::max(dense_[index], rank);
+  }
+  sparse_ = {};
+  sorted_ = 0;
+}
+
+auto mem_usage(const hyperloglog& x) -> size_t {
+  return sizeof(x) + x.sparse_.capacity() * sizeof(uint32_t)
+         + x.dense_.capacity();
+}
+
+} // namespace tenzir::sketch
@@ -91,7 +91,8 @@ handle_query(const auto& self, const query_context& query_context) {
         return;
       }
       state->second.result_generator
-        = self->state().store->extract(*tailored_expr);
+        = self->state().store->extract(*tailored_expr, query_context.selection,
+                                       extract.fields);
       state->second.result_iterator = state->second.result_generator.begin();
       state->second.sink = extract.sink;
       state->second.start = start;
@@ -126,6 +127,17 @@ handle_query(const auto& self, const query_context& query_context) {
   return rp;
 }
 
+/// Completes a query of an active store, which fails if the store could not
+/// read back all of its staged contents.
+auto finish_query(
+  default_active_store_actor::stateful_pointer<default_active_store_state> self)
+  -> caf::result<void> {
+  if (auto error = self->state().store->staging_error()) {
+    return error;
+  }
+  return {};
+}
+
 } // namespace
 
 type base_store::schema() const {
@@ -141,14 +153,28 @@ generator<uint64_t> base_store::count(expression expr, ids selection) const {
   }
 }
 
-generator<table_slice> base_store::extract(expression expr) const {
+generator<table_slice>
+base_store::extract(expression expr, ids selection,
+                    std::optional<std::vector<std::string>>) const {
   for (const auto& slice : slices()) {
-    if (auto filtered_slice = filter(slice, expr)) {
+    if (auto filtered_slice = filter(slice, expr, selection)) {
       co_yield std::move(*filtered_slice);
     }
   }
 }
 
+void active_store::stage(std::filesystem::path) {
+  // nop
+}
+
+bool active_store::has_staging_file() const {
+  return false;
+}
+
+caf::error active_store::staging_error() const {
+  return {};
+}
+
 default_passive_store_actor::behavior_type default_passive_store(
   default_passive_store_actor::stateful_pointer<default_passive_store_state>
     self,
@@ -256,7 +282,10 @@ default_active_store_actor::behavior_type default_active_store(
   self->state().filesystem = std::move(filesystem);
   self->state().store = std::move(store);
   self->state().path = std::move(path);
+  self->state().staging_path = self->state().path;
+  self->state().staging_path += ".tmp";
   self->state().store_type = std::move(store_type);
+  self->state().store->stage(self->state().staging_path);
   return {
     [self](atom::query,
            const query_context& query_context) -> caf::result<uint64_t> {
@@ -274,8 +303,22 @@ default_active_store_actor::behavior_type default_active_store(
                               || rank(selection) == num_events);
       // We don't actually need to erase anything in the store itself, but
       // rather just don't need to persist when shutting down the stream, so
-      // we set a flag for that in the actor state.
+      // we set a flag for that in the actor state. The store may have written
+      // parts of its contents to the staging file already, though.
       self->state().erased = true;
+      if (not self->state().store->has_staging_file()) {
+        return num_events;
+      }
+      self->mail(atom::erase_v, self->state().staging_path)
+        .request(self->state().filesystem, caf::infinite)
+        .then(
+          [](atom::done) {
+            // nop
+          },
+          [self](const caf::error& error) {
+            TENZIR_WARN("{} failed to delete staging file {}: {}", *self,
+                        self->state().staging_path, error);
+          });
       return num_events;
     },
     [self](atom::persist) -> caf::result<resource> {
@@ -289,27 +332,55 @@ default_active_store_actor::behavior_type default_active_store(
                      .to_error());
         return {};
       }
-      auto rp = self->make_response_promise<resource>();
       auto res = resource{
         .url = fmt::format("file://{}", self->state().path),
-        .size = (*chunk)->size(),
+        .size = *chunk ? (*chunk)->size() : 0,
+      };
+      if (not *chunk) {
+        // The store wrote its contents to the staging file already.
+        auto err = std::error_code{};
+        res.size = std::filesystem::file_size(self->state().staging_path, err);
+        if (err) {
+          self->quit(diagnostic::error("failed to stat staging file {}: {}",
+                                       self->state().staging_path,
+                                       err.message())
+                       .note("while persisting store to disk")
+                       .to_error());
+          return {};
+        }
+      }
+      auto rp = self->make_response_promise<resource>();
+      auto on_success = [self, rp, res]() mutable {
+        TENZIR_DEBUG("{} ({}) persisted itself to {}", *self,
+                     self->state().store_type, self->state().path);
+        TENZIR_ASSERT(rp.pending());
+        rp.deliver(res);
+        self->quit();
       };
+      auto on_error = [self, rp](caf::error& error) mutable {
+        rp.deliver(error);
+        self->quit(diagnostic::error(std::move(error))
+                     .note("while persisting store to disk")
+                     .to_error());
+      };
+      if (not *chunk) {
+        self
+          ->mail(atom::move_v, self->state().staging_path, self->state().path)
+          .request(self->state().filesystem, caf::infinite)
+          .then(
+            [on_success](atom::done) mutable {
+              on_success();
+            },
+            on_error);
+        return rp;
+      }
       self->mail(atom::write_v, self->state().path, std::move(*chunk))
         .request(self->state().filesystem, caf::infinite)
         .then(
-          [self, rp, res](atom::ok) mutable {
-            TENZIR_DEBUG("{} ({}) persisted itself to {}", *self,
-                         self->state().store_type, self->state().path);
-            TENZIR_ASSERT(rp.pending());
-            rp.deliver(res);
-            self->quit();
+          [on_success](atom::ok) mutable {
+            on_success();
           },
-          [self, rp](caf::error& error) mutable {
-            rp.deliver(error);
-            self->quit(diagnostic::error(std::move(error))
-                         .note("while persisting store to disk")
-                         .to_error());
-          });
+          on_error);
       return rp;
     },
     [self](table_slice& slice) {
@@ -343,13 +414,13 @@ default_active_store_actor::behavior_type default_active_store(
                      "after "
                      "query already finished",
                      *self, query_id);
-        return {};
+        return finish_query(self);
       }
       auto slice = *state.result_iterator;
       state.num_hits += slice.rows();
       self->mail(std::move(slice)).send(state.sink);
       if (++state.result_iterator == state.result_generator.end()) {
-        return {};
+        return finish_query(self);
       }
       return self->mail(atom::internal_v, atom::extract_v, query_id)
         .delegate(static_cast<default_active_store_actor>(self));
@@ -366,11 +437,11 @@ default_active_store_actor::behavior_type default_active_store(
         TENZIR_DEBUG("{} ignores count continuation request for query {} after "
                      "query already finished",
                      *self, query_id);
-        return {};
+        return finish_query(self);
       }
       state.num_hits += *state.result_iterator;
       if (++state.result_iterator == state.result_generator.end()) {
-        return {};
+        return finish_query(self);
       }
       return self->mail(atom::internal_v, atom::count_v, query_id)
         .delegate(static_cast<default_active_store_actor>(self));
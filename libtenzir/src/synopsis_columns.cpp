@@ -0,0 +1,250 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/synopsis_columns.hpp"
+
+#include "tenzir/detail/assert.hpp"
+#include "tenzir/detail/overload.hpp"
+#include "tenzir/min_max_synopsis.hpp"
+#include "tenzir/tag.hpp"
+
+namespace tenzir {
+
+namespace {
+
+/// Returns the min-max synopsis for a field of a partition, falling back to
+/// the synopsis for the type of the field like the catalog does.
+template <class T>
+auto find_min_max_synopsis(const partition_synopsis& ps,
+                           const qualified_record_field& field,
+                           const type& cleaned_type)
+  -> const min_max_synopsis<T>* {
+  const synopsis* result = nullptr;
+  if (auto it = ps.field_synopses_.find(field);
+      it != ps.field_synopses_.end() && it->second) {
+    result = it->second.get();
+  } else if (auto it = ps.type_synopses_.find(cleaned_type);
+             it != ps.type_synopses_.end()) {
+    result = it->second.get();
+  }
+  return dynamic_cast<const min_max_synopsis<T>*>(result);
+}
+
+/// Marks the partitions whose range `[min, max]` may satisfy `op rhs`, with
+/// the same semantics as `min_max_synopsis::lookup`. The loops only compare
+/// and store into contiguous arrays so that the compiler can vectorize them.
+template <class T>
+auto scan_ranges(std::span<const T> min, std::span<const T> max,
+                 relational_operator op, T rhs,
+                 synopsis_columns::candidate_mask& result) -> bool {
+  TENZIR_ASSERT(min.size() == max.size());
+  TENZIR_ASSERT(result.size() == min.size());
+  const auto n = min.size();
+  switch (op) {
+    case relational_operator::equal:
+      for (auto i = size_t{0}; i < n; ++i) {
+        result[i] |= static_cast<uint8_t>(min[i] <= rhs && rhs <= max[i]);
+      }
+      return true;
+    case relational_operator::not_equal:
+      // A range can never rule out that it contains a different value.
+      std::ranges::fill(result, uint8_t{1});
+      return true;
+    case relational_operator::less:
+      for (auto i = size_t{0}; i < n; ++i) {
+        result[i] |= static_cast<uint8_t>(min[i] < rhs);
+      }
+      return true;
+    case relational_operator::less_equal:
+      for (auto i = size_t{0}; i < n; ++i) {
+        result[i] |= static_cast<uint8_t>(min[i] <= rhs);
+      }
+      return true;
+    case relational_operator::greater:
+      for (auto i = size_t{0}; i < n; ++i) {
+        result[i] |= static_cast<uint8_t>(max[i] > rhs);
+      }
+      return true;
+    case relational_operator::greater_equal:
+      for (auto i = size_t{0}; i < n; ++i) {
+        result[i] |= static_cast<uint8_t>(max[i] >= rhs);
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace
+
+synopsis_columns::synopsis_columns(const type& schema,
+                                   const synopsis_map& partitions)
+  : schema_{schema} {
+  const auto n = partitions.size();
+  uuids_.reserve(n);
+  events_.reserve(n);
+  min_import_times_.reserve(n);
+  max_import_times_.reserve(n);
+  store_times_.reserve(n);
+  versions_.reserve(n);
+  for (const auto& [id, ps] : partitions) {
+    TENZIR_ASSERT(ps->schema == schema);
+    uuids_.push_back(id);
+    events_.push_back(ps->events);
+    min_import_times_.push_back(ps->min_import_time);
+    max_import_times_.push_back(ps->max_import_time);
+    store_times_.push_back(ps->store_time);
+    versions_.push_back(ps->version);
+  }
+  const auto* schema_rt = try_as<record_type>(&schema_);
+  if (not schema_rt) {
+    return;
+  }
+  for (auto&& leaf : schema_rt->leaves()) {
+    fields_.emplace_back(schema_, leaf.index);
+  }
+  ranges_.reserve(fields_.size());
+  for (const auto& field : fields_) {
+    // The type synopses are looked up independent from names and attributes.
+    const auto cleaned_type
+      = match(field.type(), []<concrete_type T>(const T& x) {
+          return type{x};
+        });
+    auto make_column = [&]<class T>(tag<T>) -> range_column_variant {
+      auto column = range_column<T>{};
+      column.min.reserve(n);
+      column.max.reserve(n);
+      column.unknown.reserve(n);
+      for (const auto& [_, ps] : partitions) {
+        if (const auto* syn
+            = find_min_max_synopsis<T>(*ps, field, cleaned_type)) {
+          column.min.push_back(syn->min());
+          column.max.push_back(syn->max());
+          column.unknown.push_back(0);
+        } else {
+          column.min.push_back(T{});
+          column.max.push_back(T{});
+          column.unknown.push_back(1);
+        }
+      }
+      return column;
+    };
+    ranges_.push_back(match(
+      cleaned_type,
+      [&](const time_type&) {
+        return make_column(tag_v<time>);
+      },
+      [&](const duration_type&) {
+        return make_column(tag_v<duration>);
+      },
+      [&](const int64_type&) {
+        return make_column(tag_v<int64_t>);
+      },
+      [&](const uint64_type&) {
+        return make_column(tag_v<uint64_t>);
+      },
+      [&](const double_type&) {
+        return make_column(tag_v<double>);
+      },
+      [](const auto&) -> range_column_variant {
+        return std::monostate{};
+      }));
+  }
+}
+
+auto synopsis_columns::size() const noexcept -> size_t {
+  return uuids_.size();
+}
+
+auto synopsis_columns::fields() const noexcept
+  -> std::span<const qualified_record_field> {
+  return fields_;
+}
+
+auto synopsis_columns::lookup_import_time(relational_operator op,
+                                          time rhs) const -> candidate_mask {
+  auto result = candidate_mask(size(), 0);
+  if (not scan_ranges<time>(min_import_times_, max_import_times_, op, rhs,
+                            result)) {
+    std::ranges::fill(result, uint8_t{1});
+  }
+  return result;
+}
+
+auto synopsis_columns::lookup(size_t field, relational_operator op,
+                              const data& rhs) const
+  -> std::optional<candidate_mask> {
+  TENZIR_ASSERT(field < ranges_.size());
+  auto f = detail::overload{
+    [](const std::monostate&) -> std::optional<candidate_mask> {
+      return std::nullopt;
+    },
+    [&]<class T>(const range_column<T>& column)
+      -> std::optional<candidate_mask> {
+      auto result = candidate_mask(size(), 0);
+      auto scan = [&](relational_operator scan_op, const data& x) {
+        const auto* value = try_as<T>(&x);
+        return value
+               and scan_ranges<T>(column.min, column.max, scan_op, *value,
+                                  result);
+      };
+      if (op == relational_operator::in) {
+        const auto* xs = try_as<list>(&rhs);
+        if (not xs) {
+          return std::nullopt;
+        }
+        for (const auto& x : *xs) {
+          if (not scan(relational_operator::equal, x)) {
+            return std::nullopt;
+          }
+        }
+      } else if (not scan(op, rhs)) {
+        return std::nullopt;
+      }
+      for (auto i = size_t{0}; i < result.size(); ++i) {
+        result[i] |= column.unknown[i];
+      }
+      return result;
+    },
+  };
+  return std::visit(f, ranges_[field]);
+}
+
+auto synopsis_columns::info(size_t position) const -> partition_info {
+  TENZIR_ASSERT(position < size());
+  auto result
+    = partition_info{uuids_[position], events_[position],
+                     max_import_times_[position], schema_, versions_[position]};
+  result.store_time = store_times_[position];
+  return result;
+}
+
+auto synopsis_columns::memusage() const -> size_t {
+  auto result = sizeof(*this) + uuids_.capacity() * sizeof(uuid)
+                + events_.capacity() * sizeof(uint64_t)
+                + min_import_times_.capacity() * sizeof(time)
+                + max_import_times_.capacity() * sizeof(time)
+                + store_times_.capacity() * sizeof(time)
+                + versions_.capacity() * sizeof(uint64_t)
+                + fields_.capacity() * sizeof(qualified_record_field)
+                + ranges_.capacity() * sizeof(range_column_variant);
+  for (const auto& range : ranges_) {
+    std::visit(detail::overload{
+                 [](const std::monostate&) {},
+                 [&]<class T>(const range_column<T>& column) {
+                   result += (column.min.capacity() + column.max.capacity())
+                               * sizeof(T)
+                             + column.unknown.capacity();
+                 },
+               },
+               range);
+  }
+  return result;
+}
+
+} // namespace tenzir
@@ -19,6 +19,7 @@
 #include <caf/binary_serializer.hpp>
 #include <caf/detail/type_list.hpp>
 
+#include <algorithm>
 #include <type_traits>
 
 namespace tenzir::ast {
@@ -515,4 +516,104 @@ auto ast::expression::is_deterministic(const registry& reg) const -> bool {
     });
 }
 
+namespace {
+
+/// Adds the top-level fields read by `x` to `result`, returning false if the
+/// expression may read all of them.
+auto collect_root_fields(const ast::expression& x,
+                         std::vector<std::string>& result) -> bool {
+  const auto collect = [&](const ast::expression& x) {
+    return collect_root_fields(x, result);
+  };
+  return x.match(
+    [&](const ast::root_field& x) {
+      result.push_back(x.ident.name);
+      return true;
+    },
+    [&](const ast::field_access& x) {
+      if (is<ast::this_>(x.left)) {
+        result.push_back(x.name.name);
+        return true;
+      }
+      return collect(x.left);
+    },
+    [&](const ast::index_expr& x) {
+      if (is<ast::this_>(x.expr)) {
+        const auto* index = try_as<ast::constant>(x.index);
+        const auto* name = index ? try_as<std::string>(index->value) : nullptr;
+        if (name) {
+          result.push_back(*name);
+          return true;
+        }
+      }
+      return collect(x.expr) and collect(x.index);
+    },
+    [&](const ast::binary_expr& x) {
+      return collect(x.left) and collect(x.right);
+    },
+    [&](const ast::unary_expr& x) {
+      return collect(x.expr);
+    },
+    [&](const ast::function_call& x) {
+      return std::ranges::all_of(x.args, collect);
+    },
+    [&](const ast::record& x) {
+      return std::ranges::all_of(x.items, [&](const ast::record::item& item) {
+        return match(
+          item,
+          [&](const ast::record::field& x) {
+            return collect(x.expr);
+          },
+          [&](const ast::spread& x) {
+            return collect(x.expr);
+          });
+      });
+    },
+    [&](const ast::list& x) {
+      return std::ranges::all_of(x.items, [&](const ast::list::item& item) {
+        return match(
+          item,
+          [&](const ast::expression& x) {
+            return collect(x);
+          },
+          [&](const ast::spread& x) {
+            return collect(x.expr);
+          });
+      });
+    },
+    [&](const ast::unpack& x) {
+      return collect(x.expr);
+    },
+    [](const ast::constant&) {
+      return true;
+    },
+    [](const ast::meta&) {
+      return true;
+    },
+    [](const ast::dollar_var&) {
+      return true;
+    },
+    [](const ast::underscore&) {
+      return true;
+    },
+    [](const auto&) {
+      // This covers `this`, nested pipelines, and assignments.
+      return false;
+    });
+}
+
+} // namespace
+
+auto ast::expression::root_fields() const
+  -> std::optional<std::vector<std::string>> {
+  auto result = std::vector<std::string>{};
+  if (not collect_root_fields(*this, result)) {
+    return std::nullopt;
+  }
+  std::ranges::sort(result);
+  const auto [first, last] = std::ranges::unique(result);
+  result.erase(first, last);
+  return result;
+}
+
 } // namespace tenzir
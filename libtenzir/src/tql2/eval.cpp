@@ -14,10 +14,14 @@
 #include "tenzir/tql2/eval_impl.hpp"
 #include "tenzir/try.hpp"
 
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
 /// TODO:
 /// - Reduce series expansion. For example, `src_ip in [1.2.3.4, 1.2.3.5]`
 ///   currently creates `length` copies of the list.
-/// - Optimize expressions, e.g., constant folding, compute offsets.
+/// - Optimize expressions further, e.g., common subexpressions.
 /// - Short circuiting, active rows.
 /// - Stricter behavior for const-eval, or same behavior? For example, overflow.
 /// - Modes for "must be constant", "prefer constant", "prefer runtime", "must
@@ -33,38 +37,94 @@ auto resolve(const ast::simple_selector& sel, const table_slice& slice)
   return series{ty, array};
 }
 
-auto resolve(const ast::simple_selector& sel, type ty)
+namespace {
+
+/// Resolves a selector against a type, using `find_field(record, prefix, name)`
+/// to look up the index of a field in the record type at offset `prefix`.
+auto resolve_with(const ast::simple_selector& sel, type ty, auto&& find_field)
   -> variant<offset, resolve_error> {
-  // TODO: Write this properly.
-  auto sel_index = size_t{0};
   auto result = offset{};
-  auto&& path = sel.path();
+  const auto& path = sel.path();
   result.reserve(path.size());
-  while (sel_index < path.size()) {
-    auto rty = try_as<record_type>(ty);
+  for (const auto& ident : path) {
+    const auto* rty = try_as<record_type>(ty);
     if (not rty) {
-      return resolve_error{path[sel_index],
-                           resolve_error::field_of_non_record{ty}};
+      return resolve_error{ident, resolve_error::field_of_non_record{ty}};
     }
-    auto found = false;
-    auto field_index = size_t{0};
-    for (auto&& field : rty->fields()) {
-      if (field.name == path[sel_index].name) {
-        ty = field.type;
-        found = true;
-        sel_index += 1;
-        break;
-      }
-      ++field_index;
-    }
-    if (not found) {
-      return resolve_error{path[sel_index], resolve_error::field_not_found{}};
+    const auto index = find_field(*rty, result, ident.name);
+    if (not index) {
+      return resolve_error{ident, resolve_error::field_not_found{}};
     }
-    result.push_back(field_index);
+    ty = rty->field(*index).type;
+    result.push_back(*index);
   }
   return result;
 }
 
+} // namespace
+
+auto resolve(const ast::simple_selector& sel, type ty)
+  -> variant<offset, resolve_error> {
+  return resolve_with(sel, std::move(ty),
+                      [](const record_type& rty, const offset&,
+                         std::string_view name) -> std::optional<size_t> {
+                        auto index = size_t{0};
+                        for (auto&& field : rty.fields()) {
+                          if (field.name == name) {
+                            return index;
+                          }
+                          ++index;
+                        }
+                        return std::nullopt;
+                      });
+}
+
+auto selector_resolver::resolve(const ast::simple_selector& sel,
+                                const type& schema)
+  -> variant<offset, resolve_error> {
+  auto it = schemas_.find(schema);
+  if (it == schemas_.end()) {
+    if (schemas_.size() >= max_schemas) {
+      schemas_.clear();
+    }
+    it = schemas_.emplace(schema, schema_state{}).first;
+  }
+  // The field names that we index point into the schema that is the key of
+  // the state, so they live as long as the state itself.
+  auto& state = it->second;
+  if (auto cached = state.selectors.find(&sel);
+      cached != state.selectors.end()) {
+    return cached->second;
+  }
+  auto result = resolve_with(
+    sel, it->first,
+    [&](const record_type& rty, const offset& prefix,
+        std::string_view name) -> std::optional<size_t> {
+      auto& fields = state.fields[prefix];
+      if (fields.empty()) {
+        auto index = size_t{0};
+        for (auto&& field : rty.fields()) {
+          // The first field with a name wins, just like for the linear scan.
+          fields.emplace(field.name, index);
+          ++index;
+        }
+      }
+      if (auto field = fields.find(name); field != fields.end()) {
+        return field->second;
+      }
+      return std::nullopt;
+    });
+  return state.selectors.emplace(&sel, std::move(result)).first->second;
+}
+
+auto selector_resolver::resolve(const ast::simple_selector& sel,
+                                const table_slice& slice)
+  -> variant<series, resolve_error> {
+  TRY(auto offset, resolve(sel, slice.schema()));
+  auto [ty, array] = offset.get(slice);
+  return series{ty, array};
+}
+
 auto eval(const ast::expression& expr, const table_slice& input,
           diagnostic_handler& dh) -> multi_series {
   // TODO: Do not create a new session here.
@@ -82,6 +142,59 @@ auto eval(const ast::simple_selector& expr, const table_slice& input,
   return std::move(result.parts()[0]);
 }
 
+struct compiled_expression::impl {
+  /// The number of schemas whose plans we keep at most.
+  static constexpr auto max_plans = size_t{1024};
+
+  impl(const ast::expression& expr, diagnostic_handler& dh)
+    : expr{expr}, provider{session_provider::make(dh)} {
+  }
+
+  const ast::expression& expr;
+  // The instantiated functions may hold on to the session, so we must use the
+  // same session for all batches.
+  session_provider provider;
+  std::unordered_map<const ast::expression_kind*, std::optional<data>>
+    constants;
+  std::unordered_map<const ast::function_call*, function_ptr> functions;
+  std::unordered_map<type, expression_plan> plans;
+};
+
+compiled_expression::compiled_expression(const ast::expression& expr,
+                                         diagnostic_handler& dh)
+  : impl_{std::make_unique<impl>(expr, dh)} {
+}
+
+compiled_expression::~compiled_expression() noexcept = default;
+
+compiled_expression::compiled_expression(compiled_expression&&) noexcept
+  = default;
+
+auto compiled_expression::operator=(compiled_expression&&) noexcept
+  -> compiled_expression& = default;
+
+auto compiled_expression::eval(const table_slice& input) -> multi_series {
+  auto it = impl_->plans.find(input.schema());
+  if (it == impl_->plans.end()) {
+    if (impl_->plans.size() >= impl::max_plans) {
+      impl_->plans.clear();
+    }
+    auto plan = expression_plan{};
+    plan.constants = &impl_->constants;
+    plan.functions = &impl_->functions;
+    it = impl_->plans.emplace(input.schema(), std::move(plan)).first;
+  }
+  auto result
+    = evaluator{&input, impl_->provider.as_session(), &it->second}.eval(
+      impl_->expr);
+  TENZIR_ASSERT(result.length() == detail::narrow<int64_t>(input.rows()));
+  return result;
+}
+
+auto compiled_expression::expr() const -> const ast::expression& {
+  return impl_->expr;
+}
+
 auto const_eval(const ast::expression& expr, diagnostic_handler& dh)
   -> failure_or<data> {
   // TODO: Do not create a new session here.
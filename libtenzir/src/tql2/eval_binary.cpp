@@ -13,10 +13,17 @@
 #include "tenzir/checked_math.hpp"
 #include "tenzir/detail/assert.hpp"
 #include "tenzir/detail/narrow.hpp"
+#include "tenzir/detail/type_traits.hpp"
 #include "tenzir/series.hpp"
 #include "tenzir/tql2/ast.hpp"
 #include "tenzir/tql2/eval_impl.hpp"
 
+#include <arrow/util/bitmap_ops.h>
+
+#include <array>
+#include <bit>
+#include <cstring>
+
 // TODO: This file takes very long to compile. Consider splitting it up even more.
 
 namespace tenzir {
@@ -349,6 +356,248 @@ struct BinOpKernel<Op, L, R> {
   }
 };
 
+// -- bitmap kernels -----------------------------------------------------------
+//
+// The kernels below work on packed bitmaps 64 bits at a time. Their inner loops
+// have no branches and no data-dependent memory accesses, so that the compiler
+// vectorizes them for the instruction sets enabled at build time (see the
+// `TENZIR_ENABLE_*` options for SSE and AVX). The scalar code is the portable
+// fallback and needs no runtime dispatch.
+
+static_assert(std::endian::native == std::endian::little,
+              "the bitmap kernels assume the Arrow bit order in memory");
+
+/// Returns the operator that yields the same result for swapped operands.
+constexpr auto swap_operands(ast::binary_op op) -> ast::binary_op {
+  using enum ast::binary_op;
+  switch (op) {
+    case gt:
+      return lt;
+    case lt:
+      return gt;
+    case geq:
+      return leq;
+    case leq:
+      return geq;
+    default:
+      return op;
+  }
+}
+
+/// The types whose values we compare directly on the Arrow value buffers.
+template <class T>
+constexpr auto has_raw_values
+  = detail::is_any_v<T, int64_type, uint64_type, double_type, duration_type,
+                     time_type>;
+
+/// Returns the representation of a value in the Arrow value buffer.
+template <class T>
+auto to_raw(T x) {
+  if constexpr (std::same_as<T, duration>) {
+    return x.count();
+  } else if constexpr (std::same_as<T, time>) {
+    return x.time_since_epoch().count();
+  } else {
+    return x;
+  }
+}
+
+template <ast::binary_op Op, class L, class R>
+auto compare_raw(L l, R r) -> bool {
+  using enum ast::binary_op;
+  if constexpr (std::integral<L> and std::integral<R>) {
+    if constexpr (Op == eq) {
+      return std::cmp_equal(l, r);
+    } else if constexpr (Op == neq) {
+      return std::cmp_not_equal(l, r);
+    } else if constexpr (Op == gt) {
+      return std::cmp_greater(l, r);
+    } else if constexpr (Op == lt) {
+      return std::cmp_less(l, r);
+    } else if constexpr (Op == geq) {
+      return std::cmp_greater_equal(l, r);
+    } else if constexpr (Op == leq) {
+      return std::cmp_less_equal(l, r);
+    } else {
+      static_assert(detail::always_false_v<L>,
+                    "unexpected operator in relational kernel");
+    }
+  } else {
+    if constexpr (Op == eq) {
+      return l == r;
+    } else if constexpr (Op == neq) {
+      return l != r;
+    } else if constexpr (Op == gt) {
+      return l > r;
+    } else if constexpr (Op == lt) {
+      return l < r;
+    } else if constexpr (Op == geq) {
+      return l >= r;
+    } else if constexpr (Op == leq) {
+      return l <= r;
+    } else {
+      static_assert(detail::always_false_v<L>,
+                    "unexpected operator in relational kernel");
+    }
+  }
+}
+
+/// Returns the number of bytes of a bitmap of the given length that hold the
+/// bits starting at bit `i`, which must be a multiple of 64.
+auto word_bytes(int64_t i, int64_t length) -> size_t {
+  return detail::narrow_cast<size_t>((std::min(int64_t{64}, length - i) + 7)
+                                     / 8);
+}
+
+/// Loads the bits of a bitmap that start at bit `i`, which must be a multiple
+/// of 64. A missing bitmap has all bits set.
+auto load_word(const uint8_t* bits, int64_t i, int64_t length) -> uint64_t {
+  if (not bits) {
+    return ~uint64_t{0};
+  }
+  auto word = uint64_t{0};
+  std::memcpy(&word, bits + i / 8, word_bytes(i, length));
+  return word;
+}
+
+auto store_word(uint8_t* bits, int64_t i, int64_t length, uint64_t word)
+  -> void {
+  std::memcpy(bits + i / 8, &word, word_bytes(i, length));
+}
+
+/// Returns the bits of a bitmap starting at a byte boundary, copying them only
+/// if the offset is not a multiple of eight.
+auto aligned_bits(const uint8_t* bits, int64_t offset, int64_t length,
+                  std::shared_ptr<arrow::Buffer>& storage) -> const uint8_t* {
+  if (offset % 8 == 0) {
+    return bits + offset / 8;
+  }
+  storage = check(arrow::internal::CopyBitmap(arrow::default_memory_pool(),
+                                              bits, offset, length));
+  return storage->data();
+}
+
+/// Returns the validity bitmap of an array starting at a byte boundary, or
+/// `nullptr` if the array has no nulls.
+auto aligned_validity(const arrow::Array& array,
+                      std::shared_ptr<arrow::Buffer>& storage)
+  -> const uint8_t* {
+  if (array.null_count() == 0) {
+    return nullptr;
+  }
+  return aligned_bits(array.null_bitmap_data(), array.offset(), array.length(),
+                      storage);
+}
+
+/// Writes `predicate(i)` for all `i` in `[0, length)` into a bitmap.
+auto make_bitmap(int64_t length, auto&& predicate)
+  -> std::shared_ptr<arrow::Buffer> {
+  auto result = check(arrow::AllocateBitmap(length));
+  auto* bits = result->mutable_data();
+  for (auto i = int64_t{0}; i < length; i += 64) {
+    const auto n = std::min(int64_t{64}, length - i);
+    auto word = uint64_t{0};
+    for (auto j = int64_t{0}; j < n; ++j) {
+      word |= static_cast<uint64_t>(predicate(i + j)) << j;
+    }
+    store_word(bits, i, length, word);
+  }
+  return result;
+}
+
+/// Turns the result bits of a relational operator into a boolean array. The
+/// result is null if exactly one operand is null, and `result_if_both_null(Op)`
+/// if both are.
+template <ast::binary_op Op>
+auto finish_comparison(std::shared_ptr<arrow::Buffer> values, int64_t length,
+                       const uint8_t* left_valid, const uint8_t* right_valid)
+  -> std::shared_ptr<arrow::BooleanArray> {
+  if (not left_valid and not right_valid) {
+    return std::make_shared<arrow::BooleanArray>(length, std::move(values));
+  }
+  auto validity = check(arrow::AllocateBitmap(length));
+  auto* value_bits = values->mutable_data();
+  auto* valid_bits = validity->mutable_data();
+  constexpr auto both_null = result_if_both_null(Op);
+  for (auto i = int64_t{0}; i < length; i += 64) {
+    const auto l = load_word(left_valid, i, length);
+    const auto r = load_word(right_valid, i, length);
+    auto valid = l & r;
+    auto value = load_word(value_bits, i, length) & valid;
+    if constexpr (both_null) {
+      const auto none = ~(l | r);
+      valid |= none;
+      if constexpr (*both_null) {
+        value |= none;
+      }
+    }
+    store_word(value_bits, i, length, value);
+    store_word(valid_bits, i, length, valid);
+  }
+  return std::make_shared<arrow::BooleanArray>(length, std::move(values),
+                                               std::move(validity));
+}
+
+template <ast::binary_op Op, class L, class R>
+auto compare_arrays(const type_to_arrow_array_t<L>& l,
+                    const type_to_arrow_array_t<R>& r)
+  -> std::shared_ptr<arrow::BooleanArray> {
+  const auto* lv = l.raw_values();
+  const auto* rv = r.raw_values();
+  auto values = make_bitmap(l.length(), [&](int64_t i) {
+    return compare_raw<Op>(lv[i], rv[i]);
+  });
+  auto left_storage = std::shared_ptr<arrow::Buffer>{};
+  auto right_storage = std::shared_ptr<arrow::Buffer>{};
+  return finish_comparison<Op>(std::move(values), l.length(),
+                               aligned_validity(l, left_storage),
+                               aligned_validity(r, right_storage));
+}
+
+template <ast::binary_op Op, class L, class T>
+auto compare_array_to_constant(const type_to_arrow_array_t<L>& l, T r)
+  -> std::shared_ptr<arrow::BooleanArray> {
+  const auto* lv = l.raw_values();
+  auto values = make_bitmap(l.length(), [&](int64_t i) {
+    return compare_raw<Op>(lv[i], r);
+  });
+  auto left_storage = std::shared_ptr<arrow::Buffer>{};
+  return finish_comparison<Op>(std::move(values), l.length(),
+                               aligned_validity(l, left_storage), nullptr);
+}
+
+/// An IP address as two words in memory order, which suffices for equality
+/// and masking.
+struct ip_words {
+  uint64_t first;
+  uint64_t second;
+};
+
+auto load_ip(const uint8_t* bytes) -> ip_words {
+  auto result = ip_words{};
+  std::memcpy(&result.first, bytes, 8);
+  std::memcpy(&result.second, bytes + 8, 8);
+  return result;
+}
+
+/// Turns the equality bits of two IP columns into a boolean array. Unlike for
+/// the other relational operators, IP equality never returns null.
+template <ast::binary_op Op>
+auto finish_ip_equality(std::shared_ptr<arrow::Buffer> values, int64_t length,
+                        const uint8_t* left_valid, const uint8_t* right_valid)
+  -> std::shared_ptr<arrow::BooleanArray> {
+  constexpr auto invert
+    = Op == ast::binary_op::neq ? ~uint64_t{0} : uint64_t{0};
+  auto* value_bits = values->mutable_data();
+  for (auto i = int64_t{0}; i < length; i += 64) {
+    const auto l = load_word(left_valid, i, length);
+    const auto r = load_word(right_valid, i, length);
+    const auto equal = (load_word(value_bits, i, length) & l & r) | ~(l | r);
+    store_word(value_bits, i, length, equal ^ invert);
+  }
+  return std::make_shared<arrow::BooleanArray>(length, std::move(values));
+}
+
 template <ast::binary_op Op, concrete_type L, concrete_type R>
 struct EvalBinOp;
 
@@ -359,6 +608,10 @@ struct EvalBinOp<Op, L, R> {
   static auto eval(const type_to_arrow_array_t<L>& l,
                    const type_to_arrow_array_t<R>& r, auto&& warn)
     -> std::shared_ptr<arrow::Array> {
+    if constexpr (is_relational(Op) and has_raw_values<L>
+                  and has_raw_values<R>) {
+      return compare_arrays<Op, L, R>(l, r);
+    }
     using kernel = BinOpKernel<Op, L, R>;
     using result = kernel::result;
     using result_type = data_to_type_t<result>;
@@ -512,24 +765,18 @@ template <ast::binary_op Op>
 struct EvalBinOp<Op, ip_type, ip_type> {
   static auto eval(const ip_type::array_type& l, const ip_type::array_type& r,
                    auto&&) -> std::shared_ptr<arrow::BooleanArray> {
-    // TODO: This is bad.
-    constexpr auto invert = Op == ast::binary_op::neq;
-    auto b = arrow::BooleanBuilder{};
-    check(b.Reserve(l.length()));
-    for (auto i = int64_t{0}; i < l.length(); ++i) {
-      auto ln = l.IsNull(i);
-      auto rn = r.IsNull(i);
-      auto equal = bool{};
-      if (ln != rn) {
-        equal = false;
-      } else if (ln && rn) {
-        equal = true;
-      } else {
-        equal = value_at(ip_type{}, l, i) == value_at(ip_type{}, r, i);
-      }
-      b.UnsafeAppend(equal != invert);
-    }
-    return finish(b);
+    const auto* lv = l.storage()->raw_values();
+    const auto* rv = r.storage()->raw_values();
+    auto values = make_bitmap(l.length(), [&](int64_t i) {
+      const auto x = load_ip(lv + i * 16);
+      const auto y = load_ip(rv + i * 16);
+      return ((x.first ^ y.first) | (x.second ^ y.second)) == 0;
+    });
+    auto left_storage = std::shared_ptr<arrow::Buffer>{};
+    auto right_storage = std::shared_ptr<arrow::Buffer>{};
+    return finish_ip_equality<Op>(std::move(values), l.length(),
+                                  aligned_validity(l, left_storage),
+                                  aligned_validity(r, right_storage));
   }
 };
 
@@ -610,39 +857,199 @@ struct EvalBinOp<ast::binary_op::in, L, list_type> {
   }
 };
 
+/// Evaluates a relational operator between a column and a constant directly on
+/// the values of the column, without materializing the constant. Returns
+/// `std::nullopt` if there is no such kernel for the types.
+template <ast::binary_op Op>
+auto eval_op_constant(const series& left, const data& right)
+  -> std::optional<series> {
+  return match(right, [&]<class T>(const T& value) -> std::optional<series> {
+    return match(
+      left.type, [&]<concrete_type L>(const L&) -> std::optional<series> {
+        using LA = type_to_arrow_array_t<L>;
+        if constexpr (detail::is_any_v<T, int64_t, uint64_t, double, duration,
+                                       time>) {
+          using R = data_to_type_t<T>;
+          if constexpr (is_relational(Op) and has_raw_values<L>
+                        and caf::detail::is_complete<BinOpKernel<Op, L, R>>) {
+            return series{bool_type{}, compare_array_to_constant<Op, L>(
+                                         as<LA>(*left.array), to_raw(value))};
+          }
+        } else if constexpr (std::same_as<T, ip> and std::same_as<L, ip_type>
+                             and (Op == ast::binary_op::eq
+                                  or Op == ast::binary_op::neq)) {
+          const auto& array = as<LA>(*left.array);
+          const auto* lv = array.storage()->raw_values();
+          const auto y = load_ip(as_bytes<uint8_t>(value).data());
+          auto values = make_bitmap(array.length(), [&](int64_t i) {
+            const auto x = load_ip(lv + i * 16);
+            return ((x.first ^ y.first) | (x.second ^ y.second)) == 0;
+          });
+          auto storage = std::shared_ptr<arrow::Buffer>{};
+          return series{bool_type{}, finish_ip_equality<Op>(
+                                       std::move(values), array.length(),
+                                       aligned_validity(array, storage),
+                                       nullptr)};
+        } else if constexpr (std::same_as<T, subnet>
+                             and std::same_as<L, ip_type>
+                             and Op == ast::binary_op::in) {
+          // An address is in the subnet iff it equals the network address
+          // after masking it with the prefix length.
+          const auto& array = as<LA>(*left.array);
+          const auto* lv = array.storage()->raw_values();
+          auto all_ones = std::array<uint8_t, 16>{};
+          all_ones.fill(0xff);
+          auto mask_ip = ip::v6(std::span{all_ones});
+          mask_ip.mask(value.length());
+          const auto mask = load_ip(as_bytes<uint8_t>(mask_ip).data());
+          const auto network
+            = load_ip(as_bytes<uint8_t>(value.network()).data());
+          auto values = make_bitmap(array.length(), [&](int64_t i) {
+            const auto x = load_ip(lv + i * 16);
+            return (((x.first & mask.first) ^ network.first)
+                    | ((x.second & mask.second) ^ network.second))
+                   == 0;
+          });
+          auto storage = std::shared_ptr<arrow::Buffer>{};
+          return series{bool_type{},
+                        finish_comparison<Op>(std::move(values), array.length(),
+                                              aligned_validity(array, storage),
+                                              nullptr)};
+        }
+        return std::nullopt;
+      });
+  });
+}
+
 template <ast::binary_op Op>
 auto eval_op(evaluator& self, const ast::binary_expr& x) -> multi_series {
   TENZIR_ASSERT(x.op.inner == Op);
+  const auto eval_series = [&](series left, series right) -> series {
+    return match(
+      std::tie(left.type, right.type),
+      [&]<concrete_type L, concrete_type R>(const L&, const R&) -> series {
+        if constexpr (caf::detail::is_complete<EvalBinOp<Op, L, R>>) {
+          using LA = type_to_arrow_array_t<L>;
+          using RA = type_to_arrow_array_t<R>;
+          auto& la = as<LA>(*left.array);
+          auto& ra = as<RA>(*right.array);
+          auto oa = EvalBinOp<Op, L, R>::eval(la, ra, [&](const char* w) {
+            diagnostic::warning("{}", w).primary(x).emit(self.ctx());
+          });
+          auto ot = type::from_arrow(*oa->type());
+          return series{std::move(ot), std::move(oa)};
+        } else {
+          // TODO: Not possible?
+          // TODO: Where coercion? => coercion is done in kernel.
+          diagnostic::warning("binary operator `{}` not implemented for `{}` "
+                              "and `{}`",
+                              x.op.inner, left.type.kind(), right.type.kind())
+            .primary(x)
+            .emit(self.ctx());
+          return self.null();
+        }
+      });
+  };
+  // Comparisons against constants are very common in filters, so we evaluate
+  // them without materializing the constant where we have a kernel for it.
+  if constexpr (is_relational(Op) or Op == ast::binary_op::in) {
+    const auto eval_with_constant
+      = [&]<bool ConstantLeft>(const ast::expression& column,
+                               const ast::expression& constant)
+      -> std::optional<multi_series> {
+      auto value = self.try_constant(constant);
+      if (not value) {
+        return std::nullopt;
+      }
+      constexpr auto op = ConstantLeft ? swap_operands(Op) : Op;
+      auto offset = int64_t{0};
+      auto materialized = std::optional<series>{};
+      return map_series(self.eval(column), [&](series part) -> multi_series {
+        const auto begin = offset;
+        offset += part.length();
+        if (auto result = eval_op_constant<op>(part, *value)) {
+          return std::move(*result);
+        }
+        if (not materialized) {
+          materialized = self.to_series(*value);
+        }
+        auto constant_part = materialized->slice(begin, offset);
+        if constexpr (ConstantLeft) {
+          return eval_series(std::move(constant_part), std::move(part));
+        } else {
+          return eval_series(std::move(part), std::move(constant_part));
+        }
+      });
+    };
+    if (auto result
+        = eval_with_constant.template operator()<false>(x.left, x.right)) {
+      return std::move(*result);
+    }
+    if constexpr (is_relational(Op)) {
+      if (auto result
+          = eval_with_constant.template operator()<true>(x.right, x.left)) {
+        return std::move(*result);
+      }
+    }
+  }
   auto left = self.eval(x.left);
   auto right = self.eval(x.right);
   TENZIR_ASSERT(left.length() == right.length());
-  return map_series(
-    std::move(left), std::move(right), [&](series left, series right) {
-      return match(
-        std::tie(left.type, right.type),
-        [&]<concrete_type L, concrete_type R>(const L&, const R&) -> series {
-          if constexpr (caf::detail::is_complete<EvalBinOp<Op, L, R>>) {
-            using LA = type_to_arrow_array_t<L>;
-            using RA = type_to_arrow_array_t<R>;
-            auto& la = as<LA>(*left.array);
-            auto& ra = as<RA>(*right.array);
-            auto oa = EvalBinOp<Op, L, R>::eval(la, ra, [&](const char* w) {
-              diagnostic::warning("{}", w).primary(x).emit(self.ctx());
-            });
-            auto ot = type::from_arrow(*oa->type());
-            return series{std::move(ot), std::move(oa)};
-          } else {
-            // TODO: Not possible?
-            // TODO: Where coercion? => coercion is done in kernel.
-            diagnostic::warning("binary operator `{}` not implemented for `{}` "
-                                "and `{}`",
-                                x.op.inner, left.type.kind(), right.type.kind())
-              .primary(x)
-              .emit(self.ctx());
-            return self.null();
-          }
-        });
-    });
+  return map_series(std::move(left), std::move(right), eval_series);
+}
+
+/// Returns whether the expression is a comparison of fields and constants.
+/// Evaluating such a comparison for more rows than necessary is unobservable,
+/// as it can only emit warnings that depend on the schema.
+auto is_simple_comparison(const ast::expression& x) -> bool {
+  const auto* binary = try_as<ast::binary_expr>(x);
+  if (not binary
+      or not(is_relational(binary->op.inner)
+             or binary->op.inner == ast::binary_op::in)) {
+    return false;
+  }
+  const auto is_simple_operand = [](const ast::expression& y) {
+    return is<ast::root_field>(y) or is<ast::constant>(y);
+  };
+  return is_simple_operand(binary->left) and is_simple_operand(binary->right);
+}
+
+/// Combines the left side of `and` or `or` with its right side evaluated for
+/// all rows. The result is the same as for the short-circuit evaluation, which
+/// returns the left side where it determines the result, and the right side
+/// everywhere else.
+template <ast::binary_op Op>
+auto combine_and_or(const arrow::BooleanArray& left,
+                    const arrow::BooleanArray& right)
+  -> std::shared_ptr<arrow::BooleanArray> {
+  TENZIR_ASSERT(left.length() == right.length());
+  const auto length = left.length();
+  auto storage = std::array<std::shared_ptr<arrow::Buffer>, 4>{};
+  const auto* left_bits = aligned_bits(left.values()->data(), left.offset(),
+                                       length, storage[0]);
+  const auto* left_valid = aligned_validity(left, storage[1]);
+  const auto* right_bits = aligned_bits(right.values()->data(), right.offset(),
+                                        length, storage[2]);
+  const auto* right_valid = aligned_validity(right, storage[3]);
+  auto values = check(arrow::AllocateBitmap(length));
+  auto validity = check(arrow::AllocateBitmap(length));
+  for (auto i = int64_t{0}; i < length; i += 64) {
+    const auto lv = load_word(left_valid, i, length);
+    const auto lt = load_word(left_bits, i, length) & lv;
+    const auto rv = load_word(right_valid, i, length);
+    const auto rt = load_word(right_bits, i, length) & rv;
+    if constexpr (Op == ast::binary_op::and_) {
+      store_word(values->mutable_data(), i, length, lt & rt);
+      store_word(validity->mutable_data(), i, length, (lt & rv) | (~lt & lv));
+    } else if constexpr (Op == ast::binary_op::or_) {
+      store_word(values->mutable_data(), i, length, lt | rt);
+      store_word(validity->mutable_data(), i, length, lt | rv);
+    } else {
+      static_assert(detail::always_false_v<decltype(Op)>, "unsupported op");
+    }
+  }
+  return std::make_shared<arrow::BooleanArray>(length, std::move(values),
+                                               std::move(validity));
 }
 
 template <ast::binary_op Op>
@@ -721,6 +1128,19 @@ auto eval_and_or(evaluator& self, const ast::binary_expr& x) -> multi_series {
         });
     };
     TENZIR_ASSERT(typed_left);
+    if (is_simple_comparison(x.right)) {
+      auto right_offset = int64_t{0};
+      return map_series(
+        eval_right(0, length), [&](series right) -> multi_series {
+          const auto begin = right_offset;
+          right_offset += right.length();
+          const auto left_part = std::static_pointer_cast<arrow::BooleanArray>(
+            typed_left->array->Slice(begin, right.length()));
+          return series{bool_type{},
+                        combine_and_or<Op>(
+                          *left_part, as<arrow::BooleanArray>(*right.array))};
+        });
+    }
     const auto get_left = [&](int64_t i) -> bool {
       return typed_left->array->IsValid(i) and typed_left->array->GetView(i);
     };
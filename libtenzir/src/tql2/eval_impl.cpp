@@ -14,8 +14,10 @@
 #include <tenzir/detail/zip_iterator.hpp>
 #include <tenzir/multi_series_builder.hpp>
 #include <tenzir/series_builder.hpp>
+#include <tenzir/tql2/eval.hpp>
 #include <tenzir/tql2/eval_impl.hpp>
 
+#include <algorithm>
 #include <ranges>
 
 namespace tenzir {
@@ -212,15 +214,32 @@ auto evaluator::eval(const ast::field_access& x) -> multi_series {
 }
 
 auto evaluator::eval(const ast::function_call& x) -> multi_series {
-  // TODO: We parse the function call every time we get a new batch here. We
-  // could store the result in the AST if that becomes a problem, but that is
-  // also not an optimal solution.
-  auto func
-    = ctx_.reg().get(x).make_function(function_plugin::invocation{x}, ctx_);
+  auto* func = static_cast<function_use*>(nullptr);
+  auto owned = function_ptr{};
+  if (plan_) {
+    TENZIR_ASSERT(plan_->functions);
+    auto it = plan_->functions->find(&x);
+    if (it == plan_->functions->end()) {
+      auto made = ctx_.reg().get(x).make_function(
+        function_plugin::invocation{x}, ctx_);
+      it = plan_->functions->emplace(&x, made ? std::move(*made) : nullptr)
+             .first;
+    }
+    func = it->second.get();
+  } else {
+    // TODO: We parse the function call every time we get a new batch here,
+    // unless we evaluate a compiled expression.
+    auto made
+      = ctx_.reg().get(x).make_function(function_plugin::invocation{x}, ctx_);
+    if (made) {
+      owned = std::move(*made);
+      func = owned.get();
+    }
+  }
   if (not func) {
     return series::null(null_type{}, length_);
   }
-  auto result = (*func)->run(function_use::evaluator{this}, ctx_);
+  auto result = func->run(function_use::evaluator{this}, ctx_);
   TENZIR_ASSERT(result.length() == length_);
   return result;
 }
@@ -500,11 +519,154 @@ auto evaluator::eval(const ast::constant& x) -> multi_series {
 }
 
 auto evaluator::eval(const ast::expression& x) -> multi_series {
+  if (plan_) {
+    const auto& column = lower_column(x);
+    if (column and not column->path.empty()) {
+      auto array = to_record_batch(input_or_throw(x))->column(column->path[0]);
+      for (auto index : column->path | std::views::drop(1)) {
+        // Records with nulls take the regular path, which warns about them.
+        const auto& parent = as<arrow::StructArray>(*array);
+        if (parent.null_count() != 0) {
+          array = nullptr;
+          break;
+        }
+        array = parent.field(index);
+      }
+      if (array) {
+        return series{column->ty, std::move(array)};
+      }
+    }
+    if (const auto& constant = lower_constant(x)) {
+      return to_series(*constant);
+    }
+  }
   return x.match([&](auto& y) {
     return eval(y);
   });
 }
 
+auto evaluator::lower_column(const ast::expression& x)
+  -> const std::optional<expression_plan::column>& {
+  static const auto none = std::optional<expression_plan::column>{};
+  if (not is<ast::this_>(x) and not is<ast::root_field>(x)
+      and not is<ast::field_access>(x)) {
+    return none;
+  }
+  const auto* key = x.kind.get();
+  if (auto it = plan_->columns.find(key); it != plan_->columns.end()) {
+    return it->second;
+  }
+  const auto lower_field
+    = [](const expression_plan::column& record,
+         std::string_view name) -> std::optional<expression_plan::column> {
+    const auto* ty = try_as<record_type>(record.ty);
+    if (not ty) {
+      return std::nullopt;
+    }
+    for (auto [i, field] : detail::enumerate<int>(ty->fields())) {
+      if (field.name == name) {
+        auto result = record;
+        result.path.push_back(i);
+        result.ty = field.type;
+        return result;
+      }
+    }
+    return std::nullopt;
+  };
+  auto result = x.match(
+    [&](const ast::this_&) -> std::optional<expression_plan::column> {
+      return expression_plan::column{{}, input_or_throw(x).schema()};
+    },
+    [&](const ast::root_field& y) -> std::optional<expression_plan::column> {
+      return lower_field({{}, input_or_throw(x).schema()}, y.ident.name);
+    },
+    [&](const ast::field_access& y) -> std::optional<expression_plan::column> {
+      const auto& left = lower_column(y.left);
+      if (not left) {
+        return std::nullopt;
+      }
+      return lower_field(*left, y.name.name);
+    },
+    [](const auto&) -> std::optional<expression_plan::column> {
+      TENZIR_UNREACHABLE();
+    });
+  return plan_->columns.emplace(key, std::move(result)).first->second;
+}
+
+namespace {
+
+/// Checks whether an expression does not depend on the input and has no
+/// side effects, which makes it safe to evaluate only once.
+auto is_constant(const ast::expression& x) -> bool {
+  return x.match(
+    [](const ast::constant&) {
+      return true;
+    },
+    [](const ast::record& x) {
+      return std::ranges::all_of(x.items, [](const ast::record::item& item) {
+        return item.match(
+          [](const ast::record::field& field) {
+            return is_constant(field.expr);
+          },
+          [](const ast::spread& spread) {
+            return is_constant(spread.expr);
+          });
+      });
+    },
+    [](const ast::list& x) {
+      return std::ranges::all_of(x.items, [](const ast::list::item& item) {
+        return item.match(
+          [](const ast::expression& expr) {
+            return is_constant(expr);
+          },
+          [](const ast::spread& spread) {
+            return is_constant(spread.expr);
+          });
+      });
+    },
+    [](const ast::unary_expr& x) {
+      return is_constant(x.expr);
+    },
+    [](const ast::binary_expr& x) {
+      return is_constant(x.left) and is_constant(x.right);
+    },
+    [](const auto&) {
+      return false;
+    });
+}
+
+} // namespace
+
+auto evaluator::lower_constant(const ast::expression& x)
+  -> const std::optional<data>& {
+  static const auto none = std::optional<data>{};
+  // Plain constants are already cheap to evaluate.
+  if (is<ast::constant>(x)) {
+    return none;
+  }
+  TENZIR_ASSERT(plan_->constants);
+  const auto* key = x.kind.get();
+  if (auto it = plan_->constants->find(key); it != plan_->constants->end()) {
+    return it->second;
+  }
+  auto result = std::optional<data>{};
+  if (is_constant(x)) {
+    result = try_const_eval(x, ctx_);
+  }
+  return plan_->constants->emplace(key, std::move(result)).first->second;
+}
+
+auto evaluator::try_constant(const ast::expression& x)
+  -> std::optional<data> {
+  if (const auto* constant = try_as<ast::constant>(x)) {
+    return constant->as_data();
+  }
+  if (not plan_) {
+    return std::nullopt;
+  }
+  return lower_constant(x);
+}
+
 auto evaluator::input_or_throw(into_location location) -> const table_slice& {
   return input_.match(
     [&](const table_slice* input) -> const table_slice& {
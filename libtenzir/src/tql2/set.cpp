@@ -23,6 +23,7 @@
 #include <caf/detail/is_complete.hpp>
 #include <caf/detail/is_one_of.hpp>
 
+#include <algorithm>
 #include <type_traits>
 
 namespace tenzir {
@@ -303,9 +304,43 @@ auto assign(const ast::selector& left, series right, const table_slice& input,
     });
 }
 
+auto set_operator::input_fields(
+  const std::optional<std::vector<std::string>>& fields) const
+  -> std::optional<std::vector<std::string>> {
+  auto result = std::vector<std::string>{};
+  // Unless we assign to `this`, all fields that subsequent operators read are
+  // passed through from the input.
+  auto assigns_this = false;
+  for (const auto& assignment : assignments_) {
+    auto right = assignment.right.root_fields();
+    if (not right) {
+      return std::nullopt;
+    }
+    result.insert(result.end(), right->begin(), right->end());
+    if (const auto* left = try_as<ast::simple_selector>(assignment.left)) {
+      assigns_this |= left->has_this() and left->path().empty();
+    }
+  }
+  if (not assigns_this) {
+    if (not fields) {
+      return std::nullopt;
+    }
+    result.insert(result.end(), fields->begin(), fields->end());
+  }
+  std::ranges::sort(result);
+  const auto [first, last] = std::ranges::unique(result);
+  result.erase(first, last);
+  return result;
+}
+
 auto set_operator::operator()(generator<table_slice> input,
                               operator_control_plane& ctrl) const
   -> generator<table_slice> {
+  auto rights = std::vector<compiled_expression>{};
+  rights.reserve(assignments_.size());
+  for (const auto& assignment : assignments_) {
+    rights.emplace_back(assignment.right, ctrl.diagnostics());
+  }
   for (auto&& slice : input) {
     if (slice.rows() == 0) {
       co_yield {};
@@ -319,8 +354,8 @@ auto set_operator::operator()(generator<table_slice> input,
     // side-effects from preceding assignments shall not be reflected when
     // calculating the value of the left-hand side.
     auto values = std::vector<multi_series>{};
-    for (const auto& assignment : assignments_) {
-      values.push_back(eval(assignment.right, slice, ctrl.diagnostics()));
+    for (auto& right : rights) {
+      values.push_back(right.eval(slice));
     }
     // After we know all the multi series values on the right, we can split the
     // input table slice and perform the actual assignment.
@@ -0,0 +1,195 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/value_index.hpp"
+
+#include "tenzir/detail/assert.hpp"
+#include "tenzir/detail/type_traits.hpp"
+#include "tenzir/hash/hash.hpp"
+
+namespace tenzir {
+
+namespace {
+
+template <class T>
+concept indexable_type
+  = detail::is_any_v<T, string_type, ip_type, time_type, duration_type,
+                     int64_type, uint64_type, double_type>;
+
+} // namespace
+
+auto value_index::make(const type& t, duration resolution)
+  -> std::optional<value_index> {
+  auto supported = match(t, []<concrete_type T>(const T&) {
+    return indexable_type<T>;
+  });
+  if (not supported or resolution <= duration::zero()) {
+    return std::nullopt;
+  }
+  auto result = value_index{};
+  result.type_ = t;
+  result.resolution_ = resolution;
+  return result;
+}
+
+void value_index::append(data_view x, id row) {
+  if (is<caf::none_t>(x)) {
+    return;
+  }
+  auto key = make_key(x);
+  if (not key) {
+    return;
+  }
+  auto& bm = entries_[std::move(*key)];
+  TENZIR_ASSERT(row >= bm.size());
+  bm.append_bits(false, row - bm.size());
+  bm.append_bit(true);
+}
+
+auto value_index::lookup(relational_operator op, data_view rhs) const
+  -> std::optional<ids> {
+  if (is<caf::none_t>(rhs)) {
+    return std::nullopt;
+  }
+  auto result = ewah_bitmap{};
+  auto unite = [&](auto first, auto last) {
+    for (; first != last; ++first) {
+      result |= first->second;
+    }
+  };
+  auto unite_key = [&](data_view x) {
+    auto key = make_key(x);
+    if (not key) {
+      return false;
+    }
+    if (auto it = entries_.find(*key); it != entries_.end()) {
+      result |= it->second;
+    }
+    return true;
+  };
+  switch (op) {
+    case relational_operator::equal: {
+      if (not unite_key(rhs)) {
+        return std::nullopt;
+      }
+      break;
+    }
+    case relational_operator::in: {
+      if (const auto* xs = try_as<view<list>>(&rhs)) {
+        for (auto x : **xs) {
+          if (not unite_key(x)) {
+            return std::nullopt;
+          }
+        }
+        break;
+      }
+      // Addresses are ordered such that all members of a subnet form a
+      // contiguous range that starts at its network address.
+      const auto* sn = try_as<view<subnet>>(&rhs);
+      if (not sn or not is<ip_type>(type_)) {
+        return std::nullopt;
+      }
+      for (auto it = entries_.lower_bound(data{sn->network()});
+           it != entries_.end(); ++it) {
+        const auto* addr = try_as<ip>(&it->first);
+        if (not addr or not sn->contains(*addr)) {
+          break;
+        }
+        result |= it->second;
+      }
+      break;
+    }
+    case relational_operator::less:
+    case relational_operator::less_equal:
+    case relational_operator::greater:
+    case relational_operator::greater_equal: {
+      if (not is_ordered()) {
+        return std::nullopt;
+      }
+      auto key = make_key(rhs);
+      if (not key) {
+        return std::nullopt;
+      }
+      // A bin may contain values on both sides of the boundary, so binned
+      // indexes must always include the bin of the boundary itself.
+      const auto inclusive = is_binned()
+                             or op == relational_operator::less_equal
+                             or op == relational_operator::greater_equal;
+      if (op == relational_operator::less
+          or op == relational_operator::less_equal) {
+        unite(entries_.begin(), inclusive ? entries_.upper_bound(*key)
+                                          : entries_.lower_bound(*key));
+      } else {
+        unite(inclusive ? entries_.lower_bound(*key)
+                        : entries_.upper_bound(*key),
+              entries_.end());
+      }
+      break;
+    }
+    default:
+      // Negations would require tracking the rows with null values, and the
+      // other operators do not apply to the indexed types.
+      return std::nullopt;
+  }
+  return ids{std::move(result)};
+}
+
+auto value_index::value_type() const -> const type& {
+  return type_;
+}
+
+auto value_index::size() const -> size_t {
+  return entries_.size();
+}
+
+auto value_index::memusage() const -> size_t {
+  auto result = sizeof(*this);
+  for (const auto& [key, bm] : entries_) {
+    result += sizeof(key) + bm.memusage();
+  }
+  return result;
+}
+
+auto value_index::make_key(data_view x) const -> std::optional<data> {
+  const auto bin = [&](duration d) {
+    auto remainder = d % resolution_;
+    if (remainder < duration::zero()) {
+      remainder += resolution_;
+    }
+    return d - remainder;
+  };
+  return match(type_, [&]<concrete_type T>(const T&) -> std::optional<data> {
+    if constexpr (not indexable_type<T>) {
+      return std::nullopt;
+    } else {
+      const auto* value = try_as<view<type_to_data_t<T>>>(&x);
+      if (not value) {
+        return std::nullopt;
+      }
+      if constexpr (std::is_same_v<T, string_type>) {
+        return data{hash(*value)};
+      } else if constexpr (std::is_same_v<T, time_type>) {
+        return data{time{bin(value->time_since_epoch())}};
+      } else if constexpr (std::is_same_v<T, duration_type>) {
+        return data{bin(*value)};
+      } else {
+        return data{materialize(*value)};
+      }
+    }
+  });
+}
+
+auto value_index::is_ordered() const -> bool {
+  return not is<string_type>(type_);
+}
+
+auto value_index::is_binned() const -> bool {
+  return is<time_type>(type_) or is<duration_type>(type_);
+}
+
+} // namespace tenzir
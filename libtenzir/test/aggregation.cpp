@@ -0,0 +1,178 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/diagnostics.hpp"
+#include "tenzir/series_builder.hpp"
+#include "tenzir/session.hpp"
+#include "tenzir/test/test.hpp"
+#include "tenzir/tql2/ast.hpp"
+#include "tenzir/tql2/parser.hpp"
+#include "tenzir/tql2/plugin.hpp"
+#include "tenzir/tql2/registry.hpp"
+#include "tenzir/tql2/resolve.hpp"
+
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <string_view>
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+/// Creates aggregation instances from TQL function calls over the field `x`.
+class aggregations {
+public:
+  aggregations() : provider_{session_provider::make(dh_)} {
+  }
+
+  auto make(std::string_view source) -> std::unique_ptr<aggregation_instance> {
+    auto ctx = provider_.as_session();
+    auto expr = parse_expression_with_bad_diagnostics(source, ctx);
+    REQUIRE(expr);
+    REQUIRE(resolve_entities(*expr, ctx));
+    const auto* call = try_as<ast::function_call>(*expr);
+    REQUIRE(call);
+    // The instances may refer to the call, so we keep it alive.
+    const auto& stored = calls_.emplace_back(*call);
+    const auto* fn
+      = dynamic_cast<const aggregation_plugin*>(&ctx.reg().get(stored));
+    REQUIRE(fn);
+    auto result
+      = fn->make_aggregation(aggregation_plugin::invocation{stored}, ctx);
+    REQUIRE(result);
+    return std::move(*result);
+  }
+
+  auto ctx() -> session {
+    return provider_.as_session();
+  }
+
+  auto warned() const -> bool {
+    return not dh_.empty();
+  }
+
+private:
+  collecting_diagnostic_handler dh_;
+  session_provider provider_;
+  std::deque<ast::function_call> calls_;
+};
+
+template <class T>
+auto make_slice(std::vector<T> xs) -> table_slice {
+  auto b = series_builder{};
+  for (const auto& x : xs) {
+    b.record().field("x").data(x);
+  }
+  return b.finish_assert_one_slice();
+}
+
+auto approx_equal(const data& lhs, const data& rhs) -> bool {
+  const auto* l = try_as<double>(&lhs);
+  const auto* r = try_as<double>(&rhs);
+  return l and r and std::abs(*l - *r) < 1e-9;
+}
+
+} // namespace
+
+TEST(merging sums) {
+  auto aggrs = aggregations{};
+  auto lhs = aggrs.make("sum(x)");
+  auto rhs = aggrs.make("sum(x)");
+  auto empty = aggrs.make("sum(x)");
+  lhs->update(make_slice<int64_t>({1, 2}), aggrs.ctx());
+  rhs->update(make_slice<int64_t>({3}), aggrs.ctx());
+  lhs->merge(*rhs, aggrs.ctx());
+  lhs->merge(*empty, aggrs.ctx());
+  CHECK_EQUAL(lhs->get(), data{int64_t{6}});
+  empty->merge(*lhs, aggrs.ctx());
+  CHECK_EQUAL(empty->get(), data{int64_t{6}});
+  CHECK(not aggrs.warned());
+}
+
+TEST(merging sums that overflow) {
+  auto aggrs = aggregations{};
+  auto lhs = aggrs.make("sum(x)");
+  auto rhs = aggrs.make("sum(x)");
+  lhs->update(make_slice<int64_t>({std::numeric_limits<int64_t>::max()}),
+              aggrs.ctx());
+  rhs->update(make_slice<int64_t>({1}), aggrs.ctx());
+  lhs->merge(*rhs, aggrs.ctx());
+  CHECK(aggrs.warned());
+  CHECK_EQUAL(lhs->get(), data{});
+  // The overflow sticks, even after merging more input.
+  lhs->merge(*rhs, aggrs.ctx());
+  CHECK_EQUAL(lhs->get(), data{});
+}
+
+TEST(failed states survive saving and restoring) {
+  auto aggrs = aggregations{};
+  for (const auto* call : {"sum(x)", "min(x)", "max(x)"}) {
+    auto failed = aggrs.make(call);
+    failed->update(make_slice<int64_t>({1}), aggrs.ctx());
+    failed->update(make_slice<std::string>({"foo"}), aggrs.ctx());
+    CHECK_EQUAL(failed->get(), data{});
+    auto restored = aggrs.make(call);
+    restored->restore(failed->save(), aggrs.ctx());
+    auto valid = aggrs.make(call);
+    valid->update(make_slice<int64_t>({2}), aggrs.ctx());
+    restored->merge(*valid, aggrs.ctx());
+    CHECK_EQUAL(restored->get(), data{});
+    // An instance without input is not a failed one, however.
+    auto fresh = aggrs.make(call);
+    auto restored_fresh = aggrs.make(call);
+    restored_fresh->restore(fresh->save(), aggrs.ctx());
+    restored_fresh->merge(*valid, aggrs.ctx());
+    CHECK_EQUAL(restored_fresh->get(), data{int64_t{2}});
+  }
+}
+
+TEST(merging means weights by count) {
+  auto aggrs = aggregations{};
+  auto serial = aggrs.make("mean(x)");
+  auto lhs = aggrs.make("mean(x)");
+  auto rhs = aggrs.make("mean(x)");
+  serial->update(make_slice<int64_t>({1, 2, 3, 10}), aggrs.ctx());
+  lhs->update(make_slice<int64_t>({1, 2, 3}), aggrs.ctx());
+  rhs->update(make_slice<int64_t>({10}), aggrs.ctx());
+  lhs->merge(*rhs, aggrs.ctx());
+  CHECK_EQUAL(lhs->get(), data{4.0});
+  CHECK_EQUAL(lhs->get(), serial->get());
+}
+
+TEST(merging standard deviations and variances weights by count) {
+  auto aggrs = aggregations{};
+  for (const auto* call : {"stddev(x)", "variance(x)"}) {
+    auto serial = aggrs.make(call);
+    auto lhs = aggrs.make(call);
+    auto rhs = aggrs.make(call);
+    serial->update(make_slice<double>({1.0, 2.0, 3.0, 4.0, 10.0}),
+                   aggrs.ctx());
+    lhs->update(make_slice<double>({1.0, 2.0}), aggrs.ctx());
+    rhs->update(make_slice<double>({3.0, 4.0, 10.0}), aggrs.ctx());
+    lhs->merge(*rhs, aggrs.ctx());
+    CHECK(approx_equal(lhs->get(), serial->get()));
+  }
+}
+
+TEST(merging means of incompatible types fails) {
+  auto aggrs = aggregations{};
+  auto lhs = aggrs.make("mean(x)");
+  auto rhs = aggrs.make("mean(x)");
+  lhs->update(make_slice<duration>({1s, 3s}), aggrs.ctx());
+  rhs->update(make_slice<int64_t>({1}), aggrs.ctx());
+  lhs->merge(*rhs, aggrs.ctx());
+  CHECK(aggrs.warned());
+  CHECK_EQUAL(lhs->get(), data{});
+  // A failed state propagates through merging.
+  auto other = aggrs.make("mean(x)");
+  other->update(make_slice<duration>({1s}), aggrs.ctx());
+  other->merge(*lhs, aggrs.ctx());
+  CHECK_EQUAL(other->get(), data{});
+}
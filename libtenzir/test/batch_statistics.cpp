@@ -0,0 +1,187 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/batch_statistics.hpp"
+
+#include "tenzir/expression.hpp"
+#include "tenzir/ids.hpp"
+#include "tenzir/series_builder.hpp"
+#include "tenzir/synopsis_factory.hpp"
+#include "tenzir/table_slice.hpp"
+#include "tenzir/test/test.hpp"
+
+#include <optional>
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+/// Creates a slice with the fields `x` and `r.a`, where a missing `x` is null.
+auto make_slice(std::vector<std::optional<int64_t>> xs, int64_t a,
+                time import_time) -> table_slice {
+  auto b = series_builder{};
+  for (const auto& x : xs) {
+    auto event = b.record();
+    if (x) {
+      event.field("x").data(*x);
+    } else {
+      event.field("x").null();
+    }
+    event.field("r").record().field("a").data(a);
+  }
+  auto result = b.finish_assert_one_slice("test.event");
+  result.import_time(import_time);
+  return result;
+}
+
+auto x(relational_operator op, data rhs) -> expression {
+  return predicate{data_extractor{type{int64_type{}}, 0}, op, std::move(rhs)};
+}
+
+auto a(relational_operator op, data rhs) -> expression {
+  return predicate{data_extractor{type{int64_type{}}, 1}, op, std::move(rhs)};
+}
+
+struct fixture {
+  fixture() {
+    factory<synopsis>::initialize();
+    statistics.push_back(make_batch_statistics(make_slice({1, {}, 3}, 10, t1)));
+    statistics.push_back(make_batch_statistics(make_slice({7, 8, 9}, 20, t2)));
+    statistics.push_back(
+      make_batch_statistics(make_slice({{}, {}, {}}, 30, t2)));
+  }
+
+  const time t1 = time{} + 100s;
+  const time t2 = time{} + 200s;
+  std::vector<batch_statistics> statistics;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(batch_statistics_tests, fixture)
+
+TEST(batch statistics per leaf column) {
+  const auto& stats = statistics[0];
+  CHECK_EQUAL(stats.rows, 3u);
+  CHECK_EQUAL(stats.import_time, t1);
+  REQUIRE_EQUAL(stats.columns.size(), 2u);
+  CHECK_EQUAL(stats.columns[0].null_count, 1u);
+  CHECK_EQUAL(stats.columns[1].null_count, 0u);
+  CHECK(stats.columns[0].synopsis);
+  CHECK(stats.columns[1].synopsis);
+  // A column without any values does not need a synopsis.
+  CHECK_EQUAL(statistics[2].columns[0].null_count, 3u);
+  CHECK(not statistics[2].columns[0].synopsis);
+}
+
+TEST(batch statistics minimum and maximum) {
+  using enum relational_operator;
+  const auto& [lhs, rhs, nulls] = std::tie(statistics[0], statistics[1],
+                                           statistics[2]);
+  CHECK(may_match(x(equal, int64_t{3}), lhs));
+  CHECK(not may_match(x(equal, int64_t{8}), lhs));
+  CHECK(may_match(x(equal, int64_t{8}), rhs));
+  CHECK(not may_match(x(greater, int64_t{5}), lhs));
+  CHECK(may_match(x(greater, int64_t{5}), rhs));
+  CHECK(not may_match(x(less_equal, int64_t{6}), rhs));
+  CHECK(may_match(a(equal, int64_t{20}), rhs));
+  CHECK(not may_match(a(equal, int64_t{20}), lhs));
+  // Only null values never match a comparison with a value.
+  CHECK(not may_match(x(equal, int64_t{5}), nulls));
+  CHECK(not may_match(x(greater, int64_t{5}), nulls));
+}
+
+TEST(batch statistics null counts) {
+  using enum relational_operator;
+  const auto& [lhs, rhs, nulls] = std::tie(statistics[0], statistics[1],
+                                           statistics[2]);
+  CHECK(may_match(x(equal, caf::none), lhs));
+  CHECK(not may_match(x(equal, caf::none), rhs));
+  CHECK(may_match(x(equal, caf::none), nulls));
+  CHECK(may_match(x(not_equal, caf::none), lhs));
+  CHECK(may_match(x(not_equal, caf::none), rhs));
+  CHECK(not may_match(x(not_equal, caf::none), nulls));
+  // Null values satisfy negated predicates.
+  CHECK(may_match(x(not_equal, int64_t{5}), nulls));
+  CHECK(may_match(x(not_in, list{int64_t{1}, int64_t{3}}), lhs));
+}
+
+TEST(batch statistics import time) {
+  using enum relational_operator;
+  const auto import_time
+    = operand{meta_extractor{meta_extractor::import_time}};
+  CHECK(not may_match(predicate{import_time, greater, data{t1}},
+                      statistics[0]));
+  CHECK(may_match(predicate{import_time, greater, data{t1}}, statistics[1]));
+  // Other meta extractors are not covered by the statistics.
+  CHECK(may_match(predicate{meta_extractor{meta_extractor::schema}, equal,
+                            data{"foo"}},
+                  statistics[0]));
+}
+
+TEST(batch statistics connectives) {
+  using enum relational_operator;
+  const auto& [lhs, rhs] = std::tie(statistics[0], statistics[1]);
+  const auto either
+    = expression{disjunction{x(equal, int64_t{2}), x(equal, int64_t{8})}};
+  CHECK(may_match(either, lhs));
+  CHECK(may_match(either, rhs));
+  const auto neither
+    = expression{disjunction{x(equal, int64_t{100}), a(equal, int64_t{10})}};
+  CHECK(may_match(neither, lhs));
+  CHECK(not may_match(neither, rhs));
+  const auto both
+    = expression{conjunction{x(equal, int64_t{2}), a(equal, int64_t{20})}};
+  CHECK(not may_match(both, lhs));
+  CHECK(not may_match(both, rhs));
+  // Negations never rule out a record batch, as the synopses may return
+  // false positives.
+  CHECK(may_match(expression{negation{x(equal, int64_t{8})}}, rhs));
+  CHECK(may_match(expression{negation{x(equal, int64_t{2})}}, rhs));
+  CHECK(may_match(expression{}, lhs));
+}
+
+TEST(batch statistics unsupported predicates) {
+  using enum relational_operator;
+  const auto& rhs = statistics[1];
+  // Operators that the synopsis cannot answer.
+  CHECK(may_match(x(ni, int64_t{1}), rhs));
+  // Values of a different type than the column.
+  CHECK(may_match(x(equal, data{"foo"}), rhs));
+  // Predicates that compare two columns.
+  CHECK(may_match(predicate{data_extractor{type{int64_type{}}, 0}, equal,
+                            data_extractor{type{int64_type{}}, 1}},
+                  rhs));
+  // Columns that the statistics do not know.
+  CHECK(may_match(predicate{data_extractor{type{int64_type{}}, 42}, equal,
+                            data{int64_t{1}}},
+                  rhs));
+}
+
+TEST(select batches) {
+  using enum relational_operator;
+  CHECK_EQUAL(select_batches(x(greater, int64_t{5}), ids{}, statistics),
+              (std::vector<int>{1}));
+  CHECK_EQUAL(select_batches(x(equal, caf::none), ids{}, statistics),
+              (std::vector<int>{0, 2}));
+  CHECK_EQUAL(select_batches(expression{}, ids{}, statistics),
+              (std::vector<int>{0, 1, 2}));
+  // The record batches span the ids [0, 3), [3, 6), and [6, 9).
+  const auto any = x(greater_equal, int64_t{1});
+  CHECK_EQUAL(select_batches(any, make_ids({{4, 5}}), statistics),
+              (std::vector<int>{1}));
+  CHECK_EQUAL(select_batches(any, make_ids({{2, 4}}), statistics),
+              (std::vector<int>{0, 1}));
+  CHECK_EQUAL(select_batches(any, make_ids({{6, 9}}), statistics),
+              (std::vector<int>{}));
+  CHECK_EQUAL(select_batches(any, make_ids({{9, 10}}), statistics),
+              (std::vector<int>{}));
+}
+
+FIXTURE_SCOPE_END()
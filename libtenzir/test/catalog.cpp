@@ -0,0 +1,219 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/catalog.hpp"
+
+#include "tenzir/concept/parseable/tenzir/expression.hpp"
+#include "tenzir/concept/parseable/to.hpp"
+#include "tenzir/configuration.hpp"
+#include "tenzir/detail/narrow.hpp"
+#include "tenzir/int64_synopsis.hpp"
+#include "tenzir/query_context.hpp"
+#include "tenzir/test/test.hpp"
+#include "tenzir/time_synopsis.hpp"
+
+#include <caf/actor_system.hpp>
+#include <caf/scoped_actor.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+const auto epoch = time{};
+
+auto make_schema(size_t i) -> type {
+  return type{
+    fmt::format("test.schema_{}", i),
+    record_type{
+      {"ts", time_type{}},
+      {"x", int64_type{}},
+    },
+  };
+}
+
+auto make_synopsis(const type& schema, time first, time last, int64_t x)
+  -> partition_synopsis_ptr {
+  auto result = caf::make_copy_on_write<partition_synopsis>();
+  auto& ps = result.unshared();
+  ps.schema = schema;
+  ps.events = 10;
+  ps.min_import_time = first;
+  ps.max_import_time = last;
+  ps.field_synopses_[qualified_record_field{schema, offset{0}}]
+    = std::make_unique<time_synopsis>(first, last);
+  ps.field_synopses_[qualified_record_field{schema, offset{1}}]
+    = std::make_unique<int64_synopsis>(x, x + 9);
+  return result;
+}
+
+/// Flattens a lookup result into a sorted list of `<schema>/<partition>`
+/// entries, keeping the order of the partitions within each schema.
+auto flatten(const catalog_lookup_result& result) -> std::vector<std::string> {
+  auto schemas = std::vector<type>{};
+  for (const auto& [schema, _] : result.candidate_infos) {
+    schemas.push_back(schema);
+  }
+  std::ranges::sort(schemas, [](const type& lhs, const type& rhs) {
+    return lhs.name() < rhs.name();
+  });
+  auto entries = std::vector<std::string>{};
+  for (const auto& schema : schemas) {
+    for (const auto& info : result.candidate_infos.at(schema).partition_infos) {
+      entries.push_back(fmt::format("{}/{}", schema.name(), info.uuid));
+    }
+  }
+  return entries;
+}
+
+struct fixture {
+  fixture() {
+    // Spread the partitions over many schemas so that the catalog splits the
+    // lookup over several workers.
+    for (auto i = size_t{0}; i < num_schemas; ++i) {
+      const auto schema = make_schema(i);
+      for (auto j = int64_t{0}; j < 3; ++j) {
+        const auto first = epoch + std::chrono::seconds{10 * j};
+        partitions.push_back({
+          uuid::random(),
+          make_synopsis(schema, first, first + 10s,
+                        detail::narrow_cast<int64_t>(i) * 30 + j * 10),
+        });
+      }
+    }
+    state.merge(partitions);
+    catalog = spawn_catalog();
+  }
+
+  ~fixture() {
+    self->send_exit(catalog, caf::exit_reason::user_shutdown);
+  }
+
+  /// Spawns a catalog actor that knows the fixture's partitions.
+  auto spawn_catalog() -> catalog_actor {
+    auto result = system.spawn(tenzir::catalog);
+    self->mail(atom::merge_v, partitions)
+      .request(result, caf::infinite)
+      .receive(
+        [](atom::ok) {},
+        [](const caf::error& err) {
+          FAIL(fmt::to_string(err));
+        });
+    return result;
+  }
+
+  static auto query(std::string_view expr) -> query_context {
+    auto result = query_context{};
+    result.expr = unbox(to<expression>(expr));
+    return result;
+  }
+
+  static constexpr auto num_schemas = size_t{16};
+
+  std::vector<partition_synopsis_pair> partitions;
+  catalog_state state;
+  configuration cfg;
+  caf::actor_system system{cfg};
+  caf::scoped_actor self{system};
+  catalog_actor catalog;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(catalog_tests, fixture)
+
+TEST(catalog lookup across workers equals a single lookup) {
+  for (const auto* expr : {"x >= 0", "x > 100", "x == 42", "x < 0",
+                           "#schema == \"test.schema_3\""}) {
+    MESSAGE("lookup for " << expr);
+    const auto expected = unbox(state.snapshot->lookup(query(expr).expr));
+    self->mail(atom::candidates_v, query(expr))
+      .request(catalog, caf::infinite)
+      .receive(
+        [&](const catalog_lookup_result& result) {
+          CHECK_EQUAL(result.size(), expected.size());
+          CHECK_EQUAL(flatten(result), flatten(expected));
+        },
+        [](const caf::error& err) {
+          FAIL(fmt::to_string(err));
+        });
+  }
+  // The unrestricted lookup contains every partition of every schema.
+  const auto all = unbox(state.snapshot->lookup(query("x >= 0").expr));
+  CHECK_EQUAL(flatten(all).size(), partitions.size());
+}
+
+TEST(catalog snapshot is unaffected by later updates) {
+  const auto snapshot = state.snapshot;
+  const auto expr = query("x >= 0").expr;
+  const auto before = flatten(unbox(snapshot->lookup(expr)));
+  const auto added = partition_synopsis_pair{
+    uuid::random(),
+    make_synopsis(make_schema(0), epoch + 1min, epoch + 2min, 5),
+  };
+  state.merge({added});
+  state.erase({partitions[0].uuid, partitions[4].uuid});
+  CHECK_EQUAL(flatten(unbox(snapshot->lookup(expr))), before);
+  const auto after = flatten(unbox(state.snapshot->lookup(expr)));
+  CHECK_EQUAL(after.size(), before.size() - 1);
+  CHECK(std::ranges::count(after, fmt::format("test.schema_0/{}", added.uuid))
+        == 1);
+}
+
+TEST(catalog lookup overlapping an erase sees its snapshot) {
+  const auto erased = partitions[0];
+  // The catalog handles the lookup before the erase, so the lookup workers
+  // still see the erased partition, even though they may only run after the
+  // catalog replaced its snapshot.
+  auto lookup = self->mail(atom::candidates_v, query("x >= 0"))
+                  .request(catalog, caf::infinite);
+  auto erase
+    = self->mail(atom::erase_v, erased.uuid).request(catalog, caf::infinite);
+  auto merge = self->mail(atom::merge_v,
+                          std::vector<partition_synopsis_pair>{{
+                            uuid::random(),
+                            make_synopsis(make_schema(0), epoch + 1min,
+                                          epoch + 2min, 5),
+                          }})
+                 .request(catalog, caf::infinite);
+  lookup.receive(
+    [&](const catalog_lookup_result& result) {
+      CHECK_EQUAL(flatten(result), flatten(unbox(state.snapshot->lookup(
+                                     query("x >= 0").expr))));
+    },
+    [](const caf::error& err) {
+      FAIL(fmt::to_string(err));
+    });
+  erase.receive([](atom::ok) {},
+                [](const caf::error& err) {
+                  FAIL(fmt::to_string(err));
+                });
+  merge.receive([](atom::ok) {},
+                [](const caf::error& err) {
+                  FAIL(fmt::to_string(err));
+                });
+  // Subsequent lookups see the updated catalog.
+  self->mail(atom::candidates_v, query("#schema == \"test.schema_0\""))
+    .request(catalog, caf::infinite)
+    .receive(
+      [&](const catalog_lookup_result& result) {
+        const auto entries = flatten(result);
+        CHECK_EQUAL(entries.size(), size_t{3});
+        CHECK(std::ranges::count(
+                entries, fmt::format("test.schema_0/{}", erased.uuid))
+              == 0);
+      },
+      [](const caf::error& err) {
+        FAIL(fmt::to_string(err));
+      });
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,94 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/as_bytes.hpp"
+#include "tenzir/chunk.hpp"
+#include "tenzir/index.hpp"
+#include "tenzir/io/save.hpp"
+#include "tenzir/test/test.hpp"
+#include "tenzir/uuid.hpp"
+
+#include <filesystem>
+#include <string_view>
+
+using namespace tenzir;
+
+namespace {
+
+auto contents(const chunk_ptr& chunk) -> std::string_view {
+  return {reinterpret_cast<const char*>(chunk->data()), chunk->size()};
+}
+
+struct fixture {
+  fixture() {
+    std::filesystem::create_directories(dir);
+  }
+
+  ~fixture() {
+    auto err = std::error_code{};
+    std::filesystem::remove_all(dir, err);
+  }
+
+  /// Writes a fake synopsis file for a partition.
+  auto make_synopsis(const uuid& id, std::string_view contents)
+    -> std::pair<uuid, std::filesystem::path> {
+    auto path = dir / fmt::format("{}.mdx", id);
+    REQUIRE(not io::save(path, as_bytes(contents)));
+    return {id, path};
+  }
+
+  const std::filesystem::path dir
+    = std::filesystem::temp_directory_path()
+      / fmt::format("tenzir-catalog-snapshot-{}", uuid::random());
+  const std::filesystem::path snapshot_path = dir / "catalog.bin";
+};
+
+} // namespace
+
+FIXTURE_SCOPE(catalog_snapshot_tests, fixture)
+
+TEST(catalog snapshot without a file) {
+  CHECK(load_catalog_snapshot(snapshot_path).empty());
+}
+
+TEST(catalog snapshot roundtrip) {
+  const auto a = make_synopsis(uuid::random(), "foo");
+  const auto b = make_synopsis(uuid::random(), "barbaz");
+  const auto missing = std::pair{uuid::random(), dir / "missing.mdx"};
+  CHECK_EQUAL(unbox(write_catalog_snapshot(snapshot_path, {a, b, missing})),
+              3u);
+  auto synopses = load_catalog_snapshot(snapshot_path);
+  REQUIRE_EQUAL(synopses.size(), 2u);
+  CHECK_EQUAL(contents(synopses.at(a.first)), "foo");
+  CHECK_EQUAL(contents(synopses.at(b.first)), "barbaz");
+  // Partitions without a synopsis file fall back to reading it on startup.
+  CHECK(not synopses.contains(missing.first));
+}
+
+TEST(catalog snapshot reuses the previous snapshot) {
+  const auto a = make_synopsis(uuid::random(), "foo");
+  const auto b = make_synopsis(uuid::random(), "bar");
+  REQUIRE(write_catalog_snapshot(snapshot_path, {a, b}));
+  // Synopses from the previous snapshot do not need their files anymore, and
+  // partitions that no longer exist disappear from the snapshot.
+  std::filesystem::remove(a.second);
+  const auto c = make_synopsis(uuid::random(), "qux");
+  CHECK_EQUAL(unbox(write_catalog_snapshot(snapshot_path, {c, a})), 2u);
+  auto synopses = load_catalog_snapshot(snapshot_path);
+  REQUIRE_EQUAL(synopses.size(), 2u);
+  CHECK_EQUAL(contents(synopses.at(a.first)), "foo");
+  CHECK_EQUAL(contents(synopses.at(c.first)), "qux");
+  CHECK(not synopses.contains(b.first));
+}
+
+TEST(catalog snapshot ignores malformed files) {
+  REQUIRE(not io::save(snapshot_path, as_bytes(std::string_view{"garbage"})));
+  CHECK(load_catalog_snapshot(snapshot_path).empty());
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,94 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/columnar_json_printer.hpp"
+
+#include "tenzir/concept/parseable/tenzir/ip.hpp"
+#include "tenzir/concept/parseable/to.hpp"
+#include "tenzir/concept/printable/tenzir/json.hpp"
+#include "tenzir/series_builder.hpp"
+#include "tenzir/table_slice.hpp"
+#include "tenzir/test/test.hpp"
+#include "tenzir/view3.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+auto make_slice() -> table_slice {
+  auto b = series_builder{};
+  {
+    auto r = b.record();
+    r.field("b").data(true);
+    r.field("i").data(int64_t{-42});
+    r.field("u").data(uint64_t{42});
+    r.field("d").data(1.5);
+    r.field("s").data("a \"quoted\" string with a \\ and a\nnewline\x7f");
+    r.field("t").data(time{} + 1500ms);
+    r.field("dur").data(duration{90s});
+    r.field("ip").data(unbox(to<ip>("10.0.0.1")));
+    auto xs = r.field("xs").list();
+    xs.data(int64_t{1});
+    xs.data(int64_t{2});
+    r.field("nested").record().field("x").data("foo");
+  }
+  {
+    auto r = b.record();
+    r.field("b").data(false);
+    r.field("d").data(2.0);
+    r.field("s").data("");
+    r.field("xs").list();
+  }
+  return b.finish_assert_one_slice();
+}
+
+auto print_rows(const table_slice& slice, const json_printer_options& options)
+  -> std::string {
+  auto result = std::string{};
+  auto out = std::back_inserter(result);
+  auto printer = json_printer{options};
+  auto first = true;
+  for (auto&& row : values3(slice)) {
+    if (not first) {
+      result += '\n';
+    }
+    first = false;
+    REQUIRE(printer.print(out, row));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(columnar json printer matches json printer) {
+  const auto slice = make_slice();
+  for (auto oneline : {true, false}) {
+    const auto options = json_printer_options{
+      .style = no_style(),
+      .oneline = oneline,
+    };
+    REQUIRE(columnar_json_printer::supports(options));
+    auto printer = columnar_json_printer{slice.schema(), options};
+    auto buffer = std::vector<char>{};
+    printer.print(slice, "\n", buffer);
+    CHECK_EQUAL(std::string(buffer.begin(), buffer.end()),
+                print_rows(slice, options));
+  }
+}
+
+TEST(columnar json printer options) {
+  CHECK(
+    not columnar_json_printer::supports({.tql = true, .style = no_style()}));
+  CHECK(not columnar_json_printer::supports({.style = jq_style()}));
+  CHECK(not columnar_json_printer::supports(
+    {.style = no_style(), .omit_null_fields = true}));
+}
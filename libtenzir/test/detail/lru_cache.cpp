@@ -72,3 +72,43 @@ TEST(eject) {
   CHECK_EQUAL(x1, 42);
   CHECK_EQUAL(cache.size(), size_t{0});
 }
+
+struct int_weigher {
+  size_t operator()(int, int x) const {
+    return static_cast<size_t>(x);
+  }
+};
+
+TEST(weights) {
+  tenzir::detail::lru_cache<int, int, int_factory, int_weigher> cache(
+    10, int_factory{}, int_weigher{});
+  cache.get_or_load(3);
+  cache.get_or_load(4);
+  CHECK_EQUAL(cache.weight(), 7u);
+  // Exceeding the maximum weight evicts the least recently used entries.
+  cache.get_or_load(5);
+  CHECK_EQUAL(cache.size(), 2u);
+  CHECK_EQUAL(cache.weight(), 9u);
+  CHECK(!cache.contains(3));
+  // An entry heavier than the whole cache is kept until the next insertion.
+  cache.get_or_load(20);
+  CHECK_EQUAL(cache.size(), 1u);
+  CHECK_EQUAL(cache.weight(), 20u);
+  cache.drop(20);
+  CHECK_EQUAL(cache.weight(), 0u);
+}
+
+TEST(counters) {
+  tenzir::detail::lru_cache<int, int, int_factory> cache(2, int_factory{});
+  cache.get_or_load(0);
+  cache.get_or_load(1);
+  cache.get_or_load(0);
+  cache.get_or_load(2);
+  cache.get_or_load(1);
+  CHECK_EQUAL(cache.hits(), 1u);
+  CHECK_EQUAL(cache.misses(), 4u);
+  CHECK_EQUAL(cache.evictions(), 2u);
+  // Dropping an entry explicitly does not count as an eviction.
+  cache.drop(1);
+  CHECK_EQUAL(cache.evictions(), 2u);
+}
@@ -0,0 +1,254 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/chunk.hpp"
+#include "tenzir/collect.hpp"
+#include "tenzir/defaults.hpp"
+#include "tenzir/detail/narrow.hpp"
+#include "tenzir/expression.hpp"
+#include "tenzir/ids.hpp"
+#include "tenzir/plugin.hpp"
+#include "tenzir/series_builder.hpp"
+#include "tenzir/store.hpp"
+#include "tenzir/table_slice.hpp"
+#include "tenzir/test/test.hpp"
+#include "tenzir/uuid.hpp"
+
+#include <arrow/io/memory.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/record_batch.h>
+#include <arrow/util/key_value_metadata.h>
+
+#include <filesystem>
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+/// Creates a slice with the consecutive values `first`, ..., `first + rows - 1`
+/// in the field `x`.
+auto make_slice(int64_t first, int64_t rows) -> table_slice {
+  auto b = series_builder{};
+  for (auto x = first; x < first + rows; ++x) {
+    b.record().field("x").data(x);
+  }
+  return b.finish_assert_one_slice("test.event");
+}
+
+/// Creates a slice with the fields `x`, `r.a`, and `y`, where `r.a` is ten
+/// times `x` and `y` is `x` as a string.
+auto make_events(int64_t first, int64_t rows, time import_time)
+  -> table_slice {
+  auto b = series_builder{};
+  for (auto x = first; x < first + rows; ++x) {
+    auto event = b.record();
+    event.field("x").data(x);
+    event.field("r").record().field("a").data(x * 10);
+    event.field("y").data(fmt::to_string(x));
+  }
+  auto result = b.finish_assert_one_slice("test.layout");
+  result.import_time(import_time);
+  return result;
+}
+
+/// Checks that a store contains the consecutive values 0, ..., `rows - 1`.
+auto check_values(const base_store& store, int64_t rows) -> void {
+  auto expected = int64_t{0};
+  for (const auto& slice : store.slices()) {
+    CHECK_EQUAL(slice.offset(), detail::narrow<id>(expected));
+    for (auto row = size_t{0}; row < slice.rows(); ++row) {
+      CHECK_EQUAL(materialize(slice.at(row, 0)), data{expected++});
+    }
+  }
+  CHECK_EQUAL(expected, rows);
+}
+
+struct fixture {
+  fixture() {
+    const auto* plugin = plugins::find<store_plugin>("feather");
+    REQUIRE(plugin);
+    store = unbox(plugin->make_active_store());
+    passive = unbox(plugin->make_passive_store());
+    std::filesystem::create_directories(dir);
+    store->stage(staging_path);
+  }
+
+  ~fixture() {
+    auto err = std::error_code{};
+    std::filesystem::remove_all(dir, err);
+  }
+
+  /// Adds enough events that the store seals one record batch to the staging
+  /// file and keeps the remainder in memory.
+  auto fill() -> int64_t {
+    const auto batch_size
+      = detail::narrow<int64_t>(defaults::import::table_slice_size);
+    const auto rows = batch_size + 10;
+    for (auto first = int64_t{0}; first < rows; first += 8'192) {
+      REQUIRE(not store->add({make_slice(first, std::min(int64_t{8'192},
+                                                          rows - first))}));
+    }
+    return rows;
+  }
+
+  /// Persists slices in a store without a staging file.
+  static auto persist(std::vector<table_slice> slices) -> chunk_ptr {
+    const auto* plugin = plugins::find<store_plugin>("feather");
+    auto unstaged = unbox(plugin->make_active_store());
+    REQUIRE(not unstaged->add(std::move(slices)));
+    return unbox(unstaged->finish());
+  }
+
+  const time import_time = time{} + 42s;
+  const std::filesystem::path dir
+    = std::filesystem::temp_directory_path()
+      / fmt::format("tenzir-feather-store-{}", uuid::random());
+  const std::filesystem::path staging_path = dir / "store.feather.tmp";
+  std::unique_ptr<active_store> store;
+  std::unique_ptr<passive_store> passive;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(feather_store_tests, fixture)
+
+TEST(feather store stages record batches) {
+  CHECK(not store->has_staging_file());
+  CHECK(not std::filesystem::exists(staging_path));
+  const auto rows = fill();
+  CHECK(store->has_staging_file());
+  CHECK(std::filesystem::exists(staging_path));
+  // Queries see both the staged and the in-memory events.
+  CHECK_EQUAL(store->num_events(), detail::narrow<uint64_t>(rows));
+  check_values(*store, rows);
+  CHECK(not store->staging_error());
+  // The finished store lives in the staging file.
+  auto persisted = unbox(store->finish());
+  CHECK(not persisted);
+  REQUIRE(not passive->load(unbox(chunk::mmap(staging_path))));
+  CHECK_EQUAL(passive->num_events(), detail::narrow<uint64_t>(rows));
+  check_values(*passive, rows);
+}
+
+TEST(feather store without sealed record batches) {
+  REQUIRE(not store->add({make_slice(0, 10)}));
+  CHECK(not store->has_staging_file());
+  CHECK(not std::filesystem::exists(staging_path));
+  // Finishing the store writes the remaining events to the staging file.
+  auto persisted = unbox(store->finish());
+  CHECK(not persisted);
+  REQUIRE(not passive->load(unbox(chunk::mmap(staging_path))));
+  check_values(*passive, 10);
+}
+
+TEST(feather store fails when the staging file is gone) {
+  fill();
+  std::filesystem::remove(staging_path);
+  // The query ends early, but the store reports the error.
+  for ([[maybe_unused]] const auto& slice : store->slices()) {
+  }
+  CHECK(store->staging_error());
+  CHECK(store->add({make_slice(0, 1)}));
+  CHECK(not store->finish());
+}
+
+TEST(feather store flat layout) {
+  const auto events = make_events(0, 10, import_time);
+  const auto persisted = persist({events});
+  auto reader
+    = arrow::ipc::RecordBatchFileReader::Open(as_arrow_file(persisted))
+        .ValueOrDie();
+  // Every top-level field is a column of its own.
+  const auto& schema = *reader->schema();
+  REQUIRE_EQUAL(schema.num_fields(), 3);
+  CHECK_EQUAL(schema.field(0)->name(), "x");
+  CHECK_EQUAL(schema.field(1)->name(), "r");
+  CHECK_EQUAL(schema.field(2)->name(), "y");
+  // The import time lives in the custom metadata of the record batch. The
+  // empty record batch at the end holds the statistics.
+  REQUIRE_EQUAL(reader->num_record_batches(), 2);
+  auto batch = reader->ReadRecordBatchWithCustomMetadata(0).ValueOrDie();
+  REQUIRE(batch.custom_metadata);
+  CHECK_EQUAL(batch.custom_metadata->Get("TENZIR:import_time").ValueOrDie(),
+              fmt::to_string(import_time.time_since_epoch().count()));
+  REQUIRE(not passive->load(persisted));
+  CHECK_EQUAL(passive->num_events(), 10u);
+  CHECK_EQUAL(passive->schema(), events.schema());
+  auto slices = collect(passive->slices());
+  REQUIRE_EQUAL(slices.size(), 1u);
+  CHECK_EQUAL(slices[0].import_time(), import_time);
+  CHECK_EQUAL(materialize(slices[0].at(3, 1)), data{int64_t{30}});
+  CHECK_EQUAL(materialize(slices[0].at(3, 2)), data{std::string{"3"}});
+}
+
+TEST(feather store reads the legacy layout) {
+  // The legacy layout nests the events in a single `event` column next to an
+  // `import_time` column.
+  const auto events = make_events(0, 10, import_time);
+  const auto rb = to_record_batch(events);
+  auto event_array = rb->ToStructArray().ValueOrDie();
+  auto time_builder
+    = time_type::make_arrow_builder(arrow::default_memory_pool());
+  for (auto i = int64_t{0}; i < rb->num_rows(); ++i) {
+    REQUIRE(time_builder->Append(import_time.time_since_epoch().count()).ok());
+  }
+  auto time_array = time_builder->Finish().ValueOrDie();
+  const auto schema = arrow::schema(
+    {arrow::field("import_time", time_type::to_arrow_type()),
+     arrow::field("event", event_array->type(), rb->schema()->metadata())});
+  auto buffer = arrow::io::BufferOutputStream::Create().ValueOrDie();
+  auto writer = arrow::ipc::MakeFileWriter(buffer, schema).ValueOrDie();
+  REQUIRE(writer
+            ->WriteRecordBatch(*arrow::RecordBatch::Make(
+              schema, rb->num_rows(), {time_array, event_array}))
+            .ok());
+  REQUIRE(writer->Close().ok());
+  REQUIRE(not passive->load(chunk::make(buffer->Finish().ValueOrDie())));
+  CHECK_EQUAL(passive->num_events(), 10u);
+  CHECK_EQUAL(passive->schema(), events.schema());
+  auto slices = collect(passive->slices());
+  REQUIRE_EQUAL(slices.size(), 1u);
+  CHECK_EQUAL(slices[0].import_time(), import_time);
+  CHECK_EQUAL(materialize(slices[0].at(3, 1)), data{int64_t{30}});
+  // Legacy stores cannot read single columns, so they return all fields.
+  auto extracted
+    = collect(passive->extract(expression{}, ids{},
+                               std::vector<std::string>{"y"}));
+  REQUIRE_EQUAL(extracted.size(), 1u);
+  CHECK_EQUAL(extracted[0].schema(), events.schema());
+}
+
+TEST(feather store extracts projected columns) {
+  using enum relational_operator;
+  const auto events = make_events(0, 10, import_time);
+  REQUIRE(not passive->load(persist({events})));
+  // The predicate `r.a >= 50` refers to the flat index of `r.a`.
+  const auto expr = expression{predicate{
+    data_extractor{type{int64_type{}}, 1}, greater_equal, data{int64_t{50}}}};
+  auto projected = collect(
+    passive->extract(expr, ids{}, std::vector<std::string>{"y"}));
+  REQUIRE_EQUAL(projected.size(), 1u);
+  // The store reads the requested field and those that the expression needs.
+  const auto& schema = as<record_type>(projected[0].schema());
+  REQUIRE_EQUAL(schema.num_fields(), 2u);
+  CHECK_EQUAL(schema.field(0).name, "r");
+  CHECK_EQUAL(schema.field(1).name, "y");
+  REQUIRE_EQUAL(projected[0].rows(), 5u);
+  CHECK_EQUAL(projected[0].import_time(), import_time);
+  CHECK_EQUAL(materialize(projected[0].at(0, 0)), data{int64_t{50}});
+  CHECK_EQUAL(materialize(projected[0].at(0, 1)), data{std::string{"5"}});
+  // Without fields, the store returns all of them.
+  auto full = collect(passive->extract(expr, ids{}, std::nullopt));
+  REQUIRE_EQUAL(full.size(), 1u);
+  CHECK_EQUAL(full[0].schema(), events.schema());
+  CHECK_EQUAL(full[0].rows(), 5u);
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,180 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/group_table.hpp"
+
+#include "tenzir/detail/narrow.hpp"
+#include "tenzir/series_builder.hpp"
+#include "tenzir/test/test.hpp"
+
+#include <algorithm>
+
+namespace tenzir {
+
+namespace {
+
+auto make_series(const std::vector<data>& values) -> series {
+  auto b = series_builder{};
+  for (const auto& value : values) {
+    b.data(value);
+  }
+  return b.finish_assert_one_array();
+}
+
+auto make_keys(std::vector<std::vector<data>> columns)
+  -> std::vector<multi_series> {
+  auto result = std::vector<multi_series>{};
+  for (const auto& column : columns) {
+    result.emplace_back(make_series(column));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(group ids are dense and ordered by first appearance) {
+  auto table = group_table{1};
+  auto keys = make_keys({{int64_t{1}, int64_t{2}, int64_t{1}, int64_t{3},
+                          int64_t{2}}});
+  auto ids = table.insert(keys, 5);
+  CHECK_EQUAL(ids, (std::vector<uint32_t>{0, 1, 0, 2, 1}));
+  REQUIRE_EQUAL(table.size(), size_t{3});
+  CHECK_EQUAL(table.key(1)[0], data{int64_t{2}});
+  // Known keys keep their ids across batches.
+  keys = make_keys({{int64_t{3}, int64_t{4}}});
+  ids = table.insert(keys, 2);
+  CHECK_EQUAL(ids, (std::vector<uint32_t>{2, 3}));
+  CHECK_EQUAL(table.size(), size_t{4});
+}
+
+TEST(multiple key columns) {
+  auto table = group_table{2};
+  auto keys = make_keys({
+    {data{"a"}, data{"a"}, data{"b"}, data{"a"}},
+    {data{1.0}, data{2.0}, data{1.0}, data{-0.0}},
+  });
+  auto ids = table.insert(keys, 4);
+  CHECK_EQUAL(ids, (std::vector<uint32_t>{0, 1, 2, 3}));
+  keys = make_keys({
+    {data{"b"}, data{"a"}},
+    {data{1.0}, data{0.0}},
+  });
+  ids = table.insert(keys, 2);
+  CHECK_EQUAL(ids, (std::vector<uint32_t>{2, 3}));
+  REQUIRE_EQUAL(table.size(), size_t{4});
+  CHECK_EQUAL(table.key(2)[0], data{"b"});
+  CHECK_EQUAL(table.key(2)[1], data{1.0});
+}
+
+TEST(heterogeneous keys and nulls) {
+  auto table = group_table{1};
+  auto keys = std::vector<multi_series>{multi_series{std::vector<series>{
+    make_series({int64_t{1}, caf::none}),
+    make_series({data{"1"}, caf::none}),
+  }}};
+  auto ids = table.insert(keys, 4);
+  // Values of different types are distinct, but nulls are all equal.
+  CHECK_EQUAL(ids, (std::vector<uint32_t>{0, 1, 2, 1}));
+  REQUIRE_EQUAL(table.size(), size_t{3});
+  CHECK_EQUAL(table.key(1)[0], data{});
+}
+
+TEST(many groups) {
+  auto table = group_table{1};
+  auto values = std::vector<data>{};
+  for (auto i = uint64_t{0}; i < 10'000; ++i) {
+    values.emplace_back(i);
+  }
+  auto keys = make_keys({values});
+  auto ids = table.insert(keys, 10'000);
+  REQUIRE_EQUAL(table.size(), size_t{10'000});
+  for (auto i = uint32_t{0}; i < 10'000; ++i) {
+    CHECK_EQUAL(ids[i], i);
+  }
+  std::reverse(values.begin(), values.end());
+  keys = make_keys({values});
+  ids = table.insert(keys, 10'000);
+  CHECK_EQUAL(table.size(), size_t{10'000});
+  CHECK_EQUAL(ids.front(), uint32_t{9'999});
+  CHECK_EQUAL(ids.back(), uint32_t{0});
+  table.clear();
+  CHECK(table.empty());
+}
+
+TEST(single keys agree with key columns) {
+  auto table = group_table{2};
+  auto keys = make_keys({
+    {data{"a"}, data{"b"}, caf::none},
+    {data{1.5}, data{-0.0}, data{2.0}},
+  });
+  auto ids = table.insert(keys, 3);
+  CHECK_EQUAL(ids, (std::vector<uint32_t>{0, 1, 2}));
+  CHECK_EQUAL(table.insert(std::vector<data>{"b", 0.0}), uint32_t{1});
+  CHECK_EQUAL(table.insert(std::vector<data>{caf::none, 2.0}), uint32_t{2});
+  CHECK_EQUAL(table.insert(std::vector<data>{"a", 1.5}), uint32_t{0});
+  CHECK_EQUAL(table.insert(std::vector<data>{"a", 2.0}), uint32_t{3});
+  CHECK_EQUAL(table.size(), size_t{4});
+}
+
+TEST(keys of all types) {
+  const auto values = std::vector<data>{
+    int64_t{-1},
+    uint64_t{1},
+    2.5,
+    true,
+    data{"foo"},
+    time{} + std::chrono::seconds{1},
+    duration{std::chrono::seconds{2}},
+    list{int64_t{1}, data{"bar"}},
+    caf::none,
+    data{""},
+  };
+  auto table = group_table{1};
+  // Every value is a separate batch, so that each has its own type.
+  auto batches = std::vector<series>{};
+  for (const auto& value : values) {
+    batches.push_back(make_series({value}));
+  }
+  auto keys = std::vector<multi_series>{multi_series{std::move(batches)}};
+  auto ids = table.insert(keys, detail::narrow<int64_t>(values.size()));
+  REQUIRE_EQUAL(table.size(), values.size());
+  for (auto id = uint32_t{0}; id < values.size(); ++id) {
+    CHECK_EQUAL(ids[id], id);
+    CHECK_EQUAL(table.key(id)[0], values[id]);
+    CHECK_EQUAL(table.insert(std::vector<data>{values[id]}), id);
+  }
+  ids = table.insert(keys, detail::narrow<int64_t>(values.size()));
+  CHECK_EQUAL(table.size(), values.size());
+  for (auto id = uint32_t{0}; id < values.size(); ++id) {
+    CHECK_EQUAL(ids[id], id);
+  }
+}
+
+TEST(digests and size) {
+  auto table = group_table{1};
+  const auto empty_bytes = table.approx_bytes();
+  auto keys = make_keys({{data{"foo"}, data{"bar"}}});
+  table.insert(keys, 2);
+  CHECK_EQUAL(table.digest(1),
+              table.digest(table.insert(std::vector<data>{"bar"})));
+  CHECK_NOT_EQUAL(table.digest(0), table.digest(1));
+  CHECK_GREATER(table.approx_bytes(), empty_bytes);
+  table.clear();
+  CHECK_EQUAL(table.approx_bytes(), empty_bytes);
+}
+
+TEST(no key columns) {
+  auto table = group_table{};
+  CHECK(table.empty());
+  auto ids = table.insert({}, 3);
+  CHECK_EQUAL(ids, (std::vector<uint32_t>{0, 0, 0}));
+  CHECK_EQUAL(table.size(), size_t{1});
+  CHECK(table.key(0).empty());
+}
+
+} // namespace tenzir
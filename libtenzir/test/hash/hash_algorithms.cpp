@@ -114,6 +114,16 @@ TEST(xxh64 zero bytes) {
   h.add(bytes);
 }
 
+TEST(hexify into buffer) {
+  const auto bytes = std::array<std::byte, 4>{std::byte{0x00}, std::byte{0x0f},
+                                              std::byte{0xa5}, std::byte{0xff}};
+  auto buffer = std::array<char, 8>{};
+  auto* end = hexify(bytes, buffer.data());
+  CHECK(end == buffer.data() + buffer.size());
+  CHECK_EQUAL(std::string_view(buffer.data(), buffer.size()), "000fa5ff");
+  CHECK_EQUAL(hexify<policy::uppercase>(bytes), "000FA5FF");
+}
+
 TEST(md5 validity) {
   std::array<char, 3> foo = {'f', 'o', 'o'};
   auto digest = hexify(hash<md5>(foo));
@@ -20,11 +20,14 @@ using namespace tenzir;
 namespace {
 
 auto example_index_config = R"__(
+sort-by:
+  - :timestamp
 rules:
   - targets:
       - suricata.dns.dns.rrname
       - :addr
     fp-rate: 0.005
+    value-index: true
   - targets:
       - zeek.conn.id.orig_h
     partition-index: false
@@ -55,6 +58,9 @@ TEST(example configuration) {
   CHECK_EQUAL(rule1.fp_rate, 0.01); // default
   CHECK_EQUAL(rule0.create_partition_index, true); // default
   CHECK_EQUAL(rule1.create_partition_index, false);
+  CHECK_EQUAL(rule0.create_value_index, true);
+  CHECK_EQUAL(rule1.create_value_index, false); // default
+  CHECK_EQUAL(config.sort_by, std::vector<std::string>{":timestamp"});
 }
 
 TEST(should_create_partition_index will return true for empty rules)
@@ -102,3 +108,35 @@ TEST(should_create_partition_index will will use create_partition_index from
   CHECK_EQUAL(should_create_partition_index(in_y, rules_x), true);
   CHECK_EQUAL(should_create_partition_index(in_y, rules_y), true);
 }
+
+TEST(should_create_value_index requires an explicit rule) {
+  qualified_record_field in_x{schema, {0u}};
+  qualified_record_field in_y{schema, {1u}};
+  CHECK_EQUAL(should_create_value_index(in_x, {}), false);
+  // Rules create partition indexes by default, but not value indexes.
+  auto rules = std::vector{
+    index_config::rule{.targets = {"y.x"}},
+  };
+  CHECK_EQUAL(should_create_value_index(in_x, rules), false);
+  rules.front().create_value_index = true;
+  CHECK_EQUAL(should_create_value_index(in_x, rules), true);
+  CHECK_EQUAL(should_create_value_index(in_y, rules), false);
+}
+
+TEST(find_sort_field picks the first time field a target selects) {
+  const auto events = tenzir::type{
+    "z",
+    tenzir::record_type{
+      {"x", tenzir::uint64_type{}},
+      {"ts", tenzir::type{"timestamp", tenzir::time_type{}}},
+      {"end", tenzir::time_type{}},
+    },
+  };
+  CHECK(not find_sort_field(events, {}));
+  CHECK(not find_sort_field(events, {"z.x"}));
+  CHECK_EQUAL(unbox(find_sort_field(events, {":timestamp"})), (offset{1}));
+  CHECK_EQUAL(unbox(find_sort_field(events, {"z.end", ":timestamp"})),
+              (offset{2}));
+  CHECK_EQUAL(unbox(find_sort_field(events, {"z.x", ":time"})), (offset{1}));
+  CHECK(not find_sort_field(schema, {":timestamp"}));
+}
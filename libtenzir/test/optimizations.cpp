@@ -6,16 +6,22 @@
 // SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include "tenzir/detail/serialize.hpp"
 #include "tenzir/expression.hpp"
+#include "tenzir/pipeline.hpp"
 #include "tenzir/test/test.hpp"
 #include "tenzir/time.hpp"
 #include "tenzir/tql2/ast.hpp"
+#include "tenzir/tql2/exec.hpp"
 #include "tenzir/tql2/parser.hpp"
 
+#include <caf/binary_deserializer.hpp>
 #include <caf/test/dsl.hpp>
 
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 using namespace tenzir;
 
@@ -46,3 +52,106 @@ TEST(optimize now) {
   // test("-100d + now() < x");
   // test("x > -100d + now()");
 }
+
+TEST(fuse sort and head) {
+  auto dh = collecting_diagnostic_handler{};
+  auto provider = session_provider::make(dh);
+  auto s = session{provider};
+  const auto optimize = [&](std::string_view str) {
+    auto ast = parse_pipeline_with_bad_diagnostics(str, s);
+    REQUIRE(ast);
+    auto pipe = compile(std::move(*ast), s);
+    REQUIRE(pipe);
+    return std::move(pipe->optimize_into_filter().second).unwrap();
+  };
+  auto ops = optimize("sort x | head 3");
+  REQUIRE_EQUAL(ops.size(), size_t{1});
+  CHECK_EQUAL(ops[0]->name(), "tql2.sort");
+  ops = optimize("sort -x, y | head 3 | head 5");
+  REQUIRE_EQUAL(ops.size(), size_t{1});
+  CHECK_EQUAL(ops[0]->name(), "tql2.sort");
+  ops = optimize("sort x | tail 3");
+  CHECK_EQUAL(ops.size(), size_t{2});
+  ops = optimize("head 3 | sort x");
+  CHECK_EQUAL(ops.size(), size_t{2});
+}
+
+TEST(fuse consecutive where operators) {
+  auto dh = collecting_diagnostic_handler{};
+  auto provider = session_provider::make(dh);
+  auto s = session{provider};
+  const auto optimize = [&](std::string_view str) {
+    auto ast = parse_pipeline_with_bad_diagnostics(str, s);
+    REQUIRE(ast);
+    auto pipe = compile(std::move(*ast), s);
+    REQUIRE(pipe);
+    return std::move(pipe->optimize_into_filter().second).unwrap();
+  };
+  // Serializes and deserializes an operator.
+  const auto roundtrip = [](operator_ptr& op) {
+    auto buffer = caf::byte_buffer{};
+    REQUIRE(detail::serialize(buffer, op));
+    auto result = operator_ptr{};
+    auto f = caf::binary_deserializer{buffer.data(), buffer.size()};
+    REQUIRE(f.apply(result));
+    REQUIRE(result);
+    return result;
+  };
+  auto ops = optimize("where x.starts_with(\"a\")");
+  REQUIRE_EQUAL(ops.size(), size_t{1});
+  CHECK_EQUAL(ops[0]->name(), "where_assert_operator");
+  CHECK_EQUAL(roundtrip(ops[0])->name(), "where_assert_operator");
+  ops = optimize("where x.starts_with(\"a\") | where y.starts_with(\"b\") "
+                 "| where z.starts_with(\"c\")");
+  REQUIRE_EQUAL(ops.size(), size_t{1});
+  CHECK_EQUAL(ops[0]->name(), "fused_where_operator");
+  CHECK_EQUAL(roundtrip(ops[0])->name(), "fused_where_operator");
+  // Assertions are never fused.
+  ops = optimize("where x.starts_with(\"a\") | assert y.starts_with(\"b\")");
+  CHECK_EQUAL(ops.size(), size_t{2});
+}
+
+TEST(root fields) {
+  auto dh = collecting_diagnostic_handler{};
+  auto provider = session_provider::make(dh);
+  auto s = session{provider};
+  const auto root_fields = [&](std::string_view str) {
+    auto expr = parse_expression_with_bad_diagnostics(str, s);
+    REQUIRE(expr);
+    return expr->root_fields();
+  };
+  using fields = std::vector<std::string>;
+  CHECK_EQUAL(root_fields("42"), fields{});
+  CHECK_EQUAL(root_fields("x.y + z"), (fields{"x", "z"}));
+  CHECK_EQUAL(root_fields("f(this.x, this[\"y\"], x)"), (fields{"x", "y"}));
+  CHECK_EQUAL(root_fields("{a: b, ...c}"), (fields{"b", "c"}));
+  CHECK(not root_fields("this"));
+  CHECK_EQUAL(root_fields("x + this.y.z"), (fields{"x", "y"}));
+}
+
+TEST(propagate fields through operators) {
+  auto dh = collecting_diagnostic_handler{};
+  auto provider = session_provider::make(dh);
+  auto s = session{provider};
+  const auto input_fields = [&](std::string_view str) {
+    auto ast = parse_pipeline_with_bad_diagnostics(str, s);
+    REQUIRE(ast);
+    auto pipe = compile(std::move(*ast), s);
+    REQUIRE(pipe);
+    auto fields = std::optional<std::vector<std::string>>{};
+    auto ops = std::move(*pipe).unwrap();
+    for (auto it = ops.rbegin(); it != ops.rend(); ++it) {
+      fields = (*it)->input_fields(fields);
+    }
+    return fields;
+  };
+  using fields = std::vector<std::string>;
+  CHECK_EQUAL(input_fields("select x, y=z.a"), (fields{"x", "z"}));
+  CHECK_EQUAL(input_fields("where a > 1 | sort b | head 3 | select x"),
+              (fields{"a", "b", "x"}));
+  CHECK_EQUAL(input_fields("select x | set y = 1"), (fields{"x"}));
+  CHECK_EQUAL(input_fields("summarize x, count=count(), m=max(y)"),
+              (fields{"x", "y"}));
+  CHECK(not input_fields("where this != null | select x"));
+  CHECK(not input_fields("set y = 1"));
+}
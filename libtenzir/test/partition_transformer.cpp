@@ -0,0 +1,97 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/partition_transformer.hpp"
+
+#include "tenzir/defaults.hpp"
+#include "tenzir/index_config.hpp"
+#include "tenzir/partition_synopsis.hpp"
+#include "tenzir/series_builder.hpp"
+#include "tenzir/table_slice.hpp"
+#include "tenzir/test/test.hpp"
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+auto make_slice(std::vector<int> seconds, time import_time) -> table_slice {
+  auto b = series_builder{};
+  for (auto s : seconds) {
+    b.record().field("ts").data(time{} + std::chrono::seconds{s});
+  }
+  auto result = b.finish_assert_one_slice("test.event");
+  result.import_time(import_time);
+  return result;
+}
+
+auto timestamps(const table_slice& slice) -> std::vector<time> {
+  auto result = std::vector<time>{};
+  for (auto row = size_t{0}; row < slice.rows(); ++row) {
+    result.push_back(as<time>(materialize(slice.at(row, 0))));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(sort_by_time sorts across slices) {
+  const auto t1 = time{} + 100s;
+  const auto t2 = time{} + 200s;
+  auto slices = std::vector<table_slice>{};
+  slices.push_back(make_slice({6, 1}, t1));
+  slices.push_back(make_slice({3, 2}, t2));
+  slices.push_back(make_slice({5, 4}, t1));
+  const auto sorted = sort_by_time(std::move(slices), {"test.event.ts"});
+  // The events are sorted across all slices, and the result is split wherever
+  // the import time changes.
+  REQUIRE_EQUAL(sorted.size(), 3u);
+  CHECK_EQUAL(timestamps(sorted[0]), (std::vector<time>{time{} + 1s}));
+  CHECK_EQUAL(sorted[0].import_time(), t1);
+  CHECK_EQUAL(timestamps(sorted[1]),
+              (std::vector<time>{time{} + 2s, time{} + 3s}));
+  CHECK_EQUAL(sorted[1].import_time(), t2);
+  CHECK_EQUAL(timestamps(sorted[2]),
+              (std::vector<time>{time{} + 4s, time{} + 5s, time{} + 6s}));
+  CHECK_EQUAL(sorted[2].import_time(), t1);
+  // The import time range of a rebuilt synopsis covers the original range.
+  auto synopsis = partition_synopsis{};
+  for (const auto& slice : sorted) {
+    synopsis.add(slice, defaults::max_partition_size, index_config{});
+    synopsis.min_import_time
+      = std::min(synopsis.min_import_time, slice.import_time());
+    synopsis.max_import_time
+      = std::max(synopsis.max_import_time, slice.import_time());
+  }
+  CHECK_EQUAL(synopsis.min_import_time, t1);
+  CHECK_EQUAL(synopsis.max_import_time, t2);
+}
+
+TEST(sort_by_time merges slices with the same import time) {
+  const auto t1 = time{} + 100s;
+  auto slices = std::vector<table_slice>{};
+  slices.push_back(make_slice({4, 1}, t1));
+  slices.push_back(make_slice({3, 2}, t1));
+  const auto sorted = sort_by_time(std::move(slices), {"test.event.ts"});
+  REQUIRE_EQUAL(sorted.size(), 1u);
+  CHECK_EQUAL(timestamps(sorted[0]),
+              (std::vector<time>{time{} + 1s, time{} + 2s, time{} + 3s,
+                                 time{} + 4s}));
+  CHECK_EQUAL(sorted[0].import_time(), t1);
+}
+
+TEST(sort_by_time without a matching target) {
+  auto slices = std::vector<table_slice>{};
+  slices.push_back(make_slice({2, 1}, time{} + 1s));
+  slices.push_back(make_slice({4, 3}, time{} + 2s));
+  const auto sorted = sort_by_time(std::move(slices), {"test.event.x"});
+  REQUIRE_EQUAL(sorted.size(), 2u);
+  CHECK_EQUAL(timestamps(sorted[0]),
+              (std::vector<time>{time{} + 2s, time{} + 1s}));
+  CHECK_EQUAL(sorted[1].import_time(), time{} + 2s);
+}
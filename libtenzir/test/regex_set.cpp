@@ -0,0 +1,70 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/regex_set.hpp"
+
+#include "tenzir/arrow_utils.hpp"
+#include "tenzir/test/test.hpp"
+
+#include <arrow/array/array_binary.h>
+#include <arrow/array/array_primitive.h>
+#include <arrow/array/builder_binary.h>
+
+using namespace tenzir;
+
+TEST(regex_set matches the first pattern) {
+  auto set = unbox(regex_set::make({"foo", "o+", "^bar$", "[0-9]+"}));
+  CHECK_EQUAL(set.size(), 4u);
+  CHECK_EQUAL(set.match_first("foo"), std::optional<size_t>{0});
+  CHECK_EQUAL(set.match_first("xoox"), std::optional<size_t>{1});
+  CHECK_EQUAL(set.match_first("bar"), std::optional<size_t>{2});
+  CHECK_EQUAL(set.match_first("bar1"), std::optional<size_t>{3});
+  CHECK_EQUAL(set.match_first("baz"), std::nullopt);
+  auto matches = std::vector<int>{};
+  set.match_all("foo42", matches);
+  CHECK_EQUAL(matches, (std::vector<int>{0, 1, 3}));
+}
+
+TEST(regex_set full match) {
+  auto set = unbox(regex_set::make({"foo", "fo+"}, true));
+  CHECK_EQUAL(set.match_first("foo"), std::optional<size_t>{0});
+  CHECK_EQUAL(set.match_first("fooo"), std::optional<size_t>{1});
+  CHECK_EQUAL(set.match_first("xfoo"), std::nullopt);
+}
+
+TEST(regex_set invalid pattern) {
+  CHECK(not regex_set::make({"foo", "(bar"}));
+}
+
+TEST(regex_set string array) {
+  auto set = unbox(regex_set::make({"a", "b"}));
+  auto builder = arrow::StringBuilder{};
+  check(builder.Append("xbx"));
+  check(builder.AppendNull());
+  check(builder.Append("ab"));
+  check(builder.Append("c"));
+  auto strings = finish(builder);
+  auto result = set.match_first(*strings);
+  REQUIRE_EQUAL(result->length(), 4);
+  CHECK_EQUAL(result->Value(0), 1);
+  CHECK(result->IsNull(1));
+  CHECK_EQUAL(result->Value(2), 0);
+  CHECK(result->IsNull(3));
+}
+
+TEST(regex_set latin1 matches bytes) {
+  // "é" is a single code point that UTF-8 encodes as two bytes.
+  const auto input = std::string_view{"caf\xc3\xa9"};
+  auto utf8 = unbox(regex_set::make({"caf.", "caf.."}, true));
+  CHECK_EQUAL(utf8.match_first(input), std::optional<size_t>{0});
+  auto latin1 = unbox(
+    regex_set::make({"caf.", "caf.."}, true, regex_set::encoding::latin1));
+  CHECK_EQUAL(latin1.match_first(input), std::optional<size_t>{1});
+  // Inputs need not be valid UTF-8.
+  CHECK_EQUAL(latin1.match_first("caf\xe9"), std::optional<size_t>{0});
+}
@@ -0,0 +1,124 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/sketch/hyperloglog.hpp"
+
+#include "tenzir/hash/hash.hpp"
+#include "tenzir/test/test.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+using namespace tenzir;
+using namespace tenzir::sketch;
+
+namespace {
+
+auto relative_error(double estimate, double expected) -> double {
+  return std::abs(estimate - expected) / expected;
+}
+
+} // namespace
+
+TEST(hyperloglog precision) {
+  CHECK(not hyperloglog::make(3));
+  CHECK(not hyperloglog::make(19));
+  auto sketch = unbox(hyperloglog::make(12));
+  CHECK_EQUAL(sketch.precision(), 12);
+  CHECK_EQUAL(sketch.estimate(), 0.0);
+}
+
+TEST(hyperloglog small cardinalities) {
+  auto sketch = unbox(hyperloglog::make(12));
+  for (auto round = 0; round < 3; ++round) {
+    for (auto i = uint64_t{0}; i < 100; ++i) {
+      sketch.add(hash(i));
+    }
+  }
+  // Small cardinalities use the sparse representation, which is almost exact.
+  CHECK(sketch.dense().empty());
+  CHECK_EQUAL(std::llround(sketch.estimate()), 100);
+}
+
+TEST(hyperloglog large cardinalities) {
+  auto sketch = unbox(hyperloglog::make(12));
+  for (auto i = uint64_t{0}; i < 100'000; ++i) {
+    sketch.add(hash(i));
+  }
+  CHECK(sketch.sparse().empty());
+  CHECK_EQUAL(sketch.dense().size(), size_t{4'096});
+  // The standard error for a precision of 12 is about 1.6%.
+  CHECK_LESS(relative_error(sketch.estimate(), 100'000), 0.05);
+}
+
+TEST(hyperloglog merge) {
+  auto small = unbox(hyperloglog::make(12));
+  auto large = unbox(hyperloglog::make(12));
+  auto both = unbox(hyperloglog::make(12));
+  for (auto i = uint64_t{0}; i < 50'000; ++i) {
+    large.add(hash(i));
+    both.add(hash(i));
+  }
+  for (auto i = uint64_t{40'000}; i < 40'500; ++i) {
+    small.add(hash(i));
+    both.add(hash(i));
+  }
+  auto sparse = small;
+  sparse.merge(small);
+  CHECK_EQUAL(sparse.estimate(), small.estimate());
+  small.merge(large);
+  large.merge(sparse);
+  CHECK_EQUAL(small.estimate(), both.estimate());
+  CHECK_EQUAL(large.estimate(), both.estimate());
+  CHECK_LESS(relative_error(both.estimate(), 50'000), 0.05);
+}
+
+TEST(hyperloglog estimate does not depend on batching) {
+  // With repeated digests, the sketch compacts its sparse entries before it
+  // reaches the limit of the sparse representation, and then keeps adding
+  // new digests without switching.
+  auto whole = unbox(hyperloglog::make(12));
+  for (auto round = 0; round < 3; ++round) {
+    for (auto i = uint64_t{0}; i < 200; ++i) {
+      whole.add(hash(i));
+    }
+  }
+  for (auto i = uint64_t{200}; i < 1'100; ++i) {
+    whole.add(hash(i));
+  }
+  auto lower = unbox(hyperloglog::make(12));
+  auto upper = unbox(hyperloglog::make(12));
+  for (auto i = uint64_t{0}; i < 550; ++i) {
+    lower.add(hash(i));
+    upper.add(hash(i + 550));
+  }
+  // Merging compacts the entries, so the merged sketch switches right away.
+  lower.merge(upper);
+  CHECK(lower.sparse().empty());
+  CHECK_EQUAL(whole.estimate(), lower.estimate());
+  CHECK_LESS(relative_error(whole.estimate(), 1'100), 0.05);
+}
+
+TEST(hyperloglog roundtrip) {
+  auto sparse = unbox(hyperloglog::make(10));
+  for (auto i = uint64_t{0}; i < 42; ++i) {
+    sparse.add(hash(i));
+  }
+  auto copy = unbox(
+    hyperloglog::make(sparse.precision(), sparse.sparse(), sparse.dense()));
+  CHECK_EQUAL(copy.estimate(), sparse.estimate());
+  auto dense = unbox(hyperloglog::make(10));
+  for (auto i = uint64_t{0}; i < 10'000; ++i) {
+    dense.add(hash(i));
+  }
+  copy = unbox(
+    hyperloglog::make(dense.precision(), dense.sparse(), dense.dense()));
+  CHECK_EQUAL(copy.estimate(), dense.estimate());
+  // Representations that do not match the precision are rejected.
+  CHECK(not hyperloglog::make(11, {}, dense.dense()));
+}
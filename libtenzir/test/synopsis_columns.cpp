@@ -0,0 +1,155 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/synopsis_columns.hpp"
+
+#include "tenzir/int64_synopsis.hpp"
+#include "tenzir/test/test.hpp"
+#include "tenzir/time_synopsis.hpp"
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+const auto epoch = time{};
+
+const auto schema = type{
+  "foo",
+  record_type{
+    {"ts", time_type{}},
+    {"x", int64_type{}},
+    {"s", string_type{}},
+  },
+};
+
+auto make_synopsis(time first, time last, std::optional<int64_t> x)
+  -> partition_synopsis_ptr {
+  auto result = caf::make_copy_on_write<partition_synopsis>();
+  auto& ps = result.unshared();
+  ps.schema = schema;
+  ps.events = 10;
+  ps.min_import_time = first;
+  ps.max_import_time = last;
+  ps.field_synopses_[qualified_record_field{schema, offset{0}}]
+    = std::make_unique<time_synopsis>(first, last);
+  if (x) {
+    ps.field_synopses_[qualified_record_field{schema, offset{1}}]
+      = std::make_unique<int64_synopsis>(*x, *x + 10);
+  }
+  return result;
+}
+
+auto candidates(const synopsis_columns::candidate_mask& mask)
+  -> std::vector<size_t> {
+  auto result = std::vector<size_t>{};
+  for (auto i = size_t{0}; i < mask.size(); ++i) {
+    if (mask[i] != 0) {
+      result.push_back(i);
+    }
+  }
+  return result;
+}
+
+struct fixture {
+  fixture() {
+    auto xs = std::vector<std::pair<uuid, partition_synopsis_ptr>>{};
+    xs.emplace_back(uuid::random(), make_synopsis(epoch, epoch + 10s, 0));
+    xs.emplace_back(uuid::random(),
+                    make_synopsis(epoch + 10s, epoch + 20s, 20));
+    xs.emplace_back(uuid::random(),
+                    make_synopsis(epoch + 20s, epoch + 30s, std::nullopt));
+    partitions = synopsis_columns::synopsis_map{xs.begin(), xs.end()};
+    columns = synopsis_columns{schema, partitions};
+  }
+
+  synopsis_columns::synopsis_map partitions;
+  synopsis_columns columns;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(synopsis_columns_tests, fixture)
+
+TEST(synopsis columns layout) {
+  REQUIRE_EQUAL(columns.size(), size_t{3});
+  REQUIRE_EQUAL(columns.fields().size(), size_t{3});
+  CHECK_EQUAL(columns.fields()[1].field_name(), "x");
+  auto position = size_t{0};
+  for (const auto& [id, synopsis] : partitions) {
+    const auto info = columns.info(position++);
+    CHECK_EQUAL(info.uuid, id);
+    CHECK_EQUAL(info.events, synopsis->events);
+    CHECK_EQUAL(info.max_import_time, synopsis->max_import_time);
+    CHECK_EQUAL(info.schema, schema);
+  }
+}
+
+TEST(synopsis columns import time) {
+  const auto newer = columns.lookup_import_time(relational_operator::greater,
+                                                epoch + 25s);
+  const auto older
+    = columns.lookup_import_time(relational_operator::less, epoch + 1s);
+  auto position = size_t{0};
+  for (const auto& [_, synopsis] : partitions) {
+    CHECK_EQUAL(newer[position] != 0,
+                synopsis->min_import_time == epoch + 20s);
+    CHECK_EQUAL(older[position] != 0, synopsis->min_import_time == epoch);
+    ++position;
+  }
+}
+
+TEST(synopsis columns ranges) {
+  // The third partition has no synopsis for `x` and is always a candidate.
+  auto mask = unbox(
+    columns.lookup(1, relational_operator::equal, data{int64_t{25}}));
+  auto position = size_t{0};
+  for (const auto& [_, synopsis] : partitions) {
+    const auto has_range
+      = synopsis->field_synopses_.contains(columns.fields()[1]);
+    const auto in_range = synopsis->min_import_time == epoch + 10s;
+    CHECK_EQUAL(mask[position++] != 0, not has_range or in_range);
+  }
+  auto xs = data{list{int64_t{5}, int64_t{42}}};
+  mask = unbox(columns.lookup(1, relational_operator::in, xs));
+  CHECK_EQUAL(candidates(mask).size(), size_t{2});
+  // Mismatching types and fields without a range column fall back to the
+  // synopses.
+  CHECK(not columns.lookup(1, relational_operator::equal, data{"foo"}));
+  CHECK(not columns.lookup(2, relational_operator::equal, data{"foo"}));
+}
+
+TEST(synopsis columns store time) {
+  // All partitions are older than the cold tier threshold. The first one was
+  // written while it was hot, the second one was rebuilt for the cold tier,
+  // and the third one predates the store time, so it counts as written while
+  // it was hot.
+  const auto cold_store_after = duration{1min};
+  const auto now = epoch + 1h;
+  auto xs = std::vector<std::pair<uuid, partition_synopsis_ptr>>{};
+  xs.emplace_back(uuid::random(), make_synopsis(epoch, epoch + 10s, 0));
+  xs.back().second.unshared().store_time = epoch + 11s;
+  xs.emplace_back(uuid::random(), make_synopsis(epoch, epoch + 10s, 0));
+  xs.back().second.unshared().store_time = epoch + 30min;
+  xs.emplace_back(uuid::random(), make_synopsis(epoch, epoch + 10s, 0));
+  const auto aged = synopsis_columns::synopsis_map{xs.begin(), xs.end()};
+  const auto aged_columns = synopsis_columns{schema, aged};
+  auto position = size_t{0};
+  for (const auto& [id, synopsis] : aged) {
+    const auto info = aged_columns.info(position++);
+    CHECK_EQUAL(info.store_time, synopsis->store_time);
+    // A partition that was rebuilt for the cold tier is not selected again.
+    CHECK_EQUAL(info.is_due_for_cold_tier(cold_store_after, now),
+                synopsis->store_time != epoch + 30min);
+  }
+  // Partitions are never due before they cross the threshold.
+  CHECK(not aged_columns.info(0).is_due_for_cold_tier(cold_store_after,
+                                                      epoch + 30s));
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,60 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/to_lines.hpp"
+
+#include "tenzir/split_nulls.hpp"
+#include "tenzir/test/test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace tenzir;
+using namespace std::string_literals;
+
+namespace {
+
+auto make_chunks(std::vector<std::string> xs) -> generator<chunk_ptr> {
+  for (auto& x : xs) {
+    co_yield chunk::make(std::move(x));
+  }
+}
+
+auto collect(generator<std::optional<std::string_view>> lines)
+  -> std::vector<std::string> {
+  auto result = std::vector<std::string>{};
+  for (auto&& line : lines) {
+    if (line) {
+      result.emplace_back(*line);
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(to_lines line endings) {
+  auto lines = collect(to_lines(make_chunks({"foo\nbar\r\nbaz\rqux\n\n"})));
+  CHECK_EQUAL(lines, (std::vector<std::string>{"foo", "bar", "baz", "qux",
+                                               ""}));
+}
+
+TEST(to_lines across chunks) {
+  // A carriage return at the end of a chunk and a newline at the beginning of
+  // the next chunk form a single line break.
+  auto lines = collect(
+    to_lines(make_chunks({"fo", "o\r", "\nbar\nb", "", "az\r", "\r", "qux"})));
+  CHECK_EQUAL(lines, (std::vector<std::string>{"foo", "bar", "baz", "",
+                                               "qux"}));
+}
+
+TEST(split_nulls across chunks) {
+  auto lines
+    = collect(split_nulls(make_chunks({"foo\0b"s, "ar\0\0"s, "baz"s})));
+  CHECK_EQUAL(lines, (std::vector<std::string>{"foo", "bar", "", "baz"}));
+}
@@ -0,0 +1,191 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2024 The Tenzir Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tenzir/value_index.hpp"
+
+#include "tenzir/active_partition.hpp"
+#include "tenzir/bitmap_algorithms.hpp"
+#include "tenzir/concept/parseable/tenzir/data.hpp"
+#include "tenzir/concept/parseable/tenzir/expression.hpp"
+#include "tenzir/concept/parseable/to.hpp"
+#include "tenzir/detail/serialize.hpp"
+#include "tenzir/index_config.hpp"
+#include "tenzir/partition_synopsis.hpp"
+#include "tenzir/passive_partition.hpp"
+#include "tenzir/qualified_record_field.hpp"
+#include "tenzir/series_builder.hpp"
+#include "tenzir/test/test.hpp"
+
+#include <caf/binary_deserializer.hpp>
+
+using namespace tenzir;
+using namespace std::chrono_literals;
+
+namespace {
+
+auto selected(const std::optional<ids>& x) -> std::vector<id> {
+  REQUIRE(x);
+  auto result = std::vector<id>{};
+  for (auto i : select(*x)) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+} // namespace
+
+TEST(value index types) {
+  CHECK(value_index::make(type{string_type{}}));
+  CHECK(value_index::make(type{ip_type{}}));
+  CHECK(value_index::make(type{time_type{}}));
+  CHECK(value_index::make(type{int64_type{}}));
+  CHECK(not value_index::make(type{bool_type{}}));
+  CHECK(not value_index::make(type{list_type{int64_type{}}}));
+  CHECK(not value_index::make(type{time_type{}}, duration::zero()));
+}
+
+TEST(value index strings) {
+  auto index = unbox(value_index::make(type{string_type{}}));
+  index.append(make_view("foo"), 0);
+  index.append(make_view("bar"), 1);
+  index.append(make_view(caf::none), 2);
+  index.append(make_view("foo"), 3);
+  CHECK_EQUAL(index.size(), size_t{2});
+  CHECK_EQUAL(selected(index.lookup(relational_operator::equal,
+                                    make_view("foo"))),
+              (std::vector<id>{0, 3}));
+  CHECK(selected(index.lookup(relational_operator::equal, make_view("baz")))
+          .empty());
+  auto xs = data{list{"bar", "baz"}};
+  CHECK_EQUAL(selected(index.lookup(relational_operator::in, make_view(xs))),
+              (std::vector<id>{1}));
+  // Hashed keys have no order, and negations need to know about nulls.
+  CHECK(not index.lookup(relational_operator::less, make_view("foo")));
+  CHECK(not index.lookup(relational_operator::not_equal, make_view("foo")));
+  CHECK(not index.lookup(relational_operator::equal, make_view(int64_t{1})));
+}
+
+TEST(value index numbers) {
+  auto index = unbox(value_index::make(type{int64_type{}}));
+  for (auto i = int64_t{0}; i < 10; ++i) {
+    index.append(make_view(i % 5), static_cast<id>(i));
+  }
+  CHECK_EQUAL(selected(index.lookup(relational_operator::equal,
+                                    make_view(int64_t{2}))),
+              (std::vector<id>{2, 7}));
+  CHECK_EQUAL(selected(index.lookup(relational_operator::less,
+                                    make_view(int64_t{1}))),
+              (std::vector<id>{0, 5}));
+  CHECK_EQUAL(selected(index.lookup(relational_operator::greater_equal,
+                                    make_view(int64_t{4}))),
+              (std::vector<id>{4, 9}));
+}
+
+TEST(value index addresses) {
+  auto index = unbox(value_index::make(type{ip_type{}}));
+  index.append(make_view(unbox(to<ip>("10.0.0.1"))), 0);
+  index.append(make_view(unbox(to<ip>("10.0.1.1"))), 1);
+  index.append(make_view(unbox(to<ip>("192.168.0.1"))), 2);
+  index.append(make_view(unbox(to<ip>("10.0.0.42"))), 3);
+  auto sn = unbox(to<subnet>("10.0.0.0/24"));
+  CHECK_EQUAL(selected(index.lookup(relational_operator::in, make_view(sn))),
+              (std::vector<id>{0, 3}));
+  sn = unbox(to<subnet>("10.0.0.0/8"));
+  CHECK_EQUAL(selected(index.lookup(relational_operator::in, make_view(sn))),
+              (std::vector<id>{0, 1, 3}));
+}
+
+TEST(value index times) {
+  auto index = unbox(value_index::make(type{time_type{}}, 10s));
+  const auto epoch = time{};
+  index.append(make_view(epoch + 1s), 0);
+  index.append(make_view(epoch + 12s), 1);
+  index.append(make_view(epoch + 25s), 2);
+  CHECK_EQUAL(index.size(), size_t{3});
+  // Lookups are answered at the granularity of bins, so they may return
+  // false positives in the bin of the boundary.
+  CHECK_EQUAL(selected(index.lookup(relational_operator::equal,
+                                    make_view(epoch + 15s))),
+              (std::vector<id>{1}));
+  CHECK_EQUAL(selected(index.lookup(relational_operator::less,
+                                    make_view(epoch + 11s))),
+              (std::vector<id>{0, 1}));
+  CHECK_EQUAL(selected(index.lookup(relational_operator::greater,
+                                    make_view(epoch + 20s))),
+              (std::vector<id>{2}));
+}
+
+TEST(value index serialization) {
+  auto index = unbox(value_index::make(type{string_type{}}));
+  index.append(make_view("foo"), 0);
+  index.append(make_view("bar"), 42);
+  auto buffer = caf::byte_buffer{};
+  REQUIRE(detail::serialize(buffer, index));
+  auto copy = value_index{};
+  auto f = caf::binary_deserializer{buffer.data(), buffer.size()};
+  REQUIRE(f.apply(copy));
+  CHECK_EQUAL(copy.size(), index.size());
+  CHECK_EQUAL(copy.value_type(), index.value_type());
+  CHECK_EQUAL(selected(copy.lookup(relational_operator::equal,
+                                   make_view("bar"))),
+              (std::vector<id>{42}));
+}
+
+TEST(value index partition round trip) {
+  auto b = series_builder{};
+  for (auto i = 0; i < 4; ++i) {
+    auto r = b.record();
+    r.field("id").record().field("orig_h").data(
+      unbox(to<ip>(i % 2 == 0 ? "10.0.0.1" : "10.0.0.2")));
+    r.field("n").data(int64_t{i});
+  }
+  const auto slice = b.finish_assert_one_slice("test.conn");
+  const auto& schema = slice.schema();
+  auto data = active_partition_state::serialization_data{};
+  data.id = uuid::random();
+  data.events = slice.rows();
+  data.store_id = "feather";
+  data.store_header = chunk::make(std::string{"header"});
+  data.type_ids[std::string{schema.name()}].append_bits(true, slice.rows());
+  data.synopsis = caf::make_copy_on_write<partition_synopsis>();
+  data.synopsis.unshared().add(slice, defaults::max_partition_size,
+                               index_config{});
+  // The active partition indexes the field `id.orig_h`, which has the flat
+  // index 0.
+  const auto field_type = type{ip_type{}};
+  auto index = unbox(value_index::make(field_type));
+  for (auto row = size_t{0}; row < slice.rows(); ++row) {
+    index.append(slice.at(row, 0, field_type), row);
+  }
+  data.value_indexes.push_back({
+    .name = "id.orig_h",
+    .column = 0,
+    .index = std::move(index),
+  });
+  auto fields = std::vector<struct record_type::field>{};
+  for (const auto& [field, offset] : as<record_type>(schema).leaves()) {
+    const auto qf = qualified_record_field{schema, offset};
+    fields.emplace_back(std::string{qf.name()}, qf.type());
+  }
+  const auto partition = unbox(pack_full(data, record_type{fields}));
+  auto state = passive_partition_state{};
+  REQUIRE_EQUAL(state.initialize_from_chunk(partition), caf::none);
+  // Queries refer to fields by their key, which the partition tailors to its
+  // schema before consulting the value indexes.
+  CHECK_EQUAL(selected(state.lookup(
+                unbox(to<expression>("id.orig_h == 10.0.0.2")))),
+              (std::vector<id>{1, 3}));
+  CHECK_EQUAL(selected(state.lookup(
+                unbox(to<expression>("id.orig_h == 10.0.0.2 && n > 0")))),
+              (std::vector<id>{1, 3}));
+  CHECK(selected(state.lookup(unbox(to<expression>("id.orig_h == 10.0.0.3"))))
+          .empty());
+  CHECK(not state.lookup(unbox(to<expression>("n == 1"))));
+  CHECK(not state.lookup(unbox(to<expression>("id.orig_h == 10.0.0.2 || n == "
+                                              "1"))));
+}
@@ -0,0 +1,70 @@
+: "${BATS_TEST_TIMEOUT:=120}"
+
+setup() {
+  bats_load_library bats-support
+  bats_load_library bats-assert
+  bats_load_library bats-tenzir
+}
+
+# Writes numbered lines in the given printf format to the file `input`. The
+# input spans multiple megabytes, so that the parallel parsers split it into
+# several units of work.
+generate() {
+  awk -v format="$1" 'BEGIN { for (i = 0; i < 200000; ++i) printf format "\n", i, i }' \
+    >"${BATS_TEST_TMPDIR}/input"
+}
+
+# Parses the generated input both serially and with `_jobs=4`, and checks that
+# the results are the same events in the same order.
+check_parallel() {
+  run -0 --separate-stderr tenzir "$1
+write_ndjson" <"${BATS_TEST_TMPDIR}/input"
+  local serial="${output}"
+  assert_equal "${stderr}" ""
+  run -0 --separate-stderr tenzir "$1 _jobs=4
+write_ndjson" <"${BATS_TEST_TMPDIR}/input"
+  assert_equal "${stderr}" ""
+  assert_equal "$(wc -l <<<"${output}")" 200000
+  assert_equal "${output}" "${serial}"
+}
+
+# -- tests --------------------------------------------------
+
+# bats test_tags=json
+@test "parallel NDJSON parsing preserves the order" {
+  generate '{"x":%d,"y":"%d"}'
+  check_parallel "read_ndjson"
+  check_parallel "read_json"
+  # The events are exactly the input lines.
+  run -0 tenzir 'read_ndjson _jobs=4
+write_ndjson' <"${BATS_TEST_TMPDIR}/input"
+  assert_equal "${output}" "$(cat "${BATS_TEST_TMPDIR}/input")"
+}
+
+# bats test_tags=json
+@test "unordered parallel NDJSON parsing keeps all events" {
+  generate '{"x":%d,"y":"%d"}'
+  run -0 --separate-stderr tenzir 'unordered { read_ndjson _jobs=4 }
+sort x
+write_ndjson' <"${BATS_TEST_TMPDIR}/input"
+  assert_equal "${stderr}" ""
+  assert_equal "${output}" "$(cat "${BATS_TEST_TMPDIR}/input")"
+}
+
+# bats test_tags=cef
+@test "parallel CEF parsing preserves the order" {
+  generate 'CEF:0|Tenzir|Test|1.0|%d|Event|5|cnt=%d msg=hello'
+  check_parallel "read_cef"
+}
+
+# bats test_tags=leef
+@test "parallel LEEF parsing preserves the order" {
+  generate 'LEEF:1.0|Tenzir|Test|1.0|%d|cnt=%d\tmsg=hello'
+  check_parallel "read_leef"
+}
+
+# bats test_tags=syslog
+@test "parallel syslog parsing preserves the order" {
+  generate '<34>Oct 11 22:14:15 host app[%d]: message %d'
+  check_parallel "read_syslog"
+}
@@ -613,6 +613,19 @@ EOF
   echo "v4.5.0-71-gae887a0ca3-dirty" | check tenzir 'read grok "%{TIMESTAMP_ISO8601}"'
 }
 
+# bats test_tags=pipelines
+@test "Read Grok with multiple patterns" {
+  # The last line contains a non-ASCII character, which the patterns must
+  # match byte by byte.
+  printf 'GET /index\nuser alice logged in\ncaf\xc3\xa9 ok\n' >"${BATS_TEST_TMPDIR}/input.log"
+  run -0 --separate-stderr tenzir 'read_grok ["GET /%{WORD:x}", "user %{WORD:x} logged in", "caf.. %{WORD:x}"]
+write_ndjson' <"${BATS_TEST_TMPDIR}/input.log"
+  assert_output '{"x":"index"}
+{"x":"alice"}
+{"x":"ok"}'
+  assert_equal "${stderr}" ""
+}
+
 # bats test_tags=pipelines
 @test "Print JSON in CEF" {
   export TENZIR_LEGACY=true
@@ -0,0 +1,53 @@
+: "${BATS_TEST_TIMEOUT:=60}"
+
+setup() {
+  bats_load_library bats-support
+  bats_load_library bats-assert
+  bats_load_library bats-tenzir
+
+  export_default_node_config
+  export TENZIR_ACTIVE_PARTITION_TIMEOUT=1s
+  export TENZIR_COLD_STORE_AFTER=3s
+  setup_node
+}
+
+teardown() {
+  teardown_node
+}
+
+# Prints the partitions with user data, and whether their store was written
+# after they crossed the age threshold of the cold storage tier.
+partitions() {
+  tenzir 'partitions
+where not internal
+select uuid, events, cold=store_time >= max_import_time + 3s
+write_ndjson'
+}
+
+# -- tests --------------------------------------------------
+
+# bats test_tags=server,rebuild
+@test "rebuild partitions for the cold storage tier" {
+  tenzir 'from {x: 1}
+repeat 100
+import'
+  # Wait for the partition to be persisted and to cross the threshold.
+  sleep 4
+  run -0 partitions
+  local before="${output}"
+  assert_output --partial '"events":100,"cold":false'
+  run -0 tenzir-ctl rebuild start --cold
+  run -0 partitions
+  local after="${output}"
+  assert_output --partial '"events":100,"cold":true'
+  refute_output "${before}"
+  # The rebuilt partition is already compressed for the cold tier.
+  run -0 tenzir-ctl rebuild start --cold
+  run -0 partitions
+  assert_output "${after}"
+  # The data remains the same.
+  run -0 tenzir 'export
+summarize n=count(), total=sum(x)
+write_ndjson'
+  assert_output '{"n":100,"total":100}'
+}
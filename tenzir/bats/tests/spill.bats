@@ -0,0 +1,111 @@
+: "${BATS_TEST_TIMEOUT:=120}"
+
+# Operators that spill to disk above a memory limit must produce the same
+# results as when they keep everything in memory.
+
+setup() {
+  bats_load_library bats-support
+  bats_load_library bats-assert
+  bats_load_library bats-tenzir
+
+  export TENZIR_STATE_DIRECTORY="${BATS_TEST_TMPDIR}/db"
+}
+
+@test "summarize with spilling" {
+  local pipeline="load_file \"${INPUTSDIR}/json/conn.log.json.gz\"
+decompress_gzip
+read_json
+batch 50
+summarize proto, conn_state, n=count(), pkts=sum(orig_pkts),
+  bytes=sum(orig_bytes), smallest=min(orig_ip_bytes),
+  longest=max(duration), states=count_distinct(history)
+sort proto, conn_state"
+  run -0 --separate-stderr tenzir "${pipeline}"
+  local expected="${output}"
+  refute_output ""
+  # A limit of one byte spills the groups after every batch.
+  TENZIR_SUMMARIZE__MEMORY_LIMIT=1 run -0 --separate-stderr tenzir "${pipeline}"
+  assert_output "${expected}"
+  # The spilled partitions are gone after the pipeline finished.
+  run find "${TENZIR_STATE_DIRECTORY}/summarize" -type f
+  assert_output ""
+}
+
+@test "summarize approx_count_distinct with spilling" {
+  local pipeline="load_file \"${INPUTSDIR}/json/conn.log.json.gz\"
+decompress_gzip
+read_json
+batch 50
+summarize proto, exact=count_distinct(uid), uids=approx_count_distinct(uid),
+  coarse=approx_count_distinct(uid, precision=6),
+  states=approx_count_distinct(conn_state, precision=4)
+sort proto"
+  run -0 --separate-stderr tenzir "${pipeline}"
+  local expected="${output}"
+  refute_output ""
+  # Spilling saves and restores the sketches of every group after every batch,
+  # and merges the restored sketches, which must not change the estimates.
+  TENZIR_SUMMARIZE__MEMORY_LIMIT=1 run -0 --separate-stderr tenzir "${pipeline}"
+  assert_output "${expected}"
+  run find "${TENZIR_STATE_DIRECTORY}/summarize" -type f
+  assert_output ""
+}
+
+@test "sort with spilling" {
+  local pipeline="load_file \"${INPUTSDIR}/json/conn.log.json.gz\"
+decompress_gzip
+read_json
+batch 50
+sort proto, -orig_bytes, ts, uid"
+  run -0 --separate-stderr tenzir "${pipeline}"
+  local expected="${output}"
+  refute_output ""
+  # A limit of one byte writes every batch as a separate sorted run, so the
+  # result comes entirely from merging the runs.
+  TENZIR_SORT__MEMORY_LIMIT=1 run -0 --separate-stderr tenzir "${pipeline}"
+  assert_output "${expected}"
+  run find "${TENZIR_STATE_DIRECTORY}/sort" -type f
+  assert_output ""
+  # The merged runs are in sorted order.
+  TENZIR_SORT__MEMORY_LIMIT=1 run -0 --separate-stderr tenzir "load_file \"${INPUTSDIR}/json/conn.log.json.gz\"
+decompress_gzip
+read_json
+batch 50
+sort uid
+select uid"
+  assert_output "$(LC_ALL=C sort <<<"${output}")"
+}
+
+@test "sort with spilling and multiple merge passes" {
+  local pipeline="load_file \"${INPUTSDIR}/json/conn.log.json.gz\"
+decompress_gzip
+read_json
+batch 50
+sort proto, -orig_bytes, ts, uid"
+  run -0 --separate-stderr tenzir "${pipeline}"
+  local expected="${output}"
+  refute_output ""
+  # With far more runs than the sort may open at the same time, it merges
+  # them into intermediate runs first.
+  TENZIR_SORT__MEMORY_LIMIT=1 TENZIR_SORT__MAX_OPEN_RUNS=2 \
+    run -0 --separate-stderr tenzir "${pipeline}"
+  assert_output "${expected}"
+  TENZIR_SORT__MEMORY_LIMIT=1 TENZIR_SORT__MAX_OPEN_RUNS=3 \
+    run -0 --separate-stderr tenzir "${pipeline}"
+  assert_output "${expected}"
+  run find "${TENZIR_STATE_DIRECTORY}/sort" -type f
+  assert_output ""
+}
+
+@test "legacy sort with spilling" {
+  export TENZIR_LEGACY=true
+  local pipeline="from ${INPUTSDIR}/json/conn.log.json.gz read json
+| batch 50
+| sort uid
+| write json -c"
+  run -0 --separate-stderr tenzir "${pipeline}"
+  local expected="${output}"
+  refute_output ""
+  TENZIR_SORT__MEMORY_LIMIT=1 run -0 --separate-stderr tenzir "${pipeline}"
+  assert_output "${expected}"
+}